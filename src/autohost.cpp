@@ -222,7 +222,7 @@ void AutoHost::OnSaidBattle(const wxString& /*unused*/, const wxString& msg)
 /// Should only be called if user isn't immediately kicked (ban / rank limit)
 void AutoHost::OnUserAdded(User& user)
 {
-	m_userlist.Add(TowxString(user.GetNick()));
+	m_userlist.Add(user.GetNickWx());
 	// do nothing if autohost functionality is disabled
 	if (!m_enabled)
 		return;
@@ -232,8 +232,8 @@ void AutoHost::OnUserAdded(User& user)
 
 void AutoHost::OnUserRemoved(User& user)
 {
-	if (m_userlist.Index(TowxString(user.GetNick())) != wxNOT_FOUND) //triggers assertion in arraystring otherwise
-		m_userlist.Remove(TowxString(user.GetNick()));
+	if (m_userlist.Index(user.GetNickWx()) != wxNOT_FOUND) //triggers assertion in arraystring otherwise
+		m_userlist.Remove(user.GetNickWx());
 	// do nothing if autohost functionality is disabled
 	if (!m_enabled)
 		return;
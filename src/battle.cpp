@@ -92,9 +92,9 @@ void Battle::Leave()
 
 void Battle::OnPlayerTrueskillChanged(const std::string& NickName, double TrueSkill)
 {
-	for (user_map_t::size_type i = 0; i < GetNumUsers(); i++) {
+	for (size_type i = 0; i < GetNumUsers(); i++) {
 		User& u = GetUser(i);
-		if (TowxString(u.GetNick()).Lower() == TowxString(NickName)) {
+		if (u.GetNickWx().Lower() == TowxString(NickName)) {
 			u.SetTrueSkill(TrueSkill);
 			return;
 		}
@@ -273,7 +273,7 @@ void Battle::OnUserBattleStatusUpdated(User& user, UserBattleStatus status)
 	}
 	IBattle::OnUserBattleStatusUpdated(user, status);
 	if (status.handicap != 0) {
-		UiEvents::GetUiEventSender(UiEvents::OnBattleActionEvent).SendEvent(UiEvents::OnBattleActionData(wxString(_T(" ")), (_T("Warning: user ") + TowxString(user.GetNick()) + _T(" got bonus ")) << status.handicap));
+		UiEvents::GetUiEventSender(UiEvents::OnBattleActionEvent).SendEvent(UiEvents::OnBattleActionData(wxString(_T(" ")), (_T("Warning: user ") + user.GetNickWx() + _T(" got bonus ")) << status.handicap));
 	}
 	if (IsFounderMe()) {
 		if (ShouldAutoStart()) {
@@ -302,7 +302,7 @@ void Battle::OnUserRemoved(User& user)
 
 void Battle::RingNotReadyPlayers()
 {
-	for (user_map_t::size_type i = 0; i < GetNumUsers(); i++) {
+	for (size_type i = 0; i < GetNumUsers(); i++) {
 		User& u = GetUser(i);
 		UserBattleStatus& bs = u.BattleStatus();
 		if (bs.IsBot())
@@ -314,7 +314,7 @@ void Battle::RingNotReadyPlayers()
 
 void Battle::RingNotSyncedPlayers()
 {
-	for (user_map_t::size_type i = 0; i < GetNumUsers(); i++) {
+	for (size_type i = 0; i < GetNumUsers(); i++) {
 		User& u = GetUser(i);
 		UserBattleStatus& bs = u.BattleStatus();
 		if (bs.IsBot())
@@ -425,9 +425,9 @@ bool Battle::ExecuteSayCommand(const std::string& cmd)
 bool Battle::CheckBan(User& user)
 {
 	if (IsFounderMe()) {
-		if (m_banned_users.count(user.GetNick()) > 0 || useractions().DoActionOnUser(UserActions::ActAutokick, TowxString(user.GetNick()))) {
+		if (m_banned_users.count(user.GetNick()) > 0 || useractions().DoActionOnUser(UserActions::ActAutokick, user.GetNickId())) {
 			KickPlayer(user);
-			UiEvents::GetUiEventSender(UiEvents::OnBattleActionEvent).SendEvent(UiEvents::OnBattleActionData(wxString(_T(" ")), TowxString(user.GetNick()) + _T(" is banned, kicking")));
+			UiEvents::GetUiEventSender(UiEvents::OnBattleActionEvent).SendEvent(UiEvents::OnBattleActionData(wxString(_T(" ")), user.GetNickWx() + _T(" is banned, kicking")));
 			return true;
 		} else if (m_banned_ips.count(user.BattleStatus().ip) > 0) {
 			UiEvents::GetUiEventSender(UiEvents::OnBattleActionEvent).SendEvent(UiEvents::OnBattleActionData(wxString(_T(" ")), TowxString(user.BattleStatus().ip) + _T(" is banned, kicking")));
@@ -637,7 +637,7 @@ void Battle::OnTimer(wxTimerEvent&)
 			continue;
 		if (&usr == &GetMe())
 			continue;
-		std::map<std::string, time_t>::const_iterator itor = m_ready_up_map.find(usr.GetNick());
+		std::map<StringId, time_t>::const_iterator itor = m_ready_up_map.find(usr.GetNickId());
 		if (itor != m_ready_up_map.end()) {
 			if ((now - itor->second) > autospect_trigger_time) {
 				ForceSpectator(usr, true);
@@ -657,7 +657,7 @@ void Battle::SetInGame(bool value)
 				continue;
 			if (status.ready && status.sync)
 				continue;
-			m_ready_up_map[user.GetNick()] = now;
+			m_ready_up_map[user.GetNickId()] = now;
 		}
 	}
 	IBattle::SetInGame(value);
@@ -668,7 +668,7 @@ void Battle::FixColours()
 {
 	if (!IsFounderMe())
 		return;
-	const std::vector<LSL::lslColor>& palette = GetFixColoursPalette(m_teams_sizes.size() + 1);
+	const std::vector<LSL::lslColor>& palette = GetFixColoursPalette(m_status_counts.teams.size() + 1);
 	std::vector<int> palette_use(palette.size(), 0);
 
 	LSL::lslColor my_col = GetMe().BattleStatus().colour; // Never changes color of founder (me) :-)
@@ -677,7 +677,7 @@ void Battle::FixColours()
 	palette_use[my_col_i]++;
 	std::set<int> parsed_teams;
 
-	for (user_map_t::size_type i = 0; i < GetNumUsers(); i++) {
+	for (size_type i = 0; i < GetNumUsers(); i++) {
 		User& user = GetUser(i);
 		if (&user == &GetMe())
 			continue; // skip founder ( yourself )
@@ -691,7 +691,7 @@ void Battle::FixColours()
 		LSL::lslColor& user_col = status.colour;
 		int user_col_i = GetClosestFixColour(user_col, palette_use, 60);
 		palette_use[user_col_i]++;
-		for (user_map_t::size_type j = 0; j < GetNumUsers(); j++) {
+		for (size_type j = 0; j < GetNumUsers(); j++) {
 			User& usr = GetUser(j);
 			if (usr.BattleStatus().team == status.team) {
 				ForceColour(usr, palette[user_col_i]);
@@ -918,7 +918,7 @@ void Battle::Autobalance(BalanceType balance_type, bool support_clans, bool stro
 		alliances[my_random(rnd_k)].AddPlayer(players_sorted[i]);
 	}
 
-	UserList::user_map_t::size_type totalplayers = GetNumUsers();
+	UserList::size_type totalplayers = GetNumUsers();
 	for (size_t i = 0; i < alliances.size(); ++i) {
 		for (size_t j = 0; j < alliances[i].players.size(); ++j) {
 			ASSERT_LOGIC(alliances[i].players[j], "fail in Autobalance, NULL player");
@@ -1077,7 +1077,7 @@ void Battle::FixTeamIDs(BalanceType balance_type, bool support_clans, bool stron
 	for (size_t i = 0; i < control_teams.size(); ++i) {
 		for (size_t j = 0; j < control_teams[i].players.size(); ++j) {
 			ASSERT_LOGIC(control_teams[i].players[j], "fail in Autobalance teams, NULL player");
-			wxString msg = wxString::Format(_T("setting player %s to team and ally %d"), TowxString(control_teams[i].players[j]->GetNick()).c_str(), i);
+			wxString msg = wxString::Format(_T("setting player %s to team and ally %d"), control_teams[i].players[j]->GetNickWx().c_str(), i);
 			wxLogMessage(_T("%s"), msg.c_str());
 			ForceTeam(*control_teams[i].players[j], control_teams[i].teamnum);
 			ForceAlly(*control_teams[i].players[j], control_teams[i].teamnum);
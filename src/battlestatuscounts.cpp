@@ -0,0 +1,65 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "battlestatuscounts.h"
+
+#include "user.h"
+
+void BattleStatusCounts::Add(const UserBattleStatus& status)
+{
+	if (status.spectator)
+		return;
+	Join(teams, status.team);
+	Join(allies, status.ally);
+	if (status.IsBot())
+		return;
+	if (status.ready)
+		ready++;
+	if (status.sync)
+		sync++;
+	if (status.ready && status.sync)
+		ok++;
+}
+
+void BattleStatusCounts::Remove(const UserBattleStatus& status)
+{
+	if (status.spectator)
+		return;
+	Leave(teams, status.team);
+	Leave(allies, status.ally);
+	if (status.IsBot())
+		return;
+	if (status.ready)
+		ready--;
+	if (status.sync)
+		sync--;
+	if (status.ready && status.sync)
+		ok--;
+}
+
+void BattleStatusCounts::Clear()
+{
+	teams.clear();
+	allies.clear();
+	ready = 0;
+	sync = 0;
+	ok = 0;
+}
+
+bool BattleStatusCounts::operator==(const BattleStatusCounts& other) const
+{
+	return ready == other.ready && sync == other.sync && ok == other.ok && teams == other.teams && allies == other.allies;
+}
+
+void BattleStatusCounts::Join(std::map<int, int>& sizes, int key)
+{
+	sizes[key]++;
+}
+
+void BattleStatusCounts::Leave(std::map<int, int>& sizes, int key)
+{
+	std::map<int, int>::iterator it = sizes.find(key);
+	if (it == sizes.end())
+		return;
+	if (--it->second == 0)
+		sizes.erase(it);
+}
@@ -0,0 +1,37 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_BATTLESTATUSCOUNTS_H
+#define SPRINGLOBBY_HEADERGUARD_BATTLESTATUSCOUNTS_H
+
+#include <map>
+
+struct UserBattleStatus;
+
+//! @brief Team and ally sizes and the ready/sync counters of the players in
+//! a battle, spectators aren't counted.
+//! Add() and Remove() adjust the counters by the status of a single user, so
+//! a status update is a Remove() of the old and an Add() of the new status
+//! instead of a recount of all users.
+struct BattleStatusCounts {
+	std::map<int, int> teams;  //!< controlteam -> number of players in
+	std::map<int, int> allies; //!< allyteam -> number of players in
+	unsigned int ready = 0;    //!< bots are never ready or synced
+	unsigned int sync = 0;
+	unsigned int ok = 0; //!< players which are ready and in sync
+
+	void Add(const UserBattleStatus& status);
+	void Remove(const UserBattleStatus& status);
+	void Clear();
+
+	bool operator==(const BattleStatusCounts& other) const;
+	bool operator!=(const BattleStatusCounts& other) const
+	{
+		return !(*this == other);
+	}
+
+	static void Join(std::map<int, int>& sizes, int key);
+	//! drops the entry once it is empty
+	static void Leave(std::map<int, int>& sizes, int key);
+};
+
+#endif // SPRINGLOBBY_HEADERGUARD_BATTLESTATUSCOUNTS_H
@@ -22,6 +22,7 @@ Channel::Channel(IServer& serv)
     , m_serv(serv)
     , m_do_ban_regex(false)
     , m_do_unban_regex(false)
+    , m_name(0)
 {
 }
 
@@ -32,17 +33,23 @@ Channel::~Channel()
 		panel = nullptr;
 		tmp->SetChannel(nullptr);
 	}
+	for (User* user : GetUsers()) {
+		user->OnLeftChannel(*this);
+	}
+	StringPool::Instance()->Release(m_name);
 }
 
 void Channel::SetName(const std::string& name)
 {
-	m_name = name;
+	const StringId old = m_name;
+	m_name = StringPool::Instance()->Intern(name);
+	StringPool::Instance()->Release(old);
 }
 
 
-std::string Channel::GetName() const
+const std::string& Channel::GetName() const
 {
-	return m_name;
+	return StringPool::Instance()->GetString(m_name);
 }
 
 
@@ -59,14 +66,14 @@ void Channel::Said(User& who, const std::string& message)
 		wxLogError(_T("OnChannelSaid: ud->panel NULL"));
 		return;
 	}
-	panel->Said(TowxString(who.GetNick()), TowxString(message));
+	panel->Said(who.GetNickWx(), TowxString(message));
 }
 
 
 void Channel::Say(const std::string& message)
 {
 	slLogDebugFunc("");
-	m_serv.SayChannel(m_name, message);
+	m_serv.SayChannel(GetName(), message);
 }
 
 
@@ -77,20 +84,21 @@ void Channel::DidAction(User& who, const std::string& action)
 		wxLogError(_T("OnChannelDidAction: ud->panel NULL"));
 		return;
 	}
-	panel->DidAction(TowxString(who.GetNick()), TowxString(action));
+	panel->DidAction(who.GetNickWx(), TowxString(action));
 }
 
 
 void Channel::DoAction(const std::string& action)
 {
 	slLogDebugFunc("");
-	m_serv.DoActionChannel(m_name, action);
+	m_serv.DoActionChannel(GetName(), action);
 }
 
 
 void Channel::Left(User& who, const std::string& reason)
 {
-	RemoveUser(who.GetNick());
+	RemoveUser(who.GetNickId());
+	who.OnLeftChannel(*this);
 	//wxLogDebugFunc( wxEmptyString );
 	if (panel == nullptr) {
 		wxLogWarning(_T("OnUserLeftChannel: ud->panel NULL"));
@@ -102,12 +110,12 @@ void Channel::Left(User& who, const std::string& reason)
 
 void Channel::Leave()
 {
-	m_serv.PartChannel(m_name);
+	m_serv.PartChannel(GetName());
 }
 
 void Channel::Rejoin()
 {
-	m_serv.JoinChannel(m_name, m_password);
+	m_serv.JoinChannel(GetName(), m_password);
 }
 
 
@@ -161,6 +169,7 @@ std::string Channel::GetTopic()
 void Channel::AddUser(User& user)
 {
 	UserList::AddUser(user);
+	user.OnJoinedChannel(*this);
 	CheckBanned(user.GetNick());
 }
 
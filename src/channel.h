@@ -26,7 +26,7 @@ public:
 	}
 
 	void SetName(const std::string& name);
-	std::string GetName() const;
+	const std::string& GetName() const;
 	User& GetMe();
 
 	// filtering functions
@@ -57,8 +57,6 @@ public:
 	std::string GetPassword() const;
 	void SetPassword(const std::string& pw);
 
-	std::set<std::string> user_list;
-
 private:
 	IServer& m_serv;
 
@@ -74,7 +72,7 @@ private:
 
 	std::string m_topic;
 	std::string m_topic_nick;
-	std::string m_name;
+	StringId m_name;
 
 	std::string m_password;
 
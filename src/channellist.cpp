@@ -17,9 +17,10 @@ lsl/container/channellist.cpp
 
 #include "channel.h"
 #include "log.h"
+#include "user.h"
 #include "utils/conversion.h"
 
-const UserList::user_map_t::size_type SEEKPOS_INVALID = UserList::user_map_t::size_type(-1);
+const UserList::size_type SEEKPOS_INVALID = UserList::size_type(-1);
 
 ChannelList::ChannelList()
     : m_seek(m_chans.end())
@@ -62,13 +63,10 @@ bool ChannelList::ChannelExists(const std::string& name) const
 	return m_chans.find(name) != m_chans.end();
 }
 
-bool ChannelList::UserExists(const std::string& nick) const
+bool ChannelList::UserExists(const User& user) const
 {
-	for (auto p : m_chans) {
-		Channel* channel = p.second;
-		if (channel->panel == nullptr)
-			continue;
-		if (channel->UserExists(nick))
+	for (const Channel* channel : user.GetChannels()) {
+		if (channel->panel != nullptr)
 			return true;
 	}
 	return false;
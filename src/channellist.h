@@ -19,6 +19,7 @@ lsl/container/channellist.h
 #include <wx/string.h>
 
 class Channel;
+class User;
 
 //! @brief mapping from channel name to channel object
 typedef std::map<std::string, Channel*> channel_map_t;
@@ -35,7 +36,8 @@ public:
 	Channel& GetChannel(const std::string& name);
 	Channel& GetChannel(channel_map_t::size_type index);
 	bool ChannelExists(const std::string& name) const;
-	bool UserExists(const std::string& nick) const;
+	//! true if user is in a channel which has a chat panel
+	bool UserExists(const User& user) const;
 	channel_map_t::size_type GetNumChannels() const;
 
 private:
@@ -12,13 +12,22 @@
 #include <wx/intl.h>
 #include <wx/log.h>
 #include <wx/string.h>
+#include <algorithm>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
 
+#include "chatlogwriter.h"
+#ifndef TEST
+#include "chatlogindex.h"
+#endif
 #include "settings.h"
 #include "utils/conversion.h"
 #include "utils/platform.h"
 #include "utils/slconfig.h"
 #include "utils/slpaths.h"
+#include "utils/tailscanner.h"
 
 #ifndef TEST
 SLCONFIG("/ChatLog/chatlog_enable", true, "Log chat messages");
@@ -26,13 +35,14 @@ SLCONFIG("/ChatLog/chatlog_enable", true, "Log chat messages");
 
 ChatLog::ChatLog()
     : m_active(false)
+    , m_logfile(-1)
 {
 }
 
 ChatLog::ChatLog(const wxString& logname)
     : m_logname(logname)
     , m_active(false)
-    , m_logfile()
+    , m_logfile(-1)
 {
 	wxLogMessage(_T( "ChatLog::ChatLog( %s )" ), logname.c_str());
 	if (LogEnabled()) {
@@ -55,7 +65,7 @@ bool ChatLog::SetLogFile(const wxString& logname)
 
 	m_logname.Replace(wxT(":"), wxT("_"));
 	if (logname != m_logname) {
-		if (m_logfile.IsOpened()) {
+		if (m_logfile >= 0) {
 			CloseSession();
 		}
 		m_logname = logname;
@@ -72,14 +82,19 @@ ChatLog::~ChatLog()
 
 void ChatLog::CloseSession()
 {
-	if (!m_logfile.IsOpened()) {
+	if (m_logfile < 0) {
 		return;
 	}
 
 	AddMessage(_T("### ") + wxString::Format(_("Session Closed at %s"), GetDateTimeString()));
-	m_logfile.Flush();
 	m_active = false;
-	m_logfile.Close();
+	if (!ChatLogWriter::Instance()->Close(m_logfile)) {
+		wxLogWarning(_T("Couldn't write to %s"), m_logname.c_str());
+	}
+	m_logfile = -1;
+#ifndef TEST
+	ChatLogIndex::Instance()->Unwatch(STD_STRING(m_logfilepath));
+#endif
 }
 
 bool ChatLog::AddMessage(const wxString& text)
@@ -90,12 +105,9 @@ bool ChatLog::AddMessage(const wxString& text)
 	if (!m_active) { //logging is enabled, logfile should be writeable
 		return false;
 	}
-	const bool res = m_logfile.Write(text + wxTextBuffer::GetEOL(), wxConvUTF8);
-	if (!res) {
-		wxLogWarning(_T("Couldn't write to %s"), m_logname.c_str());
-		m_logfile.Close();
-	}
-	return res;
+	const wxString line = text + wxTextBuffer::GetEOL();
+	const wxScopedCharBuffer utf8 = line.utf8_str();
+	return ChatLogWriter::Instance()->Append(m_logfile, std::string(utf8.data(), utf8.length()));
 }
 
 
@@ -123,20 +135,23 @@ bool ChatLog::OpenLogFile()
 		return false;
 	}
 
-	if (!wxFile::Exists(logFilePath)) {
-		m_logfile.Create(logFilePath);
-	} else {
-		m_logfile.Open(logFilePath, wxFile::read_write);
+	m_last_lines.Clear();
+	if (wxFile::Exists(logFilePath)) {
+		wxFile logfile(logFilePath, wxFile::read);
+		FillLastLineArray(logfile);
 	}
 
-	if (!m_logfile.IsOpened()) {
+	m_logfile = ChatLogWriter::Instance()->Open(logFilePath);
+	if (m_logfile < 0) {
 		wxLogWarning(_T( "Can't open log file %s" ), logFilePath.c_str());
 		m_active = false;
 		return false;
 	}
-
-	FillLastLineArray();
 	m_active = true;
+	m_logfilepath = logFilePath;
+#ifndef TEST
+	ChatLogIndex::Instance()->Watch(STD_STRING(logFilePath));
+#endif
 
 	return AddMessage(_T("### ") + wxString::Format(_("Session started at %s"), GetDateTimeString()));
 }
@@ -166,116 +181,16 @@ bool ChatLog::LogEnabled()
 #endif
 }
 
-/* read block at possition offset from file */
-static inline ssize_t readblock(wxFile& fd, void* buffer, size_t size, off_t offset)
-{
-	assert(offset >= 0);
-	if (offset < 0) {
-		return -1;
-	}
-
-	if (fd.Seek(offset) != offset) {
-		return -1;
-	}
-
-	return fd.Read(buffer, size);
-}
-
-
-/** Calculate the next read position for find_tail_sequences (below) */
-static inline off_t next_read_position(off_t last_read_position, size_t read_size, size_t read_overlap)
-{
-	return std::max(static_cast<long signed int>(last_read_position - read_size - read_overlap), (long signed int)0);
-}
-
-/** Find an arbitrary number of delimited strings at the end of a file.  This
- * function provides the core of our last-lines-loader implementation.
- *
- * @param fd File descriptor to operate on.  This must be opened for reading.
- *
- * @param bytes Delimiter sequence.
- *
- * @param bytes_length Number of significant bytes in @p bytes.
- *
- * @param count Number of tail sequences to find.
- *
- * @param out Destination string array.
- */
-static size_t find_tail_sequences(wxFile& fd, const char* bytes, size_t bytes_length, size_t count, wxArrayString& out)
-{
-	size_t count_added(0);
-
-	/* We overlap the file reads a little to avoid splitting (and thus missing) the
-	   delimiter sequence.  */
-	const size_t read_overlap = bytes_length - 1;
-	const size_t read_size = BUFSIZ;
-
-	const off_t log_length = fd.SeekEnd();
-	bool have_last_pos = false;
-	char buf[read_size];
-	off_t last_found_pos = 0;
-	off_t last_read_position = log_length + read_overlap;
-
-	/* We read `read_size'-byte blocks of the file, starting at the end and working backwards. */
-	while (count_added < count && last_read_position > 0) {
-		const off_t read_position = next_read_position(last_read_position, read_size, read_overlap);
-		const size_t bytes_read = readblock(fd, buf, std::min(static_cast<off_t>(read_size), last_read_position - read_position), read_position);
-
-		/* In each block, we search for `bytes', starting at the end.  */
-		for (ssize_t i = bytes_read - read_overlap - 1; i >= 0; i--) {
-			if (strncmp((buf + i), bytes, bytes_length) == 0) {
-				const off_t this_found_pos = read_position + i;
-
-				if (have_last_pos) {
-					const size_t line_length = last_found_pos - this_found_pos - bytes_length;
-
-					if (line_length > 0) {
-						char* source = NULL;
-
-						if (last_found_pos >= read_position + (off_t)bytes_read) {
-							source = new char[line_length + 1];
-							memset(source, 0, line_length + 1);
-
-							if (readblock(fd, source, line_length, this_found_pos + bytes_length) < (ssize_t)line_length) {
-								wxLogWarning(_T("ChatLog::find_tail_sequences: Read-byte count less than expected"));
-							}
-						} else {
-							source = buf + i + bytes_length;
-						}
-						source[line_length] = 0;
-						wxString tmp = wxString::FromUTF8(source);
-						out.Insert(tmp, 0);
-						if (last_found_pos >= read_position + (off_t)bytes_read)
-							delete[] source;
-
-						count_added++;
-						if (count_added >= count)
-							break;
-					}
-				}
-				last_found_pos = this_found_pos;
-				have_last_pos = true;
-				i -= bytes_length - 1;
-			}
-		}
-
-		last_read_position = read_position;
-	}
-
-	return count_added;
-}
-
-
-void ChatLog::FillLastLineArray()
+void ChatLog::FillLastLineArray(wxFile& logfile)
 {
 	m_last_lines.Clear();
 
-	if (!m_logfile.IsOpened()) {
+	if (!logfile.IsOpened()) {
 		wxLogError(_T("%s: failed to open log file."), __PRETTY_FUNCTION__);
 		return;
 	}
 
-	if (m_logfile.Length() <= 0) {
+	if (logfile.Length() <= 0) {
 		return;
 	}
 
@@ -285,22 +200,35 @@ void ChatLog::FillLastLineArray()
 	const size_t num_lines = sett().GetAutoloadedChatlogLinesCount();
 #endif
 
-	m_last_lines.Alloc(num_lines);
-
-	const wxChar* wc_EOL(wxTextBuffer::GetEOL());
-	const size_t eol_num_chars(wxStrlen(wc_EOL));
-#ifndef _WIN32
-	char* eol(static_cast<char*>(alloca(eol_num_chars)));
-#else
-	char* eol(new char[eol_num_chars]);
-#endif
-	wxConvUTF8.WC2MB(eol, wc_EOL, eol_num_chars);
-
-	const size_t lines_added = find_tail_sequences(m_logfile, eol, eol_num_chars, num_lines, m_last_lines);
-	wxLogMessage(_T("ChatLog::FillLastLineArray: Loaded %lu lines from %s."), lines_added, GetCurrentLogfilePath().c_str());
+	const wxScopedCharBuffer eol = wxString(wxTextBuffer::GetEOL()).utf8_str();
+	const std::string_view delimiter(eol.data(), eol.length());
+	std::vector<std::string_view> lines;
+	MappedFile mapped(logfile);
+	std::string tail;
+	if (mapped.IsOk()) {
+		FindTailLines(mapped.GetData(), mapped.GetSize(), delimiter, num_lines, true, lines);
+	} else {
+		// read the end of the file, doubling the amount until enough lines are found
+		const size_t length = logfile.Length();
+		size_t size = 64 * 1024;
+		while (true) {
+			size = std::min(size, length);
+			tail.resize(size);
+			if ((logfile.Seek(length - size) == wxInvalidOffset) || (logfile.Read(&tail[0], size) != static_cast<ssize_t>(size))) {
+				wxLogWarning(_T("ChatLog::FillLastLineArray: Couldn't read %s"), GetCurrentLogfilePath().c_str());
+				return;
+			}
+			const bool at_start = (size == length);
+			if ((FindTailLines(tail.data(), size, delimiter, num_lines, at_start, lines) >= num_lines) || at_start) {
+				break;
+			}
+			size *= 2;
+		}
+	}
 
-#ifdef _WIN32
-	delete[] eol;
-#endif
-	m_logfile.SeekEnd();
+	m_last_lines.Alloc(lines.size());
+	for (const std::string_view& line : lines) {
+		m_last_lines.Add(wxString::FromUTF8(line.data(), line.size()));
+	}
+	wxLogMessage(_T("ChatLog::FillLastLineArray: Loaded %lu lines from %s."), lines.size(), GetCurrentLogfilePath().c_str());
 }
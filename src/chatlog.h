@@ -28,7 +28,8 @@ public:
 	~ChatLog();
 
 	/** Append a time-stamped message to the log file.  Retrieves a
-	 * time-stamp string from LogTime.
+	 * time-stamp string from LogTime.  The message is written by the
+	 * ChatLogWriter thread.
 	 *
 	 * @note This does nothing, successfully, if chat logging is
 	 * disabled.
@@ -36,7 +37,7 @@ public:
 	 * @param text Message text to log.
 	 *
 	 * @return @c false if an error was encountered while writing to
-	 * the log file, and @c true otherwise.
+	 * the log file before, and @c true otherwise.
 	 *
 	 * @see LogEnabled LogTime
 	 */
@@ -63,7 +64,7 @@ private:
 	/** Closes the current "session" in the log file by appending a
 	 * session-closed notice to end before closing the file.
 	 *
-	 * @post The file is closed, and any further calls to AddMessage
+	 * @post All messages are written and the file is closed, any further calls to AddMessage
 	 * will reopen the log file, starting a new session.
 	 */
 	void CloseSession();
@@ -78,11 +79,12 @@ private:
 	wxString m_logname;
 
 	bool m_active;
-	wxFile m_logfile;
+	int m_logfile; //!< file handle of the ChatLogWriter, -1 when closed
+	wxString m_logfilepath; //!< path of the open log file
 
 	wxArrayString m_last_lines;
 
-	void FillLastLineArray();
+	void FillLastLineArray(wxFile& logfile);
 };
 
 #endif // CHATLOG_H_INCLUDED
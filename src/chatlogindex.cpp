@@ -0,0 +1,749 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "chatlogindex.h"
+
+#include <wx/dir.h>
+#include <wx/file.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+#include <wx/string.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <map>
+
+#include "utils/conversion.h"
+#include "utils/ircformat.h"
+
+#ifndef TEST
+#include "utils/slpaths.h"
+#endif
+
+static const uint32_t INDEX_MAGIC = 0x58494c53; // "SLIX"
+static const uint32_t INDEX_VERSION = 1;
+static const size_t HEADER_SIZE = 48;
+//! max bytes of a log read at once, bigger logs get several segments
+static const size_t MAX_READ = 16 * 1024 * 1024;
+static const size_t MAX_WORD = 64;
+
+namespace {
+
+struct Posting {
+	uint32_t day;  //!< days since 1970-01-01 of the local date, 0 if unknown
+	uint32_t secs; //!< seconds since midnight
+	uint64_t offset; //!< of the line in the log
+
+	bool operator<(const Posting& other) const
+	{
+		return offset < other.offset;
+	}
+};
+
+//! date and time of the last line parsed, kept in every segment header to
+//! continue parsing where the previous segment ended
+struct LogState {
+	uint32_t day = 0;
+	uint32_t secs = 0;
+};
+
+struct Segment {
+	uint64_t pos = 0; //!< in the index file
+	uint64_t size = 0;
+	uint64_t begin = 0; //!< part of the log covered
+	uint64_t end = 0;
+	LogState state;
+	uint32_t termcount = 0;
+	uint32_t tablesize = 0;
+	std::map<std::string, std::vector<Posting>> terms; //!< only loaded when needed
+};
+
+} // namespace
+
+template <typename T>
+static void Put(std::string& buf, T value)
+{
+	buf.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+static bool Get(const char*& pos, const char* end, T& value)
+{
+	if (end - pos < static_cast<ptrdiff_t>(sizeof(value))) {
+		return false;
+	}
+	memcpy(&value, pos, sizeof(value));
+	pos += sizeof(value);
+	return true;
+}
+
+static bool ReadAt(wxFile& file, uint64_t pos, void* buf, size_t size)
+{
+	if (file.Seek(pos) != static_cast<wxFileOffset>(pos)) {
+		return false;
+	}
+	return file.Read(buf, size) == static_cast<ssize_t>(size);
+}
+
+static std::string IndexPath(const std::string& logpath)
+{
+	return logpath.substr(0, logpath.size() - 4) + ".idx"; // replace .txt
+}
+
+// http://howardhinnant.github.io/date_algorithms.html
+static uint32_t DaysFromCivil(int y, unsigned m, unsigned d)
+{
+	y -= m <= 2;
+	const int era = (y >= 0 ? y : y - 399) / 400;
+	const unsigned yoe = static_cast<unsigned>(y - era * 400);
+	const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+	const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return era * 146097 + static_cast<int>(doe) - 719468;
+}
+
+static void CivilFromDays(uint32_t days, int& y, unsigned& m, unsigned& d)
+{
+	const int z = days + 719468;
+	const int era = (z >= 0 ? z : z - 146096) / 146097;
+	const unsigned doe = static_cast<unsigned>(z - era * 146097);
+	const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	const unsigned mp = (5 * doy + 2) / 153;
+	d = doy - (153 * mp + 2) / 5 + 1;
+	m = mp < 10 ? mp + 3 : mp - 9;
+	y = static_cast<int>(yoe) + era * 400 + (m <= 2);
+}
+
+static time_t ToTime(uint32_t day, uint32_t secs)
+{
+	int y;
+	unsigned m, d;
+	CivilFromDays(day, y, m, d);
+	struct tm tm;
+	memset(&tm, 0, sizeof(tm));
+	tm.tm_year = y - 1900;
+	tm.tm_mon = m - 1;
+	tm.tm_mday = d;
+	tm.tm_sec = secs;
+	tm.tm_isdst = -1;
+	return mktime(&tm);
+}
+
+static bool ParseNumber(std::string_view str, size_t pos, size_t len, unsigned& res)
+{
+	if (pos + len > str.size()) {
+		return false;
+	}
+	res = 0;
+	for (size_t i = pos; i < pos + len; i++) {
+		if (str[i] < '0' || str[i] > '9') {
+			return false;
+		}
+		res = res * 10 + (str[i] - '0');
+	}
+	return true;
+}
+
+//! updates state from a line, returns true if it is a chat message and sets
+//! nick (may be empty) and the message body
+static bool ParseLine(std::string_view line, LogState& state, std::string_view& nick, std::string_view& body)
+{
+	if (line.substr(0, 4) == "### ") {
+		// session notice, the text is translated but ends with "YYYY-MM-DD HH:MM"
+		for (size_t i = 4; i + 16 <= line.size(); i++) {
+			unsigned y, m, d, h, min;
+			if (ParseNumber(line, i, 4, y) && line[i + 4] == '-' && ParseNumber(line, i + 5, 2, m) && line[i + 7] == '-' &&
+			    ParseNumber(line, i + 8, 2, d) && ParseNumber(line, i + 11, 2, h) && line[i + 13] == ':' && ParseNumber(line, i + 14, 2, min)) {
+				state.day = DaysFromCivil(y, m, d);
+				state.secs = h * 3600 + min * 60;
+				break;
+			}
+		}
+		return false;
+	}
+
+	// "[HH:MM:SS] <nick> text" or "[HH:MM:SS] * nick action"
+	unsigned h, m, s;
+	if (line.size() < 11 || line[0] != '[' || !ParseNumber(line, 1, 2, h) || line[3] != ':' || !ParseNumber(line, 4, 2, m) ||
+	    line[6] != ':' || !ParseNumber(line, 7, 2, s) || line[9] != ']') {
+		return false;
+	}
+	const uint32_t secs = h * 3600 + m * 60 + s;
+	if (secs < state.secs && state.day > 0) { // midnight passed
+		state.day++;
+	}
+	state.secs = secs;
+
+	body = line.substr(11);
+	nick = std::string_view();
+	if (!body.empty() && body[0] == '<') {
+		const size_t end = body.find("> ");
+		if (end != std::string_view::npos) {
+			nick = body.substr(1, end - 1);
+			body.remove_prefix(end + 2);
+		}
+	} else if (body.substr(0, 2) == "* ") {
+		const size_t end = body.find(' ', 2);
+		nick = body.substr(2, end == std::string_view::npos ? std::string_view::npos : end - 2);
+		body.remove_prefix(std::min(body.size(), nick.size() + 3));
+	}
+	return true;
+}
+
+static std::string Lower(std::string_view str)
+{
+	std::string res(str);
+	for (char& c : res) {
+		if (c >= 'A' && c <= 'Z') {
+			c += 'a' - 'A';
+		}
+	}
+	return res;
+}
+
+void ChatLogIndex::Tokenize(std::string_view text, std::vector<std::string>& words)
+{
+	size_t start = 0;
+	for (size_t i = 0; i <= text.size(); i++) {
+		const unsigned char c = (i < text.size()) ? text[i] : ' ';
+		// non ascii bytes are parts of utf-8 sequences, count them as letters
+		if (isalnum(c) || c == '_' || c >= 0x80) {
+			continue;
+		}
+		if (i - start >= 2) {
+			words.push_back(Lower(text.substr(start, std::min(i - start, MAX_WORD))));
+		}
+		start = i + 1;
+	}
+}
+
+//! reads the segment headers, returns the offset up to which the index file is valid
+static uint64_t ReadSegments(wxFile& file, std::vector<Segment>& segments)
+{
+	const uint64_t length = file.Length();
+	uint64_t pos = 0;
+	while (pos + HEADER_SIZE <= length) {
+		char buf[HEADER_SIZE];
+		if (!ReadAt(file, pos, buf, HEADER_SIZE)) {
+			break;
+		}
+		const char* cur = buf;
+		const char* end = buf + HEADER_SIZE;
+		uint32_t magic, version;
+		Segment seg;
+		Get(cur, end, magic);
+		Get(cur, end, version);
+		Get(cur, end, seg.size);
+		Get(cur, end, seg.begin);
+		Get(cur, end, seg.end);
+		Get(cur, end, seg.state.day);
+		Get(cur, end, seg.state.secs);
+		Get(cur, end, seg.termcount);
+		Get(cur, end, seg.tablesize);
+		if (magic != INDEX_MAGIC || version != INDEX_VERSION || seg.size < HEADER_SIZE + seg.tablesize || pos + seg.size > length) {
+			break; // written partially when the lobby was killed
+		}
+		seg.pos = pos;
+		segments.push_back(seg);
+		pos += seg.size;
+	}
+	return pos;
+}
+
+//! reads the term table of a segment, calls func(term, count, offset) for each term
+template <typename F>
+static bool ReadTermTable(wxFile& file, const Segment& seg, F func)
+{
+	std::string table(seg.tablesize, '\0');
+	if (!ReadAt(file, seg.pos + HEADER_SIZE, &table[0], table.size())) {
+		return false;
+	}
+	const char* cur = table.data();
+	const char* end = cur + table.size();
+	for (uint32_t i = 0; i < seg.termcount; i++) {
+		uint16_t len;
+		uint32_t count;
+		uint64_t offset;
+		if (!Get(cur, end, len) || end - cur < len) {
+			return false;
+		}
+		const std::string_view term(cur, len);
+		cur += len;
+		if (!Get(cur, end, count) || !Get(cur, end, offset)) {
+			return false;
+		}
+		if (!func(term, count, offset)) {
+			break;
+		}
+	}
+	return true;
+}
+
+template <typename T>
+static bool ReadPostings(wxFile& file, const T& seg, uint32_t count, uint64_t offset, std::vector<Posting>& postings)
+{
+	postings.resize(count);
+	return count == 0 || ReadAt(file, seg.pos + offset, &postings[0], count * sizeof(Posting));
+}
+
+static bool LoadSegment(wxFile& file, Segment& seg)
+{
+	std::vector<std::pair<std::string, std::pair<uint32_t, uint64_t>>> entries;
+	const bool ok = ReadTermTable(file, seg, [&entries](std::string_view term, uint32_t count, uint64_t offset) {
+		entries.emplace_back(std::string(term), std::make_pair(count, offset));
+		return true;
+	});
+	if (!ok) {
+		return false;
+	}
+	for (const auto& entry : entries) {
+		if (!ReadPostings(file, seg, entry.second.first, entry.second.second, seg.terms[entry.first])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static std::string SerializeSegment(const Segment& seg)
+{
+	std::string table;
+	uint64_t offset = 0;
+	for (const auto& term : seg.terms) {
+		offset += 2 + term.first.size() + 4 + 8;
+	}
+	offset += HEADER_SIZE;
+	for (const auto& term : seg.terms) {
+		Put<uint16_t>(table, term.first.size());
+		table += term.first;
+		Put<uint32_t>(table, term.second.size());
+		Put<uint64_t>(table, offset);
+		offset += term.second.size() * sizeof(Posting);
+	}
+
+	std::string buf;
+	buf.reserve(offset);
+	Put<uint32_t>(buf, INDEX_MAGIC);
+	Put<uint32_t>(buf, INDEX_VERSION);
+	Put<uint64_t>(buf, offset);
+	Put<uint64_t>(buf, seg.begin);
+	Put<uint64_t>(buf, seg.end);
+	Put<uint32_t>(buf, seg.state.day);
+	Put<uint32_t>(buf, seg.state.secs);
+	Put<uint32_t>(buf, seg.terms.size());
+	Put<uint32_t>(buf, table.size());
+	buf += table;
+	for (const auto& term : seg.terms) {
+		buf.append(reinterpret_cast<const char*>(term.second.data()), term.second.size() * sizeof(Posting));
+	}
+	return buf;
+}
+
+//! merges all valid segments of an index file into one
+static bool CompactIndex(const std::string& idxpath)
+{
+	const wxString path = TowxString(idxpath);
+	Segment merged;
+	{
+		wxFile file(path, wxFile::read);
+		if (!file.IsOpened()) {
+			return false;
+		}
+		std::vector<Segment> segments;
+		ReadSegments(file, segments);
+		for (size_t i = 0; i < segments.size(); i++) {
+			Segment& seg = segments[i];
+			if (!LoadSegment(file, seg)) {
+				segments.resize(i);
+				break;
+			}
+			for (auto& term : seg.terms) {
+				std::vector<Posting>& postings = merged.terms[term.first];
+				postings.insert(postings.end(), term.second.begin(), term.second.end());
+			}
+		}
+		if (!segments.empty()) {
+			merged.begin = segments.front().begin;
+			merged.end = segments.back().end;
+			merged.state = segments.back().state;
+		}
+	}
+
+	const wxString tmppath = path + _T(".tmp");
+	{
+		wxFile file(tmppath, wxFile::write);
+		if (!file.IsOpened()) {
+			return false;
+		}
+		if (merged.end > 0) {
+			const std::string buf = SerializeSegment(merged);
+			if (file.Write(buf.data(), buf.size()) != buf.size()) {
+				file.Close();
+				wxRemoveFile(tmppath);
+				return false;
+			}
+		}
+	}
+	return wxRenameFile(tmppath, path, true);
+}
+
+ChatLogIndex* ChatLogIndex::Instance()
+{
+#ifdef TEST
+	static ChatLogIndex index(STD_STRING(wxFileName::GetTempDir()) + "/sltest_chatlog/");
+#else
+	static ChatLogIndex index(SlPaths::GetChatLogLoc());
+#endif
+	return &index;
+}
+
+ChatLogIndex::ChatLogIndex(const std::string& root)
+    : m_root(root)
+    , m_runs(0)
+    , m_wakeup_requested(false)
+    , m_quit(false)
+{
+	m_thread = std::thread(&ChatLogIndex::Run, this);
+}
+
+ChatLogIndex::~ChatLogIndex()
+{
+	Stop();
+}
+
+void ChatLogIndex::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_wakeup.notify_one();
+	if (m_thread.joinable()) {
+		m_thread.join();
+	}
+}
+
+void ChatLogIndex::Watch(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_watched.insert(path);
+	m_unwatched.erase(path);
+}
+
+void ChatLogIndex::Unwatch(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_watched.erase(path) > 0) {
+		m_unwatched.insert(path);
+	}
+}
+
+void ChatLogIndex::Sync()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	// the current run may have started before the data was written
+	const unsigned int target = m_runs + 2;
+	while (m_runs < target && !m_quit) {
+		m_wakeup_requested = true;
+		m_wakeup.notify_one();
+		m_done.wait(lock);
+	}
+}
+
+void ChatLogIndex::Run()
+{
+	// catch up with everything written since the last start
+	IndexAll();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true) {
+		const bool quit = m_quit;
+		if (!quit) {
+			m_wakeup.wait_for(lock, std::chrono::milliseconds(INDEX_INTERVAL_MS), [this] {
+				return m_quit || m_wakeup_requested;
+			});
+		}
+		m_wakeup_requested = false;
+		std::vector<std::string> paths(m_watched.begin(), m_watched.end());
+		paths.insert(paths.end(), m_unwatched.begin(), m_unwatched.end());
+		m_unwatched.clear();
+
+		lock.unlock();
+		for (const std::string& path : paths) {
+			IndexLog(path);
+		}
+		lock.lock();
+
+		m_runs++;
+		m_done.notify_all();
+		if (quit) { // one last run after quitting to index the rest
+			break;
+		}
+	}
+}
+
+void ChatLogIndex::IndexAll()
+{
+	if (m_root.empty() || !wxDirExists(TowxString(m_root))) {
+		return;
+	}
+	wxArrayString files;
+	wxDir::GetAllFiles(TowxString(m_root), &files, _T("*.txt"));
+	for (const wxString& file : files) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_quit) {
+				return;
+			}
+		}
+		IndexLog(STD_STRING(file));
+	}
+}
+
+bool ChatLogIndex::IndexLog(const std::string& path)
+{
+	const std::string idxpath = IndexPath(path);
+	const wxString wxidxpath = TowxString(idxpath);
+
+	Segment last;
+	size_t segments = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_file_mutex);
+		if (wxFile::Exists(wxidxpath)) {
+			wxFile file(wxidxpath, wxFile::read);
+			std::vector<Segment> headers;
+			const uint64_t valid = ReadSegments(file, headers);
+			if (valid < static_cast<uint64_t>(file.Length())) {
+				file.Close();
+				wxLogWarning(_T("Chat log index %s is broken, repairing"), wxidxpath.c_str());
+				if (!CompactIndex(idxpath)) {
+					wxRemoveFile(wxidxpath);
+					headers.clear();
+				} else if (!headers.empty()) { // merged into one segment
+					headers.erase(headers.begin(), headers.end() - 1);
+				}
+			}
+			if (!headers.empty()) {
+				last = headers.back();
+				segments = headers.size();
+			}
+		}
+	}
+
+	wxFile log(TowxString(path), wxFile::read);
+	if (!log.IsOpened()) {
+		return false;
+	}
+	const uint64_t length = log.Length();
+	if (length < last.end) {
+		// the log was truncated or recreated, what is indexed doesn't match it anymore
+		std::lock_guard<std::mutex> lock(m_file_mutex);
+		wxRemoveFile(wxidxpath);
+		last = Segment();
+		segments = 0;
+	}
+	uint64_t pos = last.end;
+	LogState state = last.state;
+	bool changed = false;
+	while (pos < length) {
+		std::string buf(std::min<uint64_t>(length - pos, MAX_READ), '\0');
+		if (!ReadAt(log, pos, &buf[0], buf.size())) {
+			break;
+		}
+		const size_t complete = buf.rfind('\n');
+		if (complete == std::string::npos) {
+			break; // the line is still written
+		}
+
+		Segment seg;
+		seg.begin = pos;
+		seg.end = pos + complete + 1;
+		std::vector<std::string> words;
+		size_t start = 0;
+		while (start <= complete) {
+			const size_t end = buf.find('\n', start);
+			std::string_view line(buf.data() + start, end - start);
+			if (!line.empty() && line.back() == '\r') {
+				line.remove_suffix(1);
+			}
+			std::string_view nick;
+			std::string_view body;
+			if (ParseLine(line, state, nick, body)) {
+				const Posting posting = {state.day, state.secs, pos + start};
+				if (!nick.empty()) {
+					seg.terms["n:" + Lower(nick)].push_back(posting);
+				}
+				words.clear();
+				Tokenize(StripIrcFormatting(body), words);
+				std::sort(words.begin(), words.end());
+				words.erase(std::unique(words.begin(), words.end()), words.end());
+				for (const std::string& word : words) {
+					seg.terms["w:" + word].push_back(posting);
+				}
+			}
+			start = end + 1;
+		}
+		seg.state = state;
+
+		const std::string data = SerializeSegment(seg);
+		std::lock_guard<std::mutex> lock(m_file_mutex);
+		wxFile file(wxidxpath, wxFile::write_append);
+		if (!file.IsOpened() || file.Write(data.data(), data.size()) != data.size()) {
+			wxLogWarning(_T("Couldn't write chat log index %s"), wxidxpath.c_str());
+			return changed;
+		}
+		file.Close();
+		changed = true;
+		pos = seg.end;
+		if (++segments > MAX_SEGMENTS) {
+			CompactIndex(idxpath);
+			segments = 1;
+		}
+	}
+	return changed;
+}
+
+std::vector<ChatLogIndex::Message> ChatLogIndex::Search(const Query& query)
+{
+	std::vector<Message> res;
+
+	std::vector<std::string> terms;
+	if (!query.nick.empty()) {
+		terms.push_back("n:" + Lower(query.nick));
+	}
+	std::vector<std::string> words;
+	Tokenize(query.text, words);
+	for (const std::string& word : words) {
+		terms.push_back("w:" + word);
+	}
+	if (terms.empty()) {
+		return res;
+	}
+	std::sort(terms.begin(), terms.end());
+	terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+	const std::string sep = STD_STRING(wxString(wxFileName::GetPathSeparator()));
+	std::vector<std::string> logs;
+	if (!query.server.empty() && !query.channel.empty()) {
+		logs.push_back(m_root + query.server + sep + query.channel + ".txt");
+	} else {
+		const std::string dir = query.server.empty() ? m_root : m_root + query.server;
+		if (wxDirExists(TowxString(dir))) {
+			wxArrayString files;
+			wxDir::GetAllFiles(TowxString(dir), &files, _T("*.txt"));
+			for (const wxString& file : files) {
+				const std::string path = STD_STRING(file);
+				if (query.channel.empty() || wxFileName(file).GetName() == TowxString(query.channel)) {
+					logs.push_back(path);
+				}
+			}
+		}
+	}
+
+	for (const std::string& log : logs) {
+		SearchLog(log, terms, query, res);
+	}
+
+	std::sort(res.begin(), res.end(), [](const Message& a, const Message& b) {
+		return a.time > b.time;
+	});
+	if (res.size() > query.max) {
+		res.resize(query.max);
+	}
+	return res;
+}
+
+void ChatLogIndex::SearchLog(const std::string& path, const std::vector<std::string>& terms, const Query& query, std::vector<Message>& res)
+{
+	LogState since;
+	if (query.since > 0) {
+		const struct tm* tm = localtime(&query.since);
+		if (tm != nullptr) {
+			since.day = DaysFromCivil(tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday);
+			since.secs = tm->tm_hour * 3600 + tm->tm_min * 60 + tm->tm_sec;
+		}
+	}
+
+	// postings of all terms, intersected over the terms
+	std::vector<Posting> matches;
+	{
+		std::lock_guard<std::mutex> lock(m_file_mutex);
+		wxFile file(TowxString(IndexPath(path)), wxFile::read);
+		if (!file.IsOpened()) {
+			return;
+		}
+		std::vector<Segment> segments;
+		ReadSegments(file, segments);
+		for (const Segment& seg : segments) {
+			if (seg.state.day < since.day) { // everything in it is older
+				continue;
+			}
+			std::map<std::string, std::pair<uint32_t, uint64_t>> found;
+			ReadTermTable(file, seg, [&terms, &found](std::string_view term, uint32_t count, uint64_t offset) {
+				if (std::find(terms.begin(), terms.end(), term) != terms.end()) {
+					found[std::string(term)] = std::make_pair(count, offset);
+				}
+				return found.size() < terms.size();
+			});
+			std::vector<Posting> current;
+			bool first = true;
+			for (const std::string& term : terms) {
+				const auto it = found.find(term);
+				if (it == found.end()) {
+					current.clear();
+					break;
+				}
+				std::vector<Posting> postings;
+				if (!ReadPostings(file, seg, it->second.first, it->second.second, postings)) {
+					current.clear();
+					break;
+				}
+				if (first) {
+					current.swap(postings);
+					first = false;
+					continue;
+				}
+				std::vector<Posting> both;
+				std::set_intersection(current.begin(), current.end(), postings.begin(), postings.end(), std::back_inserter(both));
+				current.swap(both);
+			}
+			for (const Posting& posting : current) {
+				if (posting.day > since.day || (posting.day == since.day && posting.secs >= since.secs)) {
+					matches.push_back(posting);
+				}
+			}
+		}
+	}
+	if (matches.empty()) {
+		return;
+	}
+
+	// keep the newest ones only, then read their lines from the log
+	if (matches.size() > query.max) {
+		matches.erase(matches.begin(), matches.end() - query.max);
+	}
+	wxFile log(TowxString(path), wxFile::read);
+	if (!log.IsOpened()) {
+		return;
+	}
+	const std::string relative = path.substr(m_root.size());
+	const size_t sep = relative.find_first_of("/\\");
+	const std::string server = (sep == std::string::npos) ? std::string() : relative.substr(0, sep);
+	const std::string channel = STD_STRING(wxFileName(TowxString(path)).GetName());
+	for (const Posting& posting : matches) {
+		char buf[1024];
+		const ssize_t len = (log.Seek(posting.offset) == static_cast<wxFileOffset>(posting.offset)) ? log.Read(buf, sizeof(buf)) : -1;
+		if (len <= 0) {
+			continue;
+		}
+		std::string_view line(buf, len);
+		line = line.substr(0, line.find_first_of("\r\n"));
+
+		Message msg;
+		msg.server = server;
+		msg.channel = channel;
+		msg.time = (posting.day > 0) ? ToTime(posting.day, posting.secs) : 0;
+		msg.line.assign(line.data(), line.size());
+		res.push_back(msg);
+	}
+}
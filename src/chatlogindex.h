@@ -0,0 +1,90 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_CHATLOGINDEX_H
+#define SPRINGLOBBY_HEADERGUARD_CHATLOGINDEX_H
+
+#include <condition_variable>
+#include <ctime>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "utils/mixins.h"
+
+//! @brief Full-text index over the chat logs, used to search the history.
+//! Every log <root>/<server>/<channel>.txt gets an index file <channel>.idx
+//! next to it which maps words and nicks to the messages containing them.
+//! The index is appended to in segments, each covering the part of the log
+//! written since the previous one, and stores up to which offset the log
+//! was indexed. A worker thread indexes the open logs periodically and, after
+//! a start, everything which was written while the lobby wasn't running, so
+//! already indexed parts of the logs are never read again.
+class ChatLogIndex : public SL::NonCopyable
+{
+public:
+	static constexpr int INDEX_INTERVAL_MS = 30000;
+	//! segments are merged into one when there are more
+	static constexpr size_t MAX_SEGMENTS = 16;
+
+	struct Query {
+		std::string server;  //!< empty for all servers
+		std::string channel; //!< log name, empty for all logs of the server(s)
+		std::string nick;    //!< author, empty for any
+		std::string text;    //!< all words of it have to occur, empty for any
+		time_t since = 0;
+		size_t max = 100;
+	};
+
+	struct Message {
+		std::string server;
+		std::string channel;
+		time_t time;
+		std::string line; //!< the line as found in the log, utf-8
+	};
+
+	static ChatLogIndex* Instance();
+
+	//! root is the chat log folder (with trailing delimiter)
+	explicit ChatLogIndex(const std::string& root);
+	~ChatLogIndex();
+
+	//! index the log file at path periodically, until Unwatch() is called
+	void Watch(const std::string& path);
+	//! stop indexing path after the next run
+	void Unwatch(const std::string& path);
+	//! wakes the worker and waits until it indexed everything written so far
+	void Sync();
+	//! indexes the watched logs a last time and ends the worker, has to be
+	//! called before wx is shut down as the instance lives until static destruction
+	void Stop();
+
+	//! messages matching query, newest first. Either a nick or text has to
+	//! be given. Matching is by whole words, case insensitive for ascii.
+	std::vector<Message> Search(const Query& query);
+
+	//! splits text into lower case words as stored in the index
+	static void Tokenize(std::string_view text, std::vector<std::string>& words);
+
+private:
+	void Run();
+	void IndexAll();
+	bool IndexLog(const std::string& path);
+	void SearchLog(const std::string& path, const std::vector<std::string>& terms, const Query& query, std::vector<Message>& res);
+
+	const std::string m_root;
+	std::set<std::string> m_watched;
+	std::set<std::string> m_unwatched; //!< indexed a last time on the next run
+	unsigned int m_runs; //!< count of completed runs, used by Sync()
+	bool m_wakeup_requested;
+	bool m_quit;
+	std::mutex m_mutex;
+	std::mutex m_file_mutex; //!< held while an index file is written or read
+	std::condition_variable m_wakeup;
+	std::condition_variable m_done;
+	std::thread m_thread;
+};
+
+#endif // SPRINGLOBBY_HEADERGUARD_CHATLOGINDEX_H
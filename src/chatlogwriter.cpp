@@ -0,0 +1,150 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "chatlogwriter.h"
+
+#include <wx/file.h>
+#include <wx/log.h>
+#include <wx/string.h>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+struct ChatLogWriter::File {
+	wxFile file;
+	wxString path;
+	std::string buffer;
+	bool failed = false;
+	bool closing = false; //!< Close() waits for the worker to close it
+	bool closed = false;
+};
+
+ChatLogWriter* ChatLogWriter::Instance()
+{
+	static ChatLogWriter writer;
+	return &writer;
+}
+
+ChatLogWriter::ChatLogWriter()
+    : m_next_id(0)
+    , m_pending(0)
+    , m_flush(false)
+    , m_quit(false)
+{
+	m_thread = std::thread(&ChatLogWriter::Run, this);
+}
+
+ChatLogWriter::~ChatLogWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_wakeup.notify_one();
+	m_thread.join();
+}
+
+int ChatLogWriter::Open(const wxString& path)
+{
+	std::unique_ptr<File> file(new File());
+	if (!file->file.Open(path, wxFile::write_append)) {
+		return -1;
+	}
+	file->path = path;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const int id = m_next_id++;
+	m_files[id] = std::move(file);
+	return id;
+}
+
+bool ChatLogWriter::Append(int file, std::string&& text)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	const auto it = m_files.find(file);
+	if (m_quit || it == m_files.end() || it->second->failed) {
+		return false;
+	}
+	if (m_pending >= MAX_PENDING) { // disk is too slow, wait for the worker
+		m_flush = true;
+		m_wakeup.notify_one();
+		m_written.wait(lock, [this] { return m_pending < MAX_PENDING; });
+	}
+	m_pending += text.size();
+	it->second->buffer += text;
+	if (m_pending >= FLUSH_SIZE) {
+		m_wakeup.notify_one();
+	}
+	return true;
+}
+
+bool ChatLogWriter::Close(int file)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	const auto it = m_files.find(file);
+	if (it == m_files.end()) {
+		return false;
+	}
+	File& entry = *it->second;
+	entry.closing = true;
+	m_flush = true;
+	m_wakeup.notify_one();
+	m_written.wait(lock, [&entry] { return entry.closed; });
+	const bool res = !entry.failed;
+	m_files.erase(it);
+	return res;
+}
+
+void ChatLogWriter::Run()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true) {
+		m_wakeup.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS), [this] {
+			return m_quit || m_flush || m_pending >= FLUSH_SIZE;
+		});
+		m_flush = false;
+
+		// take the buffers and write them without holding the lock, files
+		// are only closed (and removed) by this thread, so the pointers stay valid
+		std::vector<std::pair<File*, std::string>> work;
+		for (auto& it : m_files) {
+			File& file = *it.second;
+			if (!file.buffer.empty()) {
+				work.emplace_back(&file, std::move(file.buffer));
+				file.buffer.clear();
+			}
+		}
+		lock.unlock();
+
+		size_t written = 0;
+		std::vector<File*> failed;
+		for (auto& item : work) {
+			File& file = *item.first;
+			const std::string& data = item.second;
+			written += data.size();
+			if (file.file.Write(data.data(), data.size()) != data.size()) {
+				wxLogWarning(_T("Couldn't write to %s"), file.path.c_str());
+				failed.push_back(&file);
+			}
+		}
+
+		lock.lock();
+		for (File* file : failed) {
+			file->failed = true;
+		}
+		m_pending -= written;
+
+		for (auto& it : m_files) {
+			File& file = *it.second;
+			if ((file.closing || m_quit) && !file.closed && file.buffer.empty()) {
+				file.file.Flush();
+				file.file.Close();
+				file.closed = true;
+			}
+		}
+		m_written.notify_all();
+
+		if (m_quit && m_pending == 0) {
+			break;
+		}
+	}
+}
@@ -0,0 +1,60 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_CHATLOGWRITER_H
+#define SPRINGLOBBY_HEADERGUARD_CHATLOGWRITER_H
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "utils/mixins.h"
+
+class wxString;
+
+//! @brief Writes the chat log files on a worker thread.
+//! Appended text is collected in a buffer per file, the worker writes all
+//! buffers in one go every FLUSH_INTERVAL_MS or as soon as FLUSH_SIZE bytes
+//! piled up. When MAX_PENDING bytes are waiting Append() blocks until the
+//! worker caught up, so a slow disk can't make the buffers grow unbounded.
+class ChatLogWriter : public SL::NonCopyable
+{
+public:
+	static constexpr int FLUSH_INTERVAL_MS = 500;
+	static constexpr size_t FLUSH_SIZE = 64 * 1024;
+	static constexpr size_t MAX_PENDING = 4 * 1024 * 1024;
+
+	static ChatLogWriter* Instance();
+
+	ChatLogWriter();
+	//! writes everything still buffered before returning
+	~ChatLogWriter();
+
+	//! opens path for appending, returns -1 if it can't be opened
+	int Open(const wxString& path);
+	//! queues text (utf-8) to be appended to file, returns false when
+	//! writing to the file failed before
+	bool Append(int file, std::string&& text);
+	//! writes all text queued for file, then closes it. Blocks until done,
+	//! returns false if a write failed.
+	bool Close(int file);
+
+private:
+	struct File;
+
+	void Run();
+
+	std::map<int, std::unique_ptr<File>> m_files;
+	int m_next_id;
+	size_t m_pending; //!< bytes in all buffers and being written
+	bool m_flush;     //!< write the buffers now instead of waiting for the interval
+	bool m_quit;
+	std::mutex m_mutex;
+	std::condition_variable m_wakeup;  //!< wakes the worker
+	std::condition_variable m_written; //!< signaled after the worker wrote something
+	std::thread m_thread;
+};
+
+#endif // SPRINGLOBBY_HEADERGUARD_CHATLOGWRITER_H
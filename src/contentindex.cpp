@@ -0,0 +1,161 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "contentindex.h"
+
+#include <lslunitsync/unitsync.h>
+#include <wx/log.h>
+#include <algorithm>
+
+#include "utils/globalevents.h"
+#include "utils/slpaths.h"
+
+ContentIndex* ContentIndex::Instance()
+{
+	static ContentIndex index;
+	return &index;
+}
+
+ContentIndex::ContentIndex()
+    : m_current(nullptr)
+    , m_readers(0)
+    , m_owned(new Snapshot())
+{
+	m_current = m_owned.get();
+}
+
+ContentIndex::~ContentIndex()
+{
+}
+
+ContentIndex::ReadGuard::ReadGuard(const ContentIndex& index)
+    : m_index(index)
+{
+	m_index.m_readers++;
+	m_snapshot = m_index.m_current.load();
+}
+
+ContentIndex::ReadGuard::~ReadGuard()
+{
+	m_index.m_readers--;
+}
+
+void ContentIndex::Publish(std::unique_ptr<Snapshot> snapshot)
+{
+	// m_write_mutex is held by the caller
+	m_retired.push_back(std::move(m_owned));
+	m_owned = std::move(snapshot);
+	m_current = m_owned.get();
+	// a query starting after the store above sees the new snapshot, so when
+	// none runs right now the old ones can't be referenced anymore
+	if (m_readers == 0) {
+		m_retired.clear();
+	}
+}
+
+void ContentIndex::Rebuild()
+{
+	std::unique_ptr<Snapshot> snapshot(new Snapshot());
+	if (LSL::usync().IsLoaded()) {
+		try {
+			const int mapcount = LSL::usync().GetMapList().size();
+			snapshot->maps.reserve(mapcount);
+			for (int i = 0; i < mapcount; i++) {
+				const LSL::UnitsyncMap map = LSL::usync().GetMap(i);
+				snapshot->maps[map.name] = map.hash;
+			}
+			const int gamecount = LSL::usync().GetGameList().size();
+			snapshot->games.reserve(gamecount);
+			for (int i = 0; i < gamecount; i++) {
+				const LSL::UnitsyncGame game = LSL::usync().GetGame(i);
+				snapshot->games[game.name] = game.hash;
+			}
+		} catch (const std::exception& e) {
+			wxLogWarning("Couldn't index installed content: %s", e.what());
+		}
+	}
+	for (const auto& pair : SlPaths::GetSpringVersionList()) {
+		snapshot->engines.push_back(pair.first);
+	}
+
+	std::lock_guard<std::mutex> lock(m_write_mutex);
+	Publish(std::move(snapshot));
+}
+
+void ContentIndex::UnitsyncReloaded()
+{
+	Rebuild();
+	GlobalEventManager::Instance()->Send(GlobalEventManager::OnUnitsyncReloaded);
+}
+
+void ContentIndex::RefreshEngines()
+{
+	std::vector<std::string> engines;
+	for (const auto& pair : SlPaths::GetSpringVersionList()) {
+		engines.push_back(pair.first);
+	}
+	std::lock_guard<std::mutex> lock(m_write_mutex);
+	std::unique_ptr<Snapshot> snapshot(new Snapshot(*m_owned));
+	snapshot->engines = std::move(engines);
+	Publish(std::move(snapshot));
+}
+
+void ContentIndex::AddMap(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(m_write_mutex);
+	if (m_owned->maps.count(name) > 0) {
+		return;
+	}
+	std::unique_ptr<Snapshot> snapshot(new Snapshot(*m_owned));
+	snapshot->maps[name] = "";
+	Publish(std::move(snapshot));
+}
+
+void ContentIndex::AddEngine(const std::string& version)
+{
+	std::lock_guard<std::mutex> lock(m_write_mutex);
+	const std::vector<std::string>& engines = m_owned->engines;
+	if (std::find(engines.begin(), engines.end(), version) != engines.end()) {
+		return;
+	}
+	std::unique_ptr<Snapshot> snapshot(new Snapshot(*m_owned));
+	snapshot->engines.push_back(version);
+	Publish(std::move(snapshot));
+}
+
+bool ContentIndex::Exists(const std::unordered_map<std::string, std::string>& list, const std::string& name, const std::string& hash)
+{
+	const auto it = list.find(name);
+	if (it == list.end()) {
+		return false;
+	}
+	return hash.empty() || it->second == hash;
+}
+
+bool ContentIndex::MapExists(const std::string& name, const std::string& hash) const
+{
+	ReadGuard guard(*this);
+	return Exists(guard.Get().maps, name, hash);
+}
+
+bool ContentIndex::GameExists(const std::string& name, const std::string& hash) const
+{
+	ReadGuard guard(*this);
+	return Exists(guard.Get().games, name, hash);
+}
+
+std::string ContentIndex::GetCompatibleEngine(const std::string& version) const
+{
+	ReadGuard guard(*this);
+	// only a handful of engines is installed
+	for (const std::string& engine : guard.Get().engines) {
+		if (SlPaths::VersionSyncCompatible(version, engine)) {
+			return engine;
+		}
+	}
+	return "";
+}
+
+bool ContentIndex::EngineExists(const std::string& version) const
+{
+	return !GetCompatibleEngine(version).empty();
+}
@@ -0,0 +1,84 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_CONTENTINDEX_H
+#define SPRINGLOBBY_HEADERGUARD_CONTENTINDEX_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//! @brief Index of the installed maps, games and engines.
+//! Battle list rows, filters and the battle room ask for content availability
+//! very often, answering that through unitsync (or by copying the engine
+//! bundle list) each time is slow. The index keeps an immutable snapshot
+//! which is rebuilt when unitsync was reloaded and extended when a download
+//! finished, queries don't lock and can be done from any thread.
+class ContentIndex
+{
+public:
+	static ContentIndex* Instance();
+
+	ContentIndex();
+	~ContentIndex();
+
+	//! snapshots unitsync's map / game lists and the engine version list
+	void Rebuild();
+	//! has to be called after unitsync was (re)loaded instead of sending
+	//! GlobalEventManager::OnUnitsyncReloaded: rebuilds the index and sends
+	//! the event, so its handlers see the new content
+	void UnitsyncReloaded();
+	//! updates the engines only, after the engine version list was refreshed
+	void RefreshEngines();
+
+	//! add freshly downloaded content without waiting for a unitsync reload,
+	//! the hash isn't known until the next Rebuild()
+	void AddMap(const std::string& name);
+	void AddEngine(const std::string& version);
+
+	//! an empty hash matches any installed version
+	bool MapExists(const std::string& name, const std::string& hash = "") const;
+	bool GameExists(const std::string& name, const std::string& hash = "") const;
+
+	//! returns the installed engine version which is sync compatible to
+	//! version or an empty string if there is none
+	std::string GetCompatibleEngine(const std::string& version) const;
+	bool EngineExists(const std::string& version) const;
+
+private:
+	struct Snapshot {
+		std::unordered_map<std::string, std::string> maps;  // name -> hash
+		std::unordered_map<std::string, std::string> games; // name -> hash
+		std::vector<std::string> engines;
+	};
+
+	//! keeps the current snapshot alive while a query reads it
+	class ReadGuard
+	{
+	public:
+		explicit ReadGuard(const ContentIndex& index);
+		~ReadGuard();
+		const Snapshot& Get() const
+		{
+			return *m_snapshot;
+		}
+
+	private:
+		const ContentIndex& m_index;
+		const Snapshot* m_snapshot;
+	};
+
+	static bool Exists(const std::unordered_map<std::string, std::string>& list, const std::string& name, const std::string& hash);
+	void Publish(std::unique_ptr<Snapshot> snapshot);
+
+	std::atomic<const Snapshot*> m_current;
+	mutable std::atomic<int> m_readers;
+	//! replaced snapshots, freed once no query runs anymore
+	std::vector<std::unique_ptr<const Snapshot>> m_retired;
+	std::unique_ptr<const Snapshot> m_owned;
+	std::mutex m_write_mutex;
+};
+
+#endif // SPRINGLOBBY_HEADERGUARD_CONTENTINDEX_H
@@ -0,0 +1,136 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "contentsearch.h"
+
+#include <wx/log.h>
+#include <exception>
+
+ContentSearch::ContentSearch(Fetcher fetcher, Resolver resolver, size_t cacheSize, std::chrono::milliseconds ttl)
+    : m_fetcher(std::move(fetcher))
+    , m_resolver(std::move(resolver))
+    , m_cache_size(cacheSize)
+    , m_ttl(ttl)
+    , m_pending(false)
+    , m_quit(false)
+    , m_next_id(0)
+    , m_latest(0)
+{
+	m_thread = std::thread(&ContentSearch::Run, this);
+}
+
+ContentSearch::~ContentSearch()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+		m_latest = ++m_next_id;
+	}
+	m_wakeup.notify_one();
+	m_thread.join();
+}
+
+unsigned int ContentSearch::Search(const std::string& query, Callback done)
+{
+	unsigned int id;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		id = ++m_next_id;
+		m_request.id = id;
+		m_request.query = query;
+		m_request.done = std::move(done);
+		m_pending = true;
+		m_latest = id;
+	}
+	m_wakeup.notify_one();
+	return id;
+}
+
+void ContentSearch::Cancel()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_pending = false;
+	m_request.done = nullptr;
+	m_latest = ++m_next_id;
+}
+
+void ContentSearch::Run()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true) {
+		m_wakeup.wait(lock, [this] { return m_quit || m_pending; });
+		if (m_quit) {
+			return;
+		}
+		const Request request = std::move(m_request);
+		m_request.done = nullptr;
+		m_pending = false;
+		lock.unlock();
+
+		Results results;
+		try {
+			if (!FindCached(request.query, results) && Fetch(request, results)) {
+				AddCached(request.query, results);
+			}
+			if (!IsStale(request.id)) {
+				m_resolver(results);
+			}
+			if (!IsStale(request.id)) {
+				request.done(request.id, results);
+			}
+		} catch (const std::exception& e) {
+			wxLogError("Search for %s failed: %s", request.query.c_str(), e.what());
+		}
+
+		lock.lock();
+	}
+}
+
+bool ContentSearch::Fetch(const Request& request, Results& results)
+{
+	const unsigned int id = request.id;
+	const Cancelled cancelled = [this, id] {
+		return IsStale(id);
+	};
+	if (!m_fetcher(request.query, results, cancelled)) {
+		return false;
+	}
+	// most users expect a search for a part of the name to work
+	if (results.empty() && request.query.find('*') == std::string::npos && !cancelled()) {
+		return m_fetcher("*" + request.query + "*", results, cancelled);
+	}
+	return true;
+}
+
+bool ContentSearch::FindCached(const std::string& query, Results& results)
+{
+	const auto it = m_cache_index.find(query);
+	if (it == m_cache_index.end()) {
+		return false;
+	}
+	if (std::chrono::steady_clock::now() - it->second->time > m_ttl) {
+		m_cache.erase(it->second);
+		m_cache_index.erase(it);
+		return false;
+	}
+	m_cache.splice(m_cache.begin(), m_cache, it->second);
+	results = it->second->results;
+	return true;
+}
+
+void ContentSearch::AddCached(const std::string& query, const Results& results)
+{
+	if (m_cache_size == 0) {
+		return;
+	}
+	const auto it = m_cache_index.find(query);
+	if (it != m_cache_index.end()) {
+		m_cache.erase(it->second);
+		m_cache_index.erase(it);
+	}
+	while (m_cache.size() >= m_cache_size) {
+		m_cache_index.erase(m_cache.back().query);
+		m_cache.pop_back();
+	}
+	m_cache.push_front(CacheEntry{query, results, std::chrono::steady_clock::now()});
+	m_cache_index[query] = m_cache.begin();
+}
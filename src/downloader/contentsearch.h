@@ -0,0 +1,98 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_CONTENTSEARCH_H
+#define SPRINGLOBBY_HEADERGUARD_CONTENTSEARCH_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "lib/src/Downloader/DownloadEnum.h"
+#include "utils/mixins.h"
+
+//! @brief Searches for downloadable content on a worker thread.
+//! Only the latest query counts: a new one replaces the one waiting to run
+//! and the results of one which was superseded while it ran are dropped, so
+//! the search can follow the user's typing. Results are cached by query for
+//! a while, whether they are downloaded already is resolved again for every
+//! search, as that changes when a download finished.
+class ContentSearch : public SL::NonCopyable
+{
+public:
+	struct Result {
+		std::string name;
+		DownloadEnum::Category category;
+		std::string version; //!< of engines
+		unsigned int filesize;
+		bool downloaded;
+	};
+	typedef std::vector<Result> Results;
+
+	//! returns true once the results of a query aren't wanted anymore
+	typedef std::function<bool()> Cancelled;
+	//! runs query, returns false if it failed and the results shouldn't be
+	//! cached. It should give up once cancelled returns true.
+	typedef std::function<bool(const std::string& query, Results& results, const Cancelled& cancelled)> Fetcher;
+	//! sets downloaded of all results
+	typedef std::function<void(Results& results)> Resolver;
+	//! gets the id Search() returned, called on the worker thread
+	typedef std::function<void(unsigned int id, const Results& results)> Callback;
+
+	ContentSearch(Fetcher fetcher, Resolver resolver, size_t cacheSize, std::chrono::milliseconds ttl);
+	//! cancels a running query and waits for it to return
+	~ContentSearch();
+
+	//! queues query and returns its id. If nothing matches query, it is
+	//! searched for with wildcards around it.
+	unsigned int Search(const std::string& query, Callback done);
+	//! drops the queued query and the results of the running one
+	void Cancel();
+
+private:
+	struct Request {
+		unsigned int id;
+		std::string query;
+		Callback done;
+	};
+	struct CacheEntry {
+		std::string query;
+		Results results;
+		std::chrono::steady_clock::time_point time;
+	};
+
+	void Run();
+	bool IsStale(unsigned int id) const
+	{
+		return id != m_latest;
+	}
+	bool Fetch(const Request& request, Results& results);
+	bool FindCached(const std::string& query, Results& results);
+	void AddCached(const std::string& query, const Results& results);
+
+	const Fetcher m_fetcher;
+	const Resolver m_resolver;
+	const size_t m_cache_size;
+	const std::chrono::milliseconds m_ttl;
+
+	// least recently used last, only the worker uses it
+	std::list<CacheEntry> m_cache;
+	std::unordered_map<std::string, std::list<CacheEntry>::iterator> m_cache_index;
+
+	Request m_request;
+	bool m_pending;
+	bool m_quit;
+	unsigned int m_next_id;
+	std::atomic<unsigned int> m_latest; //!< id of the query whose results are wanted
+	std::mutex m_mutex;
+	std::condition_variable m_wakeup;
+	std::thread m_thread;
+};
+
+#endif // SPRINGLOBBY_HEADERGUARD_CONTENTSEARCH_H
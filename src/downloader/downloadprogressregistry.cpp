@@ -0,0 +1,155 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "downloadprogressregistry.h"
+
+#include <algorithm>
+
+DownloadProgressRegistry::Entry::Entry(unsigned int id, const std::string& name)
+    : id(id)
+    , name(name)
+    , m_downloaded(0)
+    , m_total(0)
+    , m_rate(0)
+    , m_state(STATE_RUNNING)
+    , m_sampled(false)
+    , m_sample_bytes(0)
+{
+}
+
+void DownloadProgressRegistry::Entry::Update(int64_t downloaded, int64_t total)
+{
+	Update(downloaded, total, Clock::now());
+}
+
+void DownloadProgressRegistry::Entry::Update(int64_t downloaded, int64_t total, Clock::time_point now)
+{
+	m_total = std::max<int64_t>(total, 0);
+	m_downloaded = std::max<int64_t>(downloaded, 0);
+
+	// a retry on another mirror starts over from 0
+	if (!m_sampled || downloaded < m_sample_bytes) {
+		m_sampled = true;
+		m_sample_time = now;
+		m_sample_bytes = std::max<int64_t>(downloaded, 0);
+		return;
+	}
+	const int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_sample_time).count();
+	if (elapsed < RATE_WINDOW_MS) {
+		return;
+	}
+	const int64_t rate = (downloaded - m_sample_bytes) * 1000 / elapsed;
+	const int64_t previous = m_rate;
+	// average with the last window, so the eta doesn't jump around
+	m_rate = previous > 0 ? (previous + rate) / 2 : rate;
+	m_sample_time = now;
+	m_sample_bytes = downloaded;
+}
+
+void DownloadProgressRegistry::Entry::Finish(bool success)
+{
+	if (success) {
+		const int64_t total = m_total;
+		if (total > 0) {
+			m_downloaded = total;
+		}
+	}
+	m_rate = 0;
+	m_state = success ? STATE_DONE : STATE_FAILED;
+}
+
+DownloadProgressRegistry::Progress DownloadProgressRegistry::Entry::Get() const
+{
+	Progress progress;
+	progress.id = id;
+	progress.name = name;
+	progress.downloaded = m_downloaded;
+	progress.total = m_total;
+	progress.bytesPerSecond = m_rate;
+	const int state = m_state;
+	progress.running = state == STATE_RUNNING;
+	progress.failed = state == STATE_FAILED;
+	// the counters are read one by one, a concurrent update may have
+	// changed the total in between
+	if (progress.total > 0) {
+		progress.downloaded = std::min(progress.downloaded, progress.total);
+	}
+	progress.eta = -1;
+	if (progress.running && progress.total > 0 && progress.bytesPerSecond > 0) {
+		const int64_t left = std::max<int64_t>(progress.total - progress.downloaded, 0);
+		progress.eta = static_cast<int>((left + progress.bytesPerSecond - 1) / progress.bytesPerSecond);
+	}
+	return progress;
+}
+
+DownloadProgressRegistry* DownloadProgressRegistry::Instance()
+{
+	static DownloadProgressRegistry registry;
+	return &registry;
+}
+
+DownloadProgressRegistry::DownloadProgressRegistry()
+    : m_next_id(0)
+{
+}
+
+std::shared_ptr<DownloadProgressRegistry::Entry> DownloadProgressRegistry::Start(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [&name](const std::shared_ptr<Entry>& entry) {
+				return entry->name == name && !entry->IsRunning();
+			}),
+			m_entries.end());
+	size_t finished = std::count_if(m_entries.begin(), m_entries.end(), [](const std::shared_ptr<Entry>& entry) {
+		return !entry->IsRunning();
+	});
+	for (auto it = m_entries.begin(); it != m_entries.end() && finished > MAX_FINISHED;) {
+		if (!(*it)->IsRunning()) {
+			it = m_entries.erase(it);
+			finished--;
+		} else {
+			++it;
+		}
+	}
+	m_entries.push_back(std::make_shared<Entry>(m_next_id++, name));
+	return m_entries.back();
+}
+
+std::vector<DownloadProgressRegistry::Progress> DownloadProgressRegistry::Snapshot() const
+{
+	std::vector<Progress> result;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	result.reserve(m_entries.size());
+	for (const std::shared_ptr<Entry>& entry : m_entries) {
+		result.push_back(entry->Get());
+	}
+	return result;
+}
+
+bool DownloadProgressRegistry::Find(const std::string& name, Progress& progress) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto it = m_entries.rbegin(); it != m_entries.rend(); ++it) {
+		if ((*it)->name == name) {
+			progress = (*it)->Get();
+			return true;
+		}
+	}
+	return false;
+}
+
+bool DownloadProgressRegistry::IsRunning() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return std::any_of(m_entries.begin(), m_entries.end(), [](const std::shared_ptr<Entry>& entry) {
+		return entry->IsRunning();
+	});
+}
+
+void DownloadProgressRegistry::ClearFinished()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [](const std::shared_ptr<Entry>& entry) {
+				return !entry->IsRunning();
+			}),
+			m_entries.end());
+}
@@ -0,0 +1,99 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_DOWNLOADPROGRESSREGISTRY_H
+#define SPRINGLOBBY_HEADERGUARD_DOWNLOADPROGRESSREGISTRY_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "utils/mixins.h"
+
+//! @brief Progress of every download of the session.
+//! Each download owns an Entry whose counters its thread updates with atomics
+//! only. The UI polls Snapshot(), the list of entries is locked just to add
+//! or drop one and to copy it.
+class DownloadProgressRegistry : public SL::NonCopyable
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	//! the throughput is measured over windows of this length
+	static constexpr int RATE_WINDOW_MS = 1000;
+	//! the oldest finished entries are dropped when there are more
+	static constexpr size_t MAX_FINISHED = 32;
+
+	struct Progress {
+		unsigned int id;
+		std::string name;
+		int64_t downloaded;
+		int64_t total;		//!< 0 if not known yet
+		int64_t bytesPerSecond; //!< 0 until one rate window passed
+		int eta;		//!< seconds, -1 if unknown
+		bool running;
+		bool failed;
+	};
+
+	class Entry : public SL::NonCopyable
+	{
+	public:
+		Entry(unsigned int id, const std::string& name);
+
+		//! only the thread running the download may call these
+		void Update(int64_t downloaded, int64_t total);
+		void Update(int64_t downloaded, int64_t total, Clock::time_point now);
+		void Finish(bool success);
+
+		Progress Get() const;
+		bool IsRunning() const
+		{
+			return m_state == STATE_RUNNING;
+		}
+
+		const unsigned int id;
+		const std::string name;
+
+	private:
+		enum State {
+			STATE_RUNNING,
+			STATE_DONE,
+			STATE_FAILED
+		};
+
+		std::atomic<int64_t> m_downloaded;
+		std::atomic<int64_t> m_total;
+		std::atomic<int64_t> m_rate;
+		std::atomic<int> m_state;
+
+		// start of the current rate window, owned by the writer
+		bool m_sampled;
+		Clock::time_point m_sample_time;
+		int64_t m_sample_bytes;
+	};
+
+	static DownloadProgressRegistry* Instance();
+
+	DownloadProgressRegistry();
+
+	//! adds a running entry for name. A finished entry of the same name is
+	//! replaced, so a retried download shows up once. Only the last
+	//! MAX_FINISHED finished entries are kept.
+	std::shared_ptr<Entry> Start(const std::string& name);
+	//! progress of all entries in the order they were started
+	std::vector<Progress> Snapshot() const;
+	//! progress of the last started entry for name, false if there is none
+	bool Find(const std::string& name, Progress& progress) const;
+	bool IsRunning() const;
+	void ClearFinished();
+
+private:
+	mutable std::mutex m_mutex;
+	std::vector<std::shared_ptr<Entry> > m_entries;
+	unsigned int m_next_id;
+};
+
+#endif // SPRINGLOBBY_HEADERGUARD_DOWNLOADPROGRESSREGISTRY_H
@@ -0,0 +1,231 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "downloadscheduler.h"
+
+#include <wx/log.h>
+#include <algorithm>
+#include <exception>
+
+DownloadScheduler::DownloadScheduler(size_t workers)
+    : m_worker_count(std::max<size_t>(workers, 1))
+    , m_next_seq(0)
+    , m_quit(false)
+{
+	for (size_t i = 0; i < m_worker_count; i++) {
+		m_workers.emplace_back(&DownloadScheduler::Run, this);
+	}
+}
+
+DownloadScheduler::~DownloadScheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	CancelAll();
+	m_wakeup.notify_all();
+	for (std::thread& worker : m_workers) {
+		worker.join();
+	}
+}
+
+void DownloadScheduler::SetCategoryLimit(DownloadEnum::Category cat, size_t limit)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_limits[cat] = limit;
+	}
+	m_wakeup.notify_all();
+}
+
+std::shared_ptr<DownloadScheduler::CancelToken> DownloadScheduler::Schedule(DownloadEnum::Category cat, const std::string& name, Priority priority, Job job)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (priority > PRIORITY_BACKGROUND) {
+		// preempt the running background jobs, unless one of them is this job
+		for (const std::shared_ptr<Entry>& running : m_running) {
+			if (running->priority == PRIORITY_BACKGROUND && (running->cat != cat || running->name != name)) {
+				running->token->Cancel();
+			}
+		}
+		m_wakeup.notify_all(); // their category slots are free now
+	}
+	std::shared_ptr<Entry> entry = Find(cat, name);
+	if (entry != nullptr) {
+		entry->priority = std::max(entry->priority, priority);
+		return entry->token;
+	}
+
+	entry = std::make_shared<Entry>();
+	entry->cat = cat;
+	entry->name = name;
+	entry->priority = priority;
+	entry->seq = m_next_seq++;
+	entry->job = std::move(job);
+	entry->token = std::make_shared<CancelToken>();
+	if (m_quit) {
+		entry->token->Cancel();
+		return entry->token;
+	}
+	m_queue.push_back(entry);
+	m_wakeup.notify_one();
+	return entry->token;
+}
+
+bool DownloadScheduler::Cancel(DownloadEnum::Category cat, const std::string& name)
+{
+	bool found = false;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		const std::shared_ptr<Entry> entry = Find(cat, name);
+		if (entry != nullptr) {
+			entry->token->Cancel();
+			m_queue.remove(entry);
+			found = true;
+		}
+	}
+	m_idle.notify_all();
+	return found;
+}
+
+void DownloadScheduler::CancelAll()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (const std::shared_ptr<Entry>& entry : m_queue) {
+			entry->token->Cancel();
+		}
+		for (const std::shared_ptr<Entry>& entry : m_running) {
+			entry->token->Cancel();
+		}
+		m_queue.clear();
+	}
+	m_idle.notify_all();
+}
+
+bool DownloadScheduler::IsPending(DownloadEnum::Category cat, const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return Find(cat, name) != nullptr;
+}
+
+void DownloadScheduler::WaitIdle()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_idle.wait(lock, [this] { return m_queue.empty() && m_running.empty(); });
+}
+
+size_t DownloadScheduler::GetPendingCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_queue.size() + m_running.size();
+}
+
+// the queued or running job for cat and name which wasn't cancelled
+std::shared_ptr<DownloadScheduler::Entry> DownloadScheduler::Find(DownloadEnum::Category cat, const std::string& name)
+{
+	for (const std::shared_ptr<Entry>& entry : m_queue) {
+		if (entry->cat == cat && entry->name == name) {
+			return entry;
+		}
+	}
+	for (const std::shared_ptr<Entry>& entry : m_running) {
+		if (entry->cat == cat && entry->name == name && !entry->token->IsCancelled()) {
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+bool DownloadScheduler::HasForegroundJobs() const
+{
+	for (const std::shared_ptr<Entry>& entry : m_queue) {
+		if (entry->priority > PRIORITY_BACKGROUND) {
+			return true;
+		}
+	}
+	for (const std::shared_ptr<Entry>& entry : m_running) {
+		if (entry->priority > PRIORITY_BACKGROUND) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool DownloadScheduler::IsRunning(DownloadEnum::Category cat, const std::string& name) const
+{
+	return std::any_of(m_running.begin(), m_running.end(), [&cat, &name](const std::shared_ptr<Entry>& entry) {
+		return entry->cat == cat && entry->name == name;
+	});
+}
+
+size_t DownloadScheduler::RunningCount(DownloadEnum::Category cat) const
+{
+	return std::count_if(m_running.begin(), m_running.end(), [cat](const std::shared_ptr<Entry>& entry) {
+		return entry->cat == cat && (entry->priority > PRIORITY_BACKGROUND || !entry->token->IsCancelled());
+	});
+}
+
+// the queued job with the highest priority whose category has a free slot
+std::list<std::shared_ptr<DownloadScheduler::Entry> >::iterator DownloadScheduler::NextJob()
+{
+	const bool foreground = HasForegroundJobs();
+	const size_t background = std::count_if(m_running.begin(), m_running.end(), [](const std::shared_ptr<Entry>& entry) {
+		return entry->priority == PRIORITY_BACKGROUND;
+	});
+	// a worker stays free for the content the user asks for meanwhile
+	const bool backgroundSlot = m_worker_count == 1 || background + 1 < m_worker_count;
+	auto next = m_queue.end();
+	for (auto it = m_queue.begin(); it != m_queue.end(); ++it) {
+		const Entry& entry = **it;
+		if (entry.priority == PRIORITY_BACKGROUND && (foreground || !backgroundSlot)) {
+			continue;
+		}
+		const auto limit = m_limits.find(entry.cat);
+		if (limit != m_limits.end() && limit->second > 0 && RunningCount(entry.cat) >= limit->second) {
+			continue;
+		}
+		// a cancelled job may still be writing the same files
+		if (IsRunning(entry.cat, entry.name)) {
+			continue;
+		}
+		// the queue is in the order of scheduling, so the first one wins a tie
+		if (next == m_queue.end() || entry.priority > (*next)->priority) {
+			next = it;
+		}
+	}
+	return next;
+}
+
+void DownloadScheduler::Run()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true) {
+		const auto next = NextJob();
+		if (next == m_queue.end()) {
+			if (m_quit) {
+				return;
+			}
+			m_wakeup.wait(lock);
+			continue;
+		}
+		const std::shared_ptr<Entry> entry = *next;
+		m_queue.erase(next);
+		m_running.push_back(entry);
+		lock.unlock();
+
+		try {
+			entry->job(*entry->token);
+		} catch (const std::exception& e) {
+			wxLogError("Download of %s failed: %s", entry->name.c_str(), e.what());
+		} catch (...) {
+			wxLogError("Download of %s failed", entry->name.c_str());
+		}
+		entry->job = nullptr; // release what the job holds outside of the lock
+
+		lock.lock();
+		m_running.erase(std::find(m_running.begin(), m_running.end(), entry));
+		m_wakeup.notify_all(); // a category slot got free
+		m_idle.notify_all();
+	}
+}
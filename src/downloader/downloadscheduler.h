@@ -0,0 +1,116 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_DOWNLOADSCHEDULER_H
+#define SPRINGLOBBY_HEADERGUARD_DOWNLOADSCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lib/src/Downloader/DownloadEnum.h"
+#include "utils/mixins.h"
+
+//! @brief Runs download jobs on a pool of worker threads.
+//! Jobs are identified by category and name, scheduling a job which is
+//! already queued or running doesn't add another one. Queued jobs start by
+//! priority, then in the order they were scheduled, as long as less than the
+//! limit of their category are running. Every job has its own cancel token.
+//! Background jobs only run while no other jobs are queued or running, a
+//! running one is cancelled once another job is scheduled. They leave one
+//! worker free for other jobs, and once cancelled they don't count against
+//! the limit of their category while they wind down. A job doesn't start
+//! while a cancelled one for the same content is still running.
+class DownloadScheduler : public SL::NonCopyable
+{
+public:
+	enum Priority {
+		PRIORITY_BACKGROUND, //!< gives way to all other jobs
+		PRIORITY_NORMAL,
+		PRIORITY_BATTLE //!< content needed for the current battle
+	};
+
+	//! a running job checks it between its steps and stops when it is set
+	class CancelToken
+	{
+	public:
+		CancelToken()
+		    : m_cancelled(false)
+		{
+		}
+		void Cancel()
+		{
+			m_cancelled = true;
+		}
+		bool IsCancelled() const
+		{
+			return m_cancelled;
+		}
+
+	private:
+		std::atomic<bool> m_cancelled;
+	};
+
+	typedef std::function<void(const CancelToken&)> Job;
+
+	explicit DownloadScheduler(size_t workers);
+	//! cancels all jobs and waits for the running ones to return
+	~DownloadScheduler();
+
+	//! at most limit jobs of cat run at once, 0 means as many as there are workers
+	void SetCategoryLimit(DownloadEnum::Category cat, size_t limit);
+
+	//! queues job. If a job for cat and name is queued or running already,
+	//! job is dropped and the token of that one is returned, it gets the
+	//! higher of both priorities.
+	std::shared_ptr<CancelToken> Schedule(DownloadEnum::Category cat, const std::string& name, Priority priority, Job job);
+	//! cancels the job for cat and name, a queued one is removed.
+	//! Returns false if there is none.
+	bool Cancel(DownloadEnum::Category cat, const std::string& name);
+	void CancelAll();
+	//! whether a job for cat and name is queued or running
+	bool IsPending(DownloadEnum::Category cat, const std::string& name);
+
+	//! blocks until no jobs are queued or running
+	void WaitIdle();
+	//! count of queued and running jobs
+	size_t GetPendingCount();
+
+private:
+	struct Entry {
+		DownloadEnum::Category cat;
+		std::string name;
+		Priority priority;
+		unsigned long seq;
+		Job job;
+		std::shared_ptr<CancelToken> token;
+	};
+
+	void Run();
+	std::list<std::shared_ptr<Entry> >::iterator NextJob();
+	std::shared_ptr<Entry> Find(DownloadEnum::Category cat, const std::string& name);
+	bool HasForegroundJobs() const;
+	//! whether a job for cat and name runs, even a cancelled one
+	bool IsRunning(DownloadEnum::Category cat, const std::string& name) const;
+	//! running jobs of cat, without the cancelled background ones
+	size_t RunningCount(DownloadEnum::Category cat) const;
+
+	std::list<std::shared_ptr<Entry> > m_queue;
+	std::vector<std::shared_ptr<Entry> > m_running;
+	std::map<DownloadEnum::Category, size_t> m_limits;
+	const size_t m_worker_count;
+	unsigned long m_next_seq;
+	bool m_quit;
+	std::mutex m_mutex;
+	std::condition_variable m_wakeup; //!< wakes the workers
+	std::condition_variable m_idle;   //!< signaled when a job finished
+	std::vector<std::thread> m_workers;
+};
+
+#endif // SPRINGLOBBY_HEADERGUARD_DOWNLOADSCHEDULER_H
@@ -0,0 +1,86 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "downloadtransfer.h"
+
+#include "lib/src/Downloader/Download.h"
+#include "lib/src/Downloader/Http/HttpDownloader.h"
+#include "lib/src/Downloader/IDownloader.h"
+#include "lib/src/Downloader/Rapid/RapidDownloader.h"
+// Resolves names collision: CreateDialog from WxWidgets and CreateDialog macro from WINUSER.H
+#ifdef CreateDialog
+#undef CreateDialog
+#endif
+
+#include <mutex>
+
+//! searches update the repo lists, which are cached in the download folder
+//! for all downloaders
+static std::mutex searchMutex;
+
+DownloadTransfer::DownloadTransfer()
+    : m_rapid(new CRapidDownloader())
+    , m_http(new CHttpDownloader())
+{
+}
+
+DownloadTransfer::~DownloadTransfer()
+{
+	IDownloader::freeResult(m_downloads);
+}
+
+IDownloader& DownloadTransfer::GetRapid()
+{
+	return *m_rapid;
+}
+
+IDownloader& DownloadTransfer::GetHttp()
+{
+	return *m_http;
+}
+
+void DownloadTransfer::AddUrl(DownloadEnum::Category cat, const std::string& filename, const std::string& url)
+{
+	IDownload* dl = new IDownload(filename, url, cat);
+	dl->addMirror(url);
+	m_downloads.push_back(dl);
+}
+
+int DownloadTransfer::Search(DownloadEnum::Category cat, const std::string& name)
+{
+	std::list<IDownload*> results;
+	bool ok = true;
+	{
+		std::lock_guard<std::mutex> lock(searchMutex);
+		switch (cat) {
+			case DownloadEnum::CAT_MAP:
+			case DownloadEnum::CAT_GAME:
+				ok = m_rapid->search(results, name.c_str(), cat);
+				// maps which aren't on rapid may be on the map mirrors
+				if (results.empty() && cat == DownloadEnum::CAT_MAP) {
+					ok = m_http->search(results, name.c_str(), cat);
+				}
+				break;
+			default:
+				ok = m_http->search(results, name.c_str(), cat);
+				break;
+		}
+	}
+	const int count = ok ? static_cast<int>(results.size()) : -1;
+	if (!results.empty()) { // the first result only
+		m_downloads.splice(m_downloads.end(), results, results.begin());
+	}
+	IDownloader::freeResult(results);
+	return count;
+}
+
+bool DownloadTransfer::Start(int maxParallel)
+{
+	if (m_downloads.empty()) {
+		return false;
+	}
+	// each downloader skips the downloads of the other one
+	bool ok = m_http->download(m_downloads, maxParallel);
+	ok = m_rapid->download(m_downloads) && ok;
+	IDownloader::freeResult(m_downloads);
+	return ok;
+}
@@ -0,0 +1,45 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_DOWNLOADTRANSFER_H
+#define SPRINGLOBBY_HEADERGUARD_DOWNLOADTRANSFER_H
+
+#include <list>
+#include <memory>
+#include <string>
+
+#include "lib/src/Downloader/DownloadEnum.h"
+#include "utils/mixins.h"
+
+class IDownload;
+class IDownloader;
+
+//! @brief A download with pr-downloader instances of its own.
+//! The C interface of pr-downloader keeps the search results and the queued
+//! downloads in globals, so only one download at a time can use it. A
+//! transfer searches and downloads with its own rapid and http downloader,
+//! several transfers can run at the same time.
+class DownloadTransfer : public SL::NonCopyable
+{
+public:
+	DownloadTransfer();
+	~DownloadTransfer();
+
+	//! the downloaders, to set their options before searching
+	IDownloader& GetRapid();
+	IDownloader& GetHttp();
+
+	//! queues the download of url to the file filename
+	void AddUrl(DownloadEnum::Category cat, const std::string& filename, const std::string& url);
+	//! searches name like DownloadSearch() does and queues the first
+	//! result. Returns the count of results, -1 if the search failed.
+	int Search(DownloadEnum::Category cat, const std::string& name);
+	//! downloads what is queued, returns false if it failed
+	bool Start(int maxParallel);
+
+private:
+	std::unique_ptr<IDownloader> m_rapid;
+	std::unique_ptr<IDownloader> m_http;
+	std::list<IDownload*> m_downloads;
+};
+
+#endif // SPRINGLOBBY_HEADERGUARD_DOWNLOADTRANSFER_H
@@ -0,0 +1,152 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "mirrorhealth.h"
+
+#include <algorithm>
+
+//! weight of the results so far against a new one
+static const double HISTORY_WEIGHT = 0.7;
+//! the score is per expected time to fetch this much
+static const double REFERENCE_BYTES = 1024 * 1024;
+//! assumed as long as nothing was measured
+static const double DEFAULT_TTFB_MS = 500;
+static const double DEFAULT_BYTES_PER_SECOND = 1024 * 1024;
+
+MirrorHealth* MirrorHealth::Instance()
+{
+	static MirrorHealth health;
+	return &health;
+}
+
+MirrorHealth::MirrorHealth()
+    : m_interval(0)
+    , m_quit(false)
+{
+}
+
+MirrorHealth::~MirrorHealth()
+{
+	StopProbing();
+}
+
+static double Average(double average, double value)
+{
+	return average * HISTORY_WEIGHT + value * (1 - HISTORY_WEIGHT);
+}
+
+void MirrorHealth::Record(const std::string& url, const Sample& sample)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Entry& entry = m_entries[url];
+	entry.successes = entry.successes * HISTORY_WEIGHT + (sample.ok ? 1 : 0);
+	entry.attempts = entry.attempts * HISTORY_WEIGHT + 1;
+	if (!sample.ok) {
+		return;
+	}
+	if (sample.ttfb.count() >= 0) {
+		const double ttfb = sample.ttfb.count();
+		entry.ttfbMs = entry.ttfbMs < 0 ? ttfb : Average(entry.ttfbMs, ttfb);
+	}
+	if (sample.bytes > 0) {
+		const double rate = sample.bytes / (std::max<double>(sample.duration.count(), 1) / 1000);
+		entry.bytesPerSecond = entry.bytesPerSecond <= 0 ? rate : Average(entry.bytesPerSecond, rate);
+	}
+}
+
+MirrorHealth::Stats MirrorHealth::MakeStats(const Entry& entry)
+{
+	Stats stats;
+	// as if every mirror had one success and one failure before, so one
+	// result doesn't decide everything
+	stats.successRate = (entry.successes + 1) / (entry.attempts + 2);
+	stats.ttfbMs = entry.ttfbMs;
+	stats.bytesPerSecond = entry.bytesPerSecond;
+	const double ttfb = entry.ttfbMs >= 0 ? entry.ttfbMs : DEFAULT_TTFB_MS;
+	const double rate = entry.bytesPerSecond > 0 ? entry.bytesPerSecond : DEFAULT_BYTES_PER_SECOND;
+	stats.score = stats.successRate / (ttfb / 1000 + REFERENCE_BYTES / rate);
+	return stats;
+}
+
+MirrorHealth::Stats MirrorHealth::GetStats(const std::string& url) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto it = m_entries.find(url);
+	return MakeStats(it != m_entries.end() ? it->second : Entry());
+}
+
+std::vector<std::string> MirrorHealth::Order(const std::vector<std::string>& urls) const
+{
+	std::vector<std::pair<double, std::string> > scored;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (const std::string& url : urls) {
+			const auto it = m_entries.find(url);
+			scored.push_back(std::make_pair(MakeStats(it != m_entries.end() ? it->second : Entry()).score, url));
+		}
+	}
+	std::stable_sort(scored.begin(), scored.end(), [](const std::pair<double, std::string>& a, const std::pair<double, std::string>& b) {
+		return a.first > b.first;
+	});
+	std::vector<std::string> ordered;
+	for (const auto& it : scored) {
+		ordered.push_back(it.second);
+	}
+	return ordered;
+}
+
+void MirrorHealth::StartProbing(Prober prober, std::chrono::milliseconds interval)
+{
+	std::lock_guard<std::mutex> lock(m_probe_mutex);
+	if (m_thread.joinable() || interval.count() <= 0) {
+		return;
+	}
+	m_prober = prober;
+	m_interval = interval;
+	m_quit = false;
+	m_thread = std::thread(&MirrorHealth::RunProbes, this);
+}
+
+void MirrorHealth::StopProbing()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_probe_mutex);
+		if (!m_thread.joinable()) {
+			return;
+		}
+		m_quit = true;
+	}
+	m_wakeup.notify_all();
+	m_thread.join();
+}
+
+void MirrorHealth::SetProbeUrls(const std::vector<std::string>& urls)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_probe_mutex);
+		if (urls == m_probe_urls) {
+			return;
+		}
+		m_probe_urls = urls;
+	}
+	// check the new ones right away
+	m_wakeup.notify_all();
+}
+
+void MirrorHealth::RunProbes()
+{
+	std::unique_lock<std::mutex> lock(m_probe_mutex);
+	while (!m_quit) {
+		const std::vector<std::string> urls = m_probe_urls;
+		lock.unlock();
+		for (const std::string& url : urls) {
+			if (m_quit) {
+				return;
+			}
+			Record(url, m_prober(url));
+		}
+		lock.lock();
+		if (m_probe_urls == urls) {
+			m_wakeup.wait_for(lock, m_interval, [this, &urls] { return m_quit || m_probe_urls != urls; });
+		}
+	}
+}
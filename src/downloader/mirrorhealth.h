@@ -0,0 +1,87 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_MIRRORHEALTH_H
+#define SPRINGLOBBY_HEADERGUARD_MIRRORHEALTH_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/mixins.h"
+
+//! @brief Keeps track of how well the download mirrors perform.
+//! Downloads and periodic probes report how a request to a mirror went, the
+//! mirrors are then tried in the order of their score: the success rate
+//! divided by the expected time to fetch a megabyte from it, which comes
+//! from the time to the first byte and the throughput. Older results weigh
+//! less, so a mirror which recovered moves up again. A mirror nothing is
+//! known about scores like one which worked half of the time at average
+//! speed, mirrors with the same score keep their configured order.
+class MirrorHealth : public SL::NonCopyable
+{
+public:
+	struct Sample {
+		bool ok = false;
+		std::chrono::milliseconds ttfb{-1};    //!< negative if not measured
+		int64_t bytes = 0;		       //!< received, 0 if not measured
+		std::chrono::milliseconds duration{0}; //!< of receiving them
+	};
+
+	struct Stats {
+		double successRate;
+		double ttfbMs;	       //!< average, negative if not known
+		double bytesPerSecond; //!< average, 0 if not known
+		double score;
+	};
+
+	//! requests url once and measures how it went
+	typedef std::function<Sample(const std::string& url)> Prober;
+
+	static MirrorHealth* Instance();
+
+	MirrorHealth();
+	~MirrorHealth();
+
+	void Record(const std::string& url, const Sample& sample);
+	Stats GetStats(const std::string& url) const;
+	//! urls ordered by score, best first
+	std::vector<std::string> Order(const std::vector<std::string>& urls) const;
+
+	//! probes the mirrors every interval on a thread of its own, the first
+	//! time right away
+	void StartProbing(Prober prober, std::chrono::milliseconds interval);
+	void StopProbing();
+	//! the mirrors to probe
+	void SetProbeUrls(const std::vector<std::string>& urls);
+
+private:
+	struct Entry {
+		double successes = 0;
+		double attempts = 0;
+		double ttfbMs = -1;
+		double bytesPerSecond = 0;
+	};
+
+	static Stats MakeStats(const Entry& entry);
+	void RunProbes();
+
+	std::map<std::string, Entry> m_entries;
+	mutable std::mutex m_mutex;
+
+	Prober m_prober;
+	std::chrono::milliseconds m_interval;
+	std::vector<std::string> m_probe_urls;
+	std::atomic<bool> m_quit;
+	std::mutex m_probe_mutex;
+	std::condition_variable m_wakeup;
+	std::thread m_thread;
+};
+
+#endif // SPRINGLOBBY_HEADERGUARD_MIRRORHEALTH_H
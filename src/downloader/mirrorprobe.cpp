@@ -0,0 +1,42 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "mirrorprobe.h"
+
+#include <cstdint>
+
+extern "C" {
+static size_t ProbeWrite(void* /*ptr*/, size_t size, size_t nmemb, void* userdata)
+{
+	*static_cast<int64_t*>(userdata) += size * nmemb;
+	return size * nmemb;
+}
+}
+
+MirrorHealth::Sample ProbeMirror(CURL* curl, const std::string& url)
+{
+	int64_t received = 0;
+	curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+	curl_easy_setopt(curl, CURLOPT_RANGE, "0-65535");
+	curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
+	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, ProbeWrite);
+	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &received);
+	const CURLcode res = curl_easy_perform(curl);
+
+	long code = 0;
+	double ttfb = 0;
+	double total = 0;
+	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
+	curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME, &ttfb);
+	curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &total);
+
+	MirrorHealth::Sample sample;
+	// map base urls point to a folder, an error page for it shows the mirror is up
+	const bool folder = !url.empty() && url.back() == '/';
+	sample.ok = res == CURLE_OK && (code < 400 || (folder && code < 500));
+	sample.ttfb = std::chrono::milliseconds(static_cast<long>(ttfb * 1000));
+	sample.bytes = received;
+	sample.duration = std::chrono::milliseconds(static_cast<long>((total - ttfb) * 1000));
+	return sample;
+}
@@ -0,0 +1,15 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_MIRRORPROBE_H
+#define SPRINGLOBBY_HEADERGUARD_MIRRORPROBE_H
+
+#include <curl/curl.h>
+#include <string>
+
+#include "mirrorhealth.h"
+
+//! fetches the first 64 kB from url and measures how it went, for MirrorHealth
+//! @param curl fresh handle to use, the caller sets proxy and certificates
+MirrorHealth::Sample ProbeMirror(CURL* curl, const std::string& url);
+
+#endif // SPRINGLOBBY_HEADERGUARD_MIRRORPROBE_H
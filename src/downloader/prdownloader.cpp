@@ -3,10 +3,15 @@
 
 #include <lslutils/globalsmanager.h>
 
+#include "lib/src/Downloader/CurlWrapper.h"
 #include "lib/src/Downloader/Http/HttpDownloader.h" //FIXME
 #include "lib/src/Downloader/IDownloader.h"	 //FIXME: remove this include
 #include "lib/src/FileSystem/FileSystem.h"	  //FIXME
 #include "lib/src/pr-downloader.h"
+#include "downloadtransfer.h"
+#include "mirrorhealth.h"
+#include "mirrorprobe.h"
+#include "prefetchbudget.h"
 #include "sourcesconfig.h"
 // Resolves names collision: CreateDialog from WxWidgets and CreateDialog macro from WINUSER.H
 // Remove with HttpDownloader.h header inclusion
@@ -14,23 +19,28 @@
 #undef CreateDialog
 #endif
 
+#include <curl/curl.h>
 #include <lslunitsync/unitsync.h>
-#include <lslutils/thread.h>
-#include <sys/time.h>
 #include <json/writer.h>
 #include <wx/app.h>
+#include <wx/filefn.h>
 #include <wx/log.h>
 #include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <cctype>
+#include <chrono>
 #include <cstdio>
 #include <cstring>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 
+#include "contentindex.h"
+#include "downloadprogressregistry.h"
 #include "log.h"
 #include "settings.h"
 #include "gui/mainwindow.h"
@@ -40,44 +50,123 @@
 #include "utils/slconfig.h"
 #include "utils/slpaths.h"
 
-static PrDownloader::DownloadProgress* m_progress = nullptr;
-static std::mutex dlProgressMutex;
-
-static PrDownloader::DownloadProgress* EnsureProgressLocked()
+SLCONFIG("/Downloader/Workers", 3l, "Count of downloads which can run at the same time");
+SLCONFIG("/Downloader/MaxPerCategory", 2l, "Count of maps, games, ... which can be downloaded at the same time");
+SLCONFIG("/Downloader/MirrorProbeInterval", 600l, "Seconds between health checks of the download mirrors, 0 disables them");
+SLCONFIG("/Downloader/Prefetch", false, "Download missing content of the selected battle and of battles hosted by friends in the background");
+SLCONFIG("/Downloader/PrefetchBudget", 2048l, "Megabytes prefetching may download per day");
+SLCONFIG("/Downloader/PrefetchMinFreeDisk", 4096l, "Megabytes of disk space prefetching leaves free");
+
+//! pr-downloader keeps its options, search results and downloads in globals,
+//! so only one job at a time may use them. Downloads only hold it while they
+//! are set up, they transfer with downloaders of their own.
+static std::mutex prdMutex;
+//! validating the rapid pool deletes broken files, it waits for the transfers
+static std::shared_mutex poolMutex;
+class ProgressTracker;
+//! pr-downloader reports progress on the thread running the transfer,
+//! this is the tracker of the download that thread works on
+static thread_local ProgressTracker* transferProgress = nullptr;
+
+//! starts tracking the progress of name on the calling thread. While
+//! background is set it gets no registry entry, so prefetches only show up
+//! once somebody asks for them.
+class ProgressTracker
 {
-	if (m_progress == nullptr) {
-		m_progress = new PrDownloader::DownloadProgress();
+public:
+	//! downloaded gets the count of bytes transferred in the end
+	explicit ProgressTracker(const std::string& name, std::atomic<int64_t>* downloaded = nullptr, const std::atomic<bool>* background = nullptr)
+	    : m_name(name)
+	    , m_finished(false)
+	    , m_downloaded(downloaded)
+	    , m_background(background)
+	    , m_bytes(0)
+	    , m_total(0)
+	{
+		Track();
+		transferProgress = this;
 	}
-	return m_progress;
-}
-
-static void StartDownloadProgressTracking(const std::string& name)
-{
-	std::lock_guard<std::mutex> lock(dlProgressMutex);
-	PrDownloader::DownloadProgress* progress = EnsureProgressLocked();
-	progress->name = name;
-	progress->downloaded = 0;
-	progress->filesize = 1;
-	progress->running = true;
-	progress->failed = false;
-}
-
-static void FinishDownloadProgressTracking(const std::string& name, bool success)
-{
-	std::lock_guard<std::mutex> lock(dlProgressMutex);
-	PrDownloader::DownloadProgress* progress = EnsureProgressLocked();
-	progress->name = name;
-	if (progress->filesize <= 0) {
-		progress->filesize = 1;
+	~ProgressTracker()
+	{
+		Finish(false);
+		transferProgress = nullptr;
+		if (m_downloaded != nullptr) {
+			*m_downloaded = GetDownloaded();
+		}
+	}
+	void Update(int64_t downloaded, int64_t total)
+	{
+		m_bytes = downloaded;
+		m_total = total;
+		Track();
+		if (m_entry != nullptr) {
+			m_entry->Update(downloaded, total);
+		}
+	}
+	int64_t GetDownloaded() const
+	{
+		return m_bytes;
+	}
+	bool IsTracked() const
+	{
+		return m_entry != nullptr;
+	}
+	//! a prefetch which wasn't promoted leaves no entry behind
+	void Finish(bool success)
+	{
+		if (m_finished) {
+			return;
+		}
+		m_finished = true;
+		Track();
+		if (m_entry != nullptr) {
+			m_entry->Finish(success);
+		}
 	}
-	if (progress->downloaded < 0) {
-		progress->downloaded = 0;
+
+	//! finishes without adding an entry if there is none yet
+	void Drop()
+	{
+		if (m_entry == nullptr) {
+			m_finished = true;
+		}
+		Finish(false);
 	}
-	if (success && progress->downloaded < progress->filesize) {
-		progress->downloaded = progress->filesize;
+
+private:
+	void Track()
+	{
+		if (m_entry != nullptr || (m_background != nullptr && *m_background)) {
+			return;
+		}
+		m_entry = DownloadProgressRegistry::Instance()->Start(m_name);
+		if (m_bytes > 0 || m_total > 0) {
+			m_entry->Update(m_bytes, m_total);
+		}
 	}
-	progress->running = false;
-	progress->failed = !success;
+
+	const std::string m_name;
+	std::shared_ptr<DownloadProgressRegistry::Entry> m_entry;
+	bool m_finished;
+	std::atomic<int64_t>* m_downloaded;
+	const std::atomic<bool>* m_background;
+	int64_t m_bytes;
+	int64_t m_total;
+};
+
+static PrDownloader::DownloadProgress ToDownloadProgress(const DownloadProgressRegistry::Progress& progress)
+{
+	PrDownloader::DownloadProgress result;
+	result.name = progress.name;
+	// the view and the taskbar only deal with an int, pr-downloader reports one anyway.
+	// The size stays 0 while it is unknown.
+	result.filesize = static_cast<int>(progress.total);
+	result.downloaded = static_cast<int>(progress.downloaded);
+	result.bytesPerSecond = static_cast<int>(progress.bytesPerSecond);
+	result.eta = progress.eta;
+	result.running = progress.running;
+	result.failed = progress.failed;
+	return result;
 }
 
 static void RemoveLegacyDownloaderConfigKeys()
@@ -267,10 +356,13 @@ static bool WriteFileAtomically(const std::string& path, const std::string& cont
 	return true;
 }
 
+//! the sources file is read for every download, but rarely changes
+static DownloaderSourcesConfigCache sourcesConfigCache;
+
 static EffectiveSourcesConfig LoadEffectiveSourcesConfig()
 {
 	const DownloaderSourcesConfig fileConfig =
-	    LoadDownloaderSourcesConfig(SlPaths::GetLobbyWriteDir());
+	    sourcesConfigCache.Load(SlPaths::GetLobbyWriteDir());
 
 	switch (fileConfig.loadState) {
 		case DownloaderSourcesLoadState::LoadedFromFile: {
@@ -310,9 +402,11 @@ static EffectiveSourcesConfig LoadEffectiveSourcesConfig()
 			     fileConfig.path.c_str(), writeError.c_str());
 		return initialConfig;
 	}
+	// the stamp may not tell a rewrite within the same second apart
+	sourcesConfigCache.Invalidate();
 
 	const DownloaderSourcesConfig reloaded =
-	    LoadDownloaderSourcesConfig(SlPaths::GetLobbyWriteDir());
+	    sourcesConfigCache.Load(SlPaths::GetLobbyWriteDir());
 	if (reloaded.loadState == DownloaderSourcesLoadState::LoadedFromFile) {
 		EffectiveSourcesConfig config;
 		config.loadedFromSourcesFile = true;
@@ -359,177 +453,211 @@ static void MaybeLogSourcesConfigWarning(const EffectiveSourcesConfig& config)
 		     config.sourcesFilePath.c_str(), config.sourcesFileError.c_str());
 }
 
-static void ApplyEffectiveSourcesConfig(const EffectiveSourcesConfig& config)
+static void ApplyEffectiveSourcesConfig(const EffectiveSourcesConfig& config, IDownloader& rapid, IDownloader& http)
 {
-	if (!config.rapidMasterUrls.empty()) {
-		rapidDownload->setOption("masterurl", config.rapidMasterUrls.front());
+	std::vector<std::string> probeUrls = config.rapidMasterUrls;
+	probeUrls.insert(probeUrls.end(), config.mapBaseUrls.begin(), config.mapBaseUrls.end());
+	MirrorHealth::Instance()->SetProbeUrls(probeUrls);
+
+	const std::vector<std::string> rapidMasterUrls = MirrorHealth::Instance()->Order(config.rapidMasterUrls);
+	if (!rapidMasterUrls.empty()) {
+		rapid.setOption("masterurl", rapidMasterUrls.front());
 	}
-	rapidDownload->setOption("repo_timeout_seconds",
-				 std::to_string(config.rapidRepoTimeoutSeconds));
-	httpDownload->setOption("map_download_timeout_seconds",
-				std::to_string(config.mapDownloadTimeoutSeconds));
-	httpDownload->setOption("engine_download_timeout_seconds",
-				std::to_string(config.engineDownloadTimeoutSeconds));
-	httpDownload->setOption("engine_providers", BuildEngineProvidersJson(config.engineProviders));
+	rapid.setOption("repo_timeout_seconds", std::to_string(config.rapidRepoTimeoutSeconds));
+	http.setOption("map_download_timeout_seconds", std::to_string(config.mapDownloadTimeoutSeconds));
+	http.setOption("engine_download_timeout_seconds", std::to_string(config.engineDownloadTimeoutSeconds));
+	http.setOption("engine_providers", BuildEngineProvidersJson(config.engineProviders));
 
 	if (config.mapBaseUrls.empty()) {
-		httpDownload->setOption("map_base_url", "");
-		httpDownload->setOption("map_base_urls", "");
+		http.setOption("map_base_url", "");
+		http.setOption("map_base_urls", "");
 		return;
 	}
 
-	httpDownload->setOption("map_base_url", config.mapBaseUrls.front());
-	httpDownload->setOption("map_base_urls", JoinWithNewlines(config.mapBaseUrls));
+	const std::vector<std::string> mapBaseUrls = MirrorHealth::Instance()->Order(config.mapBaseUrls);
+	http.setOption("map_base_url", mapBaseUrls.front());
+	http.setOption("map_base_urls", JoinWithNewlines(mapBaseUrls));
 }
 
-static int SearchOnRapidSource(const DownloadEnum::Category category,
-			       const std::string& name,
-			       const std::string& rapidMasterUrl)
+extern "C" {
+static size_t FetchWrite(void* ptr, size_t size, size_t nmemb, void* userdata)
 {
-	rapidDownload->setOption("masterurl", rapidMasterUrl);
-	return DownloadSearch(category, name.c_str());
+	static_cast<std::string*>(userdata)->append(static_cast<const char*>(ptr), size * nmemb);
+	return size * nmemb;
 }
 
-class DownloadItem : public LSL::WorkItem
+static int FetchProgress(void* userdata, curl_off_t /*dltotal*/, curl_off_t /*dlnow*/, curl_off_t /*ultotal*/, curl_off_t /*ulnow*/)
+{
+	const std::function<bool()>& cancelled = *static_cast<const std::function<bool()>*>(userdata);
+	return (cancelled && cancelled()) ? 1 : 0;
+}
+}
+
+//! probes with the curl setup of the downloads
+static MirrorHealth::Sample ProbeMirrorCurl(const std::string& url)
+{
+	CurlWrapper cw;
+	return ProbeMirror(cw.GetHandle(), url);
+}
+
+class DownloadItem
 {
 private:
 	DownloadEnum::Category m_category;
 	std::string m_name;
 	std::string m_filename;
+	std::atomic<bool> m_background; //!< a prefetch nobody asked for yet
+	std::atomic<bool> m_started;
+	std::atomic<bool> m_transferring;
+	std::atomic<bool> m_started_sent; //!< OnDownloadStarted, once it isn't a prefetch
+	std::atomic<int64_t> m_downloaded;
+	const int m_http_parallel;
 
 public:
-	DownloadItem(const DownloadEnum::Category cat, const std::string& name, const std::string& filename)
+	DownloadItem(const DownloadEnum::Category cat, const std::string& name, const std::string& filename, bool background = false)
 	    : m_category(cat)
 	    , m_name(name)
 	    , m_filename(filename)
+	    , m_background(background)
+	    , m_started(false)
+	    , m_transferring(false)
+	    , m_started_sent(false)
+	    , m_downloaded(0)
+	    , m_http_parallel(sett().GetHTTPMaxParallelDownloads())
 	{
 		slLogDebugFunc("");
 	}
 
-	void Run()
+	void Run(const DownloadScheduler::CancelToken& token)
 	{
 		slLogDebugFunc("");
 		wxLogInfo("Starting download of filename: %s, name: %s, category: %s", m_filename.c_str(), m_name.c_str(), DownloadEnum::getCat(m_category).c_str());
+		m_started = true;
 
-		StartDownloadProgressTracking(m_name);
-		bool progressFinalized = false;
-		bool downloadStartedEventSent = false;
+		ProgressTracker progress(m_name, &m_downloaded, &m_background);
 		auto finalizeProgress = [&](bool success) {
-			if (progressFinalized) {
-				return;
+			// a cancelled download which never showed up, like a preempted prefetch, didn't fail
+			if (!success && token.IsCancelled()) {
+				progress.Drop();
+			} else {
+				progress.Finish(success);
 			}
-			FinishDownloadProgressTracking(m_name, success);
-			if (downloadStartedEventSent) {
+			if (m_started_sent && progress.IsTracked()) {
 				GlobalEventManager::Instance()->Send(GlobalEventManager::OnDownloadProgress);
 			}
-			progressFinalized = true;
 		};
-
-		try {
-			const bool force = true;
-			DownloadSetConfig(CONFIG_RAPID_FORCEUPDATE, &force);
-			const EffectiveSourcesConfig sourceConfig = LoadEffectiveSourcesConfig();
-			MaybeLogSourcesConfigWarning(sourceConfig);
-			ApplyEffectiveSourcesConfig(sourceConfig);
-
-			if (m_category == DownloadEnum::CAT_SPRINGLOBBY ||
-			    m_category == DownloadEnum::CAT_HTTP) {
-				const int results = DownloadAddByUrl(m_category, m_filename.c_str(), m_name.c_str());
-				if (results <= 0) {
-					GlobalEventManager::Instance()->Send(GlobalEventManager::OnDownloadFailed);
-					wxLogInfo("Nothing found to download");
-					finalizeProgress(false);
-					return;
-				}
-
-				downloadInfo info;
-				const bool hasdlinfo = DownloadGetInfo(0, info);
-				if (!hasdlinfo) {
-					wxLogWarning("Download has no downloadinfo: %s", m_name.c_str());
-					GlobalEventManager::Instance()->Send(GlobalEventManager::OnDownloadFailed);
-					finalizeProgress(false);
-					return;
-				}
-
-				downloadStartedEventSent = true;
-				GlobalEventManager::Instance()->Send(GlobalEventManager::OnDownloadStarted);
-				const bool downloadFailed = DownloadStart();
-				if (downloadFailed) {
-					wxLogWarning("Download failed: %s", m_name.c_str());
-					GlobalEventManager::Instance()->Send(GlobalEventManager::OnDownloadFailed);
-					finalizeProgress(false);
-				} else {
-					wxLogInfo("Download finished: %s", m_name.c_str());
-					DownloadFinished(m_category, info);
-					GlobalEventManager::Instance()->Send(GlobalEventManager::OnDownloadComplete);
-					finalizeProgress(true);
-				}
-				return;
+		auto fail = [&]() {
+			finalizeProgress(false);
+			// nobody saw the preempted prefetch, so nobody needs to hear it stopped
+			if (progress.IsTracked()) {
+				Notify(GlobalEventManager::OnDownloadFailed);
 			}
+		};
 
-			// For rapid categories, retry full search+download on each configured source.
-			// This covers failures during both metadata lookup and the actual download start.
-			std::vector<std::string> rapidUrls;
-			if (!m_filename.empty()) {
-				rapidUrls.push_back(m_filename);
+		if (token.IsCancelled()) {
+			wxLogInfo("Download cancelled: %s", m_name.c_str());
+			fail();
+			return;
+		}
+		EffectiveSourcesConfig sourceConfig;
+		{
+			std::lock_guard<std::mutex> session(prdMutex);
+			sourceConfig = LoadEffectiveSourcesConfig();
+		}
+		MaybeLogSourcesConfigWarning(sourceConfig);
+
+		if (m_category == DownloadEnum::CAT_SPRINGLOBBY ||
+		    m_category == DownloadEnum::CAT_HTTP) {
+			DownloadTransfer transfer;
+			ApplyEffectiveSourcesConfig(sourceConfig, transfer.GetRapid(), transfer.GetHttp());
+			transfer.AddUrl(m_category, m_filename, m_name);
+
+			Started();
+			if (!Transfer(transfer)) {
+				wxLogWarning("Download failed: %s", m_name.c_str());
+				fail();
 			} else {
-				rapidUrls = sourceConfig.rapidMasterUrls;
-				}
-				if (rapidUrls.empty()) {
-					rapidUrls.push_back(kDefaultRapidMasterPrimary);
-					rapidUrls.push_back(kDefaultRapidMasterSecondary);
-				}
-
-			for (size_t idx = 0; idx < rapidUrls.size(); ++idx) {
-				const std::string& rapidUrl = rapidUrls[idx];
-				const int results = SearchOnRapidSource(m_category, m_name, rapidUrl);
-				if (results <= 0) {
-					if (idx + 1 < rapidUrls.size()) {
-						wxLogInfo("No rapid matches on %s for '%s', retrying with %s",
-							  rapidUrl.c_str(), m_name.c_str(),
-							  rapidUrls[idx + 1].c_str());
-					}
-					continue;
-				}
-
-				DownloadAdd(0); // add first result only
-				downloadInfo info;
-				if (!DownloadGetInfo(0, info)) {
-					wxLogWarning("Download has no downloadinfo on %s: %s",
-						     rapidUrl.c_str(), m_name.c_str());
-					continue;
-				}
+				wxLogInfo("Download finished: %s", m_name.c_str());
+				DownloadFinished(m_category);
+				finalizeProgress(true);
+				Notify(GlobalEventManager::OnDownloadComplete);
+			}
+			return;
+		}
 
-				if (!downloadStartedEventSent) {
-					downloadStartedEventSent = true;
-					GlobalEventManager::Instance()->Send(GlobalEventManager::OnDownloadStarted);
-				}
+		// For rapid categories, retry full search+download on each configured source.
+		// This covers failures during both metadata lookup and the actual download start.
+		std::vector<std::string> rapidUrls;
+		if (!m_filename.empty()) {
+			rapidUrls.push_back(m_filename);
+		} else {
+			rapidUrls = MirrorHealth::Instance()->Order(sourceConfig.rapidMasterUrls);
+		}
+		if (rapidUrls.empty()) {
+			rapidUrls.push_back(kDefaultRapidMasterPrimary);
+			rapidUrls.push_back(kDefaultRapidMasterSecondary);
+		}
 
-				if (!DownloadStart()) {
-					wxLogInfo("Download finished: %s (source %s)", m_name.c_str(),
-						  rapidUrl.c_str());
-					DownloadFinished(m_category, info);
-					GlobalEventManager::Instance()->Send(GlobalEventManager::OnDownloadComplete);
-					finalizeProgress(true);
-					return;
+		for (size_t idx = 0; idx < rapidUrls.size(); ++idx) {
+			if (token.IsCancelled()) {
+				wxLogInfo("Download cancelled: %s", m_name.c_str());
+				break;
+			}
+			const std::string& rapidUrl = rapidUrls[idx];
+			DownloadTransfer transfer;
+			ApplyEffectiveSourcesConfig(sourceConfig, transfer.GetRapid(), transfer.GetHttp());
+			transfer.GetRapid().setOption("masterurl", rapidUrl);
+
+			// the search fetches the repo lists, its time stands in for the time to the first byte
+			MirrorHealth::Sample sample;
+			const std::chrono::steady_clock::time_point searchStart = std::chrono::steady_clock::now();
+			const int results = transfer.Search(m_category, m_name);
+			const std::chrono::steady_clock::time_point downloadStart = std::chrono::steady_clock::now();
+			sample.ttfb = std::chrono::duration_cast<std::chrono::milliseconds>(downloadStart - searchStart);
+			if (results <= 0) {
+				// a mirror which answered but doesn't have it isn't at fault
+				if (results < 0) {
+					MirrorHealth::Instance()->Record(rapidUrl, sample);
 				}
-
 				if (idx + 1 < rapidUrls.size()) {
-					wxLogWarning("Download failed on %s for '%s', retrying with %s",
-						     rapidUrl.c_str(), m_name.c_str(),
-						     rapidUrls[idx + 1].c_str());
-				} else {
-					wxLogWarning("Download failed on %s for '%s'",
-						     rapidUrl.c_str(), m_name.c_str());
+					wxLogInfo("No rapid matches on %s for '%s', retrying with %s",
+						  rapidUrl.c_str(), m_name.c_str(),
+						  rapidUrls[idx + 1].c_str());
 				}
+				continue;
+			}
+			if (token.IsCancelled()) {
+				wxLogInfo("Download cancelled: %s", m_name.c_str());
+				break;
 			}
 
-			GlobalEventManager::Instance()->Send(GlobalEventManager::OnDownloadFailed);
-			finalizeProgress(false);
-		} catch (...) {
-			finalizeProgress(false);
-			throw;
+			Started();
+
+			const bool failed = !Transfer(transfer);
+			sample.ok = !failed;
+			sample.bytes = progress.GetDownloaded();
+			sample.duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - downloadStart);
+			MirrorHealth::Instance()->Record(rapidUrl, sample);
+			if (!failed) {
+				wxLogInfo("Download finished: %s (source %s)", m_name.c_str(),
+					  rapidUrl.c_str());
+				DownloadFinished(m_category);
+				finalizeProgress(true);
+				Notify(GlobalEventManager::OnDownloadComplete);
+				return;
+			}
+
+			if (idx + 1 < rapidUrls.size()) {
+				wxLogWarning("Download failed on %s for '%s', retrying with %s",
+					     rapidUrl.c_str(), m_name.c_str(),
+					     rapidUrls[idx + 1].c_str());
+			} else {
+				wxLogWarning("Download failed on %s for '%s'",
+					     rapidUrl.c_str(), m_name.c_str());
+			}
 		}
+
+		fail();
 	}
 
 	DownloadEnum::Category getCategory() const
@@ -544,9 +672,52 @@ public:
 	{
 		return m_name;
 	}
+	//! somebody asked for it, a running prefetch shows up as a download now
+	void Promote()
+	{
+		m_background = false;
+		if (m_transferring && !m_started_sent.exchange(true)) {
+			GlobalEventManager::Instance()->Send(GlobalEventManager::OnDownloadStarted);
+		}
+	}
+	bool IsBackground() const
+	{
+		return m_background;
+	}
+	bool IsStarted() const
+	{
+		return m_started;
+	}
+	int64_t GetDownloaded() const
+	{
+		return m_downloaded;
+	}
 
 private:
-	void DownloadFinished(DownloadEnum::Category cat, const downloadInfo& info)
+	bool Transfer(DownloadTransfer& transfer)
+	{
+		std::shared_lock<std::shared_mutex> pool(poolMutex);
+		return transfer.Start(m_http_parallel);
+	}
+
+	//! sends OnDownloadStarted once, for a prefetch Promote() does
+	void Started()
+	{
+		m_transferring = true;
+		if (!m_background && !m_started_sent.exchange(true)) {
+			GlobalEventManager::Instance()->Send(GlobalEventManager::OnDownloadStarted);
+		}
+	}
+
+	//! prefetches don't bother the user
+	void Notify(wxEventType event)
+	{
+		if (!m_background) {
+			GlobalEventManager::Instance()->Send(event);
+		}
+	}
+
+	void DownloadFinished(DownloadEnum::Category cat)
 	{
 		slLogDebugFunc("");
 
@@ -565,6 +736,11 @@ private:
 				else
 					version = m_name;
 
+				ContentIndex::Instance()->AddEngine(version);
+				// a prefetched engine is selected once its battle is joined
+				if (m_background) {
+					break;
+				}
 				SlPaths::SetUsedSpringIndex(version);
 				// Reload unitsync on the GUI thread (some engine bundles crash when initialized from the downloader worker thread).
 				GlobalEventManager::Instance()->Send(GlobalEventManager::OnUnitsyncReloadRequest);
@@ -572,7 +748,7 @@ private:
 			}
 			case DownloadEnum::CAT_SPRINGLOBBY: {
 				const std::string& updatedir = SlPaths::GetUpdateDir();
-				const std::string& zipfile = info.filename;
+				const std::string& zipfile = m_filename;
 				if (!fileSystem->extract(zipfile, updatedir)) {
 					wxLogError("Couldn't extract %s to %s", zipfile.c_str(), updatedir.c_str());
 					break;
@@ -582,6 +758,12 @@ private:
 			}
 			case DownloadEnum::CAT_MAP:
 			case DownloadEnum::CAT_GAME:
+				// make the map show up as available right away, the reload
+				// below fills in the hash. Games are often downloaded by
+				// rapid tag (i.e. "ba:stable"), they show up after the reload.
+				if (cat == DownloadEnum::CAT_MAP) {
+					ContentIndex::Instance()->AddMap(m_name);
+				}
 				if (ui().IsMainWindowCreated()) {
 					// Reload unitsync on the GUI thread (worker-thread reload has caused crashes
 					// with some engine bundles).
@@ -599,7 +781,7 @@ private:
 				} else {
 					LSL::usync().PrefetchGame(m_name);
 				}
-				GlobalEventManager::Instance()->Send(GlobalEventManager::OnUnitsyncReloaded);
+				ContentIndex::Instance()->UnitsyncReloaded();
 				break;
 			default:
 				wxLogError("Unknown category: %d", cat);
@@ -611,86 +793,80 @@ private:
 
 void PrDownloader::GetProgress(DownloadProgress& progress)
 {
-	std::lock_guard<std::mutex> lock(dlProgressMutex);
-
-	if (m_progress == nullptr) {
-		assert(false);
+	const std::vector<DownloadProgressRegistry::Progress> all = DownloadProgressRegistry::Instance()->Snapshot();
+	if (all.empty()) {
 		return;
 	}
-
-	progress.name = m_progress->name;
-	progress.downloaded = m_progress->downloaded;
-	progress.filesize = m_progress->filesize;
-	progress.running = m_progress->running;
-	progress.failed = m_progress->failed;
-
-	wxLogDebug("%s %d %d", progress.name.c_str(), progress.downloaded, progress.filesize);
+	progress = ToDownloadProgress(all.back());
 }
 
-#ifdef _WIN32
-#define BILLION (1E9)
-
-static BOOL g_first_time = 1;
-static LARGE_INTEGER g_counts_per_sec;
-
-int clock_gettime(int dummy, struct timespec* ct)
+bool PrDownloader::GetProgress(const std::string& name, DownloadProgress& progress)
 {
-	LARGE_INTEGER count;
-	if (g_first_time) {
-		g_first_time = 0;
-		if (0 == QueryPerformanceFrequency(&g_counts_per_sec)) {
-			g_counts_per_sec.QuadPart = 0;
-		}
+	DownloadProgressRegistry::Progress found;
+	if (!DownloadProgressRegistry::Instance()->Find(name, found)) {
+		return false;
 	}
+	progress = ToDownloadProgress(found);
+	return true;
+}
 
-	if ((NULL == ct) || (g_counts_per_sec.QuadPart <= 0) || (0 == QueryPerformanceCounter(&count))) {
-		return -1;
+std::vector<PrDownloader::DownloadProgress> PrDownloader::GetAllProgress()
+{
+	std::vector<DownloadProgress> result;
+	for (const DownloadProgressRegistry::Progress& progress : DownloadProgressRegistry::Instance()->Snapshot()) {
+		result.push_back(ToDownloadProgress(progress));
 	}
-	ct->tv_sec = count.QuadPart / g_counts_per_sec.QuadPart;
-	ct->tv_nsec = ((count.QuadPart % g_counts_per_sec.QuadPart) * BILLION) / g_counts_per_sec.QuadPart;
-	return 0;
+	return result;
 }
-#endif
 
 void updatelistener(int downloaded, int filesize)
 {
-	std::lock_guard<std::mutex> lock(dlProgressMutex);
-
-	if (m_progress == nullptr)
-		m_progress = new PrDownloader::DownloadProgress();
-
-	static struct timespec lastupdate = {0, 0};
-	struct timespec now = {0, 0};
-	clock_gettime(CLOCK_MONOTONIC, &now);
-
-	// rate limit
-	if (((double)now.tv_sec + 1.0e-9 * now.tv_nsec) - ((double)lastupdate.tv_sec + 1.0e-9 * lastupdate.tv_nsec) < 0.2f) {
-		// always log 100%
-		if (downloaded != filesize) {
-			return;
-		}
+	ProgressTracker* progress = transferProgress;
+	if (progress == nullptr) {
+		return;
+	}
+	progress->Update(downloaded, filesize);
+	if (!progress->IsTracked()) {
+		return;
 	}
 
-	lastupdate.tv_nsec = now.tv_nsec;
-	lastupdate.tv_sec = now.tv_sec;
-
-	m_progress->filesize = filesize;
-	m_progress->downloaded = downloaded;
-	m_progress->running = true;
-	m_progress->failed = false;
-
-	GlobalEventManager::Instance()->Send(GlobalEventManager::OnDownloadProgress);
+	// the download view polls the registry, the taskbar just needs a nudge now and then
+	static std::atomic<int64_t> lastNotify(0);
+	const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	int64_t last = lastNotify;
+	if (downloaded != filesize && now - last < 200) {
+		return;
+	}
+	if (lastNotify.compare_exchange_strong(last, now)) {
+		GlobalEventManager::Instance()->Send(GlobalEventManager::OnDownloadProgress);
+	}
 }
 
 PrDownloader::PrDownloader()
     : wxEvtHandler()
-    , m_dl_thread(new LSL::WorkerThread())
+    , m_scheduler(new DownloadScheduler(std::max(cfg().ReadLong(_T("/Downloader/Workers")), 1l)))
+    , m_prefetch_budget(new PrefetchBudget(std::chrono::hours(24)))
+    , m_ingame(false)
 {
 	slLogDebugFunc("");
 
+	const size_t perCategory = std::max(cfg().ReadLong(_T("/Downloader/MaxPerCategory")), 1l);
+	m_scheduler->SetCategoryLimit(DownloadEnum::CAT_MAP, perCategory);
+	m_scheduler->SetCategoryLimit(DownloadEnum::CAT_GAME, perCategory);
+	m_scheduler->SetCategoryLimit(DownloadEnum::CAT_HTTP, perCategory);
+	// installing an engine selects it as the used one, so one at a time
+	m_scheduler->SetCategoryLimit(DownloadEnum::CAT_ENGINE, 1);
+	m_scheduler->SetCategoryLimit(DownloadEnum::CAT_ENGINE_LINUX, 1);
+	m_scheduler->SetCategoryLimit(DownloadEnum::CAT_ENGINE_LINUX64, 1);
+	m_scheduler->SetCategoryLimit(DownloadEnum::CAT_ENGINE_WINDOWS, 1);
+	m_scheduler->SetCategoryLimit(DownloadEnum::CAT_ENGINE_WINDOWS64, 1);
+	m_scheduler->SetCategoryLimit(DownloadEnum::CAT_ENGINE_MACOSX, 1);
+	m_scheduler->SetCategoryLimit(DownloadEnum::CAT_SPRINGLOBBY, 1);
+
 	UpdateSettings();
 	IDownloader::Initialize();
 	IDownloader::setProcessUpdateListener(updatelistener);
+	MirrorHealth::Instance()->StartProbing(ProbeMirrorCurl, std::chrono::seconds(cfg().ReadLong(_T("/Downloader/MirrorProbeInterval"))));
 	SUBSCRIBE_GLOBAL_EVENT(GlobalEventManager::OnSpringStarted, PrDownloader::OnSpringStarted);
 	SUBSCRIBE_GLOBAL_EVENT(GlobalEventManager::OnSpringTerminated, PrDownloader::OnSpringTerminated);
 }
@@ -701,22 +877,19 @@ PrDownloader::~PrDownloader()
 
 	GlobalEventManager::Instance()->UnSubscribeAll(this);
 
-	if (!!m_dl_thread) {
-		m_dl_thread->Wait();
-		delete m_dl_thread;
-		m_dl_thread = nullptr;
-	}
+	// aborts the queued downloads, waits for the running ones
+	delete m_scheduler;
+	m_scheduler = nullptr;
+	delete m_prefetch_budget;
+	m_prefetch_budget = nullptr;
+	MirrorHealth::Instance()->StopProbing();
 	IDownloader::Shutdown();
-
-	if (!!m_progress) {
-		delete m_progress;
-		m_progress = nullptr;
-	}
 }
 
 void PrDownloader::ClearFinished()
 {
 	slLogDebugFunc("");
+	DownloadProgressRegistry::Instance()->ClearFinished();
 }
 
 void PrDownloader::UpdateSettings()
@@ -724,12 +897,14 @@ void PrDownloader::UpdateSettings()
 	slLogDebugFunc("");
 
 	RemoveLegacyDownloaderConfigKeys();
-	DownloadSetConfig(CONFIG_FILESYSTEM_WRITEPATH, SlPaths::GetDownloadDir().c_str());
+	const std::string writePath = SlPaths::GetDownloadDir();
 	const int httpMaxParallel = sett().GetHTTPMaxParallelDownloads();
+	std::lock_guard<std::mutex> session(prdMutex);
+	DownloadSetConfig(CONFIG_FILESYSTEM_WRITEPATH, writePath.c_str());
 	DownloadSetConfig(CONFIG_HTTP_MAX_PARALLEL, &httpMaxParallel);
 	const EffectiveSourcesConfig sourceConfig = LoadEffectiveSourcesConfig();
 	MaybeLogSourcesConfigWarning(sourceConfig);
-	ApplyEffectiveSourcesConfig(sourceConfig);
+	ApplyEffectiveSourcesConfig(sourceConfig, *rapidDownload, *httpDownload);
 }
 
 void PrDownloader::RemoveTorrentByName(const std::string& /*name*/)
@@ -737,16 +912,107 @@ void PrDownloader::RemoveTorrentByName(const std::string& /*name*/)
 	slLogDebugFunc("");
 }
 
-void PrDownloader::Download(DownloadEnum::Category cat, const std::string& filename, const std::string& url)
+void PrDownloader::Download(DownloadEnum::Category cat, const std::string& filename, const std::string& url, DownloadScheduler::Priority priority)
 {
 	slLogDebugFunc("");
 
 	wxLogDebug("Starting download of %s, %s %d", filename.c_str(), url.c_str(), cat);
-	DownloadItem* dl_item = new DownloadItem(cat, filename, url);
-	m_dl_thread->DoWork(dl_item);
+	{
+		// the prefetch of it, if any, is the one which keeps running. A
+		// preempted one winds down unseen, this download waits for it.
+		std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+		const auto it = m_prefetches.find(Content(cat, filename));
+		if (it != m_prefetches.end()) {
+			if (m_scheduler->IsPending(cat, filename)) {
+				it->second->Promote();
+			}
+			m_prefetches.erase(it);
+		}
+	}
+	std::shared_ptr<DownloadItem> dl_item = std::make_shared<DownloadItem>(cat, filename, url);
+	m_scheduler->Schedule(cat, filename, priority, [dl_item](const DownloadScheduler::CancelToken& token) {
+		dl_item->Run(token);
+	});
 }
 
-class RapidValidateItem : public LSL::WorkItem
+//! free space where downloads go, -1 if unknown
+static int64_t GetFreeDiskSpace()
+{
+	wxDiskspaceSize_t space;
+	if (!wxGetDiskSpace(TowxString(SlPaths::GetDownloadDir()), nullptr, &space)) {
+		return -1;
+	}
+	return space.GetValue();
+}
+
+bool PrDownloader::IsPrefetchEnabled()
+{
+	return cfg().ReadBool(_T("/Downloader/Prefetch"));
+}
+
+void PrDownloader::Prefetch(const std::vector<Content>& content)
+{
+	slLogDebugFunc("");
+
+	if (!IsPrefetchEnabled() || m_ingame) {
+		return;
+	}
+	DropPrefetches(content);
+
+	const int64_t megabyte = 1024 * 1024;
+	m_prefetch_budget->SetLimits(cfg().ReadLong(_T("/Downloader/PrefetchBudget")) * megabyte,
+				     cfg().ReadLong(_T("/Downloader/PrefetchMinFreeDisk")) * megabyte);
+	std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+	for (const Content& item : content) {
+		if (m_prefetches.find(item) != m_prefetches.end() || m_scheduler->IsPending(item.first, item.second)) {
+			continue;
+		}
+		if (!m_prefetch_budget->Allows(GetFreeDiskSpace())) {
+			wxLogInfo("Prefetch budget used up, not prefetching %s", item.second.c_str());
+			return;
+		}
+		wxLogDebug("Prefetching %s %d", item.second.c_str(), item.first);
+		std::shared_ptr<DownloadItem> dl_item = std::make_shared<DownloadItem>(item.first, item.second, "", true);
+		m_prefetches[item] = dl_item;
+		m_scheduler->Schedule(item.first, item.second, DownloadScheduler::PRIORITY_BACKGROUND, [this, item, dl_item](const DownloadScheduler::CancelToken& token) {
+			// the budget may have been used up while it was queued
+			if (!dl_item->IsBackground() || m_prefetch_budget->Allows(GetFreeDiskSpace())) {
+				dl_item->Run(token);
+			}
+			if (dl_item->IsBackground()) {
+				m_prefetch_budget->Record(dl_item->GetDownloaded());
+			}
+			std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+			const auto it = m_prefetches.find(item);
+			if (it != m_prefetches.end() && it->second == dl_item) {
+				m_prefetches.erase(it);
+			}
+		});
+	}
+}
+
+// cancels the prefetches which didn't start yet, except the ones for keep
+void PrDownloader::DropPrefetches(const std::vector<Content>& keep)
+{
+	std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+	for (auto it = m_prefetches.begin(); it != m_prefetches.end();) {
+		if (!it->second->IsStarted() && std::find(keep.begin(), keep.end(), it->first) == keep.end()) {
+			m_scheduler->Cancel(it->first.first, it->first.second);
+			it = m_prefetches.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+bool PrDownloader::CancelDownload(DownloadEnum::Category cat, const std::string& filename)
+{
+	slLogDebugFunc("");
+
+	return m_scheduler->Cancel(cat, filename);
+}
+
+class RapidValidateItem
 {
 private:
 	bool m_deleteBroken;
@@ -760,6 +1026,8 @@ public:
 	void Run()
 	{
 		slLogDebugFunc("");
+		std::unique_lock<std::shared_mutex> pool(poolMutex);
+		std::lock_guard<std::mutex> session(prdMutex);
 		const bool ok = DownloadRapidValidate(m_deleteBroken);
 		if (ok) {
 			GlobalEventManager::Instance()->Send(GlobalEventManager::OnRapidValidateComplete);
@@ -773,14 +1041,16 @@ void PrDownloader::ValidateRapidPoolAsync(bool deleteBroken)
 {
 	slLogDebugFunc("");
 
-	RapidValidateItem* item = new RapidValidateItem(deleteBroken);
-	m_dl_thread->DoWork(item);
+	std::shared_ptr<RapidValidateItem> item = std::make_shared<RapidValidateItem>(deleteBroken);
+	m_scheduler->Schedule(DownloadEnum::CAT_NONE, "rapid pool validation", DownloadScheduler::PRIORITY_NORMAL, [item](const DownloadScheduler::CancelToken& /*token*/) {
+		item->Run();
+	});
 }
 
 std::vector<std::string> PrDownloader::GetEffectiveRapidMasterUrls()
 {
 	const EffectiveSourcesConfig sourceConfig = LoadEffectiveSourcesConfig();
-	std::vector<std::string> urls = sourceConfig.rapidMasterUrls;
+	std::vector<std::string> urls = MirrorHealth::Instance()->Order(sourceConfig.rapidMasterUrls);
 	if (urls.empty()) {
 		urls.push_back(kDefaultRapidMasterPrimary);
 		urls.push_back(kDefaultRapidMasterSecondary);
@@ -805,12 +1075,16 @@ void PrDownloader::OnSpringStarted(wxCommandEvent& /*data*/)
 {
 	slLogDebugFunc("");
 	//FIXME: pause downloads
+	// leave the bandwidth to the game
+	m_ingame = true;
+	DropPrefetches(std::vector<Content>());
 }
 
 void PrDownloader::OnSpringTerminated(wxCommandEvent& /*data*/)
 {
 	slLogDebugFunc("");
 	//FIXME: resume downloads
+	m_ingame = false;
 }
 
 PrDownloader& prDownloader()
@@ -823,8 +1097,7 @@ PrDownloader& prDownloader()
 bool PrDownloader::IsRunning()
 {
 	slLogDebugFunc("");
-	std::lock_guard<std::mutex> lock(dlProgressMutex);
-	return m_progress != nullptr && m_progress->running;
+	return DownloadProgressRegistry::Instance()->IsRunning();
 }
 
 void PrDownloader::UpdateApplication(const std::string& updateurl)
@@ -861,12 +1134,31 @@ void PrDownloader::UpdateApplication(const std::string& updateurl)
 	Download(DownloadEnum::CAT_SPRINGLOBBY, updateurl, dlfilepath);
 }
 
+bool PrDownloader::FetchUrl(const std::string& httpurl, std::string& res, const std::function<bool()>& cancelled)
+{
+	CurlWrapper cw;
+	CURL* curl = cw.GetHandle();
+	curl_easy_setopt(curl, CURLOPT_URL, httpurl.c_str());
+	curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(curl, CURLOPT_TIMEOUT, kDefaultTimeoutSeconds);
+	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, FetchWrite);
+	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &res);
+	curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+	curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, FetchProgress);
+	curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &cancelled);
+	const CURLcode ret = curl_easy_perform(curl);
+	long code = 0;
+	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
+	return ret == CURLE_OK && code < 400;
+}
+
 bool PrDownloader::DownloadUrl(const std::string& httpurl, std::string& res)
 {
 	UpdateSettings();
-	StartDownloadProgressTracking(httpurl);
+	ProgressTracker progress(httpurl);
 	const bool ok = CHttpDownloader::DownloadUrl(httpurl, res);
-	FinishDownloadProgressTracking(httpurl, ok);
+	progress.Finish(ok);
 	GlobalEventManager::Instance()->Send(GlobalEventManager::OnDownloadProgress);
 	return ok;
 }
@@ -4,25 +4,32 @@
 #define SPRINGLOBBY_HEADERGUARD_PRDOWNLOADER_H
 
 #include <wx/event.h>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
+#include "downloadscheduler.h"
 #include "lib/src/Downloader/DownloadEnum.h"
 class IDownloader;
 
-namespace LSL
-{
-class WorkerThread;
-}
-
 class DownloadItem;
+class PrefetchBudget;
 
 class PrDownloader : public wxEvtHandler
 {
 public:
+	typedef std::pair<DownloadEnum::Category, std::string> Content;
+
 	struct DownloadProgress {
 		DownloadProgress()
 		    : filesize(0)
 		    , downloaded(0)
+		    , bytesPerSecond(0)
+		    , eta(-1)
 		    , running(false)
 		    , failed(false)
 		{
@@ -30,6 +37,8 @@ public:
 		std::string name;
 		int filesize;
 		int downloaded;
+		int bytesPerSecond;
+		int eta; //!< seconds, -1 if unknown
 		bool running;
 		bool failed;
 		bool IsFinished() const
@@ -42,15 +51,19 @@ public:
 		}
 		float GetProgressPercent()
 		{
-			if (filesize == 0 || downloaded == 0)
+			if (filesize <= 0 || downloaded <= 0)
 				return 0;
+			if (downloaded >= filesize)
+				return 100;
 			return ((float)(downloaded) / (float)filesize) * 100.0;
 		}
-		void CopyTo(DownloadProgress& prg)
+		void CopyTo(DownloadProgress& prg) const
 		{
 			prg.downloaded = downloaded;
 			prg.filesize = filesize;
 			prg.name = name;
+			prg.bytesPerSecond = bytesPerSecond;
+			prg.eta = eta;
 			prg.running = running;
 			prg.failed = failed;
 		}
@@ -70,8 +83,22 @@ public:
 		CAT_GAME  ba:stable      ""
 		CAT_LOBBY ""             /tmp/lobby.zip
 		CAT_HTTP  http://.../f.  /tmp/f.zip
+		downloads with a higher priority start first, a download which
+		is queued or running already isn't started again
 	*/
-	void Download(DownloadEnum::Category cat, const std::string& filename, const std::string& url = "");
+	void Download(DownloadEnum::Category cat, const std::string& filename, const std::string& url = "",
+		      DownloadScheduler::Priority priority = DownloadScheduler::PRIORITY_NORMAL);
+	//! aborts the download of filename, returns false if there is none
+	bool CancelDownload(DownloadEnum::Category cat, const std::string& filename);
+	/**
+		downloads content in the background if prefetching is enabled,
+		as long as the bandwidth and disk budgets allow. Prefetches run
+		quietly and give way to all other downloads, downloading the same
+		content with Download turns one into a normal download. Content
+		of an earlier call which didn't start yet is dropped.
+	*/
+	void Prefetch(const std::vector<Content>& content);
+	static bool IsPrefetchEnabled();
 	void ValidateRapidPoolAsync(bool deleteBroken);
 	std::vector<std::string> GetEffectiveRapidMasterUrls();
 
@@ -79,12 +106,27 @@ public:
 	void OnSpringStarted(wxCommandEvent& data);
 	void OnSpringTerminated(wxCommandEvent& data);
 	bool IsRunning();
+	//! progress of the download started last
 	static void GetProgress(DownloadProgress& progress);
+	//! progress of the download of name, false if there is none
+	static bool GetProgress(const std::string& name, DownloadProgress& progress);
+	//! progress of all downloads of the session
+	static std::vector<DownloadProgress> GetAllProgress();
 	void UpdateApplication(const std::string& updateurl);
 	bool DownloadUrl(const std::string& httpurl, std::string& res);
+	//! downloads httpurl into res on the calling thread. It neither uses
+	//! pr-downloader's globals nor the settings, so any thread may call it.
+	//! Gives up after a timeout or once cancelled returns true.
+	static bool FetchUrl(const std::string& httpurl, std::string& res, const std::function<bool()>& cancelled);
 
 private:
-	LSL::WorkerThread* m_dl_thread;
+	void DropPrefetches(const std::vector<Content>& keep);
+
+	DownloadScheduler* m_scheduler;
+	PrefetchBudget* m_prefetch_budget;
+	std::map<Content, std::shared_ptr<DownloadItem> > m_prefetches;
+	std::mutex m_prefetch_mutex;
+	std::atomic<bool> m_ingame;
 
 	friend class SearchItem;
 };
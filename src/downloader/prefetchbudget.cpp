@@ -0,0 +1,53 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "prefetchbudget.h"
+
+PrefetchBudget::PrefetchBudget(std::chrono::seconds window)
+    : m_window(window)
+    , m_bytes_per_window(0)
+    , m_min_free_disk(0)
+    , m_used(0)
+{
+}
+
+void PrefetchBudget::SetLimits(int64_t bytesPerWindow, int64_t minFreeDisk)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_bytes_per_window = bytesPerWindow;
+	m_min_free_disk = minFreeDisk;
+}
+
+bool PrefetchBudget::Allows(int64_t freeDisk, Clock::time_point now)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Expire(now);
+	if (m_used >= m_bytes_per_window) {
+		return false;
+	}
+	return freeDisk < 0 || freeDisk > m_min_free_disk;
+}
+
+void PrefetchBudget::Record(int64_t bytes, Clock::time_point now)
+{
+	if (bytes <= 0) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_transfers.push_back(std::make_pair(now, bytes));
+	m_used += bytes;
+}
+
+int64_t PrefetchBudget::GetUsed(Clock::time_point now)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Expire(now);
+	return m_used;
+}
+
+void PrefetchBudget::Expire(Clock::time_point now)
+{
+	while (!m_transfers.empty() && now - m_transfers.front().first >= m_window) {
+		m_used -= m_transfers.front().second;
+		m_transfers.pop_front();
+	}
+}
@@ -0,0 +1,43 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_PREFETCHBUDGET_H
+#define SPRINGLOBBY_HEADERGUARD_PREFETCHBUDGET_H
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+#include "utils/mixins.h"
+
+//! @brief Limits what downloads started in the background may use.
+//! They may transfer at most a number of bytes within a sliding window and
+//! only start while more than a reserve of disk space is free.
+class PrefetchBudget : public SL::NonCopyable
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	explicit PrefetchBudget(std::chrono::seconds window);
+
+	void SetLimits(int64_t bytesPerWindow, int64_t minFreeDisk);
+	//! whether another download may start, freeDisk is negative if unknown
+	bool Allows(int64_t freeDisk, Clock::time_point now = Clock::now());
+	//! counts bytes against the budget
+	void Record(int64_t bytes, Clock::time_point now = Clock::now());
+	//! bytes transferred within the window up to now
+	int64_t GetUsed(Clock::time_point now = Clock::now());
+
+private:
+	void Expire(Clock::time_point now);
+
+	const std::chrono::seconds m_window;
+	int64_t m_bytes_per_window;
+	int64_t m_min_free_disk;
+	std::deque<std::pair<Clock::time_point, int64_t> > m_transfers;
+	int64_t m_used;
+	std::mutex m_mutex;
+};
+
+#endif // SPRINGLOBBY_HEADERGUARD_PREFETCHBUDGET_H
@@ -12,6 +12,7 @@
 #include <string>
 #include <vector>
 
+#include <sys/stat.h>
 #include <json/reader.h>
 
 namespace {
@@ -292,3 +293,34 @@ DownloaderSourcesConfig LoadDownloaderSourcesConfig(const std::string& lobbyWrit
 	config.loadState = DownloaderSourcesLoadState::LoadedFromFile;
 	return config;
 }
+
+DownloaderSourcesConfigCache::FileStamp DownloaderSourcesConfigCache::GetFileStamp(const std::string& path)
+{
+	FileStamp stamp;
+	struct stat info;
+	if (stat(path.c_str(), &info) == 0) {
+		stamp.exists = true;
+		stamp.mtime = info.st_mtime;
+		stamp.size = info.st_size;
+	}
+	return stamp;
+}
+
+DownloaderSourcesConfig DownloaderSourcesConfigCache::Load(const std::string& lobbyWriteDir)
+{
+	const FileStamp stamp = GetFileStamp(BuildSourcesConfigPath(lobbyWriteDir));
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_valid || m_dir != lobbyWriteDir || !(m_stamp == stamp)) {
+		m_config = LoadDownloaderSourcesConfig(lobbyWriteDir);
+		m_dir = lobbyWriteDir;
+		m_stamp = stamp;
+		m_valid = true;
+	}
+	return m_config;
+}
+
+void DownloaderSourcesConfigCache::Invalidate()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_valid = false;
+}
@@ -3,6 +3,8 @@
 #ifndef SPRINGLOBBY_SOURCESCONFIG_H
 #define SPRINGLOBBY_SOURCESCONFIG_H
 
+#include <ctime>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -34,4 +36,33 @@ struct DownloaderSourcesConfig
 
 DownloaderSourcesConfig LoadDownloaderSourcesConfig(const std::string& lobbyWriteDir);
 
+// Keeps the last parsed sources file, it is only read and parsed again
+// once its modification time or size changed.
+class DownloaderSourcesConfigCache
+{
+public:
+	DownloaderSourcesConfig Load(const std::string& lobbyWriteDir);
+	// forces the next Load() to read the file, for callers which just wrote it
+	void Invalidate();
+
+private:
+	struct FileStamp
+	{
+		bool exists = false;
+		time_t mtime = 0;
+		long long size = 0;
+		bool operator==(const FileStamp& other) const
+		{
+			return exists == other.exists && mtime == other.mtime && size == other.size;
+		}
+	};
+	static FileStamp GetFileStamp(const std::string& path);
+
+	std::mutex m_mutex;
+	bool m_valid = false;
+	std::string m_dir;
+	FileStamp m_stamp;
+	DownloaderSourcesConfig m_config;
+};
+
 #endif
@@ -22,8 +22,9 @@ public:
 	virtual void Resort();
 
 	virtual bool AddItem(const DataType&, bool resortIsNeeded = true);
-	virtual bool RemoveItem(const DataType&);
-	virtual bool RefreshItem(const DataType&);
+	virtual size_t AddItems(const std::vector<const DataType*>&);
+	virtual bool RemoveItem(const DataType&, bool resortIsNeeded = true);
+	virtual bool RefreshItem(const DataType&, bool resortIsNeeded = true);
 	virtual bool ContainsItem(const DataType&);
 	virtual int GetItemsCount() const;
 	virtual void Clear();
@@ -82,7 +83,7 @@ inline void BaseDataViewCtrl<DataType>::Resort()
 }
 
 template <class DataType>
-inline bool BaseDataViewCtrl<DataType>::RefreshItem(const DataType& item)
+inline bool BaseDataViewCtrl<DataType>::RefreshItem(const DataType& item, bool resortIsNeeded)
 {
 	wxASSERT(m_DataModel != nullptr);
 
@@ -90,7 +91,7 @@ inline bool BaseDataViewCtrl<DataType>::RefreshItem(const DataType& item)
 
 	bool result = m_DataModel->UpdateItem(item);
 
-	if (result) {
+	if (result && resortIsNeeded) {
 		Resort();
 	}
 
@@ -310,6 +311,23 @@ inline void BaseDataViewCtrl<DataType>::OnShowColumns(wxCommandEvent&)
 	}
 }
 
+template <class DataType>
+inline size_t BaseDataViewCtrl<DataType>::AddItems(const std::vector<const DataType*>& items)
+{
+	wxDataViewItem selectedItem = GetSelection();
+
+	const size_t added = m_DataModel->AddItems(items);
+
+	if (added > 0) {
+		Resort();
+	}
+
+	/*Preserve selection*/
+	Select(selectedItem);
+
+	return added;
+}
+
 template <class DataType>
 inline bool BaseDataViewCtrl<DataType>::AddItem(const DataType& item, bool resortIsNeeded)
 {
@@ -328,13 +346,13 @@ inline bool BaseDataViewCtrl<DataType>::AddItem(const DataType& item, bool resor
 }
 
 template <class DataType>
-inline bool BaseDataViewCtrl<DataType>::RemoveItem(const DataType& item)
+inline bool BaseDataViewCtrl<DataType>::RemoveItem(const DataType& item, bool resortIsNeeded)
 {
 	wxDataViewItem selectedItem = GetSelection();
 
 	bool result = m_DataModel->RemoveItem(item);
 
-	if (result) {
+	if (result && resortIsNeeded) {
 		Resort();
 	}
 
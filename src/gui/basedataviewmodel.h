@@ -6,6 +6,7 @@
 #include <wx/dataview.h>
 #include <climits>
 #include <set>
+#include <vector>
 #include "log.h"
 
 #define DEFAULT_COLUMN UINT_MAX
@@ -37,6 +38,8 @@ public:
 public:
 	//Custom methods
 	bool AddItem(const DataType&);
+	//! adds all items not yet in the model, informs the view once
+	size_t AddItems(const std::vector<const DataType*>&);
 	bool RemoveItem(const DataType&);
 	bool ContainsItem(const DataType&) const;
 	void Clear();
@@ -119,6 +122,21 @@ bool BaseDataViewModel<DataType>::AddItem(const DataType& data)
 	return true;
 }
 
+template <class DataType>
+size_t BaseDataViewModel<DataType>::AddItems(const std::vector<const DataType*>& data)
+{
+	wxDataViewItemArray items;
+	for (const DataType* dataItem : data) {
+		if (m_ModelData.insert(dataItem).second) {
+			items.Add(wxDataViewItem(const_cast<DataType*>(dataItem)));
+		}
+	}
+	if (!items.IsEmpty()) {
+		ItemsAdded(wxDataViewItem(), items);
+	}
+	return items.GetCount();
+}
+
 template <class DataType>
 bool BaseDataViewModel<DataType>::RemoveItem(const DataType& data)
 {
@@ -11,7 +11,6 @@
 #include "ibattle.h"
 #include "log.h"
 #include "servermanager.h"
-#include "utils/slpaths.h"
 
 BEGIN_EVENT_TABLE(BattleDataViewCtrl, BaseDataViewCtrl)
 EVT_DATAVIEW_ITEM_CONTEXT_MENU(BATTLELIST_DATAVIEW_ID, BattleDataViewCtrl::OnContextMenu)
@@ -59,20 +58,47 @@ BattleDataViewCtrl::~BattleDataViewCtrl()
 
 void BattleDataViewCtrl::AddBattle(IBattle& battle)
 {
-	if (!ContainsItem(battle))
+	if (!ContainsItem(battle)) {
+		GetBattleModel()->InvalidateRow(battle);
 		AddItem(battle);
+	}
 }
 
 void BattleDataViewCtrl::RemoveBattle(IBattle& battle)
 {
-	if (ContainsItem(battle))
+	if (ContainsItem(battle)) {
 		RemoveItem(battle);
+		GetBattleModel()->InvalidateRow(battle);
+	}
 }
 
 void BattleDataViewCtrl::UpdateBattle(IBattle& battle)
 {
-	if (ContainsItem(battle))
+	if (ContainsItem(battle)) {
+		GetBattleModel()->InvalidateRow(battle);
 		RefreshItem(battle);
+	}
+}
+
+size_t BattleDataViewCtrl::AddItems(const std::vector<const IBattle*>& battles)
+{
+	for (const IBattle* battle : battles) {
+		if (!ContainsItem(*battle)) {
+			GetBattleModel()->InvalidateRow(*battle);
+		}
+	}
+	return BaseDataViewCtrl::AddItems(battles);
+}
+
+void BattleDataViewCtrl::Clear()
+{
+	BaseDataViewCtrl::Clear();
+	GetBattleModel()->InvalidateRows();
+}
+
+BattleDataViewModel* BattleDataViewCtrl::GetBattleModel()
+{
+	return static_cast<BattleDataViewModel*>(m_DataModel);
 }
 
 void BattleDataViewCtrl::SetTipWindowText(const long /*item_hit*/,
@@ -119,7 +145,7 @@ void BattleDataViewCtrl::OnContextMenu(wxDataViewEvent& /*event*/)
 
 	const bool game_missing = !battle->GameExists(false);
 	const bool map_missing = !battle->MapExists(false);
-	const bool engine_missing = SlPaths::GetCompatibleVersion(battle->GetEngineVersion()).empty();
+	const bool engine_missing = !battle->EngineExists();
 
 	m_popup = new wxMenu(wxEmptyString);
 
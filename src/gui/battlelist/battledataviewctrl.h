@@ -5,6 +5,7 @@
 
 #include "gui/basedataviewctrl.h"
 class IBattle;
+class BattleDataViewModel;
 class wxWindow;
 class wxString;
 class wxMenu;
@@ -22,6 +23,9 @@ public:
 	void RemoveBattle(IBattle& battle);
 	void UpdateBattle(IBattle& battle);
 
+	virtual size_t AddItems(const std::vector<const IBattle*>& battles) override;
+	virtual void Clear() override;
+
 	void SetTipWindowText(const long item_hit, const wxPoint& position);
 
 	enum {
@@ -35,6 +39,8 @@ public:
 	void OnNotifyWhenBattleEnds(wxCommandEvent& event);
 
 private:
+	BattleDataViewModel* GetBattleModel();
+
 	void OnContextMenu(wxDataViewEvent& event);
 	void OnDLMap(wxCommandEvent& event);
 	void OnDLGame(wxCommandEvent& event);
@@ -9,7 +9,6 @@
 #include "ibattle.h"
 #include "useractions.h"
 #include "utils/slconfig.h"
-#include "utils/slpaths.h"
 #include "utils/sortutil.h"
 #include "utils/conversion.h"
 
@@ -67,47 +66,47 @@ void BattleDataViewModel::GetValue(wxVariant& variant,
 		return;
 	}
 
-	const BattleOptions& opts = battle->GetBattleOptions();
+	const RowCache& row = GetRow(*battle);
 
 	switch (col) {
 		case STATUS:
-			variant = wxVariant(iconsCollection->GetBattleStatusBmp(*battle));
+			variant = wxVariant(row.status);
 			break;
 
 		case COUNTRY:
-			variant = wxVariant(iconsCollection->GetFlagBmp(battle->GetFounder().GetCountry()));
+			variant = wxVariant(row.country);
 			break;
 
 		case RANK:
-			variant = wxVariant(iconsCollection->GetRankBmp(battle->GetRankNeeded(), false));
+			variant = wxVariant(row.rank);
 			break;
 
 		case DESCRIPTION:
-			variant = wxVariant(TowxString(opts.description));
+			variant = wxVariant(row.description);
 			break;
 
 		case MAP:
-			variant = wxVariant(wxDataViewIconText(wxString(battle->GetHostMapName()), battle->MapExists(false) ? iconsCollection->ICON_EXISTS : iconsCollection->ICON_NEXISTS));
+			variant = wxVariant(wxDataViewIconText(row.map, row.map_exists ? iconsCollection->ICON_EXISTS : iconsCollection->ICON_NEXISTS));
 			break;
 
 		case GAME:
-			variant = wxVariant(wxDataViewIconText(wxString(battle->GetHostGameNameAndVersion()), battle->GameExists(false) ? iconsCollection->ICON_EXISTS : iconsCollection->ICON_NEXISTS));
+			variant = wxVariant(wxDataViewIconText(row.game, row.game_exists ? iconsCollection->ICON_EXISTS : iconsCollection->ICON_NEXISTS));
 			break;
 
 		case HOST:
-			variant = wxVariant(wxString(opts.founder));
+			variant = wxVariant(row.host);
 			break;
 
 		case SPECTATORS:
-			variant = wxVariant(wxString::Format(_T("%d"), battle->GetSpectators()));
+			variant = wxVariant(row.spectators);
 			break;
 
 		case PLAYERS:
-			variant = wxVariant(wxString::Format(_T("%d"), (static_cast<int>(battle->GetNumUsers()) - battle->GetSpectators())));
+			variant = wxVariant(row.players);
 			break;
 
 		case MAXIMUM:
-			variant = wxVariant(wxString::Format(_T("%d"), static_cast<int>(battle->GetMaxPlayers())));
+			variant = wxVariant(row.maximum);
 			break;
 
 		case RUNNING:
@@ -115,15 +114,9 @@ void BattleDataViewModel::GetValue(wxVariant& variant,
 							battle->GetBattleRunningTime()).Format(_T("%H:%M"))));
 			break;
 
-		case ENGINE: {
-			wxString engine(battle->GetEngineName());
-			engine += ' ';
-			engine += battle->GetEngineVersion();
-			if (SlPaths::GetCompatibleVersion(battle->GetEngineVersion()).empty())
-				variant = wxVariant(wxDataViewIconText(engine, iconsCollection->ICON_NEXISTS));
-			else
-				variant = wxVariant(wxDataViewIconText(engine, iconsCollection->ICON_EXISTS));
-		} break;
+		case ENGINE:
+			variant = wxVariant(wxDataViewIconText(row.engine, row.engine_exists ? iconsCollection->ICON_EXISTS : iconsCollection->ICON_NEXISTS));
+			break;
 
 		case DEFAULT_COLUMN:
 			//Do nothing
@@ -134,6 +127,45 @@ void BattleDataViewModel::GetValue(wxVariant& variant,
 	}
 }
 
+const BattleDataViewModel::RowCache& BattleDataViewModel::GetRow(const IBattle& battle) const
+{
+	auto it = m_rows.find(&battle);
+	if (it != m_rows.end()) {
+		return it->second;
+	}
+
+	IconsCollection* iconsCollection = IconsCollection::Instance();
+	const BattleOptions& opts = battle.GetBattleOptions();
+	RowCache& row = m_rows[&battle];
+	row.status = iconsCollection->GetBattleStatusBmp(battle);
+	row.country = iconsCollection->GetFlagBmp(battle.GetFounder().GetCountry());
+	row.rank = iconsCollection->GetRankBmp(battle.GetRankNeeded(), false);
+	row.description = TowxString(opts.description);
+	row.map = wxString(battle.GetHostMapName());
+	row.game = wxString(battle.GetHostGameNameAndVersion());
+	row.host = wxString(opts.founder);
+	row.spectators = wxString::Format(_T("%d"), battle.GetSpectators());
+	row.players = wxString::Format(_T("%d"), (static_cast<int>(battle.GetNumUsers()) - battle.GetSpectators()));
+	row.maximum = wxString::Format(_T("%d"), static_cast<int>(battle.GetMaxPlayers()));
+	row.engine = wxString(battle.GetEngineName());
+	row.engine += ' ';
+	row.engine += battle.GetEngineVersion();
+	row.map_exists = battle.MapExists(false);
+	row.game_exists = battle.GameExists(false);
+	row.engine_exists = battle.EngineExists();
+	return row;
+}
+
+void BattleDataViewModel::InvalidateRow(const IBattle& battle)
+{
+	m_rows.erase(&battle);
+}
+
+void BattleDataViewModel::InvalidateRows()
+{
+	m_rows.clear();
+}
+
 int BattleDataViewModel::Compare(const wxDataViewItem& itemA,
 				 const wxDataViewItem& itemB, unsigned int column,
 				 bool ascending) const
@@ -3,6 +3,9 @@
 #ifndef SRC_GUI_BATTLELIST_BATTLEDATAVIEWMODEL_H_
 #define SRC_GUI_BATTLELIST_BATTLEDATAVIEWMODEL_H_
 
+#include <unordered_map>
+#include <wx/bitmap.h>
+
 #include "gui/basedataviewmodel.h"
 class IBattle;
 
@@ -17,7 +20,30 @@ public:
 	virtual bool GetAttr(const wxDataViewItem&, unsigned int, wxDataViewItemAttr&) const override;
 	virtual wxString GetColumnType(unsigned int column) const override;
 
+	//! drop the cached cells of battle, has to be called when it changed or is removed
+	void InvalidateRow(const IBattle& battle);
+	void InvalidateRows();
+
 private:
+	//! everything GetValue() needs for a battle except the running time
+	struct RowCache {
+		wxBitmap status;
+		wxBitmap country;
+		wxBitmap rank;
+		wxString description;
+		wxString map;
+		wxString game;
+		wxString host;
+		wxString spectators;
+		wxString players;
+		wxString maximum;
+		wxString engine;
+		bool map_exists;
+		bool game_exists;
+		bool engine_exists;
+	};
+	const RowCache& GetRow(const IBattle& battle) const;
+
 	enum ColumnIndexes {
 		STATUS = 0,
 		COUNTRY,
@@ -37,6 +63,7 @@ private:
 	wxColour inactive_room_colour;
 	bool use_smart_sorting;
 	bool show_game_colours;
+	mutable std::unordered_map<const IBattle*, RowCache> m_rows;
 };
 
 #endif /* SRC_GUI_BATTLELIST_BATTLEDATAVIEWMODEL_H_ */
@@ -441,13 +441,11 @@ bool BattleListFilter::FilterBattle(IBattle& battle)
 
 		if (m_filter_highlighted->IsChecked()) {
 			try {
-				wxString host = TowxString(battle.GetFounder().GetNick());
-				bResult = useractions().DoActionOnUser(UserActions::ActHighlight, host);
+				bResult = useractions().DoActionOnUser(UserActions::ActHighlight, battle.GetFounder().GetNickId());
 
 				if (!bResult)
 					for (unsigned int i = 0; i < battle.GetNumUsers(); ++i) {
-						wxString name = TowxString(battle.GetUser(i).GetNick());
-						if (useractions().DoActionOnUser(UserActions::ActHighlight, name)) {
+						if (useractions().DoActionOnUser(UserActions::ActHighlight, battle.GetUser(i).GetNickId())) {
 							bResult = true;
 							break;
 						}
@@ -524,7 +522,7 @@ bool BattleListFilter::FilterBattle(IBattle& battle)
 
 	//Host:
 	try { //!TODO
-		if (!StringMatches(TowxString(battle.GetFounder().GetNick()),
+		if (!StringMatches(battle.GetFounder().GetNickWx(),
 				   m_filter_host_edit->GetValue(),
 				   m_filter_host_expression))
 			return false;
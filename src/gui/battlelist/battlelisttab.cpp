@@ -14,6 +14,7 @@
 #include <wx/tglbtn.h>
 #include <set>
 #include <stdexcept>
+#include <vector>
 
 #include "aui/auimanager.h"
 #include "battledataviewctrl.h"
@@ -309,6 +310,31 @@ void BattleListTab::UpdateList()
 }
 
 
+void BattleListTab::AddAllBattles()
+{
+	IServer& serv = serverSelector().GetServer();
+	std::vector<const IBattle*> battles;
+	serv.battles_iter->IteratorBegin();
+	while (!serv.battles_iter->EOL()) {
+		IBattle* b = serv.battles_iter->GetBattle();
+		if (b == nullptr || b->GetGUIListActiv()) {
+			continue;
+		}
+		if (b->GetFounder().GetNick() == cfg().ReadString("/LastJoinedBattle/HostNick")) {
+			wxLogMessage("Found last joined battle, attempting to rejoin");
+			DoJoin(*b);
+		}
+		if (m_filter->GetActiv() && !m_filter->FilterBattle(*b)) {
+			continue;
+		}
+		b->SetGUIListActiv(true);
+		battles.push_back(b);
+	}
+	m_battle_list->AddItems(battles);
+	SetNumDisplayed();
+}
+
+
 void BattleListTab::SetFilterActiv(bool activ)
 {
 	m_filter->SetActiv(activ);
@@ -470,6 +496,7 @@ void BattleListTab::OnSelect(wxDataViewEvent& /*event*/)
 		return;
 	} else {
 		SelectBattle(battle);
+		ui().PrefetchContent(battle);
 	}
 }
 
@@ -47,6 +47,8 @@ public:
 	void UserUpdate(User& user);
 
 	void UpdateList();
+	//! adds all battles of the server in one pass, used after login
+	void AddAllBattles();
 
 	void SelectBattle(IBattle* battle);
 
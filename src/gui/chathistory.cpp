@@ -0,0 +1,78 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "chathistory.h"
+
+#include <algorithm>
+#include <cassert>
+
+ChatHistory::ChatHistory()
+    : m_first(0)
+    , m_count(0)
+    , m_limit(0)
+    , m_chunk(0)
+    , m_dropped(0)
+{
+}
+
+void ChatHistory::SetLimit(size_t limit)
+{
+	if (limit == m_limit) {
+		return;
+	}
+
+	std::vector<long> lengths;
+	if (limit > 0) {
+		const size_t chunk = std::max<size_t>(limit / 4, 1);
+		lengths.resize(limit + chunk);
+		// the oldest lines which don't fit anymore are removed with the next chunk
+		const size_t keep = std::min(m_count, limit);
+		for (size_t i = 0; i < m_count - keep; i++) {
+			m_dropped += m_lengths[(m_first + i) % m_lengths.size()];
+		}
+		for (size_t i = 0; i < keep; i++) {
+			lengths[i] = m_lengths[(m_first + m_count - keep + i) % m_lengths.size()];
+		}
+		m_count = keep;
+		m_chunk = chunk;
+	} else {
+		// lines shown without a limit aren't tracked and never cropped
+		m_count = 0;
+		m_chunk = 0;
+		m_dropped = 0;
+	}
+	m_lengths.swap(lengths);
+	m_first = 0;
+	m_limit = limit;
+}
+
+void ChatHistory::Add(long length)
+{
+	if (m_limit == 0) {
+		return;
+	}
+	assert(m_count < m_lengths.size()); // Trim() has to be called before
+	m_lengths[(m_first + m_count) % m_lengths.size()] = length;
+	m_count++;
+}
+
+long ChatHistory::Trim()
+{
+	if ((m_limit == 0) || (m_count < m_limit + m_chunk)) {
+		return 0;
+	}
+	long removed = m_dropped;
+	m_dropped = 0;
+	while (m_count > m_limit) {
+		removed += m_lengths[m_first];
+		m_first = (m_first + 1) % m_lengths.size();
+		m_count--;
+	}
+	return removed;
+}
+
+void ChatHistory::Clear()
+{
+	m_first = 0;
+	m_count = 0;
+	m_dropped = 0;
+}
@@ -0,0 +1,50 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_CHATHISTORY_H
+#define SPRINGLOBBY_HEADERGUARD_CHATHISTORY_H
+
+#include <cstddef>
+#include <vector>
+
+//! @brief Remembers the length of the lines shown in a chat text control.
+//! The lengths are kept in a fixed-capacity ring, so the text control doesn't
+//! have to be asked for its line lengths when old lines are cropped. Lines
+//! are cropped in chunks of a quarter of the limit, which keeps the cost per
+//! appended line constant instead of rewriting the control for every line.
+class ChatHistory
+{
+public:
+	ChatHistory();
+
+	//! max count of lines to keep, 0 for no limit. The newest of the stored
+	//! lines are kept when the limit changes.
+	void SetLimit(size_t limit);
+	size_t GetLimit() const
+	{
+		return m_limit;
+	}
+
+	//! a line of length text positions was appended, Trim() has to be
+	//! called before every Add()
+	void Add(long length);
+	//! forget lines which are over the limit if a whole chunk of them
+	//! accumulated, returns the count of text positions to remove from the
+	//! start of the control, 0 when nothing has to be removed now
+	long Trim();
+
+	void Clear();
+	size_t GetCount() const
+	{
+		return m_count;
+	}
+
+private:
+	std::vector<long> m_lengths;
+	size_t m_first;
+	size_t m_count;
+	size_t m_limit;
+	size_t m_chunk;
+	long m_dropped; //!< length of lines forgotten by SetLimit() which weren't removed yet
+};
+
+#endif // SPRINGLOBBY_HEADERGUARD_CHATHISTORY_H
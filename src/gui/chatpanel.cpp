@@ -36,6 +36,8 @@
 #include "utils/conversion.h"
 #include "utils/curlhelper.h" //has to be first include, as else it warns about winsock2.h should be included first
 #include "utils/globalevents.h"
+#include "utils/highlightmatcher.h"
+#include "utils/ircformat.h"
 #include "utils/slconfig.h"
 #include "utils/uievents.h"
 #include "utils/version.h"
@@ -56,7 +58,7 @@ SLCONFIG("/Channel/bridgebot", (const wxString&)_T("TIZBOT"), "Name of the Bridg
 SLCONFIG("/GUI/ShowPromotions", true, "Show promotion messages as popup");
 
 /// table for irc colors
-static wxColor m_irc_colors[16] = {
+static wxColor m_irc_colors[IRC_COLOR_COUNT] = {
     wxColor(204, 204, 204),
     wxColor(0, 0, 0),
     wxColor(54, 54, 178),
@@ -112,6 +114,7 @@ ChatPanel::ChatPanel(wxWindow* parent, Channel& chan, wxImageList* imaglist)
     , m_display_joinitem(false)
     , m_topic_set(false)
     , m_reactOnPromoteEvents(true)
+    , m_use_irc_colors(false)
 {
 	Init(TowxString(chan.GetName()));
 	SetChannel(&chan);
@@ -136,8 +139,9 @@ ChatPanel::ChatPanel(wxWindow* parent, User& user, wxImageList* imaglist)
     , m_display_joinitem(true)
     , m_topic_set(false)
     , m_reactOnPromoteEvents(false)
+    , m_use_irc_colors(false)
 {
-	Init(_T("chatpanel-pm-") + TowxString(user.GetNick()));
+	Init(_T("chatpanel-pm-") + user.GetNickWx());
 	SetUser(&user);
 }
 
@@ -160,6 +164,7 @@ ChatPanel::ChatPanel(wxWindow* parent, IServer& serv, wxImageList* imaglist)
     , m_display_joinitem(false)
     , m_topic_set(false)
     , m_reactOnPromoteEvents(false)
+    , m_use_irc_colors(false)
 {
 	Init(_T("chatpanel-server"));
 	SetServer(&serv);
@@ -182,6 +187,7 @@ ChatPanel::ChatPanel(wxWindow* parent, IBattle* battle)
     , m_display_joinitem(true)
     , m_topic_set(false)
     , m_reactOnPromoteEvents(false)
+    , m_use_irc_colors(false)
 {
 	Init(_T("BATTLE"));
 	SetBattle(battle);
@@ -203,6 +209,7 @@ ChatPanel::ChatPanel(wxWindow* parent)
     , m_display_joinitem(true)
     , m_topic_set(false)
     , m_reactOnPromoteEvents(false)
+    , m_use_irc_colors(false)
 {
 	Init(_T("debug"));
 }
@@ -395,35 +402,14 @@ void ChatPanel::OutputLine(const wxString& message, const wxColour& col, bool sh
 	}
 }
 
-static size_t FirstSpecialChar(const wxString& str)
-{
-	for (size_t pos = 0; pos < str.Len(); pos++) {
-		if (!str.GetChar(pos).IsAscii()) {
-			continue;
-		}
-		const unsigned char uc = str.GetChar(pos);
-		if (uc == 0x1f || uc == 0x1d || uc == 0x03 || uc == 0x02 || uc == 0x016 || uc == 0x0F) { //get all text until first irc color is found
-			return pos;
-		}
-	}
-	return -1;
-}
-
 void ChatPanel::OutputLine(const ChatLine& line)
 {
-	const int numOfLines = m_chatlog_text->GetNumberOfLines();
-	const int maxlength = sett().GetChatHistoryLenght();
-
 	// crop lines from history that exceeds limit
-	if ((maxlength > 0) && (numOfLines > maxlength)) {
-		int end_line = 0;
-		for (int i = 0; i < numOfLines - maxlength; i++) {
-			end_line += m_chatlog_text->GetLineLength(i) + 1;
-		}
-		if (end_line > 0) {
-			m_chatlog_text->Remove(0, end_line);
-		}
+	const long cropped = m_history.Trim();
+	if (cropped > 0) {
+		m_chatlog_text->Remove(0, cropped);
 	}
+	const long start = m_chatlog_text->GetLastPosition();
 
 	if (!line.time.empty()) {
 		m_chatlog_text->SetDefaultStyle(line.timestyle);
@@ -433,65 +419,16 @@ void ChatPanel::OutputLine(const ChatLine& line)
 	}
 
 #ifndef __WXOSX_COCOA__
-	if (sett().GetUseIrcColors()) {
-		wxString m1(line.chat);
-		wxString m2;
-		wxString m3;
+	if (m_use_irc_colors) {
+		std::wstring plain;
+		std::vector<IrcTextRun> runs;
+		ParseIrcFormatting(line.chat.ToStdWstring(), plain, runs);
 		wxTextAttr at(line.chatstyle);
-		int color = 0;
-		bool bold = false;
-		wxColor curcolor(line.chatstyle.GetTextColour());
-		const wxFont oldfont = sett().GetChatFont();
-		const wxColor oldcolor(line.chatstyle.GetTextColour());
-
-		while (m1.Len() > 0) {
-			const size_t firstspec = FirstSpecialChar(m1);
-			if (firstspec > 0) {	   //unformated text found, add as whole
-				wxFont font = oldfont; //isn't needed any more in wx3.0
-				at = line.chatstyle;
-				if (bold)
-					font.SetWeight(wxFONTWEIGHT_BOLD);
-				at.SetFont(font);
-				at.SetTextColour(curcolor);
-				m_chatlog_text->SetDefaultStyle(at);
-				m_chatlog_text->AppendText(m1.Mid(0, firstspec));
-				m1 = m1.Mid(firstspec);
-				if (m1.Len() <= 0) { //no chars left, abort
-					break;
-				}
-			}
-			const unsigned char uc = m1.GetChar(0);
-			switch (uc) {      //  http://en.wikichip.org/wiki/irc/colors
-				case 0x1f: //underline
-					break;
-				case 0x1d: //italics
-					break;
-				case 0x03: {
-					if (m1.Len() > 2 && (m1.GetChar(2) >= 48 && m1.GetChar(2) <= 58)) {
-						color = (int(m1.GetChar(1)) - 48) * 10 + (int(m1.GetChar(2)) - 48);
-						m1 = m1.Mid(2); //next chars
-					} else {
-						color = int(m1.GetChar(1)) - 48;
-						m1 = m1.Mid(1); //next char
-					}
-
-					wxColor dummy(0, 0, 0);
-					if ((color > -1) && (color < long((sizeof(m_irc_colors) / sizeof(dummy))))) {
-						curcolor = m_irc_colors[color];
-					}
-					break;
-				}
-				case 0x02: //bold
-					bold = !bold;
-					break;
-				case 0x16: //reverse;
-					break;
-				case 0x0F: //reset formating
-					bold = false;
-					curcolor = oldcolor;
-					break;
-			}
-			m1 = m1.Mid(1); //next char!
+		for (const IrcTextRun& run : runs) {
+			at.SetFont(run.bold ? m_chat_font_bold : m_chat_font);
+			at.SetTextColour((run.color == IRC_DEFAULT_COLOR) ? line.chatstyle.GetTextColour() : m_irc_colors[run.color]);
+			m_chatlog_text->SetDefaultStyle(at);
+			m_chatlog_text->AppendText(wxString(plain.data() + run.offset, run.length));
 		}
 		m_chatlog_text->AppendText(_T("\n"));
 	} else
@@ -500,7 +437,7 @@ void ChatPanel::OutputLine(const ChatLine& line)
 		m_chatlog_text->SetDefaultStyle(line.chatstyle);
 		m_chatlog_text->AppendText(line.chat + _T( "\n" ));
 	}
-
+	m_history.Add(m_chatlog_text->GetLastPosition() - start);
 
 	m_chatlog_text->ScrollLines(1);
 	m_chatlog_text->ShowPosition(m_chatlog_text->GetLastPosition());
@@ -572,7 +509,7 @@ void ChatPanel::Said(const wxString& who, const wxString& message)
 		m_active_users.insert(who);
 	}
 
-	wxString me = TowxString(GetMe().GetNick());
+	wxString me = GetMe().GetNickWx();
 	wxColour col;
 	bool req_user = false;
 	if (who.Upper() == me.Upper()) {
@@ -614,13 +551,11 @@ void ChatPanel::Said(const wxString& who, const wxString& message)
 
 bool ChatPanel::ContainsWordToHighlight(const wxString& message) const
 {
-	//get list of words to highlight
-	wxArrayString words = sett().GetHighlightedWords();
-	for (unsigned int i = 0; i < words.GetCount(); i++) {
-		if (message.Find(words[i]) != wxNOT_FOUND)
-			return true;
+	const HighlightMatcher& matcher = sett().GetHighlightMatcher();
+	if (matcher.Empty()) {
+		return false;
 	}
-	return false;
+	return matcher.Contains(message.ToStdWstring());
 }
 
 /**
@@ -725,7 +660,7 @@ void ChatPanel::Joined(User& who)
 		if (m_type == CPT_Channel) {
 			SetIconHighlight(highlight_join_leave);
 		}
-		OutputLine(_T( "** " ) + wxString::Format(_("%s joined %s."), TowxString(who.GetNick()).c_str(), GetChatTypeStr().c_str()), sett().GetChatColorJoinPart());
+		OutputLine(_T( "** " ) + wxString::Format(_("%s joined %s."), who.GetNickWx().c_str(), GetChatTypeStr().c_str()), sett().GetChatColorJoinPart());
 	}
 
 	if (m_show_nick_list && (m_nicklist != nullptr)) {
@@ -733,7 +668,7 @@ void ChatPanel::Joined(User& who)
 		UpdateUserCountLabel();
 	}
 	// Also add the User to the TextCompletionDatabase
-	textcompletiondatabase.Insert_Mapping(TowxString(who.GetNick()), TowxString(who.GetNick()));
+	textcompletiondatabase.Insert_Mapping(who.GetNickWx(), who.GetNickWx());
 }
 
 void ChatPanel::OnChannelJoin(User& who)
@@ -744,17 +679,17 @@ void ChatPanel::OnChannelJoin(User& who)
 		UpdateUserCountLabel();
 	}
 	if (m_display_joinitem) {
-		OutputLine(_T( "** " ) + wxString::Format(_("%s joined %s."), TowxString(who.GetNick()).c_str(), GetChatTypeStr().c_str()), sett().GetChatColorJoinPart());
+		OutputLine(_T( "** " ) + wxString::Format(_("%s joined %s."), who.GetNickWx().c_str(), GetChatTypeStr().c_str()), sett().GetChatColorJoinPart());
 	}
 	// Also add the User to the TextCompletionDatabase
-	textcompletiondatabase.Insert_Mapping(TowxString(who.GetNick()), TowxString(who.GetNick()));
+	textcompletiondatabase.Insert_Mapping(who.GetNickWx(), who.GetNickWx());
 }
 
 void ChatPanel::Parted(User& who, const wxString& message)
 {
 	//    assert( m_type == CPT_Channel || m_type == CPT_Server || m_type == CPT_Battle || m_type == CPT_User );
 	const bool me_parted = m_channel && &who == &m_channel->GetMe();
-	const wxString nick = TowxString(who.GetNick());
+	const wxString nick = who.GetNickWx();
 	const bool wasactive = m_active_users.erase(nick) > 0;
 	if (m_display_joinitem || (wasactive && !who.IsBot())) {
 		OutputLine(_T( "** " ) + wxString::Format(_("%s left %s (%s)."), nick.c_str(), GetChatTypeStr().c_str(), message.c_str()), sett().GetChatColorJoinPart());
@@ -778,7 +713,7 @@ void ChatPanel::Parted(User& who, const wxString& message)
 		UpdateUserCountLabel();
 	}
 	// Also remove the User from the TextCompletionDatabase
-	textcompletiondatabase.Delete_Mapping(TowxString(who.GetNick()));
+	textcompletiondatabase.Delete_Mapping(who.GetNickWx());
 }
 
 void ChatPanel::SetTopic(const wxString& who, const wxString& message)
@@ -946,7 +881,7 @@ bool ChatPanel::Say(const wxString& message) //FIXME: remove all parsing / token
 		}
 
 		if (line == _T( "/clear" )) {
-			m_chatlog_text->SetValue(wxEmptyString);
+			ClearContents();
 			return true;
 		}
 
@@ -1066,6 +1001,12 @@ void ChatPanel::FocusInputBox()
 	m_say_text->SetFocus();
 }
 
+void ChatPanel::ClearContents()
+{
+	m_chatlog_text->SetValue(wxEmptyString);
+	m_history.Clear();
+}
+
 wxString ChatPanel::FindUrl(const long pos) const
 {
 	if (pos < 0) {
@@ -1190,11 +1131,11 @@ void ChatPanel::SetBattle(IBattle* battle)
 	OutputLine(_T("** ") + _("Joined Battle."), sett().GetChatColorNotification());
 
 	for (unsigned int i = 0; i < battle->GetNumUsers(); ++i) {
-		const wxString nick = TowxString(battle->GetUser(i).GetNick());
+		const wxString nick = battle->GetUser(i).GetNickWx();
 		textcompletiondatabase.Insert_Mapping(nick, nick);
 	}
 
-	SetLogFile(_T( "_BATTLE_" ) + TowxString(battle->GetFounder().GetNick()));
+	SetLogFile(_T( "_BATTLE_" ) + battle->GetFounder().GetNickWx());
 	m_battle = battle;
 }
 
@@ -1288,6 +1229,11 @@ void ChatPanel::ReadSettings()
 	//Hide bots by default
 	m_ShowPlayersOnlyFlag = true;
 
+	m_use_irc_colors = sett().GetUseIrcColors();
+	m_history.SetLimit(std::max(sett().GetChatHistoryLenght(), 0));
+	m_chat_font = sett().GetChatFont();
+	m_chat_font_bold = m_chat_font.Bold();
+
 	if (m_chatlog_text != nullptr) {
 		m_chatlog_text->SetBackgroundColour(sett().GetChatColorBackground());
 	}
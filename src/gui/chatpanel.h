@@ -9,6 +9,7 @@
 #include <set>
 #include <vector>
 #include "chatlog.h"
+#include "chathistory.h"
 #include "utils/mixins.h"
 #include "utils/TextCompletionDatabase.h"
 class wxCommandEvent;
@@ -99,6 +100,8 @@ public:
 
 	void Part();
 	void FocusInputBox();
+	//! empties the chat view
+	void ClearContents();
 
 
 	size_t GetIconIndex() const
@@ -213,6 +216,7 @@ private:
 	ChatPanelMenu* m_popup_menu;
 
 	ChatLog m_chat_log;
+	ChatHistory m_history; //!< lengths of the lines in m_chatlog_text
 
 	size_t m_icon_index;
 
@@ -234,6 +238,9 @@ private:
 	//used to avoid marking channel as changed when it's just been created.
 	bool m_topic_set;
 	bool m_reactOnPromoteEvents;
+	bool m_use_irc_colors;
+	wxFont m_chat_font;
+	wxFont m_chat_font_bold;
 	static const int MINIMUM_PANE_SIZE = 250;
 
 	DECLARE_EVENT_TABLE()
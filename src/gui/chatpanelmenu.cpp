@@ -132,7 +132,7 @@ wxMenu* ChatPanelMenu::GetMenu()
 		submenu_user->Append(broadcastitem);
 	} else if (m_chatpanel->m_type == CPT_User) {
 		if (m_chatpanel->m_user)
-			m_user_menu->EnableItems(true, TowxString(m_chatpanel->m_user->GetNick()));
+			m_user_menu->EnableItems(true, m_chatpanel->m_user->GetNickWx());
 		m_menu_all->AppendSubMenu(m_user_menu, _("User"));
 	}
 
@@ -360,7 +360,7 @@ void ChatPanelMenu::OnChannelMenuRegister(wxCommandEvent& /*unused*/)
 	if (!HasChanserv())
 		return;
 
-	wxString text = TowxString(m_chatpanel->m_channel->GetMe().GetNick());
+	wxString text = m_chatpanel->m_channel->GetMe().GetNickWx();
 	if (!ui().AskText(_("Register Channel"), _("Who should be appointed founder of this channel?"), text))
 		return;
 
@@ -685,7 +685,7 @@ void ChatPanelMenu::OnChatMenuOpenLog(wxCommandEvent&)
 
 void ChatPanelMenu::OnChannelClearContents(wxCommandEvent& /*unused*/)
 {
-	m_chatpanel->m_chatlog_text->SetValue(wxEmptyString);
+	m_chatpanel->ClearContents();
 }
 
 void ChatPanelMenu::OnUserMenuAddToGroup(wxCommandEvent& event)
@@ -695,7 +695,7 @@ void ChatPanelMenu::OnUserMenuAddToGroup(wxCommandEvent& event)
 		wxString groupname = m_user_menu->GetGroupByEvtID(id);
 		const User* user = m_chatpanel->GetSelectedUser();
 		if (user != nullptr)
-			useractions().AddUserToGroup(groupname, TowxString(user->GetNick()));
+			useractions().AddUserToGroup(groupname, user->GetNickWx());
 	}
 }
 
@@ -703,7 +703,7 @@ void ChatPanelMenu::OnUserMenuDeleteFromGroup(wxCommandEvent& /*unused*/)
 {
 	const User* user = m_chatpanel->GetSelectedUser();
 	if (user != nullptr)
-		useractions().RemoveUser(TowxString(user->GetNick()));
+		useractions().RemoveUser(user->GetNickWx());
 }
 
 void ChatPanelMenu::OnUserMenuCreateGroup(wxCommandEvent& /*unused*/)
@@ -714,7 +714,7 @@ void ChatPanelMenu::OnUserMenuCreateGroup(wxCommandEvent& /*unused*/)
 		const User* user = m_chatpanel->GetSelectedUser();
 		if (user != nullptr) {
 			useractions().AddGroup(name);
-			useractions().AddUserToGroup(name, TowxString(user->GetNick()));
+			useractions().AddUserToGroup(name, user->GetNickWx());
 			ui().mw().ShowConfigure(MainWindow::OPT_PAGE_GROUPS);
 		} else
 			customMessageBoxModal(SL_MAIN_ICON, _("couldn't add user"), _("Error"));
@@ -7,7 +7,10 @@
 #include <wx/sizer.h>
 #include <wx/stattext.h>
 #include <wx/textctrl.h>
+#include <list>
 
+#include "contentindex.h"
+#include "contentsearchresult.h"
 #include "contentsearchresultview.h"
 #include "downloader/lib/src/Downloader/Http/HttpDownloader.h" //FIXME: remove this
 #include "downloader/prdownloader.h"
@@ -15,22 +18,78 @@
 #include "servermanager.h"
 #include "ui.h"
 #include "utils/conversion.h"
-#include "utils/slpaths.h"
 
-DECLARE_EVENT_TYPE(SEARCH_FINISHED, wxID_ANY);
-DEFINE_EVENT_TYPE(SEARCH_FINISHED);
+// runs on the search thread, closing the dialog or searching for something
+// else aborts the request
+static bool FetchContent(const std::string& query, ContentSearch::Results& results, const ContentSearch::Cancelled& cancelled)
+{
+	const std::string param = ConvToIRI(query);
+	const std::string url = stdprintf("https://api.springfiles.com/json.php?nosensitive=on&logical=or&springname=%s&tag=%s", param.c_str(), param.c_str());
+	std::string res;
+	if (!PrDownloader::FetchUrl(url, res, cancelled)) {
+		return false;
+	}
+	std::list<IDownload*> dls;
+	CHttpDownloader::ParseResult(query, res, dls);
+	for (const IDownload* dl : dls) {
+		ContentSearch::Result result;
+		result.name = dl->origin_name;
+		result.category = dl->cat;
+		result.version = dl->version;
+		result.filesize = dl->size;
+		result.downloaded = false;
+		results.push_back(result);
+	}
+	IDownloader::freeResult(dls);
+	return true;
+}
+
+// runs on the search thread, the content index can be queried from any thread
+static void ResolveDownloaded(ContentSearch::Results& results)
+{
+	const ContentIndex* index = ContentIndex::Instance();
+	for (ContentSearch::Result& result : results) {
+		switch (result.category) {
+			case DownloadEnum::CAT_MAP:
+				result.downloaded = index->MapExists(result.name);
+				break;
+			case DownloadEnum::CAT_GAME:
+				result.downloaded = index->GameExists(result.name);
+				break;
+			case DownloadEnum::CAT_ENGINE: //FIXME: check if platform matches / filter out different platform (?)
+			case DownloadEnum::CAT_ENGINE_LINUX:
+			case DownloadEnum::CAT_ENGINE_LINUX64:
+			case DownloadEnum::CAT_ENGINE_MACOSX:
+			case DownloadEnum::CAT_ENGINE_WINDOWS:
+				result.downloaded = index->EngineExists(result.version);
+				break;
+			default:
+				result.downloaded = false;
+		}
+	}
+}
+
+static const size_t SEARCH_CACHE_SIZE = 32;
+static const std::chrono::minutes SEARCH_CACHE_TTL(10);
+static const int TYPING_DELAY = 400; //ms
+//! shorter queries are only searched for with the search button
+static const size_t MIN_TYPED_LENGTH = 3;
+
 BEGIN_EVENT_TABLE(ContentDownloadDialog, wxDialog)
 EVT_BUTTON(SEARCH_BUTTON, ContentDownloadDialog::OnSearch)
 EVT_BUTTON(CLOSE_BUTTON, ContentDownloadDialog::OnCloseButton)
 EVT_BUTTON(DOWNLOAD_BUTTON, ContentDownloadDialog::OnDownloadButton)
-EVT_COMMAND(ID_SEARCH_FINISHED, SEARCH_FINISHED, ContentDownloadDialog::OnSearchCompleted)
+EVT_TEXT(SEARCH_TEXT, ContentDownloadDialog::OnSearchText)
+EVT_TIMER(TYPING_TIMER, ContentDownloadDialog::OnTypingTimer)
 EVT_DATAVIEW_ITEM_ACTIVATED(LAUNCH_DOWNLOAD, ContentDownloadDialog::OnListDownload)
 END_EVENT_TABLE()
 
 ContentDownloadDialog::ContentDownloadDialog(wxWindow* parent, wxWindowID id, const wxString& title, const wxPoint& pos, const wxSize& size, long int style, const wxString& name)
     : wxDialog(parent, id, title, pos, size, style, name)
     , WindowAttributesPickle(_T("CONTENTDIALOG"), this, wxSize(670, 400))
-    , wildcardsearch(false)
+    , m_search(new ContentSearch(FetchContent, ResolveDownloaded, SEARCH_CACHE_SIZE, SEARCH_CACHE_TTL))
+    , m_search_id(0)
+    , m_typing_timer(this, TYPING_TIMER)
 {
 	m_main_sizer = new wxBoxSizer(wxVERTICAL);
 	{
@@ -40,7 +99,7 @@ ContentDownloadDialog::ContentDownloadDialog(wxWindow* parent, wxWindowID id, co
 		}
 		m_searchsizer = new wxBoxSizer(wxHORIZONTAL);
 		{
-			m_searchbox = new wxTextCtrl(this, -1);
+			m_searchbox = new wxTextCtrl(this, SEARCH_TEXT);
 			{
 				m_searchbox->SetToolTip(_("Enter search query (wildcard * can be used)"));
 				m_searchsizer->Add(m_searchbox, 1, wxALL, 5);
@@ -74,20 +133,20 @@ bool ContentDownloadDialog::Show(bool show)
 
 ContentDownloadDialog::~ContentDownloadDialog()
 {
+	// aborts a running search, no results are delivered anymore after this
+	delete m_search;
+	m_search = nullptr;
+	m_search_res_w->Clear();
 }
 
-static std::list<IDownload*> dls;
-
 void ContentDownloadDialog::Search(const wxString& str)
 {
-	//FIXME: make async!
-	const std::string param = ConvToIRI(STD_STRING(str));
-	const std::string query = stdprintf("https://api.springfiles.com/json.php?nosensitive=on&logical=or&springname=%s&tag=%s", param.c_str(), param.c_str());
-	std::string res;
-	prDownloader().DownloadUrl(query, res);
-	CHttpDownloader::ParseResult(STD_STRING(str), res, dls);
-	wxCommandEvent e;
-	OnSearchCompleted(e);
+	m_typing_timer.Stop();
+	m_search_id = m_search->Search(STD_STRING(str), [this](unsigned int id, const ContentSearch::Results& results) {
+		CallAfter([this, id, results]() {
+			OnSearchCompleted(id, results);
+		});
+	});
 }
 
 void ContentDownloadDialog::OnSearch(wxCommandEvent& /*event*/)
@@ -95,45 +154,41 @@ void ContentDownloadDialog::OnSearch(wxCommandEvent& /*event*/)
 	Search(m_searchbox->GetValue());
 }
 
-void ContentDownloadDialog::OnSearchCompleted(wxCommandEvent& /*event*/)
+void ContentDownloadDialog::OnSearchText(wxCommandEvent& /*event*/)
+{
+	if (m_searchbox->GetValue().length() < MIN_TYPED_LENGTH) {
+		m_typing_timer.Stop();
+		return;
+	}
+	m_typing_timer.StartOnce(TYPING_DELAY);
+}
+
+void ContentDownloadDialog::OnTypingTimer(wxTimerEvent& /*event*/)
+{
+	Search(m_searchbox->GetValue());
+}
+
+void ContentDownloadDialog::OnSearchCompleted(unsigned int id, const ContentSearch::Results& results)
 {
 	assert(wxThread::IsMain());
 
-	if (dls.empty() && (!wildcardsearch)) { //no results returned, try wildcard search
-		wildcardsearch = true;
-		const wxString search_query = _T("*") + m_searchbox->GetValue() + _T("*"); //By default the user would expect that
-		Search(search_query);
+	if (id != m_search_id) { // the user searched for something else meanwhile
 		return;
 	}
-	wildcardsearch = false;
+
 	m_search_res_w->Clear();
+	m_results.clear();
 
-	for (const IDownload* dl : dls) {
+	for (const ContentSearch::Result& result : results) {
 		ContentSearchResult* res = new ContentSearchResult();
-		res->name = dl->origin_name;
-		res->filesize = dl->size;
-		res->type = DownloadEnum::getCat(dl->cat);
-		res->category = dl->cat;
-		switch (dl->cat) {
-			case DownloadEnum::CAT_MAP:
-				res->is_downloaded = LSL::usync().MapExists(dl->origin_name);
-				break;
-			case DownloadEnum::CAT_GAME:
-				res->is_downloaded = LSL::usync().GameExists(dl->origin_name);
-				break;
-			case DownloadEnum::CAT_ENGINE: //FIXME: check if platform matches / filter out different platform (?)
-			case DownloadEnum::CAT_ENGINE_LINUX:
-			case DownloadEnum::CAT_ENGINE_LINUX64:
-			case DownloadEnum::CAT_ENGINE_MACOSX:
-			case DownloadEnum::CAT_ENGINE_WINDOWS:
-				res->is_downloaded = !SlPaths::GetCompatibleVersion(dl->version).empty();
-				break;
-			default:
-				res->is_downloaded = false;
-		}
+		res->name = TowxString(result.name);
+		res->filesize = result.filesize;
+		res->type = DownloadEnum::getCat(result.category);
+		res->category = result.category;
+		res->is_downloaded = result.downloaded;
+		m_results.emplace_back(res);
 		m_search_res_w->AddContent(*res);
 	}
-	IDownloader::freeResult(dls);
 }
 
 void ContentDownloadDialog::OnCloseButton(wxCommandEvent& /*event*/)
@@ -5,11 +5,16 @@
 
 #include <wx/dialog.h>
 #include <wx/listbase.h>
+#include <wx/timer.h>
+#include <memory>
+#include <vector>
+#include "downloader/contentsearch.h"
 #include "windowattributespickle.h"
 class wxBoxSizer;
 class wxStaticText;
 class wxButton;
 class wxTextCtrl;
+class ContentSearchResult;
 class ContentSearchResultView;
 class wxDataViewEvent;
 
@@ -20,7 +25,8 @@ public:
 	virtual ~ContentDownloadDialog();
 	virtual bool Show(bool show = true);
 	void OnSearch(wxCommandEvent& event);
-	void OnSearchCompleted(wxCommandEvent& event);
+	void OnSearchText(wxCommandEvent& event);
+	void OnTypingTimer(wxTimerEvent& event);
 	void OnDownloadButton(wxCommandEvent& event);
 	void OnCloseButton(wxCommandEvent& event);
 	void OnListDownload(wxDataViewEvent& event);
@@ -28,6 +34,7 @@ public:
 private:
 	DECLARE_EVENT_TABLE()
 	void Search(const wxString& str);
+	void OnSearchCompleted(unsigned int id, const ContentSearch::Results& results);
 
 	wxBoxSizer* m_main_sizer;
 	ContentSearchResultView* m_search_res_w;
@@ -37,12 +44,16 @@ private:
 	wxButton* m_download_button;
 	wxButton* m_close_button;
 
-	bool wildcardsearch;
+	ContentSearch* m_search;
+	unsigned int m_search_id; //!< of the search whose results are shown next
+	wxTimer m_typing_timer;   //!< searches when the user stopped typing
+	std::vector<std::unique_ptr<ContentSearchResult> > m_results;
 
 public:
 	enum {
 		SEARCH_BUTTON = wxID_HIGHEST,
-		ID_SEARCH_FINISHED,
+		SEARCH_TEXT,
+		TYPING_TIMER,
 		CLOSE_BUTTON,
 		LAUNCH_DOWNLOAD,
 		DOWNLOAD_BUTTON
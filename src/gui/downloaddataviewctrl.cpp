@@ -4,13 +4,17 @@
 #include "downloaddataviewmodel.h"
 #include "utils/globalevents.h"
 
+static const int POLL_INTERVAL = 500; //ms
+
 BEGIN_EVENT_TABLE(DownloadDataViewCtrl, BaseDataViewCtrl) EVT_MENU(DOWNLOAD_DATAVIEW_CANCEL, DownloadDataViewCtrl::OnCancel)
     EVT_MENU(DOWNLOAD_DATAVIEW_RETRY, DownloadDataViewCtrl::OnRetry)
+    EVT_TIMER(DOWNLOAD_DATAVIEW_POLL, DownloadDataViewCtrl::OnPollTimer)
     END_EVENT_TABLE()
 
     DownloadDataViewCtrl::DownloadDataViewCtrl(const wxString dataViewName,
 					       wxWindow* parent)
     : BaseDataViewCtrl(dataViewName, parent, DOWNLOAD_DATAVIEW_ID)
+    , m_poll_timer(this, DOWNLOAD_DATAVIEW_POLL)
 {
 
 	DownloadDataViewModel* model = new DownloadDataViewModel();
@@ -36,11 +40,11 @@ BEGIN_EVENT_TABLE(DownloadDataViewCtrl, BaseDataViewCtrl) EVT_MENU(DOWNLOAD_DATA
 	LoadColumnProperties();
 
 	SUBSCRIBE_GLOBAL_EVENT(GlobalEventManager::OnDownloadStarted, DownloadDataViewCtrl::OnDownloadStarted);
-	SUBSCRIBE_GLOBAL_EVENT(GlobalEventManager::OnDownloadProgress, DownloadDataViewCtrl::OnDownloadProgress);
 }
 
 DownloadDataViewCtrl::~DownloadDataViewCtrl()
 {
+	m_poll_timer.Stop();
 	GlobalEventManager::Instance()->UnSubscribeAll(this);
 	Clear();
 }
@@ -71,35 +75,38 @@ void DownloadDataViewCtrl::OnDownloadStarted(wxCommandEvent& /*event*/)
 {
 	slLogDebugFunc("");
 
-	PrDownloader::DownloadProgress* p = new PrDownloader::DownloadProgress;
-	prDownloader().GetProgress(*p);
-	auto item = itemsIndex.find(p->name);
-	if (item != itemsIndex.end() && item->second != nullptr) {
-		p->CopyTo(*item->second);
-		RefreshItem(*item->second);
-		delete p;
-		return;
+	UpdateItems();
+	if (!m_poll_timer.IsRunning()) {
+		m_poll_timer.Start(POLL_INTERVAL);
 	}
-	AddItem(p);
 }
 
-void DownloadDataViewCtrl::OnDownloadProgress(wxCommandEvent& /*event*/)
+void DownloadDataViewCtrl::OnPollTimer(wxTimerEvent& /*event*/)
 {
-
-	PrDownloader::DownloadProgress* existingItem;
-	PrDownloader::DownloadProgress p;
-	prDownloader().GetProgress(p);
-
-	auto item = itemsIndex.find(p.name);
-	if (item == itemsIndex.end() || item->second == nullptr) {
-		existingItem = new PrDownloader::DownloadProgress(p);
-		AddItem(existingItem);
-		return;
+	// the last poll picks up the final state of the downloads
+	if (!UpdateItems()) {
+		m_poll_timer.Stop();
 	}
+}
 
-	existingItem = item->second;
-	p.CopyTo(*existingItem);
-	RefreshItem(*existingItem);
+bool DownloadDataViewCtrl::UpdateItems()
+{
+	bool running = false;
+	for (const PrDownloader::DownloadProgress& p : PrDownloader::GetAllProgress()) {
+		running |= p.running;
+		auto item = itemsIndex.find(p.name);
+		if (item == itemsIndex.end() || item->second == nullptr) {
+			AddItem(new PrDownloader::DownloadProgress(p));
+			continue;
+		}
+		PrDownloader::DownloadProgress* existingItem = item->second;
+		if (existingItem->downloaded != p.downloaded || existingItem->running != p.running ||
+		    existingItem->bytesPerSecond != p.bytesPerSecond || existingItem->eta != p.eta) {
+			p.CopyTo(*existingItem);
+			RefreshItem(*existingItem);
+		}
+	}
+	return running;
 }
 
 void DownloadDataViewCtrl::AddItem(PrDownloader::DownloadProgress* p)
@@ -134,6 +141,9 @@ void DownloadDataViewCtrl::ClearFinished()
 {
 	slLogDebugFunc("");
 
+	// or the next poll adds them again
+	prDownloader().ClearFinished();
+
 	UnselectAll();
 
 	std::vector<const PrDownloader::DownloadProgress*> toBeRemoved;
@@ -3,6 +3,8 @@
 #ifndef SRC_DOWNLOADER_DOWNLOADDATAVIEWCTRL_H_
 #define SRC_DOWNLOADER_DOWNLOADDATAVIEWCTRL_H_
 
+#include <wx/timer.h>
+
 #include "downloader/prdownloader.h"
 #include "gui/basedataviewctrl.h"
 class wxString;
@@ -30,10 +32,13 @@ public:
 
 private:
 	void OnDownloadStarted(wxCommandEvent& event);
-	void OnDownloadProgress(wxCommandEvent& event);
+	void OnPollTimer(wxTimerEvent& event);
+	//! updates the items from the progress of all downloads, returns true if one is running
+	bool UpdateItems();
 
 private:
 	std::map<const std::string, PrDownloader::DownloadProgress*> itemsIndex;
+	wxTimer m_poll_timer; //!< runs while downloads are running
 
 private:
 	enum ColumnIndexes {
@@ -47,7 +52,8 @@ private:
 	enum {
 		DOWNLOAD_DATAVIEW_ID,
 		DOWNLOAD_DATAVIEW_CANCEL,
-		DOWNLOAD_DATAVIEW_RETRY
+		DOWNLOAD_DATAVIEW_RETRY,
+		DOWNLOAD_DATAVIEW_POLL
 	};
 
 	DECLARE_EVENT_TABLE()
@@ -48,13 +48,19 @@ void DownloadDataViewModel::GetValue(wxVariant& variant,
 			break;
 
 		case SPEED:
-			//TODO: implement
-			variant = wxVariant(wxEmptyString);
+			if (downloadInfo->running && downloadInfo->bytesPerSecond > 0) {
+				variant = wxVariant(wxString::Format(wxT("%i"), downloadInfo->bytesPerSecond / 1024));
+			} else {
+				variant = wxVariant(wxEmptyString);
+			}
 			break;
 
 		case ETA:
-			//TODO: implement
-			variant = wxVariant(wxEmptyString);
+			if (downloadInfo->running && downloadInfo->eta >= 0) {
+				variant = wxVariant(wxString::Format(wxT("%i:%02i"), downloadInfo->eta / 60, downloadInfo->eta % 60));
+			} else {
+				variant = wxVariant(wxEmptyString);
+			}
 			break;
 
 		case FILESIZE:
@@ -36,6 +36,7 @@
 #include "autohost.h"
 #include "autohostmanager.h"
 #include "battleroomdataviewctrl.h"
+#include "contentindex.h"
 #include "gui/chatpanel.h"
 #include "gui/colorbutton.h"
 #include "gui/controls.h"
@@ -1036,7 +1037,7 @@ void BattleRoomTab::OnUserJoined(User& user)
 
 	if (user == m_battle->GetMe())
 		return;
-	UiEvents::GetStatusEventSender(UiEvents::addStatusMessage).SendEvent(UiEvents::StatusData(wxString::Format(_("%s joined your battle"), TowxString(user.GetNick()).c_str()), 1));
+	UiEvents::GetStatusEventSender(UiEvents::addStatusMessage).SendEvent(UiEvents::StatusData(wxString::Format(_("%s joined your battle"), user.GetNickWx().c_str()), 1));
 }
 
 
@@ -1049,7 +1050,7 @@ void BattleRoomTab::OnUserLeft(User& user)
 
 	UpdateStatsLabels();
 
-	UiEvents::GetStatusEventSender(UiEvents::addStatusMessage).SendEvent(UiEvents::StatusData(wxString::Format(_("%s left your active battle"), TowxString(user.GetNick()).c_str()), 1));
+	UiEvents::GetStatusEventSender(UiEvents::addStatusMessage).SendEvent(UiEvents::StatusData(wxString::Format(_("%s left your active battle"), user.GetNickWx().c_str()), 1));
 }
 
 
@@ -1150,9 +1151,9 @@ void BattleRoomTab::OnDownloadComplete(wxCommandEvent& /*data*/)
 		return;
 	}
 
+	// other downloads may finish while the resync runs
 	PrDownloader::DownloadProgress progress;
-	PrDownloader::GetProgress(progress);
-	if (progress.name != m_resync_target_game) {
+	if (!PrDownloader::GetProgress(m_resync_target_game, progress) || !progress.IsFinished() || progress.IsFailed()) {
 		return;
 	}
 
@@ -1380,7 +1381,7 @@ void BattleRoomTab::SetBattle(IBattle* battle)
 		RegenerateOptionsList();
 		m_options_preset_sel->SetStringSelection(sett().GetModDefaultPresetName(TowxString(m_battle->GetHostGameNameAndVersion())));
 		m_color_sel->SetColor(lslTowxColour(m_battle->GetMe().BattleStatus().colour));
-		for (UserList::user_map_t::size_type i = 0; i < m_battle->GetNumUsers(); i++) {
+		for (UserList::size_type i = 0; i < m_battle->GetNumUsers(); i++) {
 			//TODO: disable UI update while adding users?
 			m_players->AddUser(m_battle->GetUser(i));
 		}
@@ -1561,6 +1562,7 @@ void BattleRoomTab::OnResync(wxCommandEvent& /*event*/)
 	}
 
 	SlPaths::RefreshSpringVersionList(true);
+	ContentIndex::Instance()->RefreshEngines();
 	prDownloader().ValidateRapidPoolAsync(true);
 }
 
@@ -1574,7 +1576,7 @@ void BattleRoomTab::OnRapidValidateComplete(wxCommandEvent& /*data*/)
 	m_resync_show_diag_on_next_unitsync_reload = false;
 	m_resync_unitsync_reload_retries = 0;
 
-	prDownloader().Download(DownloadEnum::CAT_GAME, m_resync_target_game, m_resync_selected_master_url);
+	prDownloader().Download(DownloadEnum::CAT_GAME, m_resync_target_game, m_resync_selected_master_url, DownloadScheduler::PRIORITY_BATTLE);
 }
 
 void BattleRoomTab::OnRapidValidateFailed(wxCommandEvent& /*data*/)
@@ -1589,7 +1591,7 @@ void BattleRoomTab::OnRapidValidateFailed(wxCommandEvent& /*data*/)
 	m_resync_show_diag_on_next_unitsync_reload = false;
 	m_resync_unitsync_reload_retries = 0;
 
-	prDownloader().Download(DownloadEnum::CAT_GAME, m_resync_target_game, m_resync_selected_master_url);
+	prDownloader().Download(DownloadEnum::CAT_GAME, m_resync_target_game, m_resync_selected_master_url, DownloadScheduler::PRIORITY_BATTLE);
 }
 
 void BattleRoomTab::OnDownloadFailed(wxCommandEvent& /*data*/)
@@ -1634,8 +1636,7 @@ void BattleRoomTab::OnDownloadFailed(wxCommandEvent& /*data*/)
 
 	if (m_resync_in_progress) {
 		PrDownloader::DownloadProgress progress;
-		PrDownloader::GetProgress(progress);
-		const bool isResyncDownload = (!m_resync_target_game.empty() && progress.name == m_resync_target_game);
+		const bool isResyncDownload = (!m_resync_target_game.empty() && PrDownloader::GetProgress(m_resync_target_game, progress) && progress.IsFailed());
 		if (!isResyncDownload) {
 			m_battle->ForceSpectator(m_battle->GetMe(), true); // auto set spectator because of failed download
 			UpdateResyncButtonColor();
@@ -1651,7 +1652,7 @@ void BattleRoomTab::OnDownloadFailed(wxCommandEvent& /*data*/)
 					m_resync_waiting_for_download = true;
 					m_resync_show_diag_on_next_unitsync_reload = false;
 					m_resync_unitsync_reload_retries = 0;
-					prDownloader().Download(DownloadEnum::CAT_GAME, m_resync_target_game, m_resync_selected_master_url);
+					prDownloader().Download(DownloadEnum::CAT_GAME, m_resync_target_game, m_resync_selected_master_url, DownloadScheduler::PRIORITY_BATTLE);
 					return;
 				}
 			}
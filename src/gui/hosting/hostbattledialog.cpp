@@ -12,6 +12,7 @@
 #include <wx/log.h>
 #include <wx/menu.h>
 
+#include "contentindex.h"
 #include "gui/controls.h"
 #include "gui/customdialogs.h"
 #include "gui/ui.h"
@@ -231,7 +232,9 @@ void HostBattleDialog::OnUseRelay(wxCommandEvent&)
 void HostBattleDialog::OnEngineSelect(wxCommandEvent& /*event*/)
 {
 	SlPaths::SetUsedSpringIndex(STD_STRING(m_engine_choice->GetString(m_engine_choice->GetSelection())));
-	LSL::usync().ReloadUnitSyncLib();
+	if (LSL::usync().ReloadUnitSyncLib()) {
+		ContentIndex::Instance()->UnitsyncReloaded();
+	}
 	ReloadEngineList();
 }
 
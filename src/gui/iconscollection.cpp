@@ -8,6 +8,7 @@
 #include <wx/image.h>
 #include <map>
 
+#include "contentindex.h"
 #include "flagimagedata.h"
 #include "ibattle.h"
 #include "log.h"
@@ -228,7 +229,7 @@ wxBitmap& IconsCollection::GetColourBmp(const LSL::lslColor& colour)
 wxBitmap& IconsCollection::GetFractionBmp(const std::string& gameName, size_t fractionId)
 {
 
-	if (gameName.empty() || !LSL::usync().GameExists(gameName)) {
+	if (gameName.empty() || !ContentIndex::Instance()->GameExists(gameName)) {
 		wxLogDebug("SideIcon %zu for game %s not found!", fractionId, gameName.c_str());
 		// game doesn't exist, dl needed?!
 		return BMP_EMPTY;
@@ -138,7 +138,7 @@ ChatPanel* MainChatTab::GetUserChatPanel(const wxString& user)
 
 void MainChatTab::OnUserConnected(User& user)
 {
-	ChatPanel* panel = GetUserChatPanel(TowxString(user.GetNick()));
+	ChatPanel* panel = GetUserChatPanel(user.GetNickWx());
 	if (panel != 0) {
 		panel->SetUser(&user);
 		panel->OnUserConnected();
@@ -152,7 +152,7 @@ void MainChatTab::OnUserConnected(User& user)
 
 void MainChatTab::OnUserDisconnected(User& user)
 {
-	ChatPanel* panel = GetUserChatPanel(TowxString(user.GetNick()));
+	ChatPanel* panel = GetUserChatPanel(user.GetNickWx());
 	if (panel != 0) {
 		panel->OnUserDisconnected();
 		panel->SetUser(0);
@@ -267,7 +267,7 @@ ChatPanel* MainChatTab::AddChatPanel(User& user)
 {
 	LOOP_PANELS(
 	    if (tmp->GetPanelType() == CPT_User) {
-			if ( m_chat_tabs->GetPageText(i) == TowxString(user.GetNick())) {
+			if ( m_chat_tabs->GetPageText(i) == user.GetNickWx()) {
 				m_chat_tabs->SetSelection( i );
 				tmp->SetUser( &user );
 				return tmp;
@@ -276,7 +276,7 @@ ChatPanel* MainChatTab::AddChatPanel(User& user)
 
 	int selection = m_chat_tabs->GetSelection();
 	ChatPanel* chat = new ChatPanel(m_chat_tabs, user, m_imagelist);
-	m_chat_tabs->InsertPage(m_chat_tabs->GetPageCount() - 1, chat, TowxString(user.GetNick()), true, wxBitmap(userchat_xpm));
+	m_chat_tabs->InsertPage(m_chat_tabs->GetPageCount() - 1, chat, user.GetNickWx(), true, wxBitmap(userchat_xpm));
 	if (selection > 0)
 		m_chat_tabs->SetSelection(selection);
 
@@ -32,6 +32,7 @@
 #include "channel/autojoinchanneldialog.h"
 #include "channel/channelchooserdialog.h"
 #include "chatpanel.h"
+#include "contentindex.h"
 #include "downloader/prdownloader.h"
 #include "gui/controls.h"
 #include "gui/customdialogs.h"
@@ -315,7 +316,7 @@ void MainWindow::OnUnitSyncReloadRequest(wxCommandEvent& /*unused*/)
 	// Ensure unitsync reload happens on the GUI thread (worker-thread reload has caused crashes
 	// with some engine bundles).
 	if (LSL::usync().ReloadUnitSyncLib()) {
-		GlobalEventManager::Instance()->Send(GlobalEventManager::OnUnitsyncReloaded);
+		ContentIndex::Instance()->UnitsyncReloaded();
 	} else {
 		wxLogWarning("Couldn't reload unitsync");
 		GlobalEventManager::Instance()->Send(GlobalEventManager::OnUnitsyncReloadFailed);
@@ -577,7 +578,7 @@ void MainWindow::OnUnitSyncReload(wxCommandEvent& /*unused*/)
 	bool res = LSL::usync().ReloadUnitSyncLib();
 	m_menuEdit->Enable(MENU_SETTINGSPP, false);
 	if (res) {
-		GlobalEventManager::Instance()->Send(GlobalEventManager::OnUnitsyncReloaded);
+		ContentIndex::Instance()->UnitsyncReloaded();
 		return;
 	}
 	wxLogWarning("Couldn't reload unitsync");
@@ -9,6 +9,7 @@
 #include <wx/string.h>
 #include <wx/translation.h>
 #include <utility>
+#include <vector>
 
 #include "gui/chatpanelmenu.h"
 #include "gui/mainwindow.h"
@@ -25,6 +26,7 @@ END_EVENT_TABLE()
 
 NickDataViewCtrl::NickDataViewCtrl(const wxString& dataViewName, wxWindow* parent, bool show_header, ChatPanelMenu* popup, bool /*highlight*/)
     : BaseDataViewCtrl(dataViewName, parent, NICK_DATAVIEW_CTRL_ID)
+    , m_resort_pending(false)
 {
 	m_menu = popup;
 
@@ -73,12 +75,15 @@ void NickDataViewCtrl::SetUsersFilterString(const wxString& fs)
 
 void NickDataViewCtrl::AddUser(const User& user)
 {
-	if (!AddRealUser(user)) {
+	const RealUser* entry = AddRealUser(user);
+	if (entry == nullptr) {
 		//User already added to widget
 		return;
 	}
 
-	DoUsersFilter();
+	if (ApplyFilter(*entry)) {
+		ScheduleResort();
+	}
 }
 
 void NickDataViewCtrl::RemoveUser(const User& user)
@@ -87,30 +92,42 @@ void NickDataViewCtrl::RemoveUser(const User& user)
 		return;
 	}
 
-	//Only remove added users
+	//Only remove added users, removing doesn't change the order of the others
 	if (ContainsItem(user)) {
-		RemoveItem(user);
+		RemoveItem(user, false);
 	}
 }
 
 void NickDataViewCtrl::UserUpdated(const User& user)
 {
+	const auto it = m_real_users_list.find(user.GetNick());
+	if (it == m_real_users_list.end()) {
+		return;
+	}
 
+	//Status changes may move the user, resort once for a burst of updates
 	if (ContainsItem(user)) {
-		RefreshItem(user);
+		RefreshItem(user, false);
 	}
-	DoUsersFilter();
+	ApplyFilter(it->second);
+	ScheduleResort();
 }
 
-void NickDataViewCtrl::SetUsers(const UserList::user_map_t& userlist)
+void NickDataViewCtrl::SetUsers(const UserList::user_vec_t& userlist)
 {
 	ClearUsers();
 
-	for (const auto& item : userlist) {
-		AddRealUser(*item.second);
+	std::vector<const User*> visible;
+	visible.reserve(userlist.size());
+	for (const User* user : userlist) {
+		const RealUser* entry = AddRealUser(*user);
+		if ((entry != nullptr) && checkFilteringConditions(*entry)) {
+			visible.push_back(user);
+		}
 	}
 
-	DoUsersFilter();
+	//Sorts once for all users
+	AddItems(visible);
 }
 
 void NickDataViewCtrl::ClearUsers()
@@ -126,25 +143,55 @@ int NickDataViewCtrl::GetUsersCount() const
 
 void NickDataViewCtrl::DoUsersFilter()
 {
-
+	std::vector<const User*> added;
 	for (auto const& item : m_real_users_list) {
+		const User& user = *item.second.user;
 		if (checkFilteringConditions(item.second)) {
 			//User passed filter. Add him/her to the list.
-			if (!ContainsItem(*item.second)) {
-				AddItem(*item.second);
+			if (!ContainsItem(user)) {
+				added.push_back(&user);
 			}
 		} else {
 			//Remove user from the list.
-			if (ContainsItem(*item.second)) {
-				RemoveItem(*item.second);
+			if (ContainsItem(user)) {
+				RemoveItem(user, false);
 			}
 		}
 	}
 
-	Resort();
+	AddItems(added);
 	Refresh();
 }
 
+//! adds or removes a single user according to the filter, returns true if the list changed
+bool NickDataViewCtrl::ApplyFilter(const RealUser& entry)
+{
+	const User& user = *entry.user;
+	const bool visible = ContainsItem(user);
+	if (checkFilteringConditions(entry)) {
+		if (!visible) {
+			AddItem(user, false);
+			return true;
+		}
+	} else if (visible) {
+		RemoveItem(user, false);
+		return true;
+	}
+	return false;
+}
+
+void NickDataViewCtrl::ScheduleResort()
+{
+	if (m_resort_pending) {
+		return;
+	}
+	m_resort_pending = true;
+	CallAfter([this]() {
+		m_resort_pending = false;
+		Resort();
+	});
+}
+
 void NickDataViewCtrl::SetTipWindowText(const long /*item_hit*/,
 					const wxPoint& /*position*/)
 {
@@ -156,28 +203,29 @@ void NickDataViewCtrl::HighlightItem(long /*item*/)
 	//TODO: implement!
 }
 
-bool NickDataViewCtrl::checkFilteringConditions(const User* user) const
+bool NickDataViewCtrl::checkFilteringConditions(const RealUser& entry) const
 {
 	//Filter out bots
-	if ((m_userFilterShowPlayersOnly) && (user->GetStatus().bot)) {
+	if ((m_userFilterShowPlayersOnly) && (entry.user->GetStatus().bot)) {
 		return false;
 	}
 	//Check users nicks
-	if (!TowxString(user->GetNick()).Lower().Contains(m_UsersFilterString)) {
+	if (!m_UsersFilterString.empty() && !entry.nick_lower.Contains(m_UsersFilterString)) {
 		return false;
 	}
 	//All is good, user passed
 	return true;
 }
 
-bool NickDataViewCtrl::AddRealUser(const User& user)
+const NickDataViewCtrl::RealUser* NickDataViewCtrl::AddRealUser(const User& user)
 {
-	if (IsContainsRealUser(user)) {
-		return false;
+	const auto result = m_real_users_list.emplace(user.GetNick(), RealUser{&user, wxEmptyString});
+	if (!result.second) {
+		return nullptr;
 	}
 
-	m_real_users_list[user.GetNick()] = &user;
-	return true;
+	result.first->second.nick_lower = user.GetNickWx().Lower();
+	return &result.first->second;
 }
 
 bool NickDataViewCtrl::RemoveRealUser(const User& user)
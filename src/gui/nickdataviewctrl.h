@@ -4,6 +4,7 @@
 #define SRC_GUI_NICKDATAVIEWCTRL_H_
 
 #include <map>
+#include <wx/string.h>
 #include "basedataviewctrl.h"
 #include "userlist.h"
 class wxWindow;
@@ -24,12 +25,17 @@ public:
 	void AddUser(const User& user);
 	void RemoveUser(const User& user);
 	void UserUpdated(const User& user);
-	void SetUsers(const UserList::user_map_t& userlist);
+	void SetUsers(const UserList::user_vec_t& userlist);
 	void ClearUsers();
 	int GetUsersCount() const;
 
 private:
-	bool AddRealUser(const User& user);
+	struct RealUser {
+		const User* user;
+		wxString nick_lower; //<- cached for filtering
+	};
+
+	const RealUser* AddRealUser(const User& user);
 	bool RemoveRealUser(const User& user);
 	void ClearRealUsers();
 	bool IsContainsRealUser(const User& user) const;
@@ -38,18 +44,21 @@ private:
 	void OnContextMenuEvent(wxDataViewEvent& event);
 
 	void DoUsersFilter();
+	bool ApplyFilter(const RealUser& entry);
+	void ScheduleResort();
 	void SetTipWindowText(const long item_hit, const wxPoint& position);
 
 	void HighlightItem(long item);
 
-	bool checkFilteringConditions(const User*) const;
+	bool checkFilteringConditions(const RealUser& entry) const;
 
 private:
 	bool m_userFilterShowPlayersOnly;
+	bool m_resort_pending; //<- Resort() is queued with CallAfter
 	ChatPanelMenu* m_menu;
 
 	wxString m_UsersFilterString;			      //<- String with filter pattern for nicklist
-	std::map<std::string, const User*> m_real_users_list; //<- actual list of users (not filtered)
+	std::map<std::string, RealUser> m_real_users_list;    //<- actual list of users (not filtered)
 
 private:
 	enum {
@@ -13,6 +13,7 @@
 #include "sound/alsound.h"
 #include "spring.h"
 #include "utils/globalevents.h"
+#include "utils/ircformat.h"
 #include "utils/slconfig.h"
 
 #ifdef HAVE_LIBNOTIFY
@@ -82,7 +83,8 @@ void NotificationManager::ShowNotification(const UiEvents::NotficationData& data
 		if (m_notification_wrapper && !(disable_if_ingame && spring().IsRunning())) {
 			//! \todo use image from customizations
 			wxBitmap nmp(charArr2wxBitmap(springlobby_64_png, sizeof(springlobby_64_png)));
-			m_notification_wrapper->Show(nmp, sett().GetNotificationPopupPosition(), data);
+			UiEvents::NotficationData plain(data.first, StripIrcFormatting(data.second.ToStdWstring()));
+			m_notification_wrapper->Show(nmp, sett().GetNotificationPopupPosition(), plain);
 		}
 	}
 	if (sett().GetChatPMSoundNotificationEnabled())
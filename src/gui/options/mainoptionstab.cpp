@@ -15,6 +15,7 @@
 
 #include "aui/auimanager.h"
 #include "chatoptionstab.h"
+#include "contentindex.h"
 #include "downloadoptionspanel.h"
 #include "groupoptionspanel.h"
 #include "gui/controls.h"
@@ -112,7 +113,7 @@ void MainOptionsTab::OnApply(wxCommandEvent& event)
 
 	sett().SaveSettings();
 
-	GlobalEventManager::Instance()->Send(GlobalEventManager::OnUnitsyncReloaded);
+	ContentIndex::Instance()->UnitsyncReloaded();
 }
 
 void MainOptionsTab::OnOk(wxCommandEvent& event)
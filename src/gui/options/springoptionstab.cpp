@@ -31,6 +31,7 @@
 #include <wx/msw/registry.h>
 #endif
 
+#include "contentindex.h"
 #include "gui/controls.h"
 #include "gui/customdialogs.h"
 #include "gui/mainwindow.h"
@@ -192,6 +193,7 @@ void SpringOptionsTab::DoRestore()
 void SpringOptionsTab::OnAutoConf(wxCommandEvent& /*unused*/)
 {
 	SlPaths::RefreshSpringVersionList(true);
+	ContentIndex::Instance()->RefreshEngines();
 	ReloadSpringList();
 }
 
@@ -302,6 +304,7 @@ void SpringOptionsTab::OnAddBundle(wxCommandEvent& /*event*/)
 		m_sync_edit->SetValue(TowxString(bundle.unitsync));
 		m_exec_edit->SetValue(TowxString(bundle.spring));
 		SlPaths::RefreshSpringVersionList(false, &bundle);
+		ContentIndex::Instance()->RefreshEngines();
 		DoRestore();
 	}
 }
@@ -396,7 +399,9 @@ void SpringOptionsTab::SwitchUnitsync(const std::string& newIndex, const std::st
 		  GetSpringlobbyName().c_str()), _("Spring error"), wxOK);
 		SlPaths::SetUsedSpringIndex(oldIndex);
 		DoRestore();
+		return;
 	}
+	ContentIndex::Instance()->UnitsyncReloaded();
 }
 
 void SpringOptionsTab::OnRemoveBundle(wxCommandEvent& /*event*/)
@@ -408,6 +413,7 @@ void SpringOptionsTab::OnRemoveBundle(wxCommandEvent& /*event*/)
 	}
 	SlPaths::DeleteSpringVersionbyIndex(index);
 	SlPaths::RefreshSpringVersionList(false);
+	ContentIndex::Instance()->RefreshEngines();
 	ReloadSpringList();
 	const std::string newIndex = STD_STRING(m_spring_list->GetStringSelection());
 }
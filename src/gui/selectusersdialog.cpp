@@ -119,7 +119,7 @@ void SelectUsersDialog::PopulateUsersList()
 
 		wxWindowUpdateLocker noUpdates(m_user_list);
 		for (unsigned int i = 0; i < userlist.GetNumUsers(); ++i) {
-			wxString name = TowxString(userlist.GetUser(i).GetNick());
+			wxString name = userlist.GetUser(i).GetNickWx();
 			if (!useractions().IsKnown(name) && !ui().IsThisMe(name)) {
 				wxString country = TowxString(userlist.GetUser(i).GetCountry());
 				AddUserToList(name, country);
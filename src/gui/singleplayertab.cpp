@@ -16,6 +16,7 @@
 #include <wx/stattext.h>
 
 #include "aui/auimanager.h"
+#include "contentindex.h"
 #include "gui/colorbutton.h"
 #include "gui/controls.h"
 #include "gui/customdialogs.h"
@@ -430,7 +431,9 @@ void SinglePlayerTab::OnEngineSelect(wxCommandEvent& /*event*/)
 
 	SlPaths::SetUsedSpringIndex(selection);
 	m_battle.SetEngineVersion(selection);
-	LSL::usync().ReloadUnitSyncLib();
+	if (LSL::usync().ReloadUnitSyncLib()) {
+		ContentIndex::Instance()->UnitsyncReloaded();
+	}
 }
 
 void SinglePlayerTab::OnMapBrowse(wxCommandEvent& /*unused*/)
@@ -9,6 +9,8 @@
 #include <wx/statbmp.h>
 #include <wx/stattext.h>
 #include <wx/timer.h>
+#include <algorithm>
+#include <cstdint>
 
 #include "downloader/prdownloader.h"
 #include "log.h"
@@ -49,7 +51,7 @@ TaskBar::TaskBar(wxWindow* statusbar)
 	SUBSCRIBE_GLOBAL_EVENT(GlobalEventManager::OnDownloadStarted, TaskBar::OnDownloadStarted);
 	SUBSCRIBE_GLOBAL_EVENT(GlobalEventManager::OnDownloadFailed, TaskBar::OnDownloadFailed);
 	SUBSCRIBE_GLOBAL_EVENT(GlobalEventManager::OnDownloadComplete, TaskBar::OnDownloadComplete);
-	SUBSCRIBE_GLOBAL_EVENT(GlobalEventManager::OnDownloadProgress, TaskBar::OnDownloadProgress);
+	SUBSCRIBE_GLOBAL_EVENT_COALESCED(GlobalEventManager::OnDownloadProgress, TaskBar::OnDownloadProgress);
 }
 
 TaskBar::~TaskBar()
@@ -129,12 +131,32 @@ void TaskBar::OnTimer(wxTimerEvent&)
 
 void TaskBar::UpdateProgress()
 {
-	PrDownloader::DownloadProgress p;
-	prDownloader().GetProgress(p);
+	std::string name;
+	int running = 0;
+	int64_t downloaded = 0;
+	int64_t filesize = 0;
+	for (const PrDownloader::DownloadProgress& p : PrDownloader::GetAllProgress()) {
+		if (!p.running) {
+			continue;
+		}
+		name = p.name;
+		running++;
+		// downloads of unknown size would push the gauge past the end
+		if (p.filesize > 0) {
+			downloaded += std::min(p.downloaded, p.filesize);
+			filesize += p.filesize;
+		}
+	}
+	if (running == 0) {
+		return;
+	}
 
-	int progress = (int)p.GetProgressPercent();
-	text->SetLabel(wxString::Format(_("Downloading %s"), TowxString(p.name)));
-	gauge->SetValue(progress);
+	if (running == 1) {
+		text->SetLabel(wxString::Format(_("Downloading %s"), TowxString(name)));
+	} else {
+		text->SetLabel(wxString::Format(_("Downloading %s and %d more"), TowxString(name), running - 1));
+	}
+	gauge->SetValue(filesize > 0 ? (int)(downloaded * 100 / filesize) : 0);
 }
 
 void TaskBar::EnsureTimerRemoved()
@@ -19,6 +19,7 @@
 #include <stdexcept>
 
 #include "channel.h"
+#include "contentindex.h"
 #include "downloader/prdownloader.h"
 #include "exception.h"
 #include "gui/agreementdialog.h"
@@ -306,7 +307,7 @@ void Ui::OnLoggedIn()
 	if (m_main_win == nullptr)
 		return;
 	mw().GetChatTab().OnLoggedIn();
-	mw().GetBattleListTab().SortBattleList();
+	mw().GetBattleListTab().AddAllBattles();
 }
 
 void Ui::OnDisconnected(IServer& server, bool wasonline)
@@ -392,16 +393,21 @@ void Ui::OnUserOffline(User& user)
 }
 
 
+void Ui::UpdateUserInChannels(User& user)
+{
+	for (Channel* chan : user.GetChannels()) {
+		if (chan->panel != nullptr) {
+			chan->panel->UserStatusUpdated(user);
+		}
+	}
+}
+
+
 void Ui::OnUserStatusChanged(User& user)
 {
 	if (m_main_win == nullptr)
 		return;
-	for (int i = 0; i < m_serv->GetNumChannels(); i++) {
-		Channel& chan = m_serv->GetChannel(i);
-		if ((chan.UserExists(user.GetNick())) && (chan.panel != nullptr)) {
-			chan.panel->UserStatusUpdated(user);
-		}
-	}
+	UpdateUserInChannels(user);
 	if (user.panel != nullptr) {
 		user.panel->UserStatusUpdated(user);
 	}
@@ -473,7 +479,7 @@ void Ui::OnUserSaid(User& chan, User& user, const wxString& message)
 	if (chan.panel == nullptr) {
 		mw().OpenPrivateChat(chan);
 	}
-	chan.panel->Said(TowxString(user.GetNick()), message);
+	chan.panel->Said(user.GetNickWx(), message);
 }
 
 void Ui::OnUserSaidEx(User& chan, User& user, const wxString& action)
@@ -483,7 +489,7 @@ void Ui::OnUserSaidEx(User& chan, User& user, const wxString& action)
 	if (chan.panel == 0) {
 		mw().OpenPrivateChat(chan);
 	}
-	chan.panel->DidAction(TowxString(user.GetNick()), action);
+	chan.panel->DidAction(user.GetNickWx(), action);
 }
 
 void Ui::OnBattleOpened(IBattle& battle)
@@ -493,12 +499,7 @@ void Ui::OnBattleOpened(IBattle& battle)
 	mw().GetBattleListTab().AddBattle(battle);
 	try {
 		User& user = battle.GetFounder();
-		for (int i = 0; i < m_serv->GetNumChannels(); i++) {
-			Channel& chan = m_serv->GetChannel(i);
-			if ((chan.UserExists(user.GetNick())) && (chan.panel != nullptr)) {
-				chan.panel->UserStatusUpdated(user);
-			}
-		}
+		UpdateUserInChannels(user);
 	} catch (const std::exception& e) {
 		wxLogWarning(_T("Exception: %s"), e.what());
 	}
@@ -522,17 +523,13 @@ void Ui::OnBattleClosed(IBattle& battle)
 		wxLogWarning(_T("Exception: %s"), e.what());
 	}
 
-	for (auto userpair : battle.GetUsers()) {
-		assert(userpair.second != nullptr);
+	const UserList::user_vec_t users = battle.GetUsers();
+	for (User* battleuser : users) {
+		assert(battleuser != nullptr);
 
-		User& user = *userpair.second;
+		User& user = *battleuser;
 		user.SetBattle(0);
-		for (int i = 0; i < m_serv->GetNumChannels(); i++) {
-			Channel& chan = m_serv->GetChannel(i);
-			if ((chan.UserExists(user.GetNick())) && (chan.panel != nullptr)) {
-				chan.panel->UserStatusUpdated(user);
-			}
-		}
+		UpdateUserInChannels(user);
 	}
 }
 
@@ -552,12 +549,7 @@ void Ui::OnUserJoinedBattle(IBattle& battle, User& user)
 		wxLogWarning(_T("Exception: %s"), e.what());
 	}
 
-	for (int i = 0; i < m_serv->GetNumChannels(); i++) {
-		Channel& chan = m_serv->GetChannel(i);
-		if ((chan.UserExists(user.GetNick())) && (chan.panel != nullptr)) {
-			chan.panel->UserStatusUpdated(user);
-		}
-	}
+	UpdateUserInChannels(user);
 }
 
 
@@ -584,12 +576,7 @@ void Ui::OnUserLeftBattle(IBattle& battle, User& user, bool isbot)
 	}
 	if (isbot)
 		return;
-	for (int i = 0; i < m_serv->GetNumChannels(); i++) {
-		Channel& chan = m_serv->GetChannel(i);
-		if ((chan.UserExists(user.GetNick())) && (chan.panel != nullptr)) {
-			chan.panel->UserStatusUpdated(user);
-		}
-	}
+	UpdateUserInChannels(user);
 }
 
 void Ui::OnBattleInfoUpdated(IBattle& battle, const wxString& Tag)
@@ -715,12 +702,12 @@ void Ui::OnRing(const wxString& from)
 
 bool Ui::IsThisMe(User& other) const
 {
-	return IsThisMe(TowxString(other.GetNick()));
+	return IsThisMe(other.GetNickWx());
 }
 
 bool Ui::IsThisMe(const User* other) const
 {
-	return ((other != nullptr) && IsThisMe(TowxString(other->GetNick())));
+	return ((other != nullptr) && IsThisMe(other->GetNickWx()));
 }
 
 bool Ui::IsThisMe(const wxString& other) const
@@ -933,16 +920,10 @@ static bool requested(DownloadEnum::Category req, DownloadEnum::Category cat)
 	return false;
 }
 
-bool Ui::NeedsDownload(const IBattle* battle, bool uiprompt, DownloadEnum::Category cat)
+// the content of battle which isn't there, stodl gets a line for each
+static std::vector<PrDownloader::Content> MissingContent(const IBattle* battle, DownloadEnum::Category cat, std::string& stodl)
 {
-	if (battle == nullptr) {
-		wxLogWarning("Battle is null, nothing required!");
-		return true;
-	}
-	bool needstuff = false;
-	std::string stodl;
-	std::list<std::pair<DownloadEnum::Category, std::string>> todl;
-
+	std::vector<PrDownloader::Content> todl;
 	if (requested(cat, DownloadEnum::CAT_ENGINE) && !battle->EngineExists() && !battle->GetEngineName().empty() && !battle->GetEngineVersion().empty()) {
 		stodl.append("- engine " + battle->GetEngineName() + " " + battle->GetEngineVersion() + "\n");
 		todl.push_back(std::make_pair(DownloadEnum::CAT_ENGINE, battle->GetEngineName() + " " + battle->GetEngineVersion()));
@@ -955,7 +936,18 @@ bool Ui::NeedsDownload(const IBattle* battle, bool uiprompt, DownloadEnum::Categ
 		stodl.append("- game " + battle->GetHostGameNameAndVersion() + "\n");
 		todl.push_back(std::make_pair(DownloadEnum::CAT_GAME, battle->GetHostGameNameAndVersion()));
 	}
+	return todl;
+}
 
+bool Ui::NeedsDownload(const IBattle* battle, bool uiprompt, DownloadEnum::Category cat)
+{
+	if (battle == nullptr) {
+		wxLogWarning("Battle is null, nothing required!");
+		return true;
+	}
+	bool needstuff = false;
+	std::string stodl;
+	const std::vector<PrDownloader::Content> todl = MissingContent(battle, cat, stodl);
 
 	if (!todl.empty()) {
 		needstuff = true;
@@ -967,7 +959,7 @@ bool Ui::NeedsDownload(const IBattle* battle, bool uiprompt, DownloadEnum::Categ
 		}
 
 		for (auto dl : todl) {
-			prDownloader().Download(dl.first, dl.second);
+			prDownloader().Download(dl.first, dl.second, "", DownloadScheduler::PRIORITY_BATTLE);
 		}
 	}
 
@@ -976,17 +968,28 @@ bool Ui::NeedsDownload(const IBattle* battle, bool uiprompt, DownloadEnum::Categ
 		return needstuff;
 	}
 
-	const std::string compatversion = SlPaths::GetCompatibleVersion(battle->GetEngineVersion());
+	const std::string compatversion = ContentIndex::Instance()->GetCompatibleEngine(battle->GetEngineVersion());
 	if (compatversion == SlPaths::GetCurrentUsedSpringIndex()) {
 		return needstuff;
 	}
 	wxLogWarning("Required engine version doesn't match current selected version, switching to %s", compatversion.c_str());
 	SlPaths::SetUsedSpringIndex(compatversion);
-	LSL::usync().ReloadUnitSyncLib();
+	if (LSL::usync().ReloadUnitSyncLib()) {
+		ContentIndex::Instance()->UnitsyncReloaded();
+	}
 
 	return true;
 }
 
+void Ui::PrefetchContent(const IBattle* battle)
+{
+	if (battle == nullptr || !PrDownloader::IsPrefetchEnabled()) {
+		return;
+	}
+	std::string stodl;
+	prDownloader().Prefetch(MissingContent(battle, DownloadEnum::CAT_NONE, stodl));
+}
+
 void Ui::OnInvalidFingerprintReceived(const std::string& fingerprint, const std::string& expected_fingerprint)
 {
 	int answer = wxCANCEL;
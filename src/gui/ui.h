@@ -110,6 +110,8 @@ public:
 
 	// return true when engine/game/map is missing & prompts user to dl when needed
 	bool NeedsDownload(const IBattle* battle, bool uiprompt = true, DownloadEnum::Category cat = DownloadEnum::CAT_NONE);
+	//! downloads what's missing for battle in the background, if enabled
+	void PrefetchContent(const IBattle* battle);
 
 	bool IsThisMe(User& other) const;
 	bool IsThisMe(const User* other) const;
@@ -128,6 +130,8 @@ public:
 private:
 	void OnLobbyDownloaded(wxCommandEvent& /*data*/);
 	void Notify();
+	//! refresh user in the nick lists of the channels it is in
+	void UpdateUserInChannels(User& user);
 
 	IServer* m_serv;
 	MainWindow* m_main_win;
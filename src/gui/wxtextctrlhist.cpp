@@ -1,7 +1,7 @@
 /* This file is part of the Springlobby (GPL v2 or later), see COPYING */
 #include "wxtextctrlhist.h"
 
-#include <wx/regex.h>
+#include <wx/wxcrt.h>
 
 #include "gui/mainchattab.h"
 #include "gui/mainwindow.h"
@@ -15,12 +15,6 @@ EVT_TEXT_ENTER(wxID_ANY, wxTextCtrlHist::OnSendMessage)
 EVT_KEY_DOWN(wxTextCtrlHist::OnChar)
 END_EVENT_TABLE()
 
-void GetArrayStringFromHashMap(const HashMap_String_String& hm, wxArrayString& matches)
-{
-	for (HashMap_String_String::const_iterator it = hm.begin(); it != hm.end(); ++it)
-		matches.Add(it->second);
-}
-
 wxTextCtrlHist::wxTextCtrlHist(TextCompletionDatabase& textDb, wxWindow* parent, wxWindowID id, const wxString& value, const wxPoint& pos, const wxSize& size, long /*unused*/)
     : wxTextCtrl(parent, id, value, pos, size, wxTE_PROCESS_ENTER | wxTE_PROCESS_TAB)
     , textcompletiondatabase(textDb)
@@ -83,39 +77,39 @@ void wxTextCtrlHist::OnChar(wxKeyEvent& event)
 			wxString selection_Begin_InsertPos = this->GetRange(0, pos_Cursor);
 			wxString selection_InsertPos_End = this->GetRange(pos_Cursor, this->GetLastPosition());
 
-			// Search for the shortest Match, starting from the Insertionpoint to the left, until we find a "\ "
-			// Special Characters according to regular Expression Syntax needs to be escaped: [,]
-			wxRegEx regex_currentWord;
-#ifdef wxHAS_REGEX_ADVANCED
-			regex_currentWord.Compile(wxT("(_|\\[|\\]|\\w)+$"), wxRE_ADVANCED);
-#else
-			regex_currentWord.Compile(wxT("(_|\\[|\\]|\\w)+$"), wxRE_EXTENDED);
-#endif
-
-			if (regex_currentWord.Matches(selection_Begin_InsertPos)) {
-				wxString currentWord = regex_currentWord.GetMatch(selection_Begin_InsertPos);
+			// Search for the shortest Match, starting from the Insertionpoint to the left, until we find a character not allowed in nicks
+			size_t word_Begin = selection_Begin_InsertPos.length();
+			while (word_Begin > 0) {
+				const wxUniChar c = selection_Begin_InsertPos[word_Begin - 1];
+				if (!wxIsalnum(c) && c != '_' && c != '[' && c != ']') {
+					break;
+				}
+				--word_Begin;
+			}
+
+			if (word_Begin < selection_Begin_InsertPos.length()) {
+				wxString currentWord = selection_Begin_InsertPos.Mid(word_Begin);
 				// std::cout << "#########: Current Word: (" << currentWord.char_str() << ")" << std::endl;
 
 				wxString selection_Begin_BeforeCurrentWord = this->GetRange(0, pos_Cursor - currentWord.length());
 				// std::cout << "#########: selection_Begin_BeforeCurrentWord: (" << selection_Begin_BeforeCurrentWord.char_str() << ")" << std::endl;
 
-				HashMap_String_String hm = textcompletiondatabase.GetMapping(currentWord);
+				const std::vector<TextCompletionDatabase::Mapping> matches = textcompletiondatabase.GetMapping(currentWord);
 
-				// std::cout << "#########: Mapping-Size: (" << hm.size() << ")" << std::endl;
+				// std::cout << "#########: Mapping-Size: (" << matches.size() << ")" << std::endl;
 
 				wxString completed_Text;
 				int new_Cursor_Pos = 0;
-				if (hm.size() == 1) {
+				if (matches.size() == 1) {
 					completed_Text.append(selection_Begin_BeforeCurrentWord);
-					completed_Text.append(hm.begin()->second);
+					completed_Text.append(matches[0].mapping);
 					completed_Text.append(selection_InsertPos_End);
-					new_Cursor_Pos = selection_Begin_BeforeCurrentWord.length() + hm.begin()->second.length();
+					new_Cursor_Pos = selection_Begin_BeforeCurrentWord.length() + matches[0].mapping.length();
 				} else {
 					//match nearest only makes sense when there's actually more than one match
-					if (hm.size() > 1 && sett().GetCompletionMethod() == Settings::MatchNearest) {
-						wxArrayString matches;
-						GetArrayStringFromHashMap(hm, matches);
-						wxString newWord = GetBestMatch(matches, currentWord);
+					if (matches.size() > 1 && sett().GetCompletionMethod() == Settings::MatchNearest) {
+						// the matches are ranked, the first one is the nearest
+						wxString newWord = matches[0].mapping;
 
 						bool realCompletion = newWord.Len() >= currentWord.Len(); // otherwise we have actually less word than before :P
 						if (realCompletion)
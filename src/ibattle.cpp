@@ -20,6 +20,7 @@ lsl/battle/ibattle.cpp
 #include <wx/tokenzr.h>
 #include <algorithm>
 
+#include "contentindex.h"
 #include "gui/ui.h"
 #include "gui/uiutils.h"
 #include "iserver.h"
@@ -42,9 +43,7 @@ IBattle::IBattle()
     , m_ingame(false)
     , m_map_loaded(false)
     , m_game_loaded(false)
-    , m_players_ready(0)
-    , m_players_sync(0)
-    , m_players_ok(0)
+    , m_status_counts_valid(false)
     , m_start_time(0)
 {
 }
@@ -158,7 +157,7 @@ const std::vector<LSL::lslColor>& IBattle::GetFixColoursPalette(int numteams) co
 
 LSL::lslColor IBattle::GetFixColour(int i) const
 {
-	int size = m_teams_sizes.size();
+	int size = m_status_counts.teams.size();
 	const std::vector<LSL::lslColor>& palette = GetFixColoursPalette(size);
 	return palette[i];
 }
@@ -204,14 +203,14 @@ LSL::lslColor IBattle::GetFreeColour(User*) const
 	    ColorVec;
 
 	ColorVec current_used_colors;
-	for (user_map_t::size_type i = 0; i < GetNumUsers(); ++i) {
+	for (size_type i = 0; i < GetNumUsers(); ++i) {
 		UserBattleStatus& bs = GetUser(i).BattleStatus();
 		current_used_colors.push_back(bs.colour);
 	}
 
 	int inc = 1;
 	while (true) {
-		ColorVec fixcolourspalette(GetFixColoursPalette(m_teams_sizes.size() + inc++));
+		ColorVec fixcolourspalette(GetFixColoursPalette(m_status_counts.teams.size() + inc++));
 
 		ColorVec::iterator fixcolourspalette_new_end = std::unique(fixcolourspalette.begin(), fixcolourspalette.end(), AreColoursSimilarProxy(20));
 
@@ -244,7 +243,7 @@ int IBattle::GetFreeTeam(bool excludeme) const
 	bool changed = true;
 	while (changed) {
 		changed = false;
-		for (user_map_t::size_type i = 0; i < GetNumUsers(); i++) {
+		for (size_type i = 0; i < GetNumUsers(); i++) {
 			User& user = GetUser(i);
 			if ((&user == &GetMe()) && excludeme)
 				continue;
@@ -261,7 +260,7 @@ int IBattle::GetFreeTeam(bool excludeme) const
 
 int IBattle::GetClosestFixColour(const LSL::lslColor& col, const std::vector<int>& excludes, int difference) const
 {
-	const std::vector<LSL::lslColor>& palette = GetFixColoursPalette(m_teams_sizes.size() + 1);
+	const std::vector<LSL::lslColor>& palette = GetFixColoursPalette(m_status_counts.teams.size() + 1);
 	int result = 0;
 	int t1 = palette.size();
 	int t2 = excludes.size();
@@ -293,22 +292,10 @@ User& IBattle::OnUserAdded(User& user)
 		pos = GetFreePosition();
 		UserPositionChanged(user);
 	}
-	if (!bs.spectator) {
-		PlayerJoinedAlly(bs.ally);
-		PlayerJoinedTeam(bs.team);
-	}
-	if (bs.spectator && IsFounderMe())
-		m_opts.spectators++;
-	if (!bs.spectator && !bs.IsBot()) {
-		if (bs.ready)
-			m_players_ready++;
-		if (bs.sync)
-			m_players_sync++;
-		if (!bs.ready || !bs.sync)
-			m_ready_up_map[user.GetNick()] = time(0);
-		if (bs.ready && bs.sync)
-			m_players_ok++;
-	}
+	// joins as an unready player, which keeps the counters valid
+	CountUserStatus(bs, 1);
+	if (!bs.IsBot())
+		m_ready_up_map[user.GetNickId()] = time(0);
 	return user;
 }
 
@@ -343,29 +330,16 @@ void IBattle::OnUserBattleStatusUpdated(User& user, UserBattleStatus status)
 
 	user.UpdateBattleStatus(status);
 	unsigned int oldspeccount = m_opts.spectators;
-	m_opts.spectators = 0;
-	m_players_sync = 0;
-	m_players_ready = 0;
-	m_players_ok = 0;
-	m_teams_sizes.clear();
-	m_ally_sizes.clear();
-	for (unsigned int i = 0; i < GetNumUsers(); i++) {
-		User& loopuser = GetUser(i);
-		UserBattleStatus& loopstatus = loopuser.BattleStatus();
-		if (loopstatus.spectator)
-			m_opts.spectators++;
-		else {
-			PlayerJoinedTeam(loopstatus.team);
-			PlayerJoinedAlly(loopstatus.ally);
-			if (!loopstatus.IsBot()) {
-				if (loopstatus.ready && loopstatus.spectator)
-					m_players_ready++;
-				if (loopstatus.sync)
-					m_players_sync++;
-				if (loopstatus.ready && loopstatus.sync)
-					m_players_ok++;
-			}
-		}
+	// the gui modifies the status of bots and of myself directly, so only
+	// trust the previous status of other players
+	if (m_status_counts_valid && (&user != &GetMe()) && !previousstatus.IsBot() && !user.BattleStatus().IsBot()) {
+		CountUserStatus(previousstatus, -1);
+		CountUserStatus(user.BattleStatus(), 1);
+#ifndef NDEBUG
+		CheckUserStatusCounts();
+#endif
+	} else {
+		RecountUserStatus();
 	}
 	if (oldspeccount != m_opts.spectators) {
 		if (IsFounderMe())
@@ -373,20 +347,52 @@ void IBattle::OnUserBattleStatusUpdated(User& user, UserBattleStatus status)
 	}
 	if (!status.IsBot()) {
 		if ((status.ready && status.sync) || status.spectator) {
-			std::map<std::string, time_t>::iterator itor = m_ready_up_map.find(user.GetNick());
+			std::map<StringId, time_t>::iterator itor = m_ready_up_map.find(user.GetNickId());
 			if (itor != m_ready_up_map.end()) {
 				m_ready_up_map.erase(itor);
 			}
 		}
 		if ((!status.ready || !status.sync) && !status.spectator) {
-			std::map<std::string, time_t>::iterator itor = m_ready_up_map.find(user.GetNick());
+			std::map<StringId, time_t>::iterator itor = m_ready_up_map.find(user.GetNickId());
 			if (itor == m_ready_up_map.end()) {
-				m_ready_up_map[user.GetNick()] = time(0);
+				m_ready_up_map[user.GetNickId()] = time(0);
 			}
 		}
 	}
 }
 
+void IBattle::CountUserStatus(const UserBattleStatus& status, int delta)
+{
+	if (status.spectator) {
+		m_opts.spectators += delta;
+	} else if (delta > 0) {
+		m_status_counts.Add(status);
+	} else {
+		m_status_counts.Remove(status);
+	}
+}
+
+void IBattle::RecountUserStatus()
+{
+	m_opts.spectators = 0;
+	m_status_counts.Clear();
+	for (size_type i = 0; i < GetNumUsers(); i++) {
+		CountUserStatus(GetUser(i).BattleStatus(), 1);
+	}
+	m_status_counts_valid = true;
+}
+
+void IBattle::CheckUserStatusCounts()
+{
+	const unsigned int spectators = m_opts.spectators;
+	const BattleStatusCounts counts = m_status_counts;
+	RecountUserStatus();
+	if (spectators != m_opts.spectators || counts != m_status_counts) {
+		wxLogWarning("Battle %d: incremental status counts differ from recount (specs %u/%u ready %u/%u sync %u/%u ok %u/%u)",
+			     GetBattleId(), spectators, m_opts.spectators, counts.ready, m_status_counts.ready, counts.sync, m_status_counts.sync, counts.ok, m_status_counts.ok);
+	}
+}
+
 bool IBattle::ShouldAutoStart() const
 {
 	if (GetInGame())
@@ -401,20 +407,12 @@ bool IBattle::ShouldAutoStart() const
 void IBattle::OnUserRemoved(User& user)
 {
 	UserBattleStatus& bs = user.BattleStatus();
-	if (!bs.spectator) {
-		PlayerLeftTeam(bs.team);
-		PlayerLeftAlly(bs.ally);
-	}
-	if (!bs.spectator && !bs.IsBot()) {
-		if (bs.ready)
-			m_players_ready--;
-		if (bs.sync)
-			m_players_sync--;
-		if (bs.ready && bs.sync)
-			m_players_ok--;
-	}
+	// the gui modifies the status of bots and of myself directly, it may not be the counted one
+	if ((&user == &GetMe()) || bs.IsBot())
+		m_status_counts_valid = false;
+	if (!bs.spectator || m_opts.spectators > 0)
+		CountUserStatus(bs, -1);
 	if (IsFounderMe() && bs.spectator) {
-		m_opts.spectators--;
 		SendHostInfo(HI_Spectators);
 	}
 	if (&user == &GetMe()) {
@@ -425,7 +423,8 @@ void IBattle::OnUserRemoved(User& user)
 	else {
 		m_bot_size --;
 	}
-	UserList::RemoveUser(user.GetNick());
+	m_ready_up_map.erase(user.GetNickId()); // the nick id may be reused once the user is gone
+	UserList::RemoveUser(user.GetNickId());
 }
 
 
@@ -580,6 +579,7 @@ void IBattle::ForceSide(User& user, int side)
 void IBattle::ForceTeam(User& user, int team)
 {
 	if (IsFounderMe() || user.BattleStatus().IsBot()) {
+		m_status_counts_valid = false;
 		if (!user.BattleStatus().spectator) {
 			PlayerLeftTeam(user.BattleStatus().team);
 			PlayerJoinedTeam(team);
@@ -593,6 +593,7 @@ void IBattle::ForceAlly(User& user, int ally)
 {
 
 	if (IsFounderMe() || user.BattleStatus().IsBot()) {
+		m_status_counts_valid = false;
 		if (!user.BattleStatus().spectator) {
 			PlayerLeftAlly(user.BattleStatus().ally);
 			PlayerJoinedAlly(ally);
@@ -611,61 +612,42 @@ void IBattle::ForceColour(User& user, const LSL::lslColor& col)
 
 void IBattle::PlayerJoinedTeam(int team)
 {
-	std::map<int, int>::const_iterator itor = m_teams_sizes.find(team);
-	if (itor == m_teams_sizes.end())
-		m_teams_sizes[team] = 1;
-	else
-		m_teams_sizes[team] = m_teams_sizes[team] + 1;
+	BattleStatusCounts::Join(m_status_counts.teams, team);
 }
 
 void IBattle::PlayerJoinedAlly(int ally)
 {
-	std::map<int, int>::const_iterator iter = m_ally_sizes.find(ally);
-	if (iter == m_ally_sizes.end())
-		m_ally_sizes[ally] = 1;
-	else
-		m_ally_sizes[ally] = m_ally_sizes[ally] + 1;
+	BattleStatusCounts::Join(m_status_counts.allies, ally);
 }
 
 void IBattle::PlayerLeftTeam(int team)
 {
-	std::map<int, int>::iterator itor = m_teams_sizes.find(team);
-	if (itor != m_teams_sizes.end()) {
-		itor->second = itor->second - 1;
-		if (itor->second == 0) {
-			m_teams_sizes.erase(itor);
-		}
-	}
+	BattleStatusCounts::Leave(m_status_counts.teams, team);
 }
 
 void IBattle::PlayerLeftAlly(int ally)
 {
-	std::map<int, int>::iterator iter = m_ally_sizes.find(ally);
-	if (iter != m_ally_sizes.end()) {
-		iter->second = iter->second - 1;
-		if (iter->second == 0) {
-			m_ally_sizes.erase(iter);
-		}
-	}
+	BattleStatusCounts::Leave(m_status_counts.allies, ally);
 }
 
 void IBattle::ForceSpectator(User& user, bool spectator)
 {
 	if (IsFounderMe() || user.BattleStatus().IsBot()) {
+		m_status_counts_valid = false;
 		UserBattleStatus& status = user.BattleStatus();
 
 		if (!status.spectator) { // leaving spectator status
 			PlayerJoinedTeam(status.team);
 			PlayerJoinedAlly(status.ally);
 			if (status.ready && !status.IsBot())
-				m_players_ready++;
+				m_status_counts.ready++;
 		}
 
 		if (spectator) { // entering spectator status
 			PlayerLeftTeam(status.team);
 			PlayerLeftAlly(status.ally);
 			if (status.ready && !status.IsBot())
-				m_players_ready--;
+				m_status_counts.ready--;
 		}
 
 		if (IsFounderMe()) {
@@ -885,17 +867,17 @@ bool IBattle::MapExists(bool comparehash) const
 		return false;
 	}
 	if (comparehash) {
-		return LSL::usync().MapExists(m_host_map.name, m_host_map.hash);
+		return ContentIndex::Instance()->MapExists(m_host_map.name, m_host_map.hash);
 	}
-	return LSL::usync().MapExists(m_host_map.name, "");
+	return ContentIndex::Instance()->MapExists(m_host_map.name);
 }
 
 
 bool IBattle::GameExists(bool comparehash) const
 {
 	if (comparehash)
-		return LSL::usync().GameExists(m_host_game.name, m_host_game.hash);
-	return LSL::usync().GameExists(m_host_game.name, "");
+		return ContentIndex::Instance()->GameExists(m_host_game.name, m_host_game.hash);
+	return ContentIndex::Instance()->GameExists(m_host_game.name);
 }
 
 void IBattle::RestrictUnit(const std::string& unitname, int count)
@@ -937,11 +919,8 @@ void IBattle::OnSelfLeftBattle()
 		}
 	}
 	ClearStartRects();
-	m_teams_sizes.clear();
-	m_ally_sizes.clear();
-	m_players_ready = 0;
-	m_players_sync = 0;
-	m_players_ok = 0;
+	m_status_counts.Clear();
+	m_status_counts_valid = false;
 	LSL::usync().UnSetCurrentArchive(); //left battle
 }
 
@@ -1225,11 +1204,11 @@ void IBattle::GetBattleFromScript(bool loadmapmod)
 				else {
 					if (!bot.ok()) {
 						if (status.ready)
-							m_players_ready++;
+							m_status_counts.ready++;
 						if (status.sync)
-							m_players_sync++;
+							m_status_counts.sync++;
 						if (status.sync && status.ready)
-							m_players_ok++;
+							m_status_counts.ok++;
 					}
 				}
 
@@ -1353,5 +1332,5 @@ void IBattle::RemoveUnfittingBots()
 
 bool IBattle::EngineExists() const
 {
-	return !SlPaths::GetCompatibleVersion(GetEngineVersion()).empty();
+	return ContentIndex::Instance()->EngineExists(GetEngineVersion());
 }
@@ -16,7 +16,9 @@ lsl/battle/ibattle.h
 
 #include <lslunitsync/data.h>
 #include <lsl/battle/tdfcontainer.h>
+#include <map>
 
+#include "battlestatuscounts.h"
 #include "user.h"
 #include "userlist.h"
 #include <lslunitsync/optionswrapper.h>
@@ -340,15 +342,15 @@ public:
 
 	virtual unsigned int GetNumReadyPlayers() const
 	{
-		return m_players_ready;
+		return m_status_counts.ready;
 	}
 	virtual unsigned int GetNumSyncedPlayers() const
 	{
-		return m_players_sync;
+		return m_status_counts.sync;
 	}
 	virtual unsigned int GetNumOkPlayers() const
 	{
-		return m_players_ok;
+		return m_status_counts.ok;
 	}
 
 	virtual int GetBattleId() const
@@ -461,6 +463,7 @@ public:
 	virtual void SetSpectators(const int& spectators)
 	{
 		m_opts.spectators = spectators;
+		m_status_counts_valid = false;
 	}
 	virtual int GetSpectators() const
 	{
@@ -581,11 +584,11 @@ public:
 
 	virtual const std::map<int, int>& GetAllySizes() const
 	{
-		return m_ally_sizes;
+		return m_status_counts.allies;
 	}
 	virtual const std::map<int, int>& GetTeamSizes() const
 	{
-		return m_teams_sizes;
+		return m_status_counts.teams;
 	}
 
 	//Extra tags for numerious battle options
@@ -717,9 +720,9 @@ public:
 protected:
 	BattleOptions m_opts;
 	bool m_generating_script;
-	std::map<int, int> m_teams_sizes; // controlteam -> number of people in
+	BattleStatusCounts m_status_counts; // team/ally sizes and ready counters of the players
 	bool m_is_self_in;
-	std::map<std::string, time_t> m_ready_up_map; // player name -> time counting from join/unspect
+	std::map<StringId, time_t> m_ready_up_map; // player nick -> time counting from join/unspect
 
 private:
 	void LoadScriptMMOpts(const std::string& sectionname, const LSL::TDF::PDataList& node);
@@ -730,6 +733,12 @@ private:
 	void PlayerJoinedTeam(int team);
 	void PlayerJoinedAlly(int ally);
 
+	//! adds (delta 1) or removes (delta -1) a user's status from the team/ally sizes and the player counters
+	void CountUserStatus(const UserBattleStatus& status, int delta);
+	void RecountUserStatus();
+	//! compares the incrementally maintained counters with a full recount
+	void CheckUserStatusCounts();
+
 	bool m_ingame;
 	bool m_map_loaded;
 	bool m_game_loaded;
@@ -747,10 +756,7 @@ private:
 
 	std::map<unsigned int, BattleStartRect> m_rects;
 
-	unsigned int m_players_ready;
-	unsigned int m_players_sync;
-	unsigned int m_players_ok;       // players which are ready and in sync
-	std::map<int, int> m_ally_sizes; // allyteam -> number of people in
+	bool m_status_counts_valid; // false if m_status_counts needs a full recount on the next status update
 
 	std::string m_preset;
 
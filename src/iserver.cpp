@@ -47,7 +47,7 @@ bool IServer::UserExists(const std::string& nickname) const
 
 bool IServer::UserIsOnBridge(const std::string& nickname) const
 {
-	bool in_channel = m_channels.UserExists(nickname);
+	bool in_channel = m_users.UserExists(nickname) && m_channels.UserExists(m_users.GetUser(nickname));
 	bool in_battle = false;
 	IBattle* my_battle = GetMe().GetBattle();
 	if (my_battle != nullptr && my_battle->UserExists(nickname))
@@ -108,11 +108,9 @@ void IServer::_RemoveUser(const std::string& nickname)
 	try {
 		User* u = &m_users.GetUser(nickname);
 		m_users.RemoveUser(nickname);
-		int numchannels = m_channels.GetNumChannels();
-		for (int i = 0; i < numchannels; i++) {
-			Channel& chan = m_channels.GetChannel(i);
-			if (chan.UserExists(nickname))
-				chan.Left(*u, "server idiocy");
+		const std::vector<Channel*> channels = u->GetChannels(); // Left() modifies the list
+		for (Channel* chan : channels) {
+			chan->Left(*u, "server idiocy");
 		}
 		delete u;
 	} catch (std::runtime_error& e) {
@@ -165,7 +163,13 @@ void IServer::_RemoveBattle(const int& id)
 
 void IServer::Reset()
 {
-	m_users.Nullify();
+	// channels unregister from their users when deleted, so remove them first
+	while (m_channels.GetNumChannels() > 0) {
+		Channel* c = &m_channels.GetChannel(0);
+		m_channels.RemoveChannel(c->GetName());
+		delete c;
+	}
+
 	while (m_users.GetNumUsers() > 0) {
 		try {
 			User* u = &m_users.GetUser(0);
@@ -184,9 +188,4 @@ void IServer::Reset()
 			delete b;
 		}
 	}
-	while (m_channels.GetNumChannels() > 0) {
-		Channel* c = &m_channels.GetChannel(0);
-		m_channels.RemoveChannel(c->GetName());
-		delete c;
-	}
 }
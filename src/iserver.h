@@ -3,6 +3,7 @@
 #ifndef SPRINGLOBBY_HEADERGUARD_SERVER_H
 #define SPRINGLOBBY_HEADERGUARD_SERVER_H
 
+#include <map>
 #include <string>
 
 #include "channellist.h"
@@ -36,8 +36,7 @@ OfflineBattle& OfflineBattle::operator=(OfflineBattle&& moved)
 	UserList::operator=((const UserList&&)moved);
 	m_id = moved.m_id;
 	m_me = moved.m_me;
-	auto spec_it = m_users.find("Spectator");
-	if (spec_it != m_users.end()) {
+	if (UserExists("Spectator")) {
 		RemoveUser("Spectator");
 		OnUserAdded(m_me);
 	}
@@ -59,7 +58,7 @@ OfflineBattle& OfflineBattle::operator=(OfflineBattle&& moved)
 					       //	m_players_ready = moved.m_players_ready;
 					       //	m_players_sync = moved.m_players_sync;
 					       //	m_players_ok = moved.m_players_ok;
-	m_teams_sizes = moved.m_teams_sizes;   // controlteam -> number of people in
+	m_status_counts.teams = moved.m_status_counts.teams; // controlteam -> number of people in
 					       //	m_ally_sizes = moved.m_ally_sizes; // allyteam -> number of people in
 					       //	m_preset = moved.m_preset;
 	m_is_self_in = moved.m_is_self_in;
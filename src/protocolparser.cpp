@@ -0,0 +1,450 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "protocolparser.h"
+
+#include <lslutils/conversion.h>
+#include <wx/convauto.h>
+#include <wx/log.h>
+#include <wx/string.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+
+#include "utils/conversion.h"
+#include "utils/lineframer.h"
+
+// max number of commands handed to the GUI thread at once
+#define MAX_BATCH_SIZE 1024
+
+static bool IsValidUtf8(std::string_view str)
+{
+	size_t i = 0;
+	while (i < str.size()) {
+		const unsigned char c = str[i];
+		if (c < 0x80) {
+			i++;
+			continue;
+		}
+		size_t len;
+		if ((c & 0xE0) == 0xC0 && c >= 0xC2) {
+			len = 2;
+		} else if ((c & 0xF0) == 0xE0) {
+			len = 3;
+		} else if ((c & 0xF8) == 0xF0 && c <= 0xF4) {
+			len = 4;
+		} else {
+			return false;
+		}
+		if (i + len > str.size()) {
+			return false;
+		}
+		for (size_t j = 1; j < len; j++) {
+			if ((static_cast<unsigned char>(str[i + j]) & 0xC0) != 0x80) {
+				return false;
+			}
+		}
+		i += len;
+	}
+	return true;
+}
+
+//! the server doesn't enforce utf-8, try the most common charsets
+static wxString convert(char* buff, const int len)
+{
+
+	if (len == 0) {
+		return wxEmptyString;
+	}
+	wxString ret = wxString(buff, wxConvUTF8, len);
+	if (!ret.IsEmpty()) {
+		return ret;
+	}
+	ret = wxString(buff, wxConvLibc, len);
+	if (!ret.empty()) {
+		return ret;
+	}
+	ret = wxString(buff, wxConvLocal, len);
+	if (!ret.IsEmpty()) {
+		return ret;
+	}
+	ret = wxString(buff, wxConvISO8859_1, len);
+	if (!ret.empty()) {
+		return ret;
+	}
+	ret = wxString(buff, wxConvAuto(), len);
+	if (!ret.empty()) {
+		return ret;
+	}
+	std::string tmp(buff, len);
+	wxLogWarning(_T("Error: invalid charset, replacing invalid chars: '%s'"), TowxString(tmp).c_str());
+
+	//worst case, couldn't convert, replace unknown chars!
+	for (int i = 0; i < len; i++) {
+		if ((buff[i] < '!') || (buff[i] > '~')) {
+			buff[i] = '_';
+		}
+	}
+	ret = wxString(buff, wxConvUTF8, len);
+	if (!ret.empty()) {
+		return ret;
+	}
+	wxLogWarning(_T("Fatal Error: couldn't convert: '%s'"), TowxString(tmp).c_str());
+	return wxEmptyString;
+}
+
+namespace
+{
+struct VerbInfo {
+	std::string_view name;
+	//! how the parser thread splits the params: 'w' word, 'i' integer, 's' sentence,
+	//! a trailing '*' repeats the previous kind until the end of the line
+	std::string_view layout;
+};
+} // namespace
+
+//! sorted, so a verb can be looked up with a binary search
+static constexpr VerbInfo verbs[] = {
+    {"ACCEPTED", ""},
+    {"ADDBOT", "iwwiis"},
+    {"ADDSTARTRECT", "iiiii"},
+    {"ADDUSER", "wwi"},
+    {"AGREEMENT", "s"},
+    {"AGREEMENTEND", ""},
+    {"BATTLECLOSED", "i"},
+    {"BATTLEOPENED", "iiiwwiiiiwssssss"},
+    {"BROADCAST", ""},
+    {"CHANNEL", "wis"},
+    {"CHANNELMESSAGE", "w"},
+    {"CHANNELTOPIC", "ww"},
+    {"CLIENTBATTLESTATUS", "wii"},
+    {"CLIENTIPPORT", "wwi"},
+    {"CLIENTS", "w*"},
+    {"CLIENTSFROM", "ww*"},
+    {"CLIENTSTATUS", "wi"},
+    {"DENIED", "s"},
+    {"DISABLEUNITS", "w*"},
+    {"ENABLEALLUNITS", ""},
+    {"ENABLEUNITS", "w*"},
+    {"ENDOFCHANNELS", ""},
+    {"FORCEJOINBATTLE", "iw"},
+    {"FORCELEAVECHANNEL", "wws"},
+    {"FORCEQUITBATTLE", ""},
+    {"HOSTPORT", "i"},
+    {"JOIN", "w"},
+    {"JOINBATTLE", "iw"},
+    {"JOINBATTLEFAILED", "s"},
+    {"JOINED", "ww"},
+    {"JOINEDBATTLE", "iww"},
+    {"JOINEDFROM", "www"},
+    {"JOINFAILED", "ws"},
+    {"JSON", ""},
+    {"LEFT", "wws"},
+    {"LEFTBATTLE", "iw"},
+    {"LEFTFROM", "ww"},
+    {"LOGININFOEND", ""},
+    {"MOTD", ""},
+    {"MUTELIST", "ws"},
+    {"MUTELISTBEGIN", "w"},
+    {"MUTELISTEND", ""},
+    {"OK", ""},
+    {"OPENBATTLE", "i"},
+    {"OPENBATTLEFAILED", "s"},
+    {"PONG", ""},
+    {"REDIRECT", "wi"},
+    {"REGISTRATIONACCEPTED", ""},
+    {"REGISTRATIONDENIED", ""},
+    {"REMOVEBOT", "iw"},
+    {"REMOVESCRIPTTAGS", "w*"},
+    {"REMOVESTARTRECT", "i"},
+    {"REMOVEUSER", "w"},
+    {"REQUESTBATTLESTATUS", ""},
+    {"RING", "w"},
+    {"SAID", "ww"},
+    {"SAIDEX", "ww"},
+    {"SAIDFROM", "wws"},
+    {"SAIDPRIVATE", "w"},
+    {"SAIDPRIVATEEX", "w"},
+    {"SAYPRIVATE", "w"},
+    {"SAYPRIVATEEX", "w"},
+    {"SCRIPT", ""},
+    {"SCRIPTEND", ""},
+    {"SCRIPTSTART", ""},
+    {"SERVERMSG", ""},
+    {"SERVERMSGBOX", ""},
+    {"SETSCRIPTTAGS", "s*"},
+    {"TASSERVER", "iwii"},
+    {"UDPSOURCEPORT", "i"},
+    {"UPDATEBATTLEINFO", "iiiws"},
+    {"UPDATEBOT", "iwii"},
+};
+
+static constexpr size_t verbCount = sizeof(verbs) / sizeof(verbs[0]);
+
+static constexpr bool IsSorted(const VerbInfo* infos, size_t count)
+{
+	for (size_t i = 1; i < count; i++) {
+		if (!(infos[i - 1].name < infos[i].name)) {
+			return false;
+		}
+	}
+	return true;
+}
+static_assert(IsSorted(verbs, verbCount), "verbs has to be sorted");
+static_assert(verbCount == static_cast<size_t>(ServerVerb::UNKNOWN), "verbs doesn't match ServerVerb");
+
+ServerVerb ProtocolParser::LookupVerb(std::string_view cmd)
+{
+	const VerbInfo* end = verbs + verbCount;
+	const VerbInfo* it = std::lower_bound(verbs, end, cmd, [](const VerbInfo& info, std::string_view name) {
+		return info.name < name;
+	});
+	if (it == end || it->name != cmd) {
+		return ServerVerb::UNKNOWN;
+	}
+	return static_cast<ServerVerb>(it - verbs);
+}
+
+std::string_view ProtocolParser::VerbName(ServerVerb verb)
+{
+	const size_t idx = static_cast<size_t>(verb);
+	if (idx >= verbCount) {
+		return "(unknown)";
+	}
+	return verbs[idx].name;
+}
+
+void ProtocolParser::Tokenize(ServerCommand& command)
+{
+	command.verb = LookupVerb(command.cmd);
+	command.fields.clear();
+	if (command.verb == ServerVerb::UNKNOWN) {
+		return;
+	}
+	const std::string& params = command.params;
+	const std::string_view layout = verbs[static_cast<size_t>(command.verb)].layout;
+	command.fields.reserve(layout.size());
+	size_t pos = 0;
+	size_t i = 0;
+	while (i < layout.size() && pos < params.size()) {
+		char kind = layout[i];
+		if (kind == '*') { // repeat the previous kind
+			kind = layout[i - 1];
+		} else {
+			i++;
+		}
+		ServerCommand::Field field;
+		field.sep = (kind == 's') ? '\t' : ' ';
+		field.begin = pos;
+		const size_t sep = params.find(field.sep, pos);
+		field.end = (sep == std::string::npos) ? params.size() : sep;
+		field.next = (sep == std::string::npos) ? params.size() : sep + 1;
+		if (kind == 'i') {
+			field.numeric = true;
+			field.value = LSL::Util::FromIntString(params.substr(field.begin, field.end - field.begin));
+		}
+		command.fields.push_back(field);
+		pos = field.next;
+	}
+}
+
+void ProtocolParser::ParseLine(std::string_view line, ServerCommand& command)
+{
+	std::string converted;
+	if (!IsValidUtf8(line)) {
+		converted.assign(line.data(), line.size());
+		converted = STD_STRING(convert(&converted[0], converted.size()));
+		line = converted;
+	}
+
+	command.replyid = 0;
+	if (!line.empty() && line[0] == '#') {
+		const size_t pos = line.find(' ');
+		if (pos == std::string_view::npos) {
+			line = std::string_view();
+		} else {
+			command.replyid = atoi(std::string(line.substr(1, pos - 1)).c_str());
+			line.remove_prefix(pos + 1);
+		}
+	}
+
+	const size_t pos = line.find(' ');
+	command.cmd.assign(line.data(), std::min(pos, line.size()));
+	for (char& c : command.cmd) {
+		c = toupper(static_cast<unsigned char>(c));
+	}
+	if (pos == std::string_view::npos) {
+		command.params.clear();
+	} else {
+		command.params.assign(line.data() + pos + 1, line.size() - pos - 1);
+	}
+	Tokenize(command);
+}
+
+ServerParams::ServerParams(const ServerCommand& command)
+    : m_params(command.params)
+    , m_fields(command.fields)
+    , m_pos(0)
+    , m_field(0)
+{
+}
+
+const ServerCommand::Field* ServerParams::Match(char sep)
+{
+	while (m_field < m_fields.size() && m_fields[m_field].begin < m_pos) {
+		m_field++;
+	}
+	if (m_field >= m_fields.size()) {
+		return nullptr;
+	}
+	const ServerCommand::Field& field = m_fields[m_field];
+	if (field.begin != m_pos || field.sep != sep) {
+		return nullptr;
+	}
+	m_field++;
+	m_pos = field.next;
+	return &field;
+}
+
+std::string ServerParams::Take(char sep)
+{
+	const size_t begin = m_pos;
+	if (const ServerCommand::Field* field = Match(sep)) {
+		return m_params.substr(field->begin, field->end - field->begin);
+	}
+	if (begin >= m_params.size()) {
+		return std::string();
+	}
+	const size_t pos = m_params.find(sep, begin);
+	if (pos == std::string::npos) {
+		m_pos = m_params.size();
+		return m_params.substr(begin);
+	}
+	m_pos = pos + 1;
+	return m_params.substr(begin, pos - begin);
+}
+
+std::string ServerParams::GetWord()
+{
+	return Take(' ');
+}
+
+std::string ServerParams::GetSentence()
+{
+	return Take('\t');
+}
+
+int ServerParams::GetInt()
+{
+	const ServerCommand::Field* field = Match(' ');
+	if (field != nullptr && field->numeric) {
+		return field->value;
+	}
+	if (field != nullptr) {
+		return LSL::Util::FromIntString(m_params.substr(field->begin, field->end - field->begin));
+	}
+	return LSL::Util::FromIntString(Take(' '));
+}
+
+ProtocolParser::ProtocolParser(std::function<void()> notify)
+    : m_notify(notify)
+    , m_generation(0)
+    , m_input(4096)
+    , m_output(256)
+    , m_notified(false)
+    , m_quit(false)
+{
+	m_thread = std::thread(&ProtocolParser::Run, this);
+}
+
+ProtocolParser::~ProtocolParser()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_cond.notify_one();
+	m_thread.join();
+}
+
+void ProtocolParser::Feed(std::string&& data)
+{
+	if (data.empty()) {
+		return;
+	}
+	Chunk chunk;
+	chunk.generation = m_generation;
+	chunk.data = std::move(data);
+	while (!m_input.Push(std::move(chunk))) { //worker is far behind, wait for it
+		m_cond.notify_one();
+		std::this_thread::yield();
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+	}
+	m_cond.notify_one();
+}
+
+void ProtocolParser::Reset()
+{
+	m_generation++;
+}
+
+bool ProtocolParser::Fetch(Batch& batch)
+{
+	m_notified = false;
+	ParsedBatch parsed;
+	while (m_output.Pop(parsed)) {
+		if (parsed.generation == m_generation) {
+			batch = std::move(parsed.commands);
+			return true;
+		}
+	}
+	return false;
+}
+
+void ProtocolParser::Run()
+{
+	LineFramer framer;
+	unsigned int generation = 0;
+	while (!m_quit) {
+		Chunk chunk;
+		if (!m_input.Pop(chunk)) {
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cond.wait(lock, [this] { return m_quit || !m_input.Empty(); });
+			continue;
+		}
+
+		ParsedBatch parsed;
+		do {
+			if (chunk.generation != generation) {
+				framer.Clear();
+				parsed.commands.clear();
+				generation = chunk.generation;
+			}
+			framer.Append(chunk.data);
+			std::string_view line;
+			while (framer.Next(line)) {
+				if (line.empty()) {
+					continue;
+				}
+				parsed.commands.emplace_back();
+				ParseLine(line, parsed.commands.back());
+			}
+		} while (parsed.commands.size() < MAX_BATCH_SIZE && m_input.Pop(chunk));
+
+		if (parsed.commands.empty()) {
+			continue;
+		}
+		parsed.generation = generation;
+		while (!m_output.Push(std::move(parsed))) { //GUI thread is busy
+			if (m_quit) {
+				return;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		if (!m_notified.exchange(true)) {
+			m_notify();
+		}
+	}
+}
@@ -0,0 +1,225 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_PROTOCOLPARSER_H
+#define SPRINGLOBBY_HEADERGUARD_PROTOCOLPARSER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "utils/mixins.h"
+#include "utils/spscqueue.h"
+
+//! protocol verbs known to the parser, in the same (sorted) order as their names
+enum class ServerVerb : unsigned char {
+	ACCEPTED,
+	ADDBOT,
+	ADDSTARTRECT,
+	ADDUSER,
+	AGREEMENT,
+	AGREEMENTEND,
+	BATTLECLOSED,
+	BATTLEOPENED,
+	BROADCAST,
+	CHANNEL,
+	CHANNELMESSAGE,
+	CHANNELTOPIC,
+	CLIENTBATTLESTATUS,
+	CLIENTIPPORT,
+	CLIENTS,
+	CLIENTSFROM,
+	CLIENTSTATUS,
+	DENIED,
+	DISABLEUNITS,
+	ENABLEALLUNITS,
+	ENABLEUNITS,
+	ENDOFCHANNELS,
+	FORCEJOINBATTLE,
+	FORCELEAVECHANNEL,
+	FORCEQUITBATTLE,
+	HOSTPORT,
+	JOIN,
+	JOINBATTLE,
+	JOINBATTLEFAILED,
+	JOINED,
+	JOINEDBATTLE,
+	JOINEDFROM,
+	JOINFAILED,
+	JSON,
+	LEFT,
+	LEFTBATTLE,
+	LEFTFROM,
+	LOGININFOEND,
+	MOTD,
+	MUTELIST,
+	MUTELISTBEGIN,
+	MUTELISTEND,
+	OK,
+	OPENBATTLE,
+	OPENBATTLEFAILED,
+	PONG,
+	REDIRECT,
+	REGISTRATIONACCEPTED,
+	REGISTRATIONDENIED,
+	REMOVEBOT,
+	REMOVESCRIPTTAGS,
+	REMOVESTARTRECT,
+	REMOVEUSER,
+	REQUESTBATTLESTATUS,
+	RING,
+	SAID,
+	SAIDEX,
+	SAIDFROM,
+	SAIDPRIVATE,
+	SAIDPRIVATEEX,
+	SAYPRIVATE,
+	SAYPRIVATEEX,
+	SCRIPT,
+	SCRIPTEND,
+	SCRIPTSTART,
+	SERVERMSG,
+	SERVERMSGBOX,
+	SETSCRIPTTAGS,
+	TASSERVER,
+	UDPSOURCEPORT,
+	UPDATEBATTLEINFO,
+	UPDATEBOT,
+	UNKNOWN //must be last
+};
+
+//! @brief A single line received from the lobby server, split into its parts.
+struct ServerCommand {
+	//! a parameter split off by the parser thread
+	struct Field {
+		uint32_t begin = 0; //offset into params
+		uint32_t end = 0;
+		uint32_t next = 0; //offset of the following parameter
+		char sep = ' ';
+		bool numeric = false;
+		int value = 0; //parsed value of numeric fields
+	};
+
+	ServerVerb verb = ServerVerb::UNKNOWN;
+	std::string cmd; //upper case protocol verb
+	std::string params;
+	std::vector<Field> fields;
+	int replyid = 0;
+};
+
+//! @brief Reads the parameters of a ServerCommand in order.
+//! Uses the fields split by the parser thread where they match the request and
+//! falls back to scanning params otherwise, results are the same as the
+//! GetWordParam() & co. functions from utils/tasutil.h.
+class ServerParams
+{
+public:
+	explicit ServerParams(const ServerCommand& command);
+
+	//! next space separated parameter
+	std::string GetWord();
+	//! next tab separated parameter
+	std::string GetSentence();
+	int GetInt();
+	bool GetBool()
+	{
+		return GetInt() != 0;
+	}
+	//! everything not read yet
+	std::string GetRest() const
+	{
+		return m_params.substr(m_pos);
+	}
+	bool empty() const
+	{
+		return m_pos >= m_params.size();
+	}
+
+private:
+	const ServerCommand::Field* Match(char sep);
+	std::string Take(char sep);
+
+	const std::string& m_params;
+	const std::vector<ServerCommand::Field>& m_fields;
+	size_t m_pos;
+	size_t m_field;
+};
+
+inline std::string GetWordParam(ServerParams& params)
+{
+	return params.GetWord();
+}
+inline std::string GetSentenceParam(ServerParams& params)
+{
+	return params.GetSentence();
+}
+inline int GetIntParam(ServerParams& params)
+{
+	return params.GetInt();
+}
+inline bool GetBoolParam(ServerParams& params)
+{
+	return params.GetBool();
+}
+
+//! @brief Decodes the lobby server stream on a worker thread.
+//! The GUI thread feeds the raw bytes read from the socket, the worker converts
+//! the charset, splits lines and tokenizes them. Parsed commands are handed back
+//! in batches, notify is called (from the worker) when new batches are ready.
+class ProtocolParser : public SL::NonCopyable
+{
+public:
+	typedef std::vector<ServerCommand> Batch;
+
+	explicit ProtocolParser(std::function<void()> notify);
+	~ProtocolParser();
+
+	//! hand over raw bytes received from the server
+	void Feed(std::string&& data);
+	//! drop all pending data, called on (re)connect / disconnect
+	void Reset();
+	//! fetch the next batch of parsed commands, returns false when none is ready
+	bool Fetch(Batch& batch);
+	//! changes on every Reset(), used to detect a reset while a batch is processed
+	unsigned int Generation() const
+	{
+		return m_generation;
+	}
+
+	//! splits a single line into reply id, verb and params, converting it to utf-8 if needed
+	static void ParseLine(std::string_view line, ServerCommand& command);
+	//! looks up the verb of command.cmd and splits its params into fields
+	static void Tokenize(ServerCommand& command);
+	static ServerVerb LookupVerb(std::string_view cmd);
+	static std::string_view VerbName(ServerVerb verb);
+
+private:
+	struct Chunk {
+		unsigned int generation = 0;
+		std::string data;
+	};
+	struct ParsedBatch {
+		unsigned int generation = 0;
+		Batch commands;
+	};
+
+	void Run();
+
+	std::function<void()> m_notify;
+	unsigned int m_generation; //only used by the GUI thread
+
+	SPSCQueue<Chunk> m_input;
+	SPSCQueue<ParsedBatch> m_output;
+	std::atomic<bool> m_notified;
+	std::atomic<bool> m_quit;
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	std::thread m_thread;
+};
+
+#endif // SPRINGLOBBY_HEADERGUARD_PROTOCOLPARSER_H
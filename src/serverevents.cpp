@@ -68,7 +68,7 @@ void ServerEvents::OnLogin()
 void ServerEvents::OnLoginInfoComplete()
 {
 	slLogDebugFunc("");
-	wxString nick = TowxString(m_serv.GetMe().GetNick());
+	wxString nick = m_serv.GetMe().GetNickWx();
 	wxArrayString highlights = sett().GetHighlightedWords();
 	if (highlights.Index(nick) == -1) {
 		highlights.Add(nick);
@@ -141,7 +141,7 @@ void ServerEvents::OnNewUser(const std::string& nick, const std::string& country
 	}
 	ui().OnUserOnline(user);
 
-	if (useractions().DoActionOnUser(UserActions::ActNotifLogin, TowxString(nick))) {
+	if (useractions().DoActionOnUser(UserActions::ActNotifLogin, nick)) {
 		actNotifBox(SL_MAIN_ICON, TowxString(nick) + _(" just connected"));
 	}
 }
@@ -155,13 +155,12 @@ void ServerEvents::OnUserStatus(const std::string& nick, UserStatus status)
 
 		UserStatus oldStatus = user.GetStatus();
 		user.SetStatus(status);
-		if (useractions().DoActionOnUser(UserActions::ActNotifStatus, TowxString(nick))) {
-			wxString diffString = TowxString(status.GetDiffString(oldStatus));
-			if (diffString != wxEmptyString)
-				actNotifBox(SL_MAIN_ICON, TowxString(nick) + _(" is now ") + diffString);
-		}
-
 		if (m_serv.IsOnline()) { //login info isn't complete yet
+			if (useractions().DoActionOnUser(UserActions::ActNotifStatus, nick)) {
+				wxString diffString = TowxString(status.GetDiffString(oldStatus));
+				if (diffString != wxEmptyString)
+					actNotifBox(SL_MAIN_ICON, TowxString(nick) + _(" is now ") + diffString);
+			}
 			ui().OnUserStatusChanged(user);
 		}
 
@@ -174,9 +173,8 @@ void ServerEvents::OnUserStatus(const std::string& nick, UserStatus status)
 						if (m_serv.IsOnline()) {
 							if (status.in_game) {
 								battle.StartSpring();
-							} else {
-								ui().OnBattleInfoUpdated(battle, wxEmptyString);
 							}
+							ui().OnBattleInfoUpdated(battle, wxEmptyString); // the battle list caches the status icon
 						}
 					}
 				}
@@ -213,7 +211,7 @@ void ServerEvents::OnUserQuit(const std::string& nick)
 		}
 		ui().OnUserOffline(user);
 		m_serv._RemoveUser(nick);
-		if (useractions().DoActionOnUser(UserActions::ActNotifLogin, TowxString(nick)))
+		if (useractions().DoActionOnUser(UserActions::ActNotifLogin, nick))
 			actNotifBox(SL_MAIN_ICON, TowxString(nick) + _(" just went offline"));
 	} catch (const std::runtime_error& e) {
 		wxLogWarning(_T("Exception: %s"), e.what());
@@ -248,14 +246,19 @@ void ServerEvents::OnBattleOpened(int id, BattleType type, NatType nat, const st
 		battle.SetHostGame(mod, "");
 		battle.SetEngineName(engineName);
 		battle.SetEngineVersion(engineVersion);
-		if (useractions().DoActionOnUser(UserActions::ActNotifBattle, TowxString(user.GetNick()))) {
-			actNotifBox(SL_MAIN_ICON, TowxString(user.GetNick()) + _(" opened battle ") + TowxString(title));
-		}
-		if (!m_serv.IsOnline()) { //login info isn't complete yet
+		if (!m_serv.IsOnline()) { //login info isn't complete yet, the battle list is filled in OnLoginInfoComplete
 			return;
 		}
+		const bool followed = useractions().DoActionOnUser(UserActions::ActNotifBattle, user.GetNickId());
+		if (followed) {
+			actNotifBox(SL_MAIN_ICON, user.GetNickWx() + _(" opened battle ") + TowxString(title));
+		}
 
 		ui().OnBattleOpened(battle);
+		// chances are the battles of friends get joined
+		if (followed) {
+			ui().PrefetchContent(&battle);
+		}
 		if (user.Status().in_game) {
 			battle.SetInGame(true);
 			battle.StartSpring();
@@ -357,6 +360,9 @@ void ServerEvents::OnUserJoinedBattle(int battleid, const std::string& nick, con
 
 		battle.OnUserAdded(user);
 		user.BattleStatus().scriptPassword = userScriptPassword;
+		if (!m_serv.IsOnline()) { //login info isn't complete yet, the battle list is filled in OnLoginInfoComplete
+			return;
+		}
 		ui().OnUserJoinedBattle(battle, user);
 		try {
 			if (&user == &battle.GetFounder()) {
@@ -386,12 +392,12 @@ void ServerEvents::OnUserLeftBattle(int battleid, const std::string& nick)
 		battle.OnUserRemoved(user);
 		ui().OnUserLeftBattle(battle, user, isbot);
 
-		std::map<std::string, User*> user_map = battle.GetUsers();
-		for (auto p : user_map) { // remove any bridged users that we no longer share channels with
-			User& user = *p.second;
+		const UserList::user_vec_t users = battle.GetUsers();
+		for (User* p : users) { // remove any bridged users that we no longer share channels with
+			User& user = *p;
 			if (!user.IsBridged())
 				continue;
-			std::string nick = p.first;
+			const std::string nick = user.GetNick();
 			if (!m_serv.UserIsOnBridge(nick)) {
 				ui().OnUserOffline(user);
 				m_serv._RemoveUser(nick);
@@ -659,7 +665,7 @@ void ServerEvents::OnChannelSaid(const std::string& channel, const std::string&
 			OnBattleSaid(battleid, who, message);
 			return;
 		}
-		if ((m_serv.GetMe().GetNick() == who) || !useractions().DoActionOnUser(UserActions::ActIgnoreChat, TowxString(who))) {
+		if ((m_serv.GetMe().GetNick() == who) || !useractions().DoActionOnUser(UserActions::ActIgnoreChat, who)) {
 			if (m_serv.UserExists(who)) {
 				m_serv.GetChannel(channel).Said(m_serv.GetUser(who), message);
 			} else {
@@ -676,7 +682,7 @@ void ServerEvents::OnBattleSaid(int battleid, const std::string& nick, const std
 {
 	try {
 		IBattle& battle = m_serv.GetBattle(battleid);
-		if ((m_serv.GetMe().GetNick() == nick) || !useractions().DoActionOnUser(UserActions::ActIgnoreChat, TowxString(nick))) {
+		if ((m_serv.GetMe().GetNick() == nick) || !useractions().DoActionOnUser(UserActions::ActIgnoreChat, nick)) {
 			ui().OnSaidBattle(battle, TowxString(nick), TowxString(msg));
 		}
 		AutoHost* ah = battle.GetAutoHost();
@@ -713,12 +719,12 @@ void ServerEvents::OnChannelPart(const std::string& channel, const std::string&
 		Channel& chan = m_serv.GetChannel(channel);
 		chan.Left(m_serv.GetUser(who), message);
 
-		std::map<std::string, User*> user_map = chan.GetUsers();
-		for (auto p : user_map) { // remove any bridged users that we no longer share channels with
-			User& user = *p.second;
+		const UserList::user_vec_t users = chan.GetUsers();
+		for (User* p : users) { // remove any bridged users that we no longer share channels with
+			User& user = *p;
 			if (!user.IsBridged())
 				continue;
-			std::string nick = p.first;
+			const std::string nick = user.GetNick();
 			if (!m_serv.UserIsOnBridge(nick)) {
 				ui().OnUserOffline(user);
 				m_serv._RemoveUser(nick);
@@ -756,7 +762,7 @@ void ServerEvents::OnChannelAction(const std::string& channel, const std::string
 			OnBattleAction(battleid, who, action);
 			return;
 		}
-		if ((m_serv.GetMe().GetNick() == who) || !useractions().DoActionOnUser(UserActions::ActIgnoreChat, TowxString(who)))
+		if ((m_serv.GetMe().GetNick() == who) || !useractions().DoActionOnUser(UserActions::ActIgnoreChat, who))
 			m_serv.GetChannel(channel).DidAction(m_serv.GetUser(who), action);
 	} catch (const std::runtime_error& e) {
 		wxLogWarning(_T("Exception: %s"), e.what());
@@ -777,7 +783,7 @@ void ServerEvents::OnPrivateMessage(User& chan, User& who, const std::string& me
 {
 	slLogDebugFunc("");
 	try {
-		if (!useractions().DoActionOnUser(UserActions::ActIgnorePM, TowxString(who.GetNick())))
+		if (!useractions().DoActionOnUser(UserActions::ActIgnorePM, who.GetNickId()))
 			ui().OnUserSaid(chan, who, TowxString(message));
 	} catch (const std::runtime_error& e) {
 		wxLogWarning(_T("Exception: %s"), e.what());
@@ -788,7 +794,7 @@ void ServerEvents::OnPrivateMessageEx(User& chan, User& who, const std::string&
 {
 	slLogDebugFunc("");
 	try {
-		if (!useractions().DoActionOnUser(UserActions::ActIgnorePM, TowxString(who.GetNick())))
+		if (!useractions().DoActionOnUser(UserActions::ActIgnorePM, who.GetNickId()))
 			ui().OnUserSaidEx(chan, who, TowxString(action));
 	} catch (const std::runtime_error& e) {
 		wxLogWarning(_T("Exception: %s"), e.what());
@@ -982,7 +988,7 @@ void ServerEvents::OnSaidFrom(const std::string& channel, const std::string& who
 {
 	slLogDebugFunc("");
 	try {
-		if (not((m_serv.GetMe().GetNick() == who) || !useractions().DoActionOnUser(UserActions::ActIgnoreChat, TowxString(who))))
+		if (not((m_serv.GetMe().GetNick() == who) || !useractions().DoActionOnUser(UserActions::ActIgnoreChat, who)))
 			return;
 		int battleid = m_serv.m_battles.BattleFromChannel(channel);
 		if (battleid != -1) {
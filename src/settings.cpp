@@ -25,6 +25,7 @@
 #include "playbackfiltervalues.h"
 #include "springsettings/presets.h"
 #include "utils/conversion.h"
+#include "utils/highlightmatcher.h"
 #include "utils/platform.h"
 #include "utils/slconfig.h"
 #include "utils/slpaths.h"
@@ -973,6 +974,7 @@ wxArrayString Settings::getFromList(const wxString& path)
 void Settings::SetHighlightedWords(const wxArrayString& words)
 {
 	setFromList(words, _T("/Chat/HighlightedWords"));
+	m_highlight_matcher.reset();
 }
 
 wxArrayString Settings::GetHighlightedWords()
@@ -980,6 +982,19 @@ wxArrayString Settings::GetHighlightedWords()
 	return getFromList(_T("/Chat/HighlightedWords"));
 }
 
+const HighlightMatcher& Settings::GetHighlightMatcher()
+{
+	if (!m_highlight_matcher) {
+		const wxArrayString words = GetHighlightedWords();
+		std::vector<std::wstring> list;
+		for (const wxString& word : words) {
+			list.push_back(word.ToStdWstring());
+		}
+		m_highlight_matcher.reset(new HighlightMatcher(list));
+	}
+	return *m_highlight_matcher;
+}
+
 void Settings::ConvertLists()
 {
 	const wxArrayString current_hl = cfg().GetEntryList(_T( "/Chat/HighlightedWords" ));
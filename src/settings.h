@@ -6,6 +6,7 @@
 #include <wx/string.h>
 #include <wx/intl.h>
 
+#include <memory>
 #include <vector>
 #include <set>
 #include "utils/mixins.h"
@@ -49,6 +50,7 @@ class wxSize;
 class wxPoint;
 class wxPathList;
 class wxTranslationHelper;
+class HighlightMatcher;
 
 typedef std::map<unsigned int, unsigned int> ColumnMap;
 
@@ -333,6 +335,8 @@ public:
 
 	void SetHighlightedWords(const wxArrayString& words);
 	wxArrayString GetHighlightedWords();
+	//! the highlighted words compiled for matching, rebuilt after they changed
+	const HighlightMatcher& GetHighlightMatcher();
 
 	//!\brief controls if user attention is requested when highlighting a line
 	void SetRequestAttOnHighlight(const bool req);
@@ -568,6 +572,8 @@ private:
 	int GetChannelJoinIndex(const wxString& name);
 	void setFromList(const wxArrayString& list, const wxString& path);
 	wxArrayString getFromList(const wxString& path);
+
+	std::unique_ptr<HighlightMatcher> m_highlight_matcher;
 };
 
 Settings& sett();
@@ -18,7 +18,6 @@ lsl/networking/socket.cpp
 #include <winsock2.h>
 #endif // _MSC_VER
 
-#include <wx/convauto.h>
 #include <wx/log.h>
 #include <wx/socket.h>
 #include <wx/string.h>
@@ -331,54 +330,12 @@ bool Socket::Send(const std::string& data)
 }
 
 
-wxString convert(char* buff, const int len)
-{
-
-	if (len == 0) {
-		return wxEmptyString;
-	}
-	wxString ret = wxString(buff, wxConvUTF8, len);
-	if (!ret.IsEmpty()) {
-		return ret;
-	}
-	ret = wxString(buff, wxConvLibc, len);
-	if (!ret.empty()) {
-		return ret;
-	}
-	ret = wxString(buff, wxConvLocal, len);
-	if (!ret.IsEmpty()) {
-		return ret;
-	}
-	ret = wxString(buff, wxConvISO8859_1, len);
-	if (!ret.empty()) {
-		return ret;
-	}
-	ret = wxString(buff, wxConvAuto(), len);
-	if (!ret.empty()) {
-		return ret;
-	}
-	std::string tmp(buff, len);
-	wxLogWarning(_T("Error: invalid charset, replacing invalid chars: '%s'"), TowxString(tmp).c_str());
-
-	//worst case, couldn't convert, replace unknown chars!
-	for (int i = 0; i < len; i++) {
-		if ((buff[i] < '!') || (buff[i] > '~')) {
-			buff[i] = '_';
-		}
-	}
-	ret = wxString(buff, wxConvUTF8, len);
-	if (!ret.empty()) {
-		return ret;
-	}
-	wxLogWarning(_T("Fatal Error: couldn't convert: '%s'"), TowxString(tmp).c_str());
-	return wxEmptyString;
-}
-
 //! @brief Receive data from connection
-wxString Socket::Receive()
+//! @return raw bytes as sent by the server, decrypted if TLS is used
+std::string Socket::Receive()
 {
 	wxLogDebug("Socket::Receive");
-	wxString res;
+	std::string res;
 	static const int chunk_size = 4096;
 	char buf[chunk_size];
 	int readnum = 0;
@@ -405,14 +362,13 @@ wxString Socket::Receive()
 				if (!VerifyCertificate()) {
 					wxLogWarning("Couldn't verify certificate, closing connection");
 					Disconnect();
-					return wxEmptyString;
+					return std::string();
 				}
 				int ret = 0;
 				do {
 					ret = SSL_read(m_ssl, buf, chunk_size);
-					if (ret >= 0) {
-						const std::string str(buf, ret);
-						res += convert(buf, ret);
+					if (ret > 0) {
+						res.append(buf, ret);
 					} else if (ret == 0) {
 						wxLogWarning("SSL_read(); %d", ret);
 					} else {
@@ -421,7 +377,7 @@ wxString Socket::Receive()
 				} while (ret > 0);
 			}
 		} else {
-			res += convert(buf, readnum);
+			res.append(buf, readnum);
 		}
 	} while (readnum > 0);
 
@@ -61,7 +61,7 @@ public:
 	void Disconnect();
 
 	bool Send(const std::string& data);
-	wxString Receive();
+	std::string Receive();
 	std::string GetLocalAddress() const;
 	std::string GetHandle() const
 	{
@@ -39,6 +39,8 @@
 #endif
 
 #include "channel.h"
+#include "chatlogindex.h"
+#include "contentindex.h"
 #include "downloader/lib/src/FileSystem/FileSystem.h"
 #include "downloader/prdownloader.h"
 #include "gui/controls.h"
@@ -191,7 +193,7 @@ bool SpringLobbyApp::OnInit()
 	wxLogMessage("Refreshing Spring Version List...");
 	SlPaths::RefreshSpringVersionList();
 	if (LSL::usync().ReloadUnitSyncLib()) {
-		GlobalEventManager::Instance()->Send(GlobalEventManager::OnUnitsyncReloaded);
+		ContentIndex::Instance()->UnitsyncReloaded();
 	} else {
 		wxLogWarning("Couldn't load unitsync");
 	}
@@ -226,6 +228,7 @@ int SpringLobbyApp::OnExit()
 
 	IconsCollection::Release();
 	ServerManager::Release();
+	ChatLogIndex::Instance()->Stop();
 	SetEvtHandlerEnabled(false);
 	UiEvents::GetNotificationEventSender().Enable(false);
 	LSL::Util::DestroyGlobals();
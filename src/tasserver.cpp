@@ -21,11 +21,15 @@ lsl/networking/tasserver.cpp
 #include <wx/string.h>
 #include <wx/timer.h>
 #include <algorithm>
+#include <chrono>
 #include <map>
 #include <memory>
 #include <stdexcept>
+#include <string_view>
+#include <vector>
 
 #include "log.h"
+#include "protocolparser.h"
 #include "serverevents.h"
 #include "settings.h"
 #include "socket.h"
@@ -59,12 +63,13 @@ IBattle::GameType IntToGameType(int gt);
 
 TASServer::TASServer()
     : m_sock(NULL)
+    , m_parser(NULL)
+    , m_executing_commands(false)
     , m_ser_ver(0)
     , m_connected(false)
     , m_online(false)
     , m_id_transmission(true)
     , m_redirecting(false)
-    , m_buffer("")
     , m_last_udp_ping(0)
     , m_last_ping(PING_DELAY)
     , //no instant ping, delay first ping for PING_DELAY seconds
@@ -79,8 +84,10 @@ TASServer::TASServer()
     , m_do_finalize_join_battle(false)
     , m_do_register(false)
     , m_finalize_join_battle_id(-1)
+    , m_cmd_stats(static_cast<size_t>(Command::UNKNOWN) + 1)
 {
 	m_se = new ServerEvents(*this);
+	m_parser = new ProtocolParser([this] { CallAfter(&TASServer::OnCommandsParsed); });
 	m_relay_host_manager_list.clear();
 
 	Start(100); // call Update every 100ms
@@ -92,6 +99,8 @@ TASServer::~TASServer()
 	Disconnect();
 	delete m_se;
 	m_se = NULL;
+	delete m_parser;
+	m_parser = NULL;
 }
 
 bool TASServer::ExecuteSayCommand(const std::string& cmdstr) //FIXME: all the /commands should be moved to a dedicated file (as its not part of lobby server protocol)
@@ -224,6 +233,9 @@ bool TASServer::ExecuteSayCommand(const std::string& cmdstr) //FIXME: all the /c
 	} else if (cmd == "/hook") {
 		SendCmd("HOOK", params);
 		return true;
+	} else if (cmd == "/cmdstats") {
+		LogCommandStats();
+		return true;
 	} else if (cmd == "/quit") {
 		Disconnect();
 		return true;
@@ -274,7 +286,7 @@ void TASServer::Connect(const ServerLoginInfo& server)
 {
 
 	m_serverinfo = server;
-	m_buffer.clear();
+	m_parser->Reset();
 	if (m_sock != NULL) {
 		Disconnect();
 	}
@@ -483,33 +495,32 @@ void TASServer::Notify()
 
 void TASServer::ExecuteCommand(const std::string& in)
 {
-	wxLogDebug(_T("%s"), in);
-	wxString cmd;
-	wxString params = TowxString(in);
-	long replyid = 0;
-
 	if (in.empty())
 		return;
 	try {
-		ASSERT_LOGIC(params.AfterFirst('\n').IsEmpty(), "losing data");
+		ASSERT_LOGIC(in.find('\n') == std::string::npos, "losing data");
 	} catch (const std::exception& e) {
 		wxLogWarning(_T("Exception: %s"), e.what());
 		return;
 	}
-	if (params[0] == '#') {
-		wxString id = params.BeforeFirst(' ').AfterFirst('#');
-		params = params.AfterFirst(' ');
-		id.ToLong(&replyid);
-	}
-	cmd = params.BeforeFirst(' ').MakeUpper();
-	params = params.AfterFirst(' ');
+	ServerCommand command;
+	ProtocolParser::ParseLine(in, command);
+	ExecuteServerCommand(command);
+}
 
+void TASServer::ExecuteServerCommand(const ServerCommand& command)
+{
+	wxLogDebug("%s %s", command.cmd.c_str(), command.params.c_str());
 	try {
-		ExecuteCommand(STD_STRING(cmd), STD_STRING(params), replyid);
+		const auto start = std::chrono::steady_clock::now();
+		DispatchCommand(command);
+		CommandStats& stats = m_cmd_stats[static_cast<size_t>(command.verb)];
+		stats.hits++;
+		stats.usecs += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
 	} catch (const std::exception& e) {
 		// catch everything so the app doesn't crash, may make SL behave oddly,
 		// but it's better than crashing randomly for normal users.
-		wxLogWarning(_T("Exception: %s %s %s"), e.what(), cmd, params);
+		wxLogWarning(_T("Exception: %s %s %s"), e.what(), command.cmd.c_str(), command.params.c_str());
 	}
 }
 
@@ -532,7 +543,36 @@ static LSL::StringMap parseKeyValue(const std::string& str)
 
 void TASServer::ExecuteCommand(const std::string& cmd, const std::string& inparams, int replyid)
 {
-	std::string params = inparams;
+	ServerCommand command;
+	command.cmd = cmd;
+	command.params = inparams;
+	command.replyid = replyid;
+	ProtocolParser::Tokenize(command);
+	ExecuteServerCommand(command);
+}
+
+void TASServer::LogCommandStats()
+{
+	std::vector<size_t> order;
+	for (size_t i = 0; i < m_cmd_stats.size(); i++) {
+		if (m_cmd_stats[i].hits > 0) {
+			order.push_back(i);
+		}
+	}
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		return m_cmd_stats[a].usecs > m_cmd_stats[b].usecs;
+	});
+	m_se->OnServerMessage("verb: hits, total ms, avg us");
+	for (const size_t i : order) {
+		const CommandStats& stats = m_cmd_stats[i];
+		const std::string name(ProtocolParser::VerbName(static_cast<Command>(i)));
+		m_se->OnServerMessage(stdprintf("%s: %llu, %.1f, %.1f", name.c_str(), stats.hits, stats.usecs / 1000.0, double(stats.usecs) / stats.hits));
+	}
+}
+
+void TASServer::DispatchCommand(const ServerCommand& command)
+{
+	ServerParams params(command);
 	std::string nick, host, map, title, channel, bridge, error, msg, owner, topic, engineName, engineVersion;
 	//NatType ntype;
 	UserStatus cstatus;
@@ -540,461 +580,612 @@ void TASServer::ExecuteCommand(const std::string& cmd, const std::string& inpara
 	int tasbstatus;
 	UserBattleStatus bstatus;
 
-	if (cmd == "TASSERVER") {
-		if (!m_sock->IsTLS()) {
-			Stop(); //don't send ping until TLS handshake is complete
-			SendCmd("STLS", "");
-		} else {
-			m_ser_ver = GetIntParam(params);
-			m_supported_spring_version = GetWordParam(params);
-			m_nat_helper_port = (unsigned long)GetIntParam(params);
-			m_server_lanmode = GetBoolParam(params);
-
-			if (m_do_register) {
-				SendCmd("REGISTER", m_serverinfo.username
-				  + std::string(" ") + GetPasswordHash(m_serverinfo.password)
-				  + std::string(" ") + m_serverinfo.email);
+	switch (command.verb) {
+		case Command::TASSERVER: {
+			if (!m_sock->IsTLS()) {
+				Stop(); //don't send ping until TLS handshake is complete
+				SendCmd("STLS", "");
 			} else {
-				m_se->OnConnected(m_serverinfo.description, "", true, m_supported_spring_version, m_server_lanmode);
+				m_ser_ver = GetIntParam(params);
+				m_supported_spring_version = GetWordParam(params);
+				m_nat_helper_port = (unsigned long)GetIntParam(params);
+				m_server_lanmode = GetBoolParam(params);
+
+				if (m_do_register) {
+					SendCmd("REGISTER", m_serverinfo.username
+					  + std::string(" ") + GetPasswordHash(m_serverinfo.password)
+					  + std::string(" ") + m_serverinfo.email);
+				} else {
+					m_se->OnConnected(m_serverinfo.description, "", true, m_supported_spring_version, m_server_lanmode);
+				}
 			}
+			break;
 		}
-	} else if (cmd == "OK") {
-		if (!m_sock->IsTLS()) {
-			wxLogInfo("%s:%d %s", m_serverinfo.hostname.c_str(), m_serverinfo.port, m_serverinfo.fingerprint.c_str());
-			m_sock->StartTLS(m_serverinfo.fingerprint);
-			Start(); //restart ping as server + client have started TLS
-		}
-	} else if (cmd == "ACCEPTED") {
-		SetUsername(params);
-		m_se->OnLogin();
-	} else if (cmd == "MOTD") {
-		m_se->OnMotd(params);
-	} else if (cmd == "ADDUSER") {
-		int id;
-		nick = GetWordParam(params);
-		const std::string country = GetWordParam(params);
-		if (params.empty()) {
-			// if server didn't send any account id to us, fill with an always increasing number
-			id = m_account_id_count;
-			m_account_id_count++;
-		} else {
-			id = GetIntParam(params);
-		}
-		// params contains user's lobby client and version.
-		m_se->OnNewUser(nick, country, id, params);
-		if (nick == m_relay_host_bot) {
-			RelayCmd("OPENBATTLE", m_delayed_open_command); // relay bot is deployed, send host command
-			m_delayed_open_command = "";
-		}
-	} else if (cmd == "CLIENTSTATUS") {
-		nick = GetWordParam(params);
-		tasstatus = GetIntParam(params);
-		cstatus = UserStatus::FromInt(tasstatus);
-		m_se->OnUserStatus(nick, cstatus);
-	} else if (cmd == "BATTLEOPENED") {
-		const int id = GetIntParam(params);
-		const int type = GetIntParam(params);
-		const int nat = GetIntParam(params);
-		nick = GetWordParam(params);
-		host = GetWordParam(params);
-		const int port = GetIntParam(params);
-		const int maxplayers = GetIntParam(params);
-		const bool haspass = GetBoolParam(params);
-		const int rank = GetIntParam(params);
-		const std::string hash = LSL::Util::MakeHashUnsigned(GetWordParam(params));
-		engineName = GetSentenceParam(params);
-		engineVersion = GetSentenceParam(params);
-		map = GetSentenceParam(params);
-		title = GetSentenceParam(params);
-		const std::string mod = GetSentenceParam(params);
-		const std::string channel_name = GetSentenceParam(params);
-		m_se->OnBattleOpened(id, (BattleType)type, IntToNatType(nat), nick, host, port, maxplayers,
-				     haspass, rank, hash, engineName, engineVersion, map, title, mod, channel_name);
-		if (nick == m_relay_host_bot) {
-			GetBattle(id).SetProxy(m_relay_host_bot);
-			JoinBattle(id, STD_STRING(sett().GetLastHostPassword())); // autojoin relayed host battles
-		}
-	} else if (cmd == "JOINEDBATTLE") {
-		const int id = GetIntParam(params);
-		nick = GetWordParam(params);
-		const std::string userScriptPassword = GetWordParam(params);
-		m_se->OnUserJoinedBattle(id, nick, userScriptPassword);
-	} else if (cmd == "UPDATEBATTLEINFO") {
-		const int id = GetIntParam(params);
-		const int specs = GetIntParam(params);
-		const bool haspass = GetBoolParam(params);
-		const std::string hash = LSL::Util::MakeHashUnsigned(GetWordParam(params));
-		map = GetSentenceParam(params);
-		m_se->OnBattleInfoUpdated(id, specs, haspass, hash, map);
-	} else if (cmd == "LOGININFOEND") {
-		m_online = true;
-		if (UserExists("RelayHostManagerList"))
-			SayPrivate("RelayHostManagerList", "!lm");
-		m_se->OnLoginInfoComplete();
-	} else if (cmd == "REMOVEUSER") {
-		nick = GetWordParam(params);
-		if (nick == GetUserName())
-			return; // to prevent peet doing nasty stuff to you, watch your back!
-		m_se->OnUserQuit(nick);
-	} else if (cmd == "BATTLECLOSED") {
-		const int id = GetIntParam(params);
-		if (m_battle_id == id) {
-			m_relay_host_bot.clear();
-			m_battle_id = -1;
-		}
-		m_se->OnBattleClosed(id);
-	} else if (cmd == "LEFTBATTLE") {
-		const int id = GetIntParam(params);
-		nick = GetWordParam(params);
-		if ((id == m_battle_id) && (nick == GetMe().GetNick())) {
-			m_battle_id = -1;
-		}
-		m_se->OnUserLeftBattle(id, nick);
-	} else if (cmd == "PONG") {
-		HandlePong(replyid);
-	} else if (cmd == "JOIN") {
-		channel = GetWordParam(params);
-		int lastid = 0;
-		cfg().Read(wxString::Format("/Channels/%s/lastid", channel.c_str()), &lastid);
-		m_se->OnJoinChannelResult(true, channel, "");
-		SendCmd("GETCHANNELMESSAGES", stdprintf("%s %d", channel.c_str(), lastid));
-	} else if (cmd == "SAID") {
-		channel = GetWordParam(params);
-		nick = GetWordParam(params);
-		m_se->OnChannelSaid(channel, nick, params);
-	} else if (cmd == "JSON") {
-		ParseJson(inparams);
-	} else if (cmd == "JOINED") {
-		channel = GetWordParam(params);
-		nick = GetWordParam(params);
-		m_se->OnUserJoinChannel(channel, nick);
-	} else if (cmd == "LEFT") {
-		channel = GetWordParam(params);
-		nick = GetWordParam(params);
-		msg = GetSentenceParam(params);
-		m_se->OnChannelPart(channel, nick, msg);
-	} else if (cmd == "CHANNELTOPIC") {
-		channel = GetWordParam(params);
-		nick = GetWordParam(params);
-		params = LSL::Util::Replace(params, "\\n", "\n");
-		m_se->OnChannelTopic(channel, nick, params);
-	} else if (cmd == "SAIDEX") {
-		channel = GetWordParam(params);
-		nick = GetWordParam(params);
-		m_se->OnChannelAction(channel, nick, params);
-	} else if (cmd == "CLIENTS") {
-		channel = GetWordParam(params);
-		while (!(nick = GetWordParam(params)).empty()) {
-			m_se->OnChannelJoin(channel, nick);
-		}
-	} else if (cmd == "SAYPRIVATE") {
-		nick = GetWordParam(params);
-		if (((nick == m_relay_host_bot) || (nick == m_relay_host_manager)) && LSL::Util::BeginsWith(params, "!"))
-			return; // drop the message
-		if ((nick == "RelayHostManagerList") && (params == "!lm"))
-			return; // drop the message
-		if (nick == "SL_bot") {
-			if (LSL::Util::BeginsWith(params, "stats.report"))
-				return;
+		case Command::OK: {
+			if (!m_sock->IsTLS()) {
+				wxLogInfo("%s:%d %s", m_serverinfo.hostname.c_str(), m_serverinfo.port, m_serverinfo.fingerprint.c_str());
+				m_sock->StartTLS(m_serverinfo.fingerprint);
+				Start(); //restart ping as server + client have started TLS
+			}
+			break;
+		}
+		case Command::ACCEPTED: {
+			SetUsername(command.params);
+			m_se->OnLogin();
+			break;
+		}
+		case Command::MOTD: {
+			m_se->OnMotd(command.params);
+			break;
+		}
+		case Command::ADDUSER: {
+			int id;
+			nick = GetWordParam(params);
+			const std::string country = GetWordParam(params);
+			if (params.empty()) {
+				// if server didn't send any account id to us, fill with an always increasing number
+				id = m_account_id_count;
+				m_account_id_count++;
+			} else {
+				id = GetIntParam(params);
+			}
+			// params contains user's lobby client and version.
+			m_se->OnNewUser(nick, country, id, params.GetRest());
+			if (nick == m_relay_host_bot) {
+				RelayCmd("OPENBATTLE", m_delayed_open_command); // relay bot is deployed, send host command
+				m_delayed_open_command = "";
+			}
+			break;
+		}
+		case Command::CLIENTSTATUS: {
+			nick = GetWordParam(params);
+			tasstatus = GetIntParam(params);
+			cstatus = UserStatus::FromInt(tasstatus);
+			m_se->OnUserStatus(nick, cstatus);
+			break;
+		}
+		case Command::BATTLEOPENED: {
+			const int id = GetIntParam(params);
+			const int type = GetIntParam(params);
+			const int nat = GetIntParam(params);
+			nick = GetWordParam(params);
+			host = GetWordParam(params);
+			const int port = GetIntParam(params);
+			const int maxplayers = GetIntParam(params);
+			const bool haspass = GetBoolParam(params);
+			const int rank = GetIntParam(params);
+			const std::string hash = LSL::Util::MakeHashUnsigned(GetWordParam(params));
+			engineName = GetSentenceParam(params);
+			engineVersion = GetSentenceParam(params);
+			map = GetSentenceParam(params);
+			title = GetSentenceParam(params);
+			const std::string mod = GetSentenceParam(params);
+			const std::string channel_name = GetSentenceParam(params);
+			m_se->OnBattleOpened(id, (BattleType)type, IntToNatType(nat), nick, host, port, maxplayers,
+					     haspass, rank, hash, engineName, engineVersion, map, title, mod, channel_name);
+			if (nick == m_relay_host_bot) {
+				GetBattle(id).SetProxy(m_relay_host_bot);
+				JoinBattle(id, STD_STRING(sett().GetLastHostPassword())); // autojoin relayed host battles
+			}
+			break;
+		}
+		case Command::JOINEDBATTLE: {
+			const int id = GetIntParam(params);
+			nick = GetWordParam(params);
+			const std::string userScriptPassword = GetWordParam(params);
+			m_se->OnUserJoinedBattle(id, nick, userScriptPassword);
+			break;
+		}
+		case Command::UPDATEBATTLEINFO: {
+			const int id = GetIntParam(params);
+			const int specs = GetIntParam(params);
+			const bool haspass = GetBoolParam(params);
+			const std::string hash = LSL::Util::MakeHashUnsigned(GetWordParam(params));
+			map = GetSentenceParam(params);
+			m_se->OnBattleInfoUpdated(id, specs, haspass, hash, map);
+			break;
+		}
+		case Command::LOGININFOEND: {
+			m_online = true;
+			if (UserExists("RelayHostManagerList"))
+				SayPrivate("RelayHostManagerList", "!lm");
+			m_se->OnLoginInfoComplete();
+			break;
+		}
+		case Command::REMOVEUSER: {
+			nick = GetWordParam(params);
+			if (nick == GetUserName())
+				return; // to prevent peet doing nasty stuff to you, watch your back!
+			m_se->OnUserQuit(nick);
+			break;
+		}
+		case Command::BATTLECLOSED: {
+			const int id = GetIntParam(params);
+			if (m_battle_id == id) {
+				m_relay_host_bot.clear();
+				m_battle_id = -1;
+			}
+			m_se->OnBattleClosed(id);
+			break;
+		}
+		case Command::LEFTBATTLE: {
+			const int id = GetIntParam(params);
+			nick = GetWordParam(params);
+			if ((id == m_battle_id) && (nick == GetMe().GetNick())) {
+				m_battle_id = -1;
+			}
+			m_se->OnUserLeftBattle(id, nick);
+			break;
+		}
+		case Command::PONG: {
+			HandlePong(command.replyid);
+			break;
+		}
+		case Command::JOIN: {
+			channel = GetWordParam(params);
+			int lastid = 0;
+			cfg().Read(wxString::Format("/Channels/%s/lastid", channel.c_str()), &lastid);
+			m_se->OnJoinChannelResult(true, channel, "");
+			SendCmd("GETCHANNELMESSAGES", stdprintf("%s %d", channel.c_str(), lastid));
+			break;
+		}
+		case Command::SAID: {
+			channel = GetWordParam(params);
+			nick = GetWordParam(params);
+			m_se->OnChannelSaid(channel, nick, params.GetRest());
+			break;
+		}
+		case Command::JSON: {
+			ParseJson(command.params);
+			break;
+		}
+		case Command::JOINED: {
+			channel = GetWordParam(params);
+			nick = GetWordParam(params);
+			m_se->OnUserJoinChannel(channel, nick);
+			break;
+		}
+		case Command::LEFT: {
+			channel = GetWordParam(params);
+			nick = GetWordParam(params);
+			msg = GetSentenceParam(params);
+			m_se->OnChannelPart(channel, nick, msg);
+			break;
+		}
+		case Command::CHANNELTOPIC: {
+			channel = GetWordParam(params);
+			nick = GetWordParam(params);
+			topic = LSL::Util::Replace(params.GetRest(), "\\n", "\n");
+			m_se->OnChannelTopic(channel, nick, topic);
+			break;
+		}
+		case Command::SAIDEX: {
+			channel = GetWordParam(params);
+			nick = GetWordParam(params);
+			m_se->OnChannelAction(channel, nick, params.GetRest());
+			break;
+		}
+		case Command::CLIENTS: {
+			channel = GetWordParam(params);
+			while (!(nick = GetWordParam(params)).empty()) {
+				m_se->OnChannelJoin(channel, nick);
+			}
+			break;
+		}
+		case Command::SAYPRIVATE: {
+			nick = GetWordParam(params);
+			msg = params.GetRest();
+			if (((nick == m_relay_host_bot) || (nick == m_relay_host_manager)) && LSL::Util::BeginsWith(msg, "!"))
+				return; // drop the message
+			if ((nick == "RelayHostManagerList") && (msg == "!lm"))
+				return; // drop the message
+			if (nick == "SL_bot") {
+				if (LSL::Util::BeginsWith(msg, "stats.report"))
+					return;
+			}
+			User& user = GetUser(nick);
+			m_se->OnPrivateMessage(user, GetMe(), msg);
+			break;
+		}
+		case Command::SAYPRIVATEEX: {
+			nick = GetWordParam(params);
+			msg = params.GetRest();
+			User& user = GetUser(nick);
+			m_se->OnPrivateMessageEx(user, GetMe(), msg);
+			break;
 		}
-		User& user = GetUser(nick);
-		m_se->OnPrivateMessage(user, GetMe(), params);
-	} else if (cmd == "SAYPRIVATEEX") {
-		nick = GetWordParam(params);
-		User& user = GetUser(nick);
-		m_se->OnPrivateMessageEx(user, GetMe(), params);
-	} else if (cmd == "SAIDPRIVATE") {
-		nick = GetWordParam(params);
-		if (nick == m_relay_host_bot) {
-			if (LSL::Util::BeginsWith(params, "JOINEDBATTLE")) {
-				GetWordParam(params); // skip first word, it's the message itself
-				/*id =*/
-				GetIntParam(params);
-				const std::string usernick = GetWordParam(params);
-				const std::string userScriptPassword = GetWordParam(params);
-				try {
-					User& usr = GetUser(usernick);
-					usr.BattleStatus().scriptPassword = userScriptPassword;
-					IBattle* battle = GetCurrentBattle();
-					if (battle) {
-						if (battle->CheckBan(usr))
-							return;
+		case Command::SAIDPRIVATE: {
+			nick = GetWordParam(params);
+			msg = params.GetRest();
+			if (nick == m_relay_host_bot) {
+				if (LSL::Util::BeginsWith(msg, "JOINEDBATTLE")) {
+					GetWordParam(params); // skip first word, it's the message itself
+					/*id =*/
+					GetIntParam(params);
+					const std::string usernick = GetWordParam(params);
+					const std::string userScriptPassword = GetWordParam(params);
+					try {
+						User& usr = GetUser(usernick);
+						usr.BattleStatus().scriptPassword = userScriptPassword;
+						IBattle* battle = GetCurrentBattle();
+						if (battle) {
+							if (battle->CheckBan(usr))
+								return;
+						}
+						SetRelayIngamePassword(usr);
+					} catch (const std::exception& e) {
+						wxLogWarning(_T("Exception: %s"), e.what());
 					}
-					SetRelayIngamePassword(usr);
-				} catch (const std::exception& e) {
-					wxLogWarning(_T("Exception: %s"), e.what());
+					return;
 				}
+			}
+			if (nick == m_relay_host_manager) {
+				if (LSL::Util::BeginsWith(msg, "\001")) { // error code
+					m_se->OnServerMessageBox(LSL::Util::AfterFirst(msg, " "));
+				} else {
+					m_relay_host_bot = msg;
+				}
+				m_relay_host_manager.clear();
 				return;
 			}
+			if (nick == "RelayHostManagerList") {
+				if (LSL::Util::BeginsWith(msg, "list ")) {
+					const std::string list = LSL::Util::AfterFirst(msg, " ");
+					m_relay_host_manager_list = LSL::Util::StringTokenize(list, "\t");
+					return;
+				}
+			}
+			User& user = GetUser(nick);
+			m_se->OnPrivateMessage(user, user, msg);
+			break;
 		}
-		if (nick == m_relay_host_manager) {
-			if (LSL::Util::BeginsWith(params, "\001")) { // error code
-				m_se->OnServerMessageBox(LSL::Util::AfterFirst(params, " "));
-			} else {
-				m_relay_host_bot = params;
+		case Command::SAIDPRIVATEEX: {
+			nick = GetWordParam(params);
+			msg = params.GetRest();
+			User& user = GetUser(nick);
+			m_se->OnPrivateMessageEx(user, user, msg);
+			break;
+		}
+		case Command::JOINBATTLE: {
+			const int id = GetIntParam(params);
+			std::string hash = LSL::Util::MakeHashUnsigned(GetWordParam(params));
+			if (hash == "0") {
+				hash.clear();
 			}
-			m_relay_host_manager.clear();
-			return;
+			m_battle_id = id;
+			m_se->OnJoinedBattle(id, hash);
+			m_se->OnBattleInfoUpdated(m_battle_id);
+			try {
+				if (GetBattle(id).IsProxy())
+					RelayCmd("SUPPORTSCRIPTPASSWORD"); // send flag to relayhost marking we support script passwords
+			} catch (const std::exception& e) {
+				wxLogWarning(_T("Exception: %s"), e.what());
+			}
+			break;
 		}
-		if (nick == "RelayHostManagerList") {
-			if (LSL::Util::BeginsWith(params, "list ")) {
-				const std::string list = LSL::Util::AfterFirst(params, " ");
-				m_relay_host_manager_list = LSL::Util::StringTokenize(list, "\t");
-				return;
+		case Command::CLIENTBATTLESTATUS: {
+			nick = GetWordParam(params);
+			tasbstatus = GetIntParam(params);
+			bstatus = UserBattleStatus::FromInt(tasbstatus);
+			bstatus.colour = LSL::lslColor(GetIntParam(params));
+			m_se->OnClientBattleStatus(m_battle_id, nick, bstatus);
+			break;
+		}
+		case Command::ADDSTARTRECT: {
+			//ADDSTARTRECT allyno left top right bottom
+			const int ally = GetIntParam(params);
+			const int left = GetIntParam(params);
+			const int top = GetIntParam(params);
+			const int right = GetIntParam(params);
+			const int bottom = GetIntParam(params);
+			;
+			m_se->OnBattleStartRectAdd(m_battle_id, ally, left, top, right, bottom);
+			break;
+		}
+		case Command::REMOVESTARTRECT: {
+			//REMOVESTARTRECT allyno
+			const int ally = GetIntParam(params);
+			m_se->OnBattleStartRectRemove(m_battle_id, ally);
+			break;
+		}
+		case Command::ENABLEALLUNITS: {
+			//"ENABLEALLUNITS" params: "".
+			m_se->OnBattleEnableAllUnits(m_battle_id);
+			break;
+		}
+		case Command::ENABLEUNITS: {
+			//ENABLEUNITS unitname1 unitname2
+			while ((nick = GetWordParam(params)) != "") {
+				m_se->OnBattleEnableUnit(m_battle_id, nick);
 			}
+			break;
 		}
-		User& user = GetUser(nick);
-		m_se->OnPrivateMessage(user, user, params);
-	} else if (cmd == "SAIDPRIVATEEX") {
-		nick = GetWordParam(params);
-		User& user = GetUser(nick);
-		m_se->OnPrivateMessageEx(user, user, params);
-	} else if (cmd == "JOINBATTLE") {
-		const int id = GetIntParam(params);
-		std::string hash = LSL::Util::MakeHashUnsigned(GetWordParam(params));
-		if (hash == "0") {
-			hash.clear();
-		}
-		m_battle_id = id;
-		m_se->OnJoinedBattle(id, hash);
-		m_se->OnBattleInfoUpdated(m_battle_id);
-		try {
-			if (GetBattle(id).IsProxy())
-				RelayCmd("SUPPORTSCRIPTPASSWORD"); // send flag to relayhost marking we support script passwords
-		} catch (const std::exception& e) {
-			wxLogWarning(_T("Exception: %s"), e.what());
+		case Command::DISABLEUNITS: {
+			//"DISABLEUNITS" params: "arm_advanced_radar_tower arm_advanced_sonar_station arm_advanced_torpedo_launcher arm_dragons_teeth arm_energy_storage arm_eraser arm_fark arm_fart_mine arm_fibber arm_geothermal_powerplant arm_guardian"
+			while ((nick = GetWordParam(params)) != "") {
+				m_se->OnBattleDisableUnit(m_battle_id, nick);
+			}
+			break;
 		}
-	} else if (cmd == "CLIENTBATTLESTATUS") {
-		nick = GetWordParam(params);
-		tasbstatus = GetIntParam(params);
-		bstatus = UserBattleStatus::FromInt(tasbstatus);
-		bstatus.colour = LSL::lslColor(GetIntParam(params));
-		m_se->OnClientBattleStatus(m_battle_id, nick, bstatus);
-	} else if (cmd == "ADDSTARTRECT") {
-		//ADDSTARTRECT allyno left top right bottom
-		const int ally = GetIntParam(params);
-		const int left = GetIntParam(params);
-		const int top = GetIntParam(params);
-		const int right = GetIntParam(params);
-		const int bottom = GetIntParam(params);
-		;
-		m_se->OnBattleStartRectAdd(m_battle_id, ally, left, top, right, bottom);
-	} else if (cmd == "REMOVESTARTRECT") {
-		//REMOVESTARTRECT allyno
-		const int ally = GetIntParam(params);
-		m_se->OnBattleStartRectRemove(m_battle_id, ally);
-	} else if (cmd == "ENABLEALLUNITS") {
-		//"ENABLEALLUNITS" params: "".
-		m_se->OnBattleEnableAllUnits(m_battle_id);
-	} else if (cmd == "ENABLEUNITS") {
-		//ENABLEUNITS unitname1 unitname2
-		while ((nick = GetWordParam(params)) != "") {
-			m_se->OnBattleEnableUnit(m_battle_id, nick);
-		}
-	} else if (cmd == "DISABLEUNITS") {
-		//"DISABLEUNITS" params: "arm_advanced_radar_tower arm_advanced_sonar_station arm_advanced_torpedo_launcher arm_dragons_teeth arm_energy_storage arm_eraser arm_fark arm_fart_mine arm_fibber arm_geothermal_powerplant arm_guardian"
-		while ((nick = GetWordParam(params)) != "") {
-			m_se->OnBattleDisableUnit(m_battle_id, nick);
-		}
-	} else if (cmd == "CHANNEL") {
-		channel = GetWordParam(params);
-		const int units = GetIntParam(params);
-		topic = GetSentenceParam(params);
-		m_se->OnChannelList(channel, units, topic);
-	} else if (cmd == "ENDOFCHANNELS") {
-		//Cmd: ENDOFCHANNELS params:
-	} else if (cmd == "REQUESTBATTLESTATUS") {
-		m_se->OnRequestBattleStatus(m_battle_id);
-	} else if (cmd == "AGREEMENT") {
-		msg = GetSentenceParam(params);
-		m_agreement += msg + "\n";
-	} else if (cmd == "AGREEMENTEND") {
-		m_se->OnAcceptAgreement(m_agreement);
-		m_agreement.clear();
-	} else if (cmd == "OPENBATTLE") {
-		m_battle_id = GetIntParam(params);
-		m_se->OnHostedBattle(m_battle_id);
-	} else if (cmd == "ADDBOT") {
-		// ADDBOT BATTLE_ID name owner battlestatus teamcolor {AIDLL}
-		const int id = GetIntParam(params);
-		nick = GetWordParam(params);
-		owner = GetWordParam(params);
-		tasbstatus = GetIntParam(params);
-		bstatus = UserBattleStatus::FromInt(tasbstatus);
-		bstatus.colour = LSL::lslColor(GetIntParam(params));
-		wxString ai = TowxString(GetSentenceParam(params));
-		if (ai.empty()) {
-			wxLogWarning(wxString::Format(_T("Recieved illegal ADDBOT (empty dll field) from %s for battle %d"), nick.c_str(), id));
-			ai = _T("INVALID|INVALID");
-		}
-		if (ai.Find(_T('|')) != -1) {
-			bstatus.aiversion = STD_STRING(ai.AfterLast(_T('|')));
-			ai = ai.BeforeLast(_T('|'));
-		}
-		bstatus.aishortname = STD_STRING(ai);
-		bstatus.owner = owner;
-		m_se->OnBattleAddBot(id, nick, bstatus);
-	} else if (cmd == "UPDATEBOT") {
-		const int id = GetIntParam(params);
-		nick = GetWordParam(params);
-		tasbstatus = GetIntParam(params);
-		bstatus = UserBattleStatus::FromInt(tasbstatus);
-		bstatus.colour = LSL::lslColor(GetIntParam(params));
-		m_se->OnBattleUpdateBot(id, nick, bstatus);
-		//UPDATEBOT BATTLE_ID name battlestatus teamcolor
-	} else if (cmd == "REMOVEBOT") {
-		const int id = GetIntParam(params);
-		nick = GetWordParam(params);
-		m_se->OnBattleRemoveBot(id, nick);
-		//REMOVEBOT BATTLE_ID name
-	} else if (cmd == "RING") {
-		nick = GetWordParam(params);
-		m_se->OnRing(nick);
-		//RING username
-	} else if (cmd == "SERVERMSG") {
-		m_se->OnServerMessage(params);
-		//SERVERMSG {message}
-	} else if (cmd == "JOINBATTLEFAILED") {
-		msg = GetSentenceParam(params);
-		m_se->OnServerMessage("Failed to join battle. " + msg);
-		//JOINBATTLEFAILED {reason}
-	} else if (cmd == "OPENBATTLEFAILED") {
-		msg = GetSentenceParam(params);
-		m_se->OnServerMessage("Failed to host new battle on server. " + msg);
-		//OPENBATTLEFAILED {reason}
-	} else if (cmd == "JOINFAILED") {
-		channel = GetWordParam(params);
-		msg = GetSentenceParam(params);
-		m_se->OnServerMessage("Failed to join channel #" + channel + ". " + msg);
-		//JOINFAILED channame {reason}
-	} else if (cmd == "CHANNELMESSAGE") {
-		channel = GetWordParam(params);
-		m_se->OnChannelMessage(channel, params);
-		//CHANNELMESSAGE channame {message}
-	} else if (cmd == "FORCELEAVECHANNEL") {
-		channel = GetWordParam(params);
-		nick = GetWordParam(params);
-		msg = GetSentenceParam(params);
-		m_se->OnChannelPart(channel, GetMe().GetNick(), "Kicked by <" + nick + "> " + msg);
-		//FORCELEAVECHANNEL channame username [{reason}]
-	} else if (cmd == "DENIED") {
-		m_last_denied = msg = GetSentenceParam(params);
-		m_se->OnLoginDenied(msg);
-		Disconnect();
-		//Command: "DENIED" params: "Already logged in".
-	} else if (cmd == "HOSTPORT") {
-		unsigned int tmp_port = (unsigned int)GetIntParam(params);
-		m_se->OnHostExternalUdpPort(tmp_port);
-		//HOSTPORT port
-	} else if (cmd == "UDPSOURCEPORT") {
-		unsigned int tmp_port = (unsigned int)GetIntParam(params);
-		m_se->OnMyExternalUdpSourcePort(tmp_port);
-		if (m_do_finalize_join_battle)
-			FinalizeJoinBattle();
-		//UDPSOURCEPORT port
-	} else if (cmd == "CLIENTIPPORT") {
-		// clientipport username ip port
-		nick = GetWordParam(params);
-		const std::string ip = GetWordParam(params);
-		unsigned int u_port = (unsigned int)GetIntParam(params);
-		m_se->OnClientIPPort(nick, ip, u_port);
-	} else if (cmd == "SETSCRIPTTAGS") {
-		wxString command;
-		while ((command = TowxString(GetSentenceParam(params))) != wxEmptyString) {
-			const std::string key = STD_STRING(command.BeforeFirst('=').Lower());
-			const std::string value = STD_STRING(command.AfterFirst('='));
-			m_se->OnSetBattleInfo(m_battle_id, key, value);
-		}
-		m_se->OnBattleInfoUpdated(m_battle_id);
-		// !! Command: "SETSCRIPTTAGS" params: "game/startpostype=0	game/maxunits=1000	game/limitdgun=0	game/startmetal=1000	game/gamemode=0	game/ghostedbuildings=-1	game/startenergy=1000	game/diminishingmms=0"
-	} else if (cmd == "REMOVESCRIPTTAGS") {
-		std::string key;
-		while ((key = GetWordParam(params)) != "") {
-			m_se->OnUnsetBattleInfo(m_battle_id, key);
-		}
-		m_se->OnBattleInfoUpdated(m_battle_id);
-	} else if (cmd == "SCRIPTSTART") {
-		m_se->OnScriptStart(m_battle_id);
-		// !! Command: "SCRIPTSTART" params: ""
-	} else if (cmd == "SCRIPTEND") {
-		m_se->OnScriptEnd(m_battle_id);
-		// !! Command: "SCRIPTEND" params: ""
-	} else if (cmd == "SCRIPT") {
-		m_se->OnScriptLine(m_battle_id, params);
-		// !! Command: "SCRIPT" params: "[game]"
-	} else if (cmd == "FORCEQUITBATTLE") {
-		m_relay_host_bot.clear();
-		m_se->OnKickedFromBattle();
-	} else if (cmd == "BROADCAST") {
-		m_se->OnServerBroadcast(params);
-	} else if (cmd == "SERVERMSGBOX") {
-		m_se->OnServerMessageBox(params);
-	} else if (cmd == "REDIRECT") {
-		if (m_online)
-			return;
-		std::string address = GetWordParam(params);
-		unsigned int u_port = GetIntParam(params);
-		if (address.empty())
-			return;
-		if (u_port == 0)
-			u_port = DEFSETT_DEFAULT_SERVER_PORT;
-		m_redirecting = true;
-		m_se->OnRedirect(address, u_port, GetUserName(), GetPassword());
-	} else if (cmd == "MUTELISTBEGIN") {
-		m_current_chan_name_mutelist = GetWordParam(params);
-		m_se->OnMutelistBegin(m_current_chan_name_mutelist);
-
-	} else if (cmd == "MUTELIST") {
-		const std::string mutee = GetWordParam(params);
-		const std::string description = GetSentenceParam(params);
-		m_se->OnMutelistItem(m_current_chan_name_mutelist, mutee, description);
-	} else if (cmd == "MUTELISTEND") {
-		m_se->OnMutelistEnd(m_current_chan_name_mutelist);
-		m_current_chan_name_mutelist.clear();
-	} else if (cmd == "FORCEJOINBATTLE") {
-		const int battleID = GetIntParam(params);
-		const std::string scriptpw = GetWordParam(params);
-		m_se->OnForceJoinBattle(battleID, scriptpw);
-	} else if (cmd == "REGISTRATIONACCEPTED") {
-		m_do_register = false;
-		m_se->RegistrationAccepted(GetUserName(), GetPassword());
-		m_se->OnConnected(m_serverinfo.description, "", true, m_supported_spring_version, m_server_lanmode);
-	} else if (cmd == "REGISTRATIONDENIED") {
-		m_se->RegistrationDenied(params);
-	} else if (cmd == "JOINEDFROM") {
-		channel = GetWordParam(params);
-		bridge = GetWordParam(params);
-		nick = GetWordParam(params);
-		if (!UserExists(nick)) // bridged users are only known when in a channel with them
-		{
-			const int id = m_account_id_count;
-			m_account_id_count++;
-			m_se->OnNewUser(nick, "", id, bridge + " (bridge)");
-		}
-		m_se->OnJoinedFrom(channel, nick);
-	} else if (cmd == "CLIENTSFROM") {
-		channel = GetWordParam(params);
-		bridge = GetWordParam(params);
-		while (!(nick = GetWordParam(params)).empty()) {
-			if (!UserExists(nick)) {
+		case Command::CHANNEL: {
+			channel = GetWordParam(params);
+			const int units = GetIntParam(params);
+			topic = GetSentenceParam(params);
+			m_se->OnChannelList(channel, units, topic);
+			break;
+		}
+		case Command::ENDOFCHANNELS: {
+			//Cmd: ENDOFCHANNELS params:
+			break;
+		}
+		case Command::REQUESTBATTLESTATUS: {
+			m_se->OnRequestBattleStatus(m_battle_id);
+			break;
+		}
+		case Command::AGREEMENT: {
+			msg = GetSentenceParam(params);
+			m_agreement += msg + "\n";
+			break;
+		}
+		case Command::AGREEMENTEND: {
+			m_se->OnAcceptAgreement(m_agreement);
+			m_agreement.clear();
+			break;
+		}
+		case Command::OPENBATTLE: {
+			m_battle_id = GetIntParam(params);
+			m_se->OnHostedBattle(m_battle_id);
+			break;
+		}
+		case Command::ADDBOT: {
+			// ADDBOT BATTLE_ID name owner battlestatus teamcolor {AIDLL}
+			const int id = GetIntParam(params);
+			nick = GetWordParam(params);
+			owner = GetWordParam(params);
+			tasbstatus = GetIntParam(params);
+			bstatus = UserBattleStatus::FromInt(tasbstatus);
+			bstatus.colour = LSL::lslColor(GetIntParam(params));
+			wxString ai = TowxString(GetSentenceParam(params));
+			if (ai.empty()) {
+				wxLogWarning(wxString::Format(_T("Recieved illegal ADDBOT (empty dll field) from %s for battle %d"), nick.c_str(), id));
+				ai = _T("INVALID|INVALID");
+			}
+			if (ai.Find(_T('|')) != -1) {
+				bstatus.aiversion = STD_STRING(ai.AfterLast(_T('|')));
+				ai = ai.BeforeLast(_T('|'));
+			}
+			bstatus.aishortname = STD_STRING(ai);
+			bstatus.owner = owner;
+			m_se->OnBattleAddBot(id, nick, bstatus);
+			break;
+		}
+		case Command::UPDATEBOT: {
+			const int id = GetIntParam(params);
+			nick = GetWordParam(params);
+			tasbstatus = GetIntParam(params);
+			bstatus = UserBattleStatus::FromInt(tasbstatus);
+			bstatus.colour = LSL::lslColor(GetIntParam(params));
+			m_se->OnBattleUpdateBot(id, nick, bstatus);
+			//UPDATEBOT BATTLE_ID name battlestatus teamcolor
+			break;
+		}
+		case Command::REMOVEBOT: {
+			const int id = GetIntParam(params);
+			nick = GetWordParam(params);
+			m_se->OnBattleRemoveBot(id, nick);
+			//REMOVEBOT BATTLE_ID name
+			break;
+		}
+		case Command::RING: {
+			nick = GetWordParam(params);
+			m_se->OnRing(nick);
+			//RING username
+			break;
+		}
+		case Command::SERVERMSG: {
+			m_se->OnServerMessage(command.params);
+			//SERVERMSG {message}
+			break;
+		}
+		case Command::JOINBATTLEFAILED: {
+			msg = GetSentenceParam(params);
+			m_se->OnServerMessage("Failed to join battle. " + msg);
+			//JOINBATTLEFAILED {reason}
+			break;
+		}
+		case Command::OPENBATTLEFAILED: {
+			msg = GetSentenceParam(params);
+			m_se->OnServerMessage("Failed to host new battle on server. " + msg);
+			//OPENBATTLEFAILED {reason}
+			break;
+		}
+		case Command::JOINFAILED: {
+			channel = GetWordParam(params);
+			msg = GetSentenceParam(params);
+			m_se->OnServerMessage("Failed to join channel #" + channel + ". " + msg);
+			//JOINFAILED channame {reason}
+			break;
+		}
+		case Command::CHANNELMESSAGE: {
+			channel = GetWordParam(params);
+			m_se->OnChannelMessage(channel, params.GetRest());
+			//CHANNELMESSAGE channame {message}
+			break;
+		}
+		case Command::FORCELEAVECHANNEL: {
+			channel = GetWordParam(params);
+			nick = GetWordParam(params);
+			msg = GetSentenceParam(params);
+			m_se->OnChannelPart(channel, GetMe().GetNick(), "Kicked by <" + nick + "> " + msg);
+			//FORCELEAVECHANNEL channame username [{reason}]
+			break;
+		}
+		case Command::DENIED: {
+			m_last_denied = msg = GetSentenceParam(params);
+			m_se->OnLoginDenied(msg);
+			Disconnect();
+			//Command: "DENIED" params: "Already logged in".
+			break;
+		}
+		case Command::HOSTPORT: {
+			unsigned int tmp_port = (unsigned int)GetIntParam(params);
+			m_se->OnHostExternalUdpPort(tmp_port);
+			//HOSTPORT port
+			break;
+		}
+		case Command::UDPSOURCEPORT: {
+			unsigned int tmp_port = (unsigned int)GetIntParam(params);
+			m_se->OnMyExternalUdpSourcePort(tmp_port);
+			if (m_do_finalize_join_battle)
+				FinalizeJoinBattle();
+			//UDPSOURCEPORT port
+			break;
+		}
+		case Command::CLIENTIPPORT: {
+			// clientipport username ip port
+			nick = GetWordParam(params);
+			const std::string ip = GetWordParam(params);
+			unsigned int u_port = (unsigned int)GetIntParam(params);
+			m_se->OnClientIPPort(nick, ip, u_port);
+			break;
+		}
+		case Command::SETSCRIPTTAGS: {
+			wxString command;
+			while ((command = TowxString(GetSentenceParam(params))) != wxEmptyString) {
+				const std::string key = STD_STRING(command.BeforeFirst('=').Lower());
+				const std::string value = STD_STRING(command.AfterFirst('='));
+				m_se->OnSetBattleInfo(m_battle_id, key, value);
+			}
+			m_se->OnBattleInfoUpdated(m_battle_id);
+			// !! Command: "SETSCRIPTTAGS" params: "game/startpostype=0	game/maxunits=1000	game/limitdgun=0	game/startmetal=1000	game/gamemode=0	game/ghostedbuildings=-1	game/startenergy=1000	game/diminishingmms=0"
+			break;
+		}
+		case Command::REMOVESCRIPTTAGS: {
+			std::string key;
+			while ((key = GetWordParam(params)) != "") {
+				m_se->OnUnsetBattleInfo(m_battle_id, key);
+			}
+			m_se->OnBattleInfoUpdated(m_battle_id);
+			break;
+		}
+		case Command::SCRIPTSTART: {
+			m_se->OnScriptStart(m_battle_id);
+			// !! Command: "SCRIPTSTART" params: ""
+			break;
+		}
+		case Command::SCRIPTEND: {
+			m_se->OnScriptEnd(m_battle_id);
+			// !! Command: "SCRIPTEND" params: ""
+			break;
+		}
+		case Command::SCRIPT: {
+			m_se->OnScriptLine(m_battle_id, command.params);
+			// !! Command: "SCRIPT" params: "[game]"
+			break;
+		}
+		case Command::FORCEQUITBATTLE: {
+			m_relay_host_bot.clear();
+			m_se->OnKickedFromBattle();
+			break;
+		}
+		case Command::BROADCAST: {
+			m_se->OnServerBroadcast(command.params);
+			break;
+		}
+		case Command::SERVERMSGBOX: {
+			m_se->OnServerMessageBox(command.params);
+			break;
+		}
+		case Command::REDIRECT: {
+			if (m_online)
+				return;
+			std::string address = GetWordParam(params);
+			unsigned int u_port = GetIntParam(params);
+			if (address.empty())
+				return;
+			if (u_port == 0)
+				u_port = DEFSETT_DEFAULT_SERVER_PORT;
+			m_redirecting = true;
+			m_se->OnRedirect(address, u_port, GetUserName(), GetPassword());
+			break;
+		}
+		case Command::MUTELISTBEGIN: {
+			m_current_chan_name_mutelist = GetWordParam(params);
+			m_se->OnMutelistBegin(m_current_chan_name_mutelist);
+			break;
+		}
+		case Command::MUTELIST: {
+			const std::string mutee = GetWordParam(params);
+			const std::string description = GetSentenceParam(params);
+			m_se->OnMutelistItem(m_current_chan_name_mutelist, mutee, description);
+			break;
+		}
+		case Command::MUTELISTEND: {
+			m_se->OnMutelistEnd(m_current_chan_name_mutelist);
+			m_current_chan_name_mutelist.clear();
+			break;
+		}
+		case Command::FORCEJOINBATTLE: {
+			const int battleID = GetIntParam(params);
+			const std::string scriptpw = GetWordParam(params);
+			m_se->OnForceJoinBattle(battleID, scriptpw);
+			break;
+		}
+		case Command::REGISTRATIONACCEPTED: {
+			m_do_register = false;
+			m_se->RegistrationAccepted(GetUserName(), GetPassword());
+			m_se->OnConnected(m_serverinfo.description, "", true, m_supported_spring_version, m_server_lanmode);
+			break;
+		}
+		case Command::REGISTRATIONDENIED: {
+			m_se->RegistrationDenied(command.params);
+			break;
+		}
+		case Command::JOINEDFROM: {
+			channel = GetWordParam(params);
+			bridge = GetWordParam(params);
+			nick = GetWordParam(params);
+			if (!UserExists(nick)) // bridged users are only known when in a channel with them
+			{
 				const int id = m_account_id_count;
 				m_account_id_count++;
 				m_se->OnNewUser(nick, "", id, bridge + " (bridge)");
 			}
 			m_se->OnJoinedFrom(channel, nick);
+			break;
+		}
+		case Command::CLIENTSFROM: {
+			channel = GetWordParam(params);
+			bridge = GetWordParam(params);
+			while (!(nick = GetWordParam(params)).empty()) {
+				if (!UserExists(nick)) {
+					const int id = m_account_id_count;
+					m_account_id_count++;
+					m_se->OnNewUser(nick, "", id, bridge + " (bridge)");
+				}
+				m_se->OnJoinedFrom(channel, nick);
+			}
+			break;
+		}
+		case Command::LEFTFROM: {
+			channel = GetWordParam(params);
+			nick = GetWordParam(params);
+			m_se->OnLeftFrom(channel, nick);
+			break;
+		}
+		case Command::SAIDFROM: {
+			channel = GetWordParam(params);
+			nick = GetWordParam(params);
+			msg = GetSentenceParam(params);
+			m_se->OnSaidFrom(channel, nick, msg);
+			break;
+		}
+		case Command::UNKNOWN:
+		default: {
+			wxLogWarning(wxString::Format("??? Cmd: %s params: %s", command.cmd.c_str(), command.params.c_str()));
+			m_se->OnUnknownCommand(command.cmd, command.params);
+			break;
 		}
-	} else if (cmd == "LEFTFROM") {
-		channel = GetWordParam(params);
-		nick = GetWordParam(params);
-		m_se->OnLeftFrom(channel, nick);
-	} else if (cmd == "SAIDFROM") {
-		channel = GetWordParam(params);
-		nick = GetWordParam(params);
-		msg = GetSentenceParam(params);
-		m_se->OnSaidFrom(channel, nick, msg);
-	} else {
-		wxLogWarning(wxString::Format("??? Cmd: %s params: %s", cmd.c_str(), params.c_str()));
-		m_se->OnUnknownCommand(cmd, params);
 	}
 }
 
@@ -1876,7 +2067,7 @@ void TASServer::OnDisconnected(wxSocketError err)
 	m_connected = false;
 	m_online = false;
 	m_redirecting = false;
-	m_buffer.clear();
+	m_parser->Reset();
 	m_relay_host_manager_list.clear();
 	m_last_id = 0;
 	m_pinglist.clear();
@@ -1896,15 +2087,27 @@ void TASServer::OnDataReceived()
 		return;
 
 	m_last_net_packet = 0;
-	m_buffer += LSL::Util::Replace(STD_STRING(m_sock->Receive()), "\r", "");
+	m_parser->Feed(m_sock->Receive());
+}
 
-	size_t returnpos = m_buffer.find("\n");
-	while (returnpos != std::string::npos) {
-		const std::string cmd = m_buffer.substr(0, returnpos);
-		m_buffer = m_buffer.substr(returnpos + 1, m_buffer.size() - (returnpos + 1));
-		ExecuteCommand(cmd);
-		returnpos = m_buffer.find("\n");
+//! @brief Executes the commands decoded by the parser thread, called on the GUI thread.
+void TASServer::OnCommandsParsed()
+{
+	if (m_executing_commands) { // called from a nested event loop (i.e. a modal dialog), the outer call continues after it
+		return;
+	}
+	m_executing_commands = true;
+	ProtocolParser::Batch batch;
+	while (m_parser->Fetch(batch)) {
+		const unsigned int generation = m_parser->Generation();
+		for (const ServerCommand& command : batch) {
+			ExecuteServerCommand(command);
+			if (generation != m_parser->Generation()) { // (re)connected or disconnected, drop the rest
+				break;
+			}
+		}
 	}
+	m_executing_commands = false;
 }
 
 void TASServer::OnError(const std::string& err)
@@ -1991,7 +2194,7 @@ void TASServer::UdpPingAllClients() // used when hosting with nat holepunching.
 	std::vector<UserOrder> ordered_users;
 
 
-	for (UserList::user_map_t::size_type i = 0; i < battle->GetNumUsers(); i++) {
+	for (UserList::size_type i = 0; i < battle->GetNumUsers(); i++) {
 		User& user = battle->GetUser(i);
 		if (&user == &(battle->GetMe()))
 			continue; // dont include myself (change in copypasta)
@@ -17,6 +17,7 @@ lsl/networking/tasserver.h
 #include <string>
 #include <wx/timer.h>
 #include <list>
+#include <vector>
 
 #include "iserver.h"
 #include "inetclass.h"
@@ -30,6 +31,9 @@ class User;
 struct UserBattleStatus;
 class IServerEvents;
 class PingThread;
+class ProtocolParser;
+struct ServerCommand;
+enum class ServerVerb : unsigned char;
 
 //! @brief TASServer protocol implementation.
 class TASServer : public IServer, public iNetClass, public wxTimer
@@ -118,6 +122,9 @@ public:
 
 	void SendScriptToProxy(const std::string& script) override;
 
+	//! protocol verbs known to ExecuteCommand, see protocolparser.h
+	typedef ServerVerb Command;
+
 private:
 	void Connect(const ServerLoginInfo& server) override;
 	void SendUdpSourcePort(int udpport);
@@ -130,6 +137,10 @@ private:
 	}
 	// TASServer specific functions
 	void ExecuteCommand(const std::string& cmd, const std::string& inparams, int replyid = -1);
+	void ExecuteServerCommand(const ServerCommand& command);
+	void DispatchCommand(const ServerCommand& command);
+	//! prints per verb hit count and handler time to the server tab
+	void LogCommandStats();
 
 	void HandlePong(int replyid);
 
@@ -142,6 +153,7 @@ private:
 	void OnConnected() override;
 	void OnDisconnected(wxSocketError err) override;
 	void OnDataReceived() override;
+	void OnCommandsParsed();
 	void OnError(const std::string& err) override;
 	void OnInvalidFingerprintReceived(const std::string& fingerprint, const std::string& expected_fingerprint) override;
 
@@ -177,11 +189,19 @@ private:
 		wxLongLong t;
 	};
 
+	//! @brief Per protocol verb statistics, used to find out which commands dominate the load.
+	struct CommandStats {
+		unsigned long long hits = 0;
+		unsigned long long usecs = 0;
+	};
+
 	CRC m_crc;
 	const std::string GetSys();
 
 	ServerEvents* m_se;
 	Socket* m_sock;
+	ProtocolParser* m_parser;
+	bool m_executing_commands; //OnCommandsParsed() is running
 
 	double m_ser_ver;
 	LSL::StringVector m_relay_host_manager_list;
@@ -192,7 +212,6 @@ private:
 	bool m_debug_dont_catch;
 	bool m_id_transmission;
 	bool m_redirecting;
-	std::string m_buffer;
 	int m_last_udp_ping;
 	int m_last_ping;       //time last ping was sent
 	int m_last_net_packet; //time last packet was received
@@ -222,6 +241,8 @@ private:
 	std::string m_relay_host_bot;
 	std::string m_relay_host_manager;
 	std::string m_supported_spring_version;
+
+	std::vector<CommandStats> m_cmd_stats; //indexed by Command, last entry counts unknown commands
 };
 
 #endif // SPRINGLOBBY_HEADERGUARD_TASSERVER_H
@@ -0,0 +1,111 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+#define BOOST_TEST_MODULE basedataviewmodel
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <wx/dataview.h>
+
+#include "gui/basedataviewmodel.h"
+
+struct Item {
+	int id;
+};
+
+class ItemModel : public BaseDataViewModel<Item>
+{
+public:
+	ItemModel()
+	    : BaseDataViewModel<Item>(1)
+	{
+	}
+	void GetValue(wxVariant& variant, const wxDataViewItem& item, unsigned int) const override
+	{
+		variant = static_cast<long>(static_cast<const Item*>(item.GetID())->id);
+	}
+	wxString GetColumnType(unsigned int) const override
+	{
+		return COL_TYPE_TEXT;
+	}
+};
+
+struct Notifications {
+	int added = 0;	 //!< single ItemAdded() calls
+	int batches = 0; //!< ItemsAdded() calls
+	size_t items = 0;
+};
+
+//! counts what the view is told, a view reacts to every call
+class CountingNotifier : public wxDataViewModelNotifier
+{
+public:
+	explicit CountingNotifier(Notifications& notifications)
+	    : m_notifications(notifications)
+	{
+	}
+	bool ItemAdded(const wxDataViewItem&, const wxDataViewItem&) override
+	{
+		m_notifications.added++;
+		m_notifications.items++;
+		return true;
+	}
+	bool ItemsAdded(const wxDataViewItem&, const wxDataViewItemArray& items) override
+	{
+		m_notifications.batches++;
+		m_notifications.items += items.GetCount();
+		return true;
+	}
+	bool ItemDeleted(const wxDataViewItem&, const wxDataViewItem&) override
+	{
+		return true;
+	}
+	bool ItemChanged(const wxDataViewItem&) override
+	{
+		return true;
+	}
+	bool ValueChanged(const wxDataViewItem&, unsigned int) override
+	{
+		return true;
+	}
+	bool Cleared() override
+	{
+		return true;
+	}
+	void Resort() override
+	{
+	}
+
+private:
+	Notifications& m_notifications;
+};
+
+// the battle list after login: the snapshot is handed over at once, the
+// battles opened later one by one
+BOOST_AUTO_TEST_CASE(basedataviewmodel_additems)
+{
+	std::vector<Item> data(5001);
+	std::vector<const Item*> snapshot;
+	for (size_t i = 0; i < data.size() - 1; i++) {
+		data[i].id = i;
+		snapshot.push_back(&data[i]);
+	}
+
+	Notifications notifications;
+	ItemModel model;
+	model.AddNotifier(new CountingNotifier(notifications));
+
+	BOOST_CHECK(model.AddItems(snapshot) == 5000);
+	BOOST_CHECK(notifications.batches == 1);
+	BOOST_CHECK(notifications.added == 0);
+	BOOST_CHECK(notifications.items == 5000);
+	BOOST_CHECK(model.GetItemsCount() == 5000);
+
+	// items already listed aren't added or reported again
+	BOOST_CHECK(model.AddItems(snapshot) == 0);
+	BOOST_CHECK(notifications.batches == 1);
+
+	BOOST_CHECK(model.AddItem(data.back()));
+	BOOST_CHECK(notifications.added == 1);
+	BOOST_CHECK(notifications.items == 5001);
+	BOOST_CHECK(model.ContainsItem(data[4999]));
+	BOOST_CHECK(model.GetItemsCount() == 5001);
+}
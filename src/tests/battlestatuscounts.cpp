@@ -0,0 +1,113 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+#define BOOST_TEST_MODULE battlestatuscounts
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "battlestatuscounts.h"
+#include "user.h"
+
+static BattleStatusCounts Recount(const std::vector<UserBattleStatus>& users)
+{
+	BattleStatusCounts counts;
+	for (const UserBattleStatus& status : users) {
+		counts.Add(status);
+	}
+	return counts;
+}
+
+static UserBattleStatus RandomStatus(std::mt19937& rng, bool bot)
+{
+	UserBattleStatus status;
+	status.team = rng() % 16;
+	status.ally = rng() % 4;
+	status.spectator = !bot && rng() % 4 == 0;
+	status.ready = rng() % 2 == 0;
+	status.sync = rng() % 3;
+	if (bot) {
+		status.aishortname = "KAIK";
+	}
+	return status;
+}
+
+BOOST_AUTO_TEST_CASE(battlestatuscounts)
+{
+	std::vector<UserBattleStatus> users(3);
+	users[0].team = 1;
+	users[0].ready = true;
+	users[0].sync = SYNC_SYNCED;
+	users[1].team = 1;
+	users[1].ally = 1;
+	users[2].spectator = true;
+	users[2].ready = true;
+	BattleStatusCounts counts = Recount(users);
+	BOOST_CHECK(counts.teams.size() == 1 && counts.teams[1] == 2);
+	BOOST_CHECK(counts.allies.size() == 2 && counts.allies[0] == 1 && counts.allies[1] == 1);
+	BOOST_CHECK(counts.ready == 1 && counts.sync == 1 && counts.ok == 1);
+
+	// bots take a team but are never counted as ready
+	UserBattleStatus bot;
+	bot.aishortname = "KAIK";
+	bot.team = 2;
+	bot.ready = true;
+	counts.Add(bot);
+	BOOST_CHECK(counts.teams[2] == 1 && counts.ready == 1);
+
+	// empty teams are dropped
+	counts.Remove(bot);
+	counts.Remove(users[1]);
+	BOOST_CHECK(counts.teams.size() == 1 && counts.teams[1] == 1);
+	BOOST_CHECK(counts.allies.size() == 1);
+	counts.Remove(users[0]);
+	BOOST_CHECK(counts == BattleStatusCounts());
+}
+
+// status updates, joins and leaves of a full battle, the counters are kept
+// up to date without a recount
+BOOST_AUTO_TEST_CASE(battlestatuscounts_updates)
+{
+	std::mt19937 rng(42);
+	std::vector<UserBattleStatus> users;
+	for (int i = 0; i < 32; i++) {
+		users.push_back(RandomStatus(rng, i % 8 == 0));
+	}
+	BattleStatusCounts counts = Recount(users);
+
+	const int updates = 100000;
+	int mismatches = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < updates; i++) {
+		const size_t user = rng() % users.size();
+		const unsigned int event = rng() % 16;
+		if (event == 0 && users.size() > 16) { // leaves
+			counts.Remove(users[user]);
+			users.erase(users.begin() + user);
+		} else if (event == 1 && users.size() < 48) { // joins
+			users.push_back(RandomStatus(rng, rng() % 8 == 0));
+			counts.Add(users.back());
+		} else {
+			const UserBattleStatus status = RandomStatus(rng, users[user].IsBot());
+			counts.Remove(users[user]);
+			users[user] = status;
+			counts.Add(status);
+		}
+		if (i % 1000 == 0 && counts != Recount(users)) {
+			mismatches++;
+		}
+	}
+	const auto updated = std::chrono::steady_clock::now();
+	BOOST_CHECK(mismatches == 0);
+	BOOST_CHECK(counts == Recount(users));
+
+	// what each update used to cost
+	for (int i = 0; i < updates; i++) {
+		counts = Recount(users);
+	}
+	const auto recounted = std::chrono::steady_clock::now();
+	const double update_ms = std::chrono::duration<double, std::milli>(updated - start).count();
+	const double recount_ms = std::chrono::duration<double, std::milli>(recounted - updated).count();
+	BOOST_TEST_MESSAGE("battlestatuscounts: " << updates << " updates in " << update_ms << " ms, recounting took " << recount_ms << " ms");
+	BOOST_CHECK(update_ms < recount_ms);
+}
@@ -0,0 +1,78 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+#define BOOST_TEST_MODULE chathistory
+
+#include <boost/test/unit_test.hpp>
+
+#include "gui/chathistory.h"
+
+BOOST_AUTO_TEST_CASE(chathistory_trim)
+{
+	ChatHistory history;
+	history.SetLimit(8); // crops in chunks of 2 lines
+	BOOST_CHECK(history.GetLimit() == 8);
+
+	for (long i = 1; i <= 9; i++) {
+		BOOST_CHECK(history.Trim() == 0);
+		history.Add(i);
+	}
+	BOOST_CHECK(history.GetCount() == 9);
+	// one line over the limit isn't a whole chunk yet
+	BOOST_CHECK(history.Trim() == 0);
+	history.Add(10);
+	// the two oldest lines go at once
+	BOOST_CHECK(history.Trim() == 1 + 2);
+	BOOST_CHECK(history.GetCount() == 8);
+
+	for (long i = 11; i <= 12; i++) {
+		BOOST_CHECK(history.Trim() == 0);
+		history.Add(i);
+	}
+	BOOST_CHECK(history.Trim() == 3 + 4);
+	BOOST_CHECK(history.GetCount() == 8);
+}
+
+BOOST_AUTO_TEST_CASE(chathistory_clear)
+{
+	ChatHistory history;
+	history.SetLimit(4);
+	for (long i = 1; i <= 4; i++) {
+		history.Trim();
+		history.Add(10);
+	}
+	history.Clear();
+	BOOST_CHECK(history.GetCount() == 0);
+	// lines cleared from the control are never removed again
+	for (long i = 1; i <= 5; i++) {
+		BOOST_CHECK(history.Trim() == 0);
+		history.Add(i);
+	}
+	BOOST_CHECK(history.Trim() == 1);
+	BOOST_CHECK(history.GetCount() == 4);
+}
+
+BOOST_AUTO_TEST_CASE(chathistory_limit)
+{
+	ChatHistory history;
+	// without a limit nothing is tracked
+	history.Add(5);
+	BOOST_CHECK(history.GetCount() == 0);
+	BOOST_CHECK(history.Trim() == 0);
+
+	history.SetLimit(8);
+	for (long i = 1; i <= 8; i++) {
+		history.Trim();
+		history.Add(i);
+	}
+	// lowering the limit keeps the newest lines, the dropped ones are
+	// removed from the control with the next chunk
+	history.SetLimit(4);
+	BOOST_CHECK(history.GetCount() == 4);
+	BOOST_CHECK(history.Trim() == 0);
+	history.Add(9);
+	BOOST_CHECK(history.Trim() == 1 + 2 + 3 + 4 + 5);
+	BOOST_CHECK(history.GetCount() == 4);
+
+	history.SetLimit(0);
+	BOOST_CHECK(history.GetCount() == 0);
+	BOOST_CHECK(history.Trim() == 0);
+}
@@ -2,12 +2,25 @@
 #define BOOST_TEST_MODULE slconfig
 
 #include <boost/test/unit_test.hpp>
+#include <wx/file.h>
 #include <wx/filefn.h>
 #include <wx/filename.h>
 #include <wx/log.h>
 #include <wx/string.h>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #include "chatlog.h"
+#include "chatlogindex.h"
+#include "chatlogwriter.h"
+#include "utils/conversion.h"
+#include "utils/tailscanner.h"
 #include "testingstuff/silent_logger.h"
 
 struct TestInitializer {
@@ -59,3 +72,201 @@ BOOST_AUTO_TEST_CASE(slconfig)
 
 	delete logfile;
 }
+
+// logs lines of busy channels, appending must not wait for the disk
+BOOST_AUTO_TEST_CASE(chatlog_throughput)
+{
+	const int files = 20;
+	const int lines = 20000;
+	const std::string line = "[12:34:56] <[CLAN]SomePlayer> some chat message of a typical length\n";
+
+	ChatLogWriter writer;
+	std::vector<wxString> paths;
+	std::vector<int> ids;
+	for (int i = 0; i < files; i++) {
+		paths.push_back(wxFileName::GetTempDir() + wxString::Format(_T("/sltest_throughput%d.log"), i));
+		wxRemoveFile(paths[i]);
+		ids.push_back(writer.Open(paths[i]));
+		BOOST_REQUIRE(ids[i] >= 0);
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	for (int l = 0; l < lines; l++) {
+		for (int i = 0; i < files; i++) {
+			BOOST_CHECK(writer.Append(ids[i], std::string(line)));
+		}
+	}
+	const auto appended = std::chrono::steady_clock::now();
+	for (int i = 0; i < files; i++) {
+		BOOST_CHECK(writer.Close(ids[i]));
+	}
+	const auto closed = std::chrono::steady_clock::now();
+
+	const double append_ms = std::chrono::duration<double, std::milli>(appended - start).count();
+	const double close_ms = std::chrono::duration<double, std::milli>(closed - appended).count();
+	BOOST_TEST_MESSAGE("chatlog: " << files * lines << " lines to " << files << " files, append " << append_ms << " ms, close " << close_ms << " ms");
+	BOOST_CHECK(append_ms < files * lines / 100.0); // 10 us per line
+
+	for (int i = 0; i < files; i++) {
+		wxFile file(paths[i]);
+		BOOST_CHECK(file.Length() == static_cast<wxFileOffset>(lines * line.size()));
+		file.Close();
+		wxRemoveFile(paths[i]);
+	}
+}
+
+// loads the backlog of a big log, only its tail is read
+BOOST_AUTO_TEST_CASE(chatlog_backlog)
+{
+	const wxString path = wxFileName::GetTempDir() + _T("/sltest_backlog.log");
+	const std::string line = "[12:34:56] <[CLAN]SomePlayer> some chat message of a typical length\n";
+	const size_t count = 500 * 1000; // ~35MB
+	{
+		std::string chunk;
+		for (int i = 0; i < 1000; i++) {
+			chunk += line;
+		}
+		wxFile file(path, wxFile::write);
+		for (size_t i = 0; i < count / 1000; i++) {
+			BOOST_REQUIRE(file.Write(chunk.data(), chunk.size()) == chunk.size());
+		}
+		BOOST_REQUIRE(file.Write("last line\n", 10) == 10);
+	}
+
+	wxFile file(path, wxFile::read);
+	MappedFile mapped(file);
+	BOOST_REQUIRE(mapped.IsOk());
+	BOOST_CHECK(mapped.GetSize() == count * line.size() + 10);
+	std::vector<std::string_view> lines;
+	BOOST_CHECK(FindTailLines(mapped.GetData(), mapped.GetSize(), "\n", 10000, true, lines) == 10000);
+	BOOST_REQUIRE(lines.size() == 10000);
+	BOOST_CHECK(lines.back() == "last line");
+	BOOST_CHECK(lines.front() == line.substr(0, line.size() - 1));
+	BOOST_CHECK(lines.front().data() == mapped.GetData() + mapped.GetSize() - 10 - 9999 * line.size());
+
+#ifndef _WIN32
+	{
+		// the start of the text is unreadable, scanning further back than needed would crash
+		const size_t page = sysconf(_SC_PAGESIZE);
+		const size_t tail = 100 * line.size() + 10;
+		const size_t guard = 16 * page;
+		const size_t size = guard + (tail + page - 1) / page * page;
+		char* const mem = static_cast<char*>(mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+		BOOST_REQUIRE(mem != MAP_FAILED);
+		char* const text = mem + size - tail;
+		for (size_t i = 0; i < 100; i++) {
+			memcpy(text + i * line.size(), line.data(), line.size());
+		}
+		memcpy(text + 100 * line.size(), "last line\n", 10);
+		BOOST_REQUIRE(mprotect(mem, guard, PROT_NONE) == 0);
+		BOOST_CHECK(FindTailLines(mem, size, "\n", 50, false, lines) == 50);
+		BOOST_CHECK(lines.back() == "last line");
+		BOOST_CHECK(lines.front().data() == text + 51 * line.size());
+		munmap(mem, size);
+	}
+#endif
+
+	// all lines of a small log, the first one too
+	const char text[] = "first\n\nsecond\r\nincomplete";
+	BOOST_CHECK(FindTailLines(text, sizeof(text) - 1, "\n", 10, true, lines) == 2);
+	BOOST_CHECK(lines[0] == "first");
+	BOOST_CHECK(lines[1] == "second\r");
+	BOOST_CHECK(FindTailLines(text, sizeof(text) - 1, "\r\n", 10, false, lines) == 0);
+	BOOST_CHECK(FindTailLines(text, sizeof(text) - 1, "\r\n", 10, true, lines) == 1);
+	BOOST_CHECK(lines[0] == "first\n\nsecond");
+
+	file.Close();
+	wxRemoveFile(path);
+}
+
+static void AppendLines(const std::string& path, const std::string& lines)
+{
+	std::ofstream file(path, std::ios::app | std::ios::binary);
+	file << lines;
+}
+
+BOOST_AUTO_TEST_CASE(chatlog_index)
+{
+	const std::string root = STD_STRING(wxFileName::GetTempDir()) + "/sltest_chatlogindex/";
+	const std::string log = root + "server/main.txt";
+	wxMkdir(TowxString(root));
+	wxMkdir(TowxString(root + "server"));
+	wxRemoveFile(TowxString(log));
+	wxRemoveFile(TowxString(root + "server/main.idx"));
+
+	AppendLines(log, "### Session started at 2024-01-05 23:58\n"
+			 "[23:59:00] <Alice> hello World foo\n"
+			 "[00:00:10] <Bob> foo bar\n"
+			 "[00:01:00] * Alice waves foo\n");
+	{
+		ChatLogIndex index(root);
+		index.Sync();
+
+		ChatLogIndex::Query query;
+		query.text = "FOO";
+		std::vector<ChatLogIndex::Message> res = index.Search(query);
+		BOOST_REQUIRE(res.size() == 3);
+		BOOST_CHECK(res[0].line == "[00:01:00] * Alice waves foo");
+		BOOST_CHECK(res[0].server == "server");
+		BOOST_CHECK(res[0].channel == "main");
+
+		query.nick = "alice";
+		BOOST_CHECK(index.Search(query).size() == 2);
+
+		struct tm tm = {};
+		tm.tm_year = 2024 - 1900;
+		tm.tm_mday = 6;
+		tm.tm_isdst = -1;
+		query.since = mktime(&tm);
+		BOOST_CHECK(index.Search(query).size() == 1);
+
+		// the unfinished line is indexed when it is complete
+		index.Watch(log);
+		AppendLines(log, "[00:02:00] <Carol> partial");
+		index.Sync();
+	}
+	AppendLines(log, " line\n");
+
+	// only the new part of the log is indexed after a restart
+	ChatLogIndex index(root);
+	index.Sync();
+	ChatLogIndex::Query query;
+	query.server = "server";
+	query.channel = "main";
+	query.nick = "Carol";
+	query.text = "partial line";
+	std::vector<ChatLogIndex::Message> res = index.Search(query);
+	BOOST_REQUIRE(res.size() == 1);
+	BOOST_CHECK(res[0].line == "[00:02:00] <Carol> partial line");
+}
+
+BOOST_AUTO_TEST_CASE(chatlog_index_truncated)
+{
+	const std::string root = STD_STRING(wxFileName::GetTempDir()) + "/sltest_chatlogtruncated/";
+	const std::string log = root + "server/main.txt";
+	wxMkdir(TowxString(root));
+	wxMkdir(TowxString(root + "server"));
+	wxRemoveFile(TowxString(log));
+	wxRemoveFile(TowxString(root + "server/main.idx"));
+
+	AppendLines(log, "[10:00:00] <Alice> a rather long first line about apples\n"
+			 "[10:01:00] <Alice> and a second one about apples\n");
+	ChatLogIndex index(root);
+	index.Sync();
+	ChatLogIndex::Query query;
+	query.text = "apples";
+	BOOST_CHECK(index.Search(query).size() == 2);
+
+	// the log is recreated shorter than what was indexed of it
+	wxRemoveFile(TowxString(log));
+	AppendLines(log, "[11:00:00] <Bob> pears\n");
+	index.Watch(log);
+	index.Sync();
+	BOOST_CHECK(index.Search(query).empty());
+	query.text = "pears";
+	std::vector<ChatLogIndex::Message> res = index.Search(query);
+	BOOST_REQUIRE(res.size() == 1);
+	BOOST_CHECK(res[0].line == "[11:00:00] <Bob> pears");
+
+	index.Stop();
+}
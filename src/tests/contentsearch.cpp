@@ -0,0 +1,249 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+#define BOOST_TEST_MODULE contentsearch
+
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "downloader/contentsearch.h"
+#include "testingstuff/silent_logger.h"
+
+struct TestInitializer {
+	TestInitializer()
+	{
+		InitWxLogger();
+	}
+	~TestInitializer()
+	{
+	}
+};
+
+BOOST_GLOBAL_FIXTURE(TestInitializer);
+
+// stands in for springfiles: every query except "nothing" finds one map
+// named after it
+class FakeServer
+{
+public:
+	FakeServer()
+	    : m_blocked(false)
+	{
+	}
+
+	ContentSearch::Fetcher Fetcher()
+	{
+		return [this](const std::string& query, ContentSearch::Results& results, const ContentSearch::Cancelled& /*cancelled*/) {
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_queries.push_back(query);
+			m_changed.notify_all();
+			m_changed.wait(lock, [this] { return !m_blocked; });
+			if (query.find("nothing") != std::string::npos && query != "*nothing*") {
+				return true;
+			}
+			ContentSearch::Result result;
+			result.name = query;
+			result.category = DownloadEnum::CAT_MAP;
+			result.filesize = 1;
+			result.downloaded = false;
+			results.push_back(result);
+			return true;
+		};
+	}
+
+	std::vector<std::string> Queries()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_queries;
+	}
+	void Block(bool blocked)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_blocked = blocked;
+		m_changed.notify_all();
+	}
+	void WaitForQueries(size_t count)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_changed.wait(lock, [this, count] { return m_queries.size() >= count; });
+	}
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_changed;
+	std::vector<std::string> m_queries;
+	bool m_blocked;
+};
+
+// collects the delivered results
+class Receiver
+{
+public:
+	ContentSearch::Callback Callback()
+	{
+		return [this](unsigned int id, const ContentSearch::Results& results) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_received.push_back(std::make_pair(id, results));
+			m_changed.notify_all();
+		};
+	}
+	std::pair<unsigned int, ContentSearch::Results> Wait(size_t count = 1)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_changed.wait(lock, [this, count] { return m_received.size() >= count; });
+		return m_received.back();
+	}
+	size_t Count()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_received.size();
+	}
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_changed;
+	std::vector<std::pair<unsigned int, ContentSearch::Results> > m_received;
+};
+
+static void NoneDownloaded(ContentSearch::Results& results)
+{
+	for (ContentSearch::Result& result : results) {
+		result.downloaded = false;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(contentsearch_cache)
+{
+	FakeServer server;
+	Receiver receiver;
+	std::atomic<int> resolved(0);
+	ContentSearch search(server.Fetcher(), [&resolved](ContentSearch::Results& results) {
+		resolved++;
+		for (ContentSearch::Result& result : results) {
+			result.downloaded = resolved > 1;
+		}
+	}, 2, std::chrono::minutes(1));
+
+	const unsigned int id = search.Search("delta", receiver.Callback());
+	auto received = receiver.Wait(1);
+	BOOST_CHECK(received.first == id);
+	BOOST_REQUIRE(received.second.size() == 1);
+	BOOST_CHECK(received.second[0].name == "delta");
+	BOOST_CHECK(!received.second[0].downloaded);
+
+	// cached, but whether it's downloaded is checked again
+	search.Search("delta", receiver.Callback());
+	received = receiver.Wait(2);
+	BOOST_REQUIRE(received.second.size() == 1);
+	BOOST_CHECK(received.second[0].downloaded);
+	BOOST_CHECK(server.Queries().size() == 1);
+	BOOST_CHECK(resolved == 2);
+
+	// the least recently used query is dropped
+	search.Search("comet", receiver.Callback());
+	receiver.Wait(3);
+	search.Search("delta", receiver.Callback());
+	receiver.Wait(4);
+	search.Search("tabula", receiver.Callback());
+	receiver.Wait(5);
+	search.Search("delta", receiver.Callback());
+	receiver.Wait(6);
+	BOOST_CHECK(server.Queries().size() == 3);
+	search.Search("comet", receiver.Callback());
+	receiver.Wait(7);
+	BOOST_CHECK(server.Queries().size() == 4);
+}
+
+BOOST_AUTO_TEST_CASE(contentsearch_ttl)
+{
+	FakeServer server;
+	Receiver receiver;
+	ContentSearch search(server.Fetcher(), NoneDownloaded, 8, std::chrono::milliseconds(20));
+	search.Search("delta", receiver.Callback());
+	receiver.Wait(1);
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	search.Search("delta", receiver.Callback());
+	receiver.Wait(2);
+	BOOST_CHECK(server.Queries().size() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(contentsearch_wildcard)
+{
+	FakeServer server;
+	Receiver receiver;
+	ContentSearch search(server.Fetcher(), NoneDownloaded, 8, std::chrono::minutes(1));
+	search.Search("nothing", receiver.Callback());
+	const auto received = receiver.Wait(1);
+	const std::vector<std::string> expected = {"nothing", "*nothing*"};
+	BOOST_CHECK(server.Queries() == expected);
+	BOOST_REQUIRE(received.second.size() == 1);
+	BOOST_CHECK(received.second[0].name == "*nothing*");
+}
+
+BOOST_AUTO_TEST_CASE(contentsearch_stale)
+{
+	FakeServer server;
+	Receiver receiver;
+	ContentSearch search(server.Fetcher(), NoneDownloaded, 8, std::chrono::minutes(1));
+
+	// the user keeps typing while the first query runs
+	server.Block(true);
+	search.Search("d", receiver.Callback());
+	server.WaitForQueries(1);
+	search.Search("de", receiver.Callback());
+	search.Search("del", receiver.Callback());
+	const unsigned int id = search.Search("delta", receiver.Callback());
+	server.Block(false);
+
+	const auto received = receiver.Wait(1);
+	BOOST_CHECK(received.first == id);
+	BOOST_CHECK(received.second[0].name == "delta");
+	// the queries in between were never run
+	const std::vector<std::string> expected = {"d", "delta"};
+	BOOST_CHECK(server.Queries() == expected);
+
+	// cancelled results are dropped as well
+	server.Block(true);
+	search.Search("comet", receiver.Callback());
+	server.WaitForQueries(3);
+	search.Cancel();
+	server.Block(false);
+	search.Search("delta", receiver.Callback());
+	receiver.Wait(2);
+	BOOST_CHECK(receiver.Count() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(contentsearch_abort)
+{
+	std::atomic<int> started(0);
+	std::atomic<int> aborted(0);
+	// a request which hangs until it is given up
+	const ContentSearch::Fetcher hanging = [&started, &aborted](const std::string& /*query*/, ContentSearch::Results& /*results*/, const ContentSearch::Cancelled& cancelled) {
+		started++;
+		while (!cancelled()) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		aborted++;
+		return false;
+	};
+	Receiver receiver;
+	{
+		ContentSearch search(hanging, NoneDownloaded, 8, std::chrono::minutes(1));
+		search.Search("delta", receiver.Callback());
+		while (started == 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		// a new query gives up the running one
+		search.Search("comet", receiver.Callback());
+		while (started < 2) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		BOOST_CHECK(aborted == 1);
+	} // and so does closing the dialog
+	BOOST_CHECK(aborted == 2);
+	BOOST_CHECK(receiver.Count() == 0);
+}
@@ -0,0 +1,148 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+#define BOOST_TEST_MODULE downloadprogressregistry
+
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "downloader/downloadprogressregistry.h"
+
+typedef DownloadProgressRegistry::Progress Progress;
+typedef DownloadProgressRegistry::Clock Clock;
+
+BOOST_AUTO_TEST_CASE(downloadprogressregistry_rate)
+{
+	DownloadProgressRegistry registry;
+	const std::shared_ptr<DownloadProgressRegistry::Entry> entry = registry.Start("map");
+	const Clock::time_point start = Clock::now();
+
+	entry->Update(0, 10000, start);
+	Progress progress = entry->Get();
+	BOOST_CHECK(progress.running);
+	BOOST_CHECK(progress.total == 10000);
+	BOOST_CHECK(progress.bytesPerSecond == 0);
+	BOOST_CHECK(progress.eta == -1);
+
+	// no rate before a window passed
+	entry->Update(500, 10000, start + std::chrono::milliseconds(500));
+	BOOST_CHECK(entry->Get().bytesPerSecond == 0);
+	BOOST_CHECK(entry->Get().downloaded == 500);
+
+	entry->Update(1000, 10000, start + std::chrono::milliseconds(1000));
+	progress = entry->Get();
+	BOOST_CHECK(progress.bytesPerSecond == 1000);
+	BOOST_CHECK(progress.eta == 9);
+
+	// averaged with the last window
+	entry->Update(4000, 10000, start + std::chrono::milliseconds(2000));
+	progress = entry->Get();
+	BOOST_CHECK(progress.bytesPerSecond == 2000);
+	BOOST_CHECK(progress.eta == 3);
+
+	// a retry starts over
+	entry->Update(0, 10000, start + std::chrono::milliseconds(2500));
+	BOOST_CHECK(entry->Get().downloaded == 0);
+
+	entry->Finish(true);
+	progress = entry->Get();
+	BOOST_CHECK(!progress.running);
+	BOOST_CHECK(!progress.failed);
+	BOOST_CHECK(progress.downloaded == 10000);
+	BOOST_CHECK(progress.eta == -1);
+	BOOST_CHECK(!registry.IsRunning());
+}
+
+BOOST_AUTO_TEST_CASE(downloadprogressregistry_entries)
+{
+	DownloadProgressRegistry registry;
+	const std::shared_ptr<DownloadProgressRegistry::Entry> map = registry.Start("map");
+	const std::shared_ptr<DownloadProgressRegistry::Entry> game = registry.Start("game");
+	map->Update(10, 100);
+	game->Update(20, 200);
+	BOOST_CHECK(registry.IsRunning());
+
+	std::vector<Progress> all = registry.Snapshot();
+	BOOST_REQUIRE(all.size() == 2);
+	BOOST_CHECK(all[0].name == "map" && all[0].downloaded == 10);
+	BOOST_CHECK(all[1].name == "game" && all[1].downloaded == 20);
+
+	// a retried download replaces its finished entry
+	map->Finish(false);
+	Progress progress;
+	BOOST_REQUIRE(registry.Find("map", progress));
+	BOOST_CHECK(progress.failed);
+	registry.Start("map");
+	all = registry.Snapshot();
+	BOOST_REQUIRE(all.size() == 2);
+	BOOST_CHECK(all[1].name == "map" && all[1].running);
+	BOOST_CHECK(!registry.Find("engine", progress));
+
+	game->Finish(true);
+	registry.ClearFinished();
+	all = registry.Snapshot();
+	BOOST_REQUIRE(all.size() == 1);
+	BOOST_CHECK(all[0].name == "map");
+}
+
+BOOST_AUTO_TEST_CASE(downloadprogressregistry_prune)
+{
+	DownloadProgressRegistry registry;
+	const std::shared_ptr<DownloadProgressRegistry::Entry> running = registry.Start("running");
+	for (size_t i = 0; i < DownloadProgressRegistry::MAX_FINISHED + 10; i++) {
+		registry.Start("download" + std::to_string(i))->Finish(i % 2 == 0);
+	}
+	// the oldest finished ones are dropped, running ones are kept
+	registry.Start("last");
+	std::vector<Progress> all = registry.Snapshot();
+	BOOST_REQUIRE(all.size() == DownloadProgressRegistry::MAX_FINISHED + 2);
+	BOOST_CHECK(all.front().name == "running");
+	BOOST_CHECK(all[1].name == "download10");
+	BOOST_CHECK(all.back().name == "last");
+	Progress progress;
+	BOOST_CHECK(!registry.Find("download9", progress));
+}
+
+BOOST_AUTO_TEST_CASE(downloadprogressregistry_concurrent)
+{
+	DownloadProgressRegistry registry;
+	const int DOWNLOADS = 4;
+	const int64_t SIZE = 20000;
+	std::atomic<bool> done(false);
+	std::atomic<bool> overrun(false);
+	std::vector<std::thread> writers;
+	for (int i = 0; i < DOWNLOADS; i++) {
+		writers.emplace_back([&registry, i, SIZE]() {
+			const std::shared_ptr<DownloadProgressRegistry::Entry> entry = registry.Start("download" + std::to_string(i));
+			for (int64_t downloaded = 0; downloaded <= SIZE; downloaded += 100) {
+				entry->Update(downloaded, SIZE);
+			}
+			entry->Finish(true);
+		});
+	}
+	// the ui polls while the downloads run
+	std::thread reader([&registry, &done, &overrun, SIZE]() {
+		while (!done) {
+			for (const Progress& progress : registry.Snapshot()) {
+				if (progress.downloaded > SIZE) {
+					overrun = true;
+				}
+			}
+		}
+	});
+	for (std::thread& writer : writers) {
+		writer.join();
+	}
+	done = true;
+	reader.join();
+	BOOST_CHECK(!overrun);
+
+	const std::vector<Progress> all = registry.Snapshot();
+	BOOST_REQUIRE(all.size() == DOWNLOADS);
+	for (const Progress& progress : all) {
+		BOOST_CHECK(!progress.running);
+		BOOST_CHECK(progress.downloaded == SIZE);
+	}
+}
@@ -0,0 +1,263 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+#define BOOST_TEST_MODULE downloadscheduler
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "downloader/downloadscheduler.h"
+#include "testingstuff/httpstandin.h"
+#include "testingstuff/silent_logger.h"
+
+struct TestInitializer {
+	TestInitializer()
+	{
+		InitWxLogger();
+	}
+	~TestInitializer()
+	{
+	}
+};
+
+BOOST_GLOBAL_FIXTURE(TestInitializer);
+
+typedef DownloadScheduler::CancelToken CancelToken;
+
+// records the order jobs run in and how many run at once
+class JobLog
+{
+public:
+	DownloadScheduler::Job Job(const std::string& name, int ms = 20)
+	{
+		return [this, name, ms](const CancelToken&) {
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_order.push_back(name);
+				m_max_running = std::max(m_max_running, ++m_running);
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_running--;
+		};
+	}
+	std::vector<std::string> Order()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_order;
+	}
+	int MaxRunning()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_max_running;
+	}
+
+private:
+	std::mutex m_mutex;
+	std::vector<std::string> m_order;
+	int m_running = 0;
+	int m_max_running = 0;
+};
+
+BOOST_AUTO_TEST_CASE(downloadscheduler_queue)
+{
+	DownloadScheduler scheduler(1);
+	JobLog log;
+
+	// block the only worker so everything below gets queued
+	std::atomic<bool> started(false);
+	std::atomic<bool> release(false);
+	scheduler.Schedule(DownloadEnum::CAT_NONE, "gate", DownloadScheduler::PRIORITY_NORMAL, [&started, &release](const CancelToken&) {
+		started = true;
+		while (!release) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	});
+	while (!started) {
+		std::this_thread::yield();
+	}
+	scheduler.Schedule(DownloadEnum::CAT_MAP, "a", DownloadScheduler::PRIORITY_NORMAL, log.Job("a"));
+	scheduler.Schedule(DownloadEnum::CAT_GAME, "b", DownloadScheduler::PRIORITY_BACKGROUND, log.Job("b"));
+	scheduler.Schedule(DownloadEnum::CAT_GAME, "c", DownloadScheduler::PRIORITY_NORMAL, log.Job("c"));
+	scheduler.Schedule(DownloadEnum::CAT_MAP, "d", DownloadScheduler::PRIORITY_NORMAL, log.Job("d"));
+
+	// duplicates are dropped, but raise the priority
+	const std::shared_ptr<CancelToken> token = scheduler.Schedule(DownloadEnum::CAT_ENGINE, "e", DownloadScheduler::PRIORITY_NORMAL, log.Job("e"));
+	BOOST_CHECK(scheduler.Schedule(DownloadEnum::CAT_ENGINE, "e", DownloadScheduler::PRIORITY_BATTLE, log.Job("e2")) == token);
+	BOOST_CHECK(scheduler.Schedule(DownloadEnum::CAT_GAME, "b", DownloadScheduler::PRIORITY_BACKGROUND, log.Job("b2")) != token);
+	// same name in another category is another job
+	scheduler.Schedule(DownloadEnum::CAT_GAME, "a", DownloadScheduler::PRIORITY_BATTLE, log.Job("game a"));
+	BOOST_CHECK(scheduler.GetPendingCount() == 7);
+
+	// a queued job which is cancelled never runs
+	BOOST_CHECK(scheduler.Cancel(DownloadEnum::CAT_MAP, "d"));
+	BOOST_CHECK(!scheduler.Cancel(DownloadEnum::CAT_MAP, "d"));
+
+	release = true;
+	scheduler.WaitIdle();
+	const std::vector<std::string> expected = {"e", "game a", "a", "c", "b"};
+	BOOST_CHECK(log.Order() == expected);
+	BOOST_CHECK(scheduler.GetPendingCount() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(downloadscheduler_limits)
+{
+	DownloadScheduler scheduler(4);
+	scheduler.SetCategoryLimit(DownloadEnum::CAT_ENGINE, 1);
+	JobLog engines;
+	JobLog maps;
+	for (int i = 0; i < 4; i++) {
+		scheduler.Schedule(DownloadEnum::CAT_ENGINE, "engine" + std::to_string(i), DownloadScheduler::PRIORITY_NORMAL, engines.Job("engine"));
+		scheduler.Schedule(DownloadEnum::CAT_MAP, "map" + std::to_string(i), DownloadScheduler::PRIORITY_NORMAL, maps.Job("map", 50));
+	}
+	scheduler.WaitIdle();
+	BOOST_CHECK(engines.Order().size() == 4);
+	BOOST_CHECK(engines.MaxRunning() == 1);
+	BOOST_CHECK(maps.MaxRunning() > 1);
+}
+
+BOOST_AUTO_TEST_CASE(downloadscheduler_background)
+{
+	DownloadScheduler scheduler(2);
+	JobLog log;
+
+	// runs until it is cancelled
+	std::atomic<bool> started(false);
+	std::atomic<bool> cancelled(false);
+	const auto background = [&started, &cancelled](const CancelToken& token) {
+		started = true;
+		for (int i = 0; i < 5000 && !token.IsCancelled(); i++) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		cancelled = token.IsCancelled();
+	};
+
+	// asking for the same content again keeps it running
+	std::shared_ptr<CancelToken> token = scheduler.Schedule(DownloadEnum::CAT_MAP, "map", DownloadScheduler::PRIORITY_BACKGROUND, background);
+	while (!started) {
+		std::this_thread::yield();
+	}
+	BOOST_CHECK(scheduler.Schedule(DownloadEnum::CAT_MAP, "map", DownloadScheduler::PRIORITY_NORMAL, log.Job("map")) == token);
+	BOOST_CHECK(!token->IsCancelled());
+	scheduler.Cancel(DownloadEnum::CAT_MAP, "map");
+	scheduler.WaitIdle();
+
+	// other content preempts it, background jobs wait for the others
+	started = false;
+	cancelled = false;
+	token = scheduler.Schedule(DownloadEnum::CAT_MAP, "prefetch", DownloadScheduler::PRIORITY_BACKGROUND, background);
+	while (!started) {
+		std::this_thread::yield();
+	}
+	scheduler.Schedule(DownloadEnum::CAT_GAME, "game", DownloadScheduler::PRIORITY_BATTLE, log.Job("game", 50));
+	scheduler.Schedule(DownloadEnum::CAT_GAME, "other prefetch", DownloadScheduler::PRIORITY_BACKGROUND, log.Job("other prefetch"));
+	BOOST_CHECK(token->IsCancelled());
+	scheduler.WaitIdle();
+	BOOST_CHECK(cancelled);
+	const std::vector<std::string> expected = {"game", "other prefetch"};
+	BOOST_CHECK(log.Order() == expected);
+}
+
+BOOST_AUTO_TEST_CASE(downloadscheduler_preempt)
+{
+	DownloadScheduler scheduler(2);
+	scheduler.SetCategoryLimit(DownloadEnum::CAT_MAP, 1);
+	JobLog log;
+
+	// a transfer which doesn't notice the cancellation for a while
+	std::atomic<bool> started(false);
+	std::atomic<bool> done(false);
+	scheduler.Schedule(DownloadEnum::CAT_MAP, "prefetch", DownloadScheduler::PRIORITY_BACKGROUND, [&started, &done](const CancelToken&) {
+		started = true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(300));
+		done = true;
+	});
+	while (!started) {
+		std::this_thread::yield();
+	}
+
+	// the other worker is kept for what the user asks for
+	scheduler.Schedule(DownloadEnum::CAT_GAME, "other prefetch", DownloadScheduler::PRIORITY_BACKGROUND, log.Job("other prefetch"));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	BOOST_CHECK(log.Order().empty());
+
+	// neither the worker nor the map slot of the preempted one hold it up
+	std::atomic<bool> waited(true);
+	scheduler.Schedule(DownloadEnum::CAT_MAP, "map", DownloadScheduler::PRIORITY_BATTLE, [&done, &waited](const CancelToken&) {
+		waited = done.load();
+	});
+	scheduler.WaitIdle();
+	BOOST_CHECK(!waited);
+	BOOST_CHECK(log.Order().size() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(downloadscheduler_preempt_same)
+{
+	DownloadScheduler scheduler(3);
+
+	// the preempted prefetch is still in its transfer when the map is asked for
+	std::atomic<bool> started(false);
+	std::atomic<bool> done(false);
+	scheduler.Schedule(DownloadEnum::CAT_MAP, "map", DownloadScheduler::PRIORITY_BACKGROUND, [&started, &done](const CancelToken&) {
+		started = true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		done = true;
+	});
+	while (!started) {
+		std::this_thread::yield();
+	}
+	scheduler.Schedule(DownloadEnum::CAT_GAME, "game", DownloadScheduler::PRIORITY_BATTLE, [](const CancelToken&) {});
+
+	// the new download waits for it instead of writing the same files
+	std::atomic<bool> overlapped(true);
+	scheduler.Schedule(DownloadEnum::CAT_MAP, "map", DownloadScheduler::PRIORITY_BATTLE, [&done, &overlapped](const CancelToken&) {
+		overlapped = !done;
+	});
+	scheduler.WaitIdle();
+	BOOST_CHECK(done);
+	BOOST_CHECK(!overlapped);
+}
+
+#ifndef _WIN32
+BOOST_AUTO_TEST_CASE(downloadscheduler_http)
+{
+	// a slow rapid mirror
+	HttpStandIn server;
+	HttpStandIn::Route slow;
+	slow.chunkDelay = 25;
+	server.SetRoute("/rapid/", slow);
+	DownloadScheduler scheduler(3);
+	std::mutex mutex;
+	std::map<std::string, long> sizes;
+	std::map<std::string, std::chrono::steady_clock::time_point> finished;
+	const auto download = [&](const std::string& path) {
+		return [&, path](const CancelToken& token) {
+			const long size = server.Get(path, [&token] { return token.IsCancelled(); }).size;
+			std::lock_guard<std::mutex> lock(mutex);
+			sizes[path] = size;
+			finished[path] = std::chrono::steady_clock::now();
+		};
+	};
+
+	// doesn't hold up the map of the battle
+	scheduler.Schedule(DownloadEnum::CAT_GAME, "game", DownloadScheduler::PRIORITY_NORMAL, download("/rapid/game"));
+	scheduler.Schedule(DownloadEnum::CAT_GAME, "game", DownloadScheduler::PRIORITY_NORMAL, download("/rapid/game"));
+	scheduler.Schedule(DownloadEnum::CAT_MAP, "map", DownloadScheduler::PRIORITY_BATTLE, download("/maps/map"));
+	const std::shared_ptr<CancelToken> cancelled = scheduler.Schedule(DownloadEnum::CAT_GAME, "other", DownloadScheduler::PRIORITY_NORMAL, download("/rapid/other"));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	BOOST_CHECK(scheduler.Cancel(DownloadEnum::CAT_GAME, "other"));
+	BOOST_CHECK(cancelled->IsCancelled());
+	scheduler.WaitIdle();
+
+	BOOST_CHECK(sizes["/rapid/game"] == static_cast<long>(HttpStandIn::PAYLOAD_SIZE));
+	BOOST_CHECK(sizes["/maps/map"] == static_cast<long>(HttpStandIn::PAYLOAD_SIZE));
+	BOOST_CHECK(sizes["/rapid/other"] == -1);
+	BOOST_CHECK(finished["/maps/map"] < finished["/rapid/game"]);
+	BOOST_CHECK(server.Requests("/rapid/game") == 1);
+}
+#endif
@@ -0,0 +1,58 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+#define BOOST_TEST_MODULE downloadtransfer
+
+#include <boost/test/unit_test.hpp>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "downloader/downloadscheduler.h"
+#include "downloader/downloadtransfer.h"
+#include "downloader/lib/src/Downloader/IDownloader.h"
+#include "testingstuff/httpstandin.h"
+#include "utils/conversion.h"
+
+#ifndef _WIN32
+// two downloads scheduled like DownloadItems transfer at the same time
+BOOST_AUTO_TEST_CASE(downloadtransfer_parallel)
+{
+	HttpStandIn server;
+	HttpStandIn::Route route;
+	route.chunkDelay = 30; // half a second for a download
+	server.SetRoute("/", route);
+
+	const std::string dir = STD_STRING(wxFileName::GetTempDir()) + "/sltest_downloadtransfer/";
+	wxMkdir(TowxString(dir));
+	const std::vector<std::string> names = {"a", "b"};
+	std::atomic<bool> ok[2];
+	IDownloader::Initialize();
+	{
+		DownloadScheduler scheduler(2);
+		for (size_t i = 0; i < names.size(); i++) {
+			const std::string file = dir + names[i];
+			const std::string url = server.Url("/file/" + names[i]);
+			wxRemoveFile(TowxString(file));
+			ok[i] = false;
+			scheduler.Schedule(DownloadEnum::CAT_HTTP, names[i], DownloadScheduler::PRIORITY_NORMAL, [&ok, i, file, url](const DownloadScheduler::CancelToken& /*token*/) {
+				DownloadTransfer transfer;
+				transfer.AddUrl(DownloadEnum::CAT_HTTP, file, url);
+				ok[i] = transfer.Start(1);
+			});
+		}
+		scheduler.WaitIdle();
+	}
+	IDownloader::Shutdown();
+
+	BOOST_CHECK(server.MaxConcurrent() == 2);
+	for (size_t i = 0; i < names.size(); i++) {
+		BOOST_CHECK(ok[i]);
+		std::ifstream file(dir + names[i], std::ios::binary);
+		const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		BOOST_CHECK(content == std::string(HttpStandIn::PAYLOAD_SIZE, names[i][0]));
+		wxRemoveFile(TowxString(dir + names[i]));
+	}
+}
+#endif
@@ -0,0 +1,50 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+#define BOOST_TEST_MODULE highlightmatcher
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "utils/highlightmatcher.h"
+
+BOOST_AUTO_TEST_CASE(highlightmatcher)
+{
+	const HighlightMatcher empty;
+	BOOST_CHECK(empty.Empty());
+	BOOST_CHECK(!empty.Contains(L"anything"));
+
+	const HighlightMatcher matcher({L"he", L"she", L"his", L"hers", L"", L"he"});
+	BOOST_CHECK(!matcher.Empty());
+	BOOST_CHECK(matcher.Contains(L"ushers"));
+	BOOST_CHECK(matcher.Contains(L"his"));
+	BOOST_CHECK(!matcher.Contains(L"HE IS"));
+	BOOST_CHECK(!matcher.Contains(L""));
+
+	const std::vector<HighlightMatcher::Match> matches = matcher.FindAll(L"ushers");
+	BOOST_REQUIRE(matches.size() == 3);
+	BOOST_CHECK(matches[0].pos == 1 && matches[0].len == 3); // she
+	BOOST_CHECK(matches[1].pos == 2 && matches[1].len == 2); // he
+	BOOST_CHECK(matches[2].pos == 2 && matches[2].len == 4); // hers
+}
+
+// compare against a plain search for every word
+BOOST_AUTO_TEST_CASE(highlightmatcher_naive)
+{
+	const std::vector<std::wstring> words = {L"ab", L"bab", L"b", L"aaa", L"äb", L"abab"};
+	const HighlightMatcher matcher(words);
+	const std::wstring text = L"aabababaaabäbbaaaab";
+
+	size_t expected = 0;
+	for (const std::wstring& word : words) {
+		for (size_t pos = text.find(word); pos != std::wstring::npos; pos = text.find(word, pos + 1)) {
+			expected++;
+		}
+	}
+	const std::vector<HighlightMatcher::Match> matches = matcher.FindAll(text);
+	BOOST_CHECK(matches.size() == expected);
+	for (const HighlightMatcher::Match& match : matches) {
+		const std::wstring found = text.substr(match.pos, match.len);
+		BOOST_CHECK(std::find(words.begin(), words.end(), found) != words.end());
+	}
+}
@@ -0,0 +1,117 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+#define BOOST_TEST_MODULE ircformat
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cwctype>
+#include <string>
+#include <vector>
+
+#include "utils/ircformat.h"
+
+static bool CheckRun(const IrcTextRun& run, size_t offset, size_t length, int color, bool bold)
+{
+	return run.offset == offset && run.length == length && run.color == color && run.bold == bold;
+}
+
+BOOST_AUTO_TEST_CASE(ircformat)
+{
+	std::wstring plain;
+	std::vector<IrcTextRun> runs;
+
+	ParseIrcFormatting(L"", plain, runs);
+	BOOST_CHECK(plain.empty() && runs.empty());
+
+	ParseIrcFormatting(L"no codes", plain, runs);
+	BOOST_CHECK(plain == L"no codes");
+	BOOST_REQUIRE(runs.size() == 1);
+	BOOST_CHECK(CheckRun(runs[0], 0, 8, IRC_DEFAULT_COLOR, false));
+
+	ParseIrcFormatting(L"a\x02" L"b\x02" L"c\x0f", plain, runs);
+	BOOST_CHECK(plain == L"abc");
+	BOOST_REQUIRE(runs.size() == 3);
+	BOOST_CHECK(CheckRun(runs[0], 0, 1, IRC_DEFAULT_COLOR, false));
+	BOOST_CHECK(CheckRun(runs[1], 1, 1, IRC_DEFAULT_COLOR, true));
+	BOOST_CHECK(CheckRun(runs[2], 2, 1, IRC_DEFAULT_COLOR, false));
+
+	// one and two digits, background colors, reset by a bare color code
+	ParseIrcFormatting(L"\x03" L"4red\x03" L"12,05blue\x03" L"1,x\x03" L"9", plain, runs);
+	BOOST_CHECK(plain == L"redblue,x");
+	BOOST_REQUIRE(runs.size() == 3);
+	BOOST_CHECK(CheckRun(runs[0], 0, 3, 4, false));
+	BOOST_CHECK(CheckRun(runs[1], 3, 4, 12, false));
+	BOOST_CHECK(CheckRun(runs[2], 7, 2, 1, false));
+	ParseIrcFormatting(L"\x03" L"04\x02" L"x\x03" L"y\x03" L"77z\x03" L"99,w", plain, runs);
+	BOOST_CHECK(plain == L"xyz,w");
+	BOOST_REQUIRE(runs.size() == 2);
+	BOOST_CHECK(CheckRun(runs[0], 0, 1, 4, true));
+	BOOST_CHECK(CheckRun(runs[1], 1, 4, IRC_DEFAULT_COLOR, true)); // 77 is ignored
+
+	// codes without effect are dropped and don't split runs, digits after
+	// a two digit color are text
+	ParseIrcFormatting(L"\x1f" L"u\x1d" L"i\x16" L"r\x03" L"0123", plain, runs);
+	BOOST_CHECK(plain == L"uir23");
+	BOOST_REQUIRE(runs.size() == 2);
+	BOOST_CHECK(CheckRun(runs[0], 0, 3, IRC_DEFAULT_COLOR, false));
+	BOOST_CHECK(CheckRun(runs[1], 3, 2, 1, false));
+
+	BOOST_CHECK(StripIrcFormatting(L"\x02" L"bold\x02 \x03" L"4,1red") == L"bold red");
+	BOOST_CHECK(StripIrcFormatting(std::string("\x03" "04utf-8 \xc3\xa4")) == "utf-8 \xc3\xa4");
+	BOOST_CHECK(StripIrcFormatting(std::string("plain")) == "plain");
+}
+
+// the way ChatPanel used to split a message, cutting off each piece
+static size_t ParseNaive(std::wstring text)
+{
+	size_t pieces = 0;
+	while (!text.empty()) {
+		const size_t pos = text.find_first_of(L"\x02\x03\x0f\x16\x1d\x1f");
+		if (pos != 0) {
+			pieces++;
+			if (pos == std::wstring::npos) {
+				break;
+			}
+			text = text.substr(pos);
+		}
+		if (text[0] == 0x03) {
+			text = text.substr((text.size() > 2 && iswdigit(text[2])) ? 2 : 1);
+		}
+		text = text.substr(1);
+	}
+	return pieces;
+}
+
+// messages of bots and spammers with a color code for every character
+BOOST_AUTO_TEST_CASE(ircformat_colorspam)
+{
+	std::wstring spam;
+	for (int i = 0; i < 10000; i++) {
+		spam += L"\x03";
+		spam += std::to_wstring(i % 16);
+		spam += (i % 7 == 0) ? L"\x02" L"x" : L"x";
+	}
+
+	std::wstring plain;
+	std::vector<IrcTextRun> runs;
+	const auto start = std::chrono::steady_clock::now();
+	ParseIrcFormatting(spam, plain, runs);
+	const auto parsed = std::chrono::steady_clock::now();
+	const size_t pieces = ParseNaive(spam);
+	const auto naive = std::chrono::steady_clock::now();
+
+	// one pass over the text, the old way copies the rest of it for every piece
+	const double parse_ms = std::chrono::duration<double, std::milli>(parsed - start).count();
+	const double naive_ms = std::chrono::duration<double, std::milli>(naive - parsed).count();
+	BOOST_TEST_MESSAGE("ircformat: " << runs.size() << " runs in " << parse_ms << " ms, cutting into pieces took " << naive_ms << " ms");
+	BOOST_CHECK(parse_ms < naive_ms);
+	BOOST_CHECK(parse_ms < 100);
+
+	BOOST_CHECK(plain == std::wstring(10000, L'x'));
+	BOOST_CHECK(runs.size() == pieces);
+	size_t offset = 0;
+	for (const IrcTextRun& run : runs) {
+		BOOST_CHECK(run.offset == offset);
+		offset += run.length;
+	}
+	BOOST_CHECK(offset == plain.size());
+}
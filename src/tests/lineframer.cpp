@@ -0,0 +1,83 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+#define BOOST_TEST_MODULE lineframer
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "utils/lineframer.h"
+
+static std::vector<std::string> Drain(LineFramer& framer)
+{
+	std::vector<std::string> res;
+	std::string_view line;
+	while (framer.Next(line)) {
+		res.push_back(std::string(line));
+	}
+	return res;
+}
+
+BOOST_AUTO_TEST_CASE(lineframer)
+{
+	LineFramer framer;
+	framer.Append("TASSERVER 0.38 * 8201 0\r\nMO");
+	std::vector<std::string> lines = Drain(framer);
+	BOOST_REQUIRE(lines.size() == 1);
+	BOOST_CHECK(lines[0] == "TASSERVER 0.38 * 8201 0");
+	BOOST_CHECK(framer.Pending() == 2);
+
+	framer.Append("TD hello\r");
+	BOOST_CHECK(Drain(framer).empty());
+	framer.Append("\n\nPONG\n");
+	lines = Drain(framer);
+	BOOST_REQUIRE(lines.size() == 3);
+	BOOST_CHECK(lines[0] == "MOTD hello");
+	BOOST_CHECK(lines[1].empty());
+	BOOST_CHECK(lines[2] == "PONG");
+	BOOST_CHECK(framer.Pending() == 0);
+
+	framer.Append("incomplete");
+	framer.Clear();
+	framer.Append("\n");
+	lines = Drain(framer);
+	BOOST_REQUIRE(lines.size() == 1);
+	BOOST_CHECK(lines[0].empty());
+}
+
+// replays a login burst as it is sent by a busy server
+BOOST_AUTO_TEST_CASE(lineframer_loginburst)
+{
+	const size_t count = 50000;
+	std::string burst;
+	for (size_t i = 0; i < count; i++) {
+		const std::string nick = "Player" + std::to_string(i);
+		switch (i % 3) {
+			case 0:
+				burst += "ADDUSER " + nick + " DE " + std::to_string(i) + " SpringLobby 0.270\r\n";
+				break;
+			case 1:
+				burst += "CLIENTSTATUS " + nick + " 4\r\n";
+				break;
+			default:
+				burst += "JOINEDBATTLE " + std::to_string(i % 600) + " " + nick + "\r\n";
+				break;
+		}
+	}
+
+	const size_t chunk_size = 4096; // same as Socket::Receive()
+	size_t bytes = 0;
+	LineFramer framer;
+	size_t received = 0;
+	for (size_t pos = 0; pos < burst.size(); pos += chunk_size) {
+		framer.Append(burst.data() + pos, std::min(chunk_size, burst.size() - pos));
+		std::string_view line;
+		while (framer.Next(line)) {
+			bytes += line.size();
+			received++;
+		}
+	}
+	BOOST_CHECK(received == count);
+	BOOST_CHECK(framer.Pending() == 0);
+	BOOST_CHECK(bytes == burst.size() - 2 * count);
+}
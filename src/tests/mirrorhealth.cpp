@@ -0,0 +1,151 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+#define BOOST_TEST_MODULE mirrorhealth
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "downloader/mirrorhealth.h"
+#include "downloader/mirrorprobe.h"
+#include "testingstuff/httpstandin.h"
+
+static MirrorHealth::Sample Success(int ttfb, int64_t bytes, int duration)
+{
+	MirrorHealth::Sample sample;
+	sample.ok = true;
+	sample.ttfb = std::chrono::milliseconds(ttfb);
+	sample.bytes = bytes;
+	sample.duration = std::chrono::milliseconds(duration);
+	return sample;
+}
+
+BOOST_AUTO_TEST_CASE(mirrorhealth_order)
+{
+	MirrorHealth health;
+	const std::vector<std::string> urls = {"http://a", "http://b", "http://c", "http://d"};
+
+	// nothing known yet, the configured order stays
+	BOOST_CHECK(health.Order(urls) == urls);
+
+	health.Record("http://a", MirrorHealth::Sample());
+	health.Record("http://a", MirrorHealth::Sample());
+	health.Record("http://c", Success(20, 4 * 1024 * 1024, 1000));
+	health.Record("http://d", Success(300, 512 * 1024, 1000));
+
+	// b is unknown and ends up between the fast and the slow one
+	const std::vector<std::string> expected = {"http://c", "http://b", "http://d", "http://a"};
+	BOOST_CHECK(health.Order(urls) == expected);
+
+	const MirrorHealth::Stats stats = health.GetStats("http://c");
+	BOOST_CHECK_CLOSE(stats.ttfbMs, 20, 0.01);
+	BOOST_CHECK_CLOSE(stats.bytesPerSecond, 4 * 1024 * 1024, 0.01);
+	BOOST_CHECK(health.GetStats("http://a").successRate < 0.5);
+	BOOST_CHECK(health.GetStats("http://b").ttfbMs < 0);
+}
+
+BOOST_AUTO_TEST_CASE(mirrorhealth_recovery)
+{
+	MirrorHealth health;
+	const std::vector<std::string> urls = {"http://a", "http://b"};
+	for (int i = 0; i < 5; i++) {
+		health.Record("http://a", MirrorHealth::Sample());
+		health.Record("http://b", Success(100, 1024 * 1024, 1000));
+	}
+	BOOST_CHECK(health.Order(urls)[0] == "http://b");
+
+	// a works again and is faster, older failures fade out
+	for (int i = 0; i < 10; i++) {
+		health.Record("http://a", Success(10, 4 * 1024 * 1024, 1000));
+		health.Record("http://b", Success(100, 1024 * 1024, 1000));
+	}
+	BOOST_CHECK(health.Order(urls)[0] == "http://a");
+}
+
+#ifndef _WIN32
+static MirrorHealth::Sample Probe(const std::string& url)
+{
+	CURL* curl = curl_easy_init();
+	const MirrorHealth::Sample sample = ProbeMirror(curl, url);
+	curl_easy_cleanup(curl);
+	return sample;
+}
+
+BOOST_AUTO_TEST_CASE(mirrorprobe)
+{
+	HttpStandIn server;
+	HttpStandIn::Route route;
+	route.latency = 100;
+	server.SetRoute("/slow/", route);
+	route = HttpStandIn::Route();
+	route.status = 404;
+	server.SetRoute("/maps/", route);
+	route.status = 0;
+	server.SetRoute("/dropped/", route);
+
+	MirrorHealth::Sample sample = Probe(server.Url("/repos.gz"));
+	BOOST_CHECK(sample.ok);
+	BOOST_CHECK(sample.bytes > 0);
+	BOOST_CHECK(sample.ttfb.count() >= 0);
+
+	sample = Probe(server.Url("/slow/repos.gz"));
+	BOOST_CHECK(sample.ok);
+	BOOST_CHECK(sample.ttfb.count() >= 100);
+
+	// an error page for a folder still shows the mirror is up, not for a file
+	BOOST_CHECK(Probe(server.Url("/maps/")).ok);
+	BOOST_CHECK(!Probe(server.Url("/maps/some.sd7")).ok);
+	BOOST_CHECK(!Probe(server.Url("/dropped/repos.gz")).ok);
+}
+
+BOOST_AUTO_TEST_CASE(mirrorhealth_probing)
+{
+	HttpStandIn fast, slow, broken, dropping;
+	HttpStandIn::Route route;
+	route.latency = 100;
+	route.chunkDelay = 5;
+	slow.SetRoute("/", route);
+	route = HttpStandIn::Route();
+	route.status = 500;
+	broken.SetRoute("/", route);
+	route.status = 0;
+	dropping.SetRoute("/", route);
+
+	std::vector<HttpStandIn*> servers = {&broken, &slow, &dropping, &fast};
+	std::vector<std::string> urls;
+	for (HttpStandIn* server : servers) {
+		urls.push_back(server->Url("/repos.gz"));
+	}
+	const MirrorHealth::Prober prober = Probe;
+	MirrorHealth health;
+	health.SetProbeUrls(urls);
+	health.StartProbing(prober, std::chrono::milliseconds(20));
+	const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+	while (fast.Requests("/repos.gz") < 3 && std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	health.StopProbing();
+	BOOST_REQUIRE(fast.Requests("/repos.gz") >= 3);
+	BOOST_CHECK(slow.Requests("/repos.gz") >= 3);
+
+	const std::vector<std::string> ordered = health.Order(urls);
+	BOOST_CHECK(ordered[0] == fast.Url("/repos.gz"));
+	BOOST_CHECK(ordered[1] == slow.Url("/repos.gz"));
+	BOOST_CHECK(health.GetStats(slow.Url("/repos.gz")).ttfbMs >= 100);
+	BOOST_CHECK(health.GetStats(broken.Url("/repos.gz")).successRate < 0.5);
+	BOOST_CHECK(health.GetStats(dropping.Url("/repos.gz")).successRate < 0.5);
+
+	// the broken one recovers and is probed again
+	broken.SetRoute("/", HttpStandIn::Route());
+	const int probed = broken.Requests("/repos.gz");
+	health.StartProbing(prober, std::chrono::milliseconds(20));
+	while (broken.Requests("/repos.gz") < probed + 8 && std::chrono::steady_clock::now() < deadline + std::chrono::seconds(20)) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	health.StopProbing();
+	const std::vector<std::string> recovered = health.Order(urls);
+	BOOST_CHECK(std::find(recovered.begin(), recovered.end(), broken.Url("/repos.gz")) < std::find(recovered.begin(), recovered.end(), slow.Url("/repos.gz")));
+}
+#endif
@@ -0,0 +1,41 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+#define BOOST_TEST_MODULE prefetchbudget
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+
+#include "downloader/prefetchbudget.h"
+
+BOOST_AUTO_TEST_CASE(prefetchbudget_window)
+{
+	PrefetchBudget budget(std::chrono::hours(1));
+	budget.SetLimits(100, 0);
+	const PrefetchBudget::Clock::time_point start = PrefetchBudget::Clock::now();
+
+	BOOST_CHECK(budget.Allows(-1, start));
+	budget.Record(60, start);
+	BOOST_CHECK(budget.Allows(-1, start));
+	budget.Record(60, start + std::chrono::minutes(30));
+	BOOST_CHECK(budget.GetUsed(start + std::chrono::minutes(30)) == 120);
+	BOOST_CHECK(!budget.Allows(-1, start + std::chrono::minutes(30)));
+
+	// the first transfer left the window
+	BOOST_CHECK(budget.Allows(-1, start + std::chrono::minutes(61)));
+	BOOST_CHECK(budget.GetUsed(start + std::chrono::minutes(61)) == 60);
+	BOOST_CHECK(budget.GetUsed(start + std::chrono::minutes(91)) == 0);
+
+	// no budget means no prefetching
+	budget.SetLimits(0, 0);
+	BOOST_CHECK(!budget.Allows(-1, start + std::chrono::minutes(91)));
+}
+
+BOOST_AUTO_TEST_CASE(prefetchbudget_disk)
+{
+	PrefetchBudget budget(std::chrono::hours(1));
+	budget.SetLimits(100, 1000);
+	BOOST_CHECK(!budget.Allows(500));
+	BOOST_CHECK(!budget.Allows(1000));
+	BOOST_CHECK(budget.Allows(1001));
+	// unknown free space doesn't stop it
+	BOOST_CHECK(budget.Allows(-1));
+}
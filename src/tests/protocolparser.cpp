@@ -0,0 +1,154 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+#define BOOST_TEST_MODULE protocolparser
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "protocolparser.h"
+
+BOOST_AUTO_TEST_CASE(protocolparser_parseline)
+{
+	ServerCommand command;
+	ProtocolParser::ParseLine("#42 clientstatus someone 3", command);
+	BOOST_CHECK(command.replyid == 42);
+	BOOST_CHECK(command.cmd == "CLIENTSTATUS");
+	BOOST_CHECK(command.verb == ServerVerb::CLIENTSTATUS);
+	BOOST_CHECK(command.params == "someone 3");
+	BOOST_REQUIRE(command.fields.size() == 2);
+	BOOST_CHECK(command.fields[1].numeric);
+	BOOST_CHECK(command.fields[1].value == 3);
+
+	ProtocolParser::ParseLine("PONG", command);
+	BOOST_CHECK(command.replyid == 0);
+	BOOST_CHECK(command.verb == ServerVerb::PONG);
+	BOOST_CHECK(command.params.empty());
+	BOOST_CHECK(command.fields.empty());
+
+	ProtocolParser::ParseLine("NOSUCHVERB a b", command);
+	BOOST_CHECK(command.verb == ServerVerb::UNKNOWN);
+	BOOST_CHECK(command.cmd == "NOSUCHVERB");
+	BOOST_CHECK(command.params == "a b");
+
+	BOOST_CHECK(ProtocolParser::LookupVerb("ACCEPTED") == ServerVerb::ACCEPTED);
+	BOOST_CHECK(ProtocolParser::LookupVerb("UPDATEBOT") == ServerVerb::UPDATEBOT);
+	BOOST_CHECK(ProtocolParser::LookupVerb("ZZZ") == ServerVerb::UNKNOWN);
+	BOOST_CHECK(ProtocolParser::VerbName(ServerVerb::SAIDPRIVATE) == "SAIDPRIVATE");
+}
+
+BOOST_AUTO_TEST_CASE(protocolparser_params)
+{
+	ServerCommand command;
+	ProtocolParser::ParseLine("BATTLEOPENED 12 0 0 founder 1.2.3.4 8452 16 1 0 -1 Spring\t104.0\tSome Map\tA title\tSome Game\tbattle12", command);
+	BOOST_CHECK(command.fields.size() == 16);
+	ServerParams params(command);
+	BOOST_CHECK(GetIntParam(params) == 12);
+	BOOST_CHECK(GetIntParam(params) == 0);
+	BOOST_CHECK(GetIntParam(params) == 0);
+	BOOST_CHECK(GetWordParam(params) == "founder");
+	BOOST_CHECK(GetWordParam(params) == "1.2.3.4");
+	BOOST_CHECK(GetIntParam(params) == 8452);
+	BOOST_CHECK(GetIntParam(params) == 16);
+	BOOST_CHECK(GetBoolParam(params));
+	BOOST_CHECK(GetIntParam(params) == 0);
+	BOOST_CHECK(GetWordParam(params) == "-1");
+	BOOST_CHECK(GetSentenceParam(params) == "Spring");
+	BOOST_CHECK(GetSentenceParam(params) == "104.0");
+	BOOST_CHECK(GetSentenceParam(params) == "Some Map");
+	BOOST_CHECK(GetSentenceParam(params) == "A title");
+	BOOST_CHECK(GetSentenceParam(params) == "Some Game");
+	BOOST_CHECK(GetSentenceParam(params) == "battle12");
+	BOOST_CHECK(params.empty());
+	BOOST_CHECK(GetWordParam(params).empty());
+	BOOST_CHECK(GetIntParam(params) == 0);
+
+	// the rest of the line stays available as is
+	ProtocolParser::ParseLine("SAID main someone hello  world", command);
+	ServerParams said(command);
+	BOOST_CHECK(GetWordParam(said) == "main");
+	BOOST_CHECK(GetWordParam(said) == "someone");
+	BOOST_CHECK(said.GetRest() == "hello  world");
+
+	// reading differently than the parser split falls back to scanning the line
+	ProtocolParser::ParseLine("LEFT main someone was kicked\tfor spam", command);
+	ServerParams left(command);
+	BOOST_CHECK(GetSentenceParam(left) == "main someone was kicked");
+	BOOST_CHECK(GetWordParam(left) == "for");
+	BOOST_CHECK(GetWordParam(left) == "spam");
+	BOOST_CHECK(left.empty());
+
+	// variable number of params
+	ProtocolParser::ParseLine("CLIENTS main a b c", command);
+	BOOST_CHECK(command.fields.size() == 4);
+	ServerParams clients(command);
+	BOOST_CHECK(GetWordParam(clients) == "main");
+	std::vector<std::string> nicks;
+	std::string nick;
+	while (!(nick = GetWordParam(clients)).empty()) {
+		nicks.push_back(nick);
+	}
+	BOOST_CHECK(nicks == std::vector<std::string>({"a", "b", "c"}));
+
+	// commands built without the parser thread
+	command = ServerCommand();
+	command.cmd = "JOINEDBATTLE";
+	command.params = "7 someone pw";
+	ProtocolParser::Tokenize(command);
+	BOOST_CHECK(command.verb == ServerVerb::JOINEDBATTLE);
+	ServerParams joined(command);
+	BOOST_CHECK(GetIntParam(joined) == 7);
+	BOOST_CHECK(GetWordParam(joined) == "someone");
+	BOOST_CHECK(GetWordParam(joined) == "pw");
+}
+
+BOOST_AUTO_TEST_CASE(protocolparser_thread)
+{
+	std::mutex mutex;
+	std::condition_variable cond;
+	int notified = 0;
+	ProtocolParser parser([&] {
+		std::lock_guard<std::mutex> lock(mutex);
+		notified++;
+		cond.notify_one();
+	});
+
+	// returns the commands parsed so far, waits for at least count of them
+	auto fetch = [&](size_t count) {
+		std::vector<ServerCommand> commands;
+		const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+		while (std::chrono::steady_clock::now() < deadline) {
+			ProtocolParser::Batch batch;
+			while (parser.Fetch(batch)) {
+				commands.insert(commands.end(), batch.begin(), batch.end());
+			}
+			if (commands.size() >= count) {
+				break;
+			}
+			std::unique_lock<std::mutex> lock(mutex);
+			cond.wait_for(lock, std::chrono::milliseconds(10));
+		}
+		return commands;
+	};
+
+	parser.Feed("TASSERVER 0.38 * 8201 0\r\nADDUSER some");
+	parser.Feed("one DE 17 SpringLobby\n\nPO");
+	parser.Feed(std::string("NG\n"));
+	std::vector<ServerCommand> commands = fetch(3);
+	BOOST_REQUIRE(commands.size() == 3);
+	BOOST_CHECK(commands[0].verb == ServerVerb::TASSERVER);
+	BOOST_CHECK(commands[1].verb == ServerVerb::ADDUSER);
+	BOOST_CHECK(commands[1].params == "someone DE 17 SpringLobby");
+	BOOST_CHECK(commands[2].verb == ServerVerb::PONG);
+
+	// data of the old connection is dropped after a reset
+	parser.Feed("SAID main someone unfinished");
+	parser.Reset();
+	parser.Feed("\nMOTD hello\n");
+	commands = fetch(1);
+	BOOST_REQUIRE(commands.size() == 1);
+	BOOST_CHECK(commands[0].verb == ServerVerb::MOTD);
+	BOOST_CHECK(commands[0].params == "hello");
+}
@@ -0,0 +1,63 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+#define BOOST_TEST_MODULE spscqueue
+
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "utils/spscqueue.h"
+
+BOOST_AUTO_TEST_CASE(spscqueue_bounds)
+{
+	SPSCQueue<std::string> queue(3); // rounded up to 4
+	BOOST_CHECK(queue.Empty());
+	std::string item;
+	BOOST_CHECK(!queue.Pop(item));
+
+	for (int i = 0; i < 4; i++) {
+		BOOST_CHECK(queue.Push(std::to_string(i)));
+	}
+	std::string rejected = "full";
+	BOOST_CHECK(!queue.Push(std::move(rejected)));
+	BOOST_CHECK(rejected == "full");
+
+	BOOST_REQUIRE(queue.Pop(item));
+	BOOST_CHECK(item == "0");
+	BOOST_CHECK(queue.Push("4"));
+	for (int i = 1; i <= 4; i++) {
+		BOOST_REQUIRE(queue.Pop(item));
+		BOOST_CHECK(item == std::to_string(i));
+	}
+	BOOST_CHECK(queue.Empty());
+	BOOST_CHECK(!queue.Pop(item));
+}
+
+BOOST_AUTO_TEST_CASE(spscqueue_threads)
+{
+	const int count = 100000;
+	SPSCQueue<int> queue(64);
+	std::thread producer([&queue] {
+		for (int i = 0; i < count; i++) {
+			int item = i;
+			while (!queue.Push(std::move(item))) {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	int expected = 0;
+	bool ordered = true;
+	while (expected < count) {
+		int item;
+		if (!queue.Pop(item)) {
+			std::this_thread::yield();
+			continue;
+		}
+		ordered = ordered && (item == expected);
+		expected++;
+	}
+	producer.join();
+	BOOST_CHECK(ordered);
+	BOOST_CHECK(queue.Empty());
+}
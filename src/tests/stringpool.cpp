@@ -0,0 +1,279 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+#define BOOST_TEST_MODULE stringpool
+
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <wx/string.h>
+
+#include "utils/stringpool.h"
+
+class User;
+
+// count heap usage of the whole test, every block is prefixed with its size
+static std::atomic<size_t> allocated(0);
+
+void* operator new(size_t size)
+{
+	size_t* block = static_cast<size_t*>(malloc(size + sizeof(max_align_t)));
+	if (block == nullptr) {
+		throw std::bad_alloc();
+	}
+	*block = size;
+	allocated += size;
+	return reinterpret_cast<char*>(block) + sizeof(max_align_t);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	if (ptr == nullptr) {
+		return;
+	}
+	size_t* block = reinterpret_cast<size_t*>(static_cast<char*>(ptr) - sizeof(max_align_t));
+	allocated -= *block;
+	free(block);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	operator delete(ptr);
+}
+
+BOOST_AUTO_TEST_CASE(stringpool)
+{
+	StringPool pool;
+	BOOST_CHECK(pool.Intern("") == 0);
+	BOOST_CHECK(pool.GetString(0).empty());
+
+	const StringId a = pool.Intern("[TAG]Player");
+	const StringId b = pool.Intern("DE");
+	BOOST_CHECK(a != b);
+	BOOST_CHECK(pool.Intern(std::string("[TAG]Player")) == a);
+	BOOST_CHECK(pool.GetString(a) == "[TAG]Player");
+	BOOST_CHECK(pool.GetWxString(a) == wxString(_T("[TAG]Player")));
+	BOOST_CHECK(pool.GetWxString(pool.Intern("\xc3\xa4")) == wxString::FromUTF8("\xc3\xa4"));
+
+	StringId id = 0;
+	BOOST_CHECK(pool.Find("DE", id) && id == b);
+	BOOST_CHECK(!pool.Find("unknown", id));
+	BOOST_CHECK(pool.GetCount() == 4);
+
+	// references stay valid while the pool grows
+	const std::string& ref = pool.GetString(a);
+	for (int i = 0; i < 10000; i++) {
+		pool.Intern("nick" + std::to_string(i));
+	}
+	BOOST_CHECK(&ref == &pool.GetString(a));
+	BOOST_CHECK(pool.GetString(pool.Intern("nick9999")) == "nick9999");
+}
+
+BOOST_AUTO_TEST_CASE(stringpool_threads)
+{
+	StringPool pool;
+	const int count = 20000;
+	std::vector<StringId> ids[4];
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; t++) {
+		threads.emplace_back([&pool, &ids, t, count]() {
+			for (int i = 0; i < count; i++) {
+				const StringId id = pool.Intern("user" + std::to_string(i));
+				if (pool.GetString(id) != "user" + std::to_string(i)) {
+					return;
+				}
+				ids[t].push_back(id);
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	for (int t = 1; t < 4; t++) {
+		BOOST_CHECK(ids[t] == ids[0]);
+	}
+	BOOST_CHECK(pool.GetCount() == count + 1);
+}
+
+BOOST_AUTO_TEST_CASE(stringpool_release)
+{
+	StringPool pool;
+	const StringId a = pool.Intern("someone");
+	BOOST_CHECK(pool.Intern("someone") == a);
+	pool.AddRef(a);
+	BOOST_CHECK(pool.GetCount() == 2);
+
+	// still referenced twice
+	pool.Release(a);
+	pool.Release(a);
+	StringId id = 0;
+	BOOST_CHECK(pool.Find("someone", id) && id == a);
+	BOOST_CHECK(pool.GetString(a) == "someone");
+
+	// the last reference frees the entry, its id is reused
+	pool.Release(a);
+	BOOST_CHECK(!pool.Find("someone", id));
+	BOOST_CHECK(pool.GetCount() == 1);
+	const StringId b = pool.Intern("someone else");
+	BOOST_CHECK(b == a);
+	BOOST_CHECK(pool.GetString(b) == "someone else");
+	BOOST_CHECK(pool.GetWxString(b) == wxString(_T("someone else")));
+
+	// the empty string stays
+	pool.Release(0);
+	BOOST_CHECK(pool.Intern("") == 0);
+	BOOST_CHECK(pool.Find("", id) && id == 0);
+
+	// users coming and going don't grow the pool
+	for (int round = 0; round < 10; round++) {
+		std::vector<StringId> ids;
+		for (int i = 0; i < 1000; i++) {
+			ids.push_back(pool.Intern("user" + std::to_string(round * 1000 + i)));
+		}
+		for (const StringId user : ids) {
+			pool.Release(user);
+		}
+	}
+	BOOST_CHECK(pool.GetCount() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(stringpool_release_threads)
+{
+	StringPool pool;
+	const StringId kept = pool.Intern("kept");
+	std::vector<std::thread> threads;
+	std::vector<int> errors(4, 0);
+	for (int t = 0; t < 4; t++) {
+		threads.emplace_back([&pool, &errors, t]() {
+			for (int i = 0; i < 5000; i++) {
+				const std::string str = "user" + std::to_string(i % 50);
+				const StringId id = pool.Intern(str);
+				if (pool.GetString(id) != str) {
+					errors[t]++;
+				}
+				pool.Release(id);
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	for (int t = 0; t < 4; t++) {
+		BOOST_CHECK(errors[t] == 0);
+	}
+	BOOST_CHECK(pool.GetCount() == 2);
+	BOOST_CHECK(pool.GetString(kept) == "kept");
+}
+
+BOOST_AUTO_TEST_CASE(stringpool_find_threads)
+{
+	// lookups run concurrently with users coming and going
+	StringPool pool;
+	const StringId kept = pool.Intern("kept");
+	std::atomic<bool> stop(false);
+	std::atomic<int> errors(0);
+	std::vector<std::thread> readers;
+	for (int t = 0; t < 3; t++) {
+		readers.emplace_back([&pool, &stop, &errors, kept]() {
+			while (!stop) {
+				StringId id = 0;
+				if (!pool.Find("kept", id) || id != kept) {
+					errors++;
+				}
+				pool.Find("user7", id);
+			}
+		});
+	}
+	for (int i = 0; i < 20000; i++) {
+		pool.Release(pool.Intern("user" + std::to_string(i % 10)));
+	}
+	stop = true;
+	for (std::thread& thread : readers) {
+		thread.join();
+	}
+	BOOST_CHECK(errors == 0);
+	BOOST_CHECK(pool.GetCount() == 2);
+}
+
+// 8000 online users, the server list plus 30 joined channels holding a quarter of them each
+static const size_t USERS = 8000;
+static const size_t CHANNELS = 30;
+
+static std::string Nick(size_t i)
+{
+	if (i % 2 == 0) {
+		return "Player" + std::to_string(i);
+	}
+	return "[CLAN" + std::to_string(i % 100) + "]LongerNickname" + std::to_string(i);
+}
+
+static bool InList(size_t list, size_t user)
+{
+	return list == 0 || (user + list) % 4 == 0;
+}
+
+static size_t Pow2(size_t n)
+{
+	size_t res = 16;
+	while (res < n) {
+		res *= 2;
+	}
+	return res;
+}
+
+// heap bytes per online user of the nick containers, before and after interning
+BOOST_AUTO_TEST_CASE(stringpool_memory)
+{
+	std::vector<std::string> nicks;
+	for (size_t i = 0; i < USERS; i++) {
+		nicks.push_back(Nick(i));
+	}
+	User* const dummy = nullptr;
+
+	size_t start = allocated;
+	size_t before;
+	{
+		// each list had a std::map by nick, channels also kept a std::set of nicks
+		std::vector<std::map<std::string, User*>> lists(CHANNELS + 1);
+		std::vector<std::set<std::string>> sets(CHANNELS);
+		for (size_t l = 0; l <= CHANNELS; l++) {
+			for (size_t i = 0; i < USERS; i++) {
+				if (InList(l, i)) {
+					lists[l][nicks[i]] = dummy;
+					if (l > 0) {
+						sets[l - 1].insert(nicks[i]);
+					}
+				}
+			}
+		}
+		before = (allocated - start) / USERS;
+	}
+
+	start = allocated;
+	size_t after;
+	{
+		// interned nicks, each list keeps users and ids in arrays plus an index at most half full
+		StringPool pool;
+		std::vector<std::vector<User*>> users(CHANNELS + 1);
+		std::vector<std::vector<StringId>> ids(CHANNELS + 1);
+		std::vector<std::vector<uint32_t>> index(CHANNELS + 1);
+		for (size_t l = 0; l <= CHANNELS; l++) {
+			for (size_t i = 0; i < USERS; i++) {
+				if (InList(l, i)) {
+					users[l].push_back(dummy);
+					ids[l].push_back(pool.Intern(nicks[i]));
+				}
+			}
+			index[l].assign(Pow2(ids[l].size() * 2), 0);
+		}
+		after = (allocated - start) / USERS;
+	}
+	BOOST_TEST_MESSAGE("nick containers: " << before << " bytes per user before, " << after << " after");
+	BOOST_CHECK(before > 0);
+	BOOST_CHECK(after * 3 < before);
+	BOOST_CHECK(after < 1024);
+}
@@ -0,0 +1,219 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_HTTPSTANDIN_H
+#define SPRINGLOBBY_HEADERGUARD_HTTPSTANDIN_H
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+//! @brief Serves synthetic content over http on a local port, in place of a
+//! download mirror. Every path is answered with PAYLOAD_SIZE bytes of its
+//! last character. Routes make the paths below a prefix slow or fail.
+class HttpStandIn
+{
+public:
+	static constexpr size_t PAYLOAD_SIZE = 256 * 1024;
+
+	struct Route {
+		int latency = 0;    //!< ms before the response starts
+		int chunkDelay = 0; //!< ms between the 16 kB chunks of the body
+		int status = 200;   //!< other ones are sent without a body, 0 drops the connection
+	};
+
+	struct Response {
+		int status = 0; //!< 0 if there was no response
+		long size = 0;  //!< of the body, -1 if cancelled
+		std::chrono::milliseconds ttfb{0};
+		std::chrono::milliseconds duration{0};
+	};
+
+	HttpStandIn()
+	    : m_quit(false)
+	    , m_active(0)
+	    , m_max_active(0)
+	{
+		m_socket = socket(AF_INET, SOCK_STREAM, 0);
+		sockaddr_in addr = {};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		socklen_t len = sizeof(addr);
+		if (bind(m_socket, (sockaddr*)&addr, len) != 0 || listen(m_socket, 16) != 0 ||
+		    getsockname(m_socket, (sockaddr*)&addr, &len) != 0) {
+			throw std::runtime_error("can't listen on a local port");
+		}
+		m_port = ntohs(addr.sin_port);
+		m_thread = std::thread(&HttpStandIn::Accept, this);
+	}
+	~HttpStandIn()
+	{
+		m_quit = true;
+		shutdown(m_socket, SHUT_RDWR);
+		close(m_socket);
+		m_thread.join();
+		for (std::thread& thread : m_connections) {
+			thread.join();
+		}
+	}
+
+	//! applies route to all paths starting with prefix, the longest prefix wins
+	void SetRoute(const std::string& prefix, const Route& route)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_routes[prefix] = route;
+	}
+
+	int Requests(const std::string& path)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_requests[path];
+	}
+
+	//! most requests which were answered at the same time
+	int MaxConcurrent()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_max_active;
+	}
+
+	std::string Url(const std::string& path) const
+	{
+		return "http://127.0.0.1:" + std::to_string(m_port) + path;
+	}
+
+	//! GETs path, cancelled is checked while the body is received
+	Response Get(const std::string& path, std::function<bool()> cancelled = nullptr)
+	{
+		typedef std::chrono::steady_clock Clock;
+		const Clock::time_point start = Clock::now();
+		Response res;
+		const int fd = socket(AF_INET, SOCK_STREAM, 0);
+		sockaddr_in addr = {};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = htons(m_port);
+		if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+			close(fd);
+			return res;
+		}
+		const std::string request = "GET " + path + " HTTP/1.0\r\n\r\n";
+		send(fd, request.data(), request.size(), 0);
+		std::string response;
+		char buf[16 * 1024];
+		ssize_t len;
+		while ((len = recv(fd, buf, sizeof(buf), 0)) > 0) {
+			if (response.empty()) {
+				res.ttfb = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+			}
+			if (cancelled && cancelled()) {
+				close(fd);
+				res.size = -1;
+				return res;
+			}
+			response.append(buf, len);
+		}
+		close(fd);
+		res.duration = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+		const size_t header = response.find("\r\n\r\n");
+		if (response.compare(0, 9, "HTTP/1.0 ") != 0 || header == std::string::npos) {
+			return res;
+		}
+		res.status = std::stoi(response.substr(9, 3));
+		res.size = response.size() - header - 4;
+		return res;
+	}
+
+private:
+	void Accept()
+	{
+		while (true) {
+			const int fd = accept(m_socket, nullptr, nullptr);
+			if (fd < 0) {
+				return;
+			}
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_connections.emplace_back(&HttpStandIn::Serve, this, fd);
+		}
+	}
+
+	void Serve(int fd)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_max_active = std::max(m_max_active, ++m_active);
+		}
+		Respond(fd);
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_active--;
+	}
+
+	void Respond(int fd)
+	{
+		std::string request;
+		char buf[1024];
+		ssize_t len;
+		while (request.find("\r\n\r\n") == std::string::npos && (len = recv(fd, buf, sizeof(buf), 0)) > 0) {
+			request.append(buf, len);
+		}
+		const std::string path = request.substr(4, request.find(' ', 4) - 4);
+		Route route;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_requests[path]++;
+			size_t matched = 0;
+			for (const auto& it : m_routes) {
+				if (path.compare(0, it.first.size(), it.first) == 0 && it.first.size() >= matched) {
+					route = it.second;
+					matched = it.first.size();
+				}
+			}
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(route.latency));
+		if (route.status != 200) {
+			if (route.status != 0) {
+				const std::string header = "HTTP/1.0 " + std::to_string(route.status) + " Error\r\nContent-Length: 0\r\n\r\n";
+				send(fd, header.data(), header.size(), MSG_NOSIGNAL);
+			}
+			close(fd);
+			return;
+		}
+		const std::string header = "HTTP/1.0 200 OK\r\nContent-Length: " + std::to_string(PAYLOAD_SIZE) + "\r\n\r\n";
+		send(fd, header.data(), header.size(), MSG_NOSIGNAL);
+		const std::string chunk(16 * 1024, path.back());
+		for (size_t sent = 0; sent < PAYLOAD_SIZE && !m_quit; sent += chunk.size()) {
+			if (send(fd, chunk.data(), chunk.size(), MSG_NOSIGNAL) < 0) {
+				break;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(route.chunkDelay));
+		}
+		close(fd);
+	}
+
+	int m_socket;
+	int m_port;
+	std::atomic<bool> m_quit;
+	std::mutex m_mutex;
+	std::map<std::string, Route> m_routes;
+	std::map<std::string, int> m_requests;
+	int m_active;
+	int m_max_active;
+	std::vector<std::thread> m_connections;
+	std::thread m_thread;
+};
+#endif
+
+#endif // SPRINGLOBBY_HEADERGUARD_HTTPSTANDIN_H
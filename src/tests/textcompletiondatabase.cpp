@@ -0,0 +1,91 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+#define BOOST_TEST_MODULE textcompletiondatabase
+
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <vector>
+
+#include "utils/TextCompletionDatabase.h"
+
+static std::vector<std::string> Abbreviations(const std::vector<TextCompletionDatabase::Mapping>& mappings)
+{
+	std::vector<std::string> res;
+	for (const TextCompletionDatabase::Mapping& mapping : mappings) {
+		res.push_back(std::string(mapping.abbreviation.mb_str()));
+	}
+	return res;
+}
+
+BOOST_AUTO_TEST_CASE(textcompletiondatabase_prefix)
+{
+	TextCompletionDatabase db;
+	db.Insert_Mapping(_T("abd"), _T("4"));
+	db.Insert_Mapping(_T("b"), _T("5"));
+	db.Insert_Mapping(_T("abc"), _T("3"));
+	db.Insert_Mapping(_T("aab"), _T("1"));
+	db.Insert_Mapping(_T("ab"), _T("2"));
+	db.Insert_Mapping(_T("ab"), _T("2"));
+	BOOST_CHECK(db.Size() == 5);
+
+	// only the range starting with the prefix, exact match first
+	const std::vector<std::string> ab = {"ab", "abc", "abd"};
+	BOOST_CHECK(Abbreviations(db.GetMapping(_T("ab"))) == ab);
+	// then shorter ones before longer ones
+	const std::vector<std::string> a = {"ab", "aab", "abc", "abd"};
+	BOOST_CHECK(Abbreviations(db.GetMapping(_T("a"))) == a);
+	BOOST_CHECK(db.GetMapping(_T("abe")).empty());
+	BOOST_CHECK(db.GetMapping(_T("c")).empty());
+	BOOST_CHECK(db.GetMapping(wxEmptyString).empty());
+
+	db.Delete_Mapping(_T("abc"));
+	db.Delete_Mapping(_T("missing"));
+	BOOST_CHECK(db.Size() == 4);
+	const std::vector<std::string> deleted = {"ab", "abd"};
+	BOOST_CHECK(Abbreviations(db.GetMapping(_T("ab"))) == deleted);
+	BOOST_CHECK(db.GetMapping(_T("ab"))[0].mapping == _T("2"));
+}
+
+BOOST_AUTO_TEST_CASE(textcompletiondatabase_case)
+{
+	TextCompletionDatabase db;
+	db.Insert_Mapping(_T("alice"), _T("alice"));
+	db.Insert_Mapping(_T("Alice"), _T("Alice"));
+	db.Insert_Mapping(_T("ALBERT"), _T("ALBERT"));
+	BOOST_CHECK(db.Size() == 3);
+
+	// abbreviations differing in case only are kept apart, matching ignores it
+	BOOST_CHECK(db.GetMapping(_T("aL")).size() == 3);
+	BOOST_CHECK(db.GetMapping(_T("ALI")).size() == 2);
+	BOOST_CHECK(Abbreviations(db.GetMapping(_T("Alice")))[0] == "Alice");
+	BOOST_CHECK(Abbreviations(db.GetMapping(_T("alice")))[0] == "alice");
+
+	db.Delete_Mapping(_T("ALICE"));
+	BOOST_CHECK(db.Size() == 3);
+	db.Delete_Mapping(_T("Alice"));
+	const std::vector<std::string> rest = {"alice"};
+	BOOST_CHECK(Abbreviations(db.GetMapping(_T("ALICE"))) == rest);
+}
+
+BOOST_AUTO_TEST_CASE(textcompletiondatabase_max)
+{
+	TextCompletionDatabase db;
+	for (int i = 149; i >= 0; i--) {
+		const wxString nick = wxString::Format(_T("nick%d"), i);
+		db.Insert_Mapping(nick, nick);
+	}
+	db.Insert_Mapping(_T("nick"), _T("nick"));
+	db.Insert_Mapping(_T("other"), _T("other"));
+
+	// at most 100 by default, the best ranked ones of all 151 matches
+	const std::vector<std::string> res = Abbreviations(db.GetMapping(_T("NICK")));
+	BOOST_REQUIRE(res.size() == 100);
+	BOOST_CHECK(res[0] == "nick");
+	BOOST_CHECK(res[1] == "nick0");
+	BOOST_CHECK(res[10] == "nick9");
+	BOOST_CHECK(res[11] == "nick10");
+	BOOST_CHECK(res[99] == "nick98");
+
+	const std::vector<std::string> few = {"nick", "nick0", "nick1"};
+	BOOST_CHECK(Abbreviations(db.GetMapping(_T("nick"), 3)) == few);
+	BOOST_CHECK(db.GetMapping(_T("nick1"), 0).empty());
+}
@@ -2,6 +2,11 @@
 #define BOOST_TEST_MODULE globalevents
 
 #include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "../testingstuff/silent_logger.h"
 
@@ -150,3 +155,167 @@ BOOST_AUTO_TEST_CASE(TestIfUnsubscribedProperly)
 
 	gem->Release();
 }
+
+//! keeps the queued events until Dispatch() is called, like an event loop would
+class QueueingEvtHandler : public wxEvtHandler
+{
+public:
+	QueueingEvtHandler()
+	    : LastValue{-1}
+	    , HandledCount{0}
+	{
+	}
+
+	virtual void QueueEvent(wxEvent* event) override
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queued.emplace_back(event);
+	}
+
+	size_t QueuedCount()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_queued.size();
+	}
+
+	void Dispatch()
+	{
+		std::vector<std::unique_ptr<wxEvent> > queued;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			queued.swap(m_queued);
+		}
+		for (auto& event : queued) {
+			ProcessEvent(*event);
+		}
+	}
+
+	void OnEvent(wxCommandEvent& event)
+	{
+		LastValue = event.GetInt();
+		HandledCount++;
+	}
+
+public:
+	int LastValue;
+	int HandledCount;
+
+private:
+	std::mutex m_mutex;
+	std::vector<std::unique_ptr<wxEvent> > m_queued;
+};
+
+//! counts events queued from any thread
+class CountingEvtHandler : public wxEvtHandler
+{
+public:
+	CountingEvtHandler()
+	    : CallCount{0}
+	{
+	}
+
+	virtual void QueueEvent(wxEvent* event) override
+	{
+		delete event;
+		CallCount++;
+	}
+
+	void DummyTarget(wxCommandEvent&)
+	{
+	}
+
+public:
+	std::atomic<int> CallCount;
+};
+
+BOOST_AUTO_TEST_CASE(TestIfCoalescesEvents)
+{
+	GlobalEventManager* gem = GlobalEventManager::Instance();
+
+	QueueingEvtHandler coalesced;
+	QueueingEvtHandler normal;
+	gem->Subscribe(&coalesced, gem->OnDownloadProgress,
+		       wxObjectEventFunction(&QueueingEvtHandler::OnEvent), "", true);
+	gem->Subscribe(&normal, gem->OnDownloadProgress,
+		       wxObjectEventFunction(&QueueingEvtHandler::OnEvent), "");
+
+	for (int i = 0; i < 10; i++) {
+		wxCommandEvent event(gem->OnDownloadProgress);
+		event.SetInt(i);
+		gem->Send(event);
+	}
+	BOOST_CHECK_EQUAL(coalesced.QueuedCount(), 1);
+	BOOST_CHECK_EQUAL(normal.QueuedCount(), 10);
+
+	//only the latest event is delivered
+	coalesced.Dispatch();
+	normal.Dispatch();
+	BOOST_CHECK_EQUAL(coalesced.HandledCount, 1);
+	BOOST_CHECK_EQUAL(coalesced.LastValue, 9);
+	BOOST_CHECK_EQUAL(normal.HandledCount, 10);
+	BOOST_CHECK_EQUAL(normal.LastValue, 9);
+
+	//queued again after delivery
+	gem->Send(gem->OnDownloadProgress);
+	BOOST_CHECK_EQUAL(coalesced.QueuedCount(), 1);
+	coalesced.Dispatch();
+	BOOST_CHECK_EQUAL(coalesced.HandledCount, 2);
+
+	gem->UnSubscribeAll(&coalesced);
+	gem->UnSubscribeAll(&normal);
+
+	gem->Release();
+}
+
+BOOST_AUTO_TEST_CASE(StressSendWhileSubscribing)
+{
+	GlobalEventManager* gem = GlobalEventManager::Instance();
+
+	//keeps the table from getting empty, UnSubscribeAll() asserts on that
+	CountingEvtHandler permanent;
+	gem->Subscribe(&permanent, gem->OnDownloadStarted,
+		       wxObjectEventFunction(&CountingEvtHandler::DummyTarget), "");
+
+	std::atomic<bool> stop(false);
+	std::vector<std::thread> senders;
+	for (int i = 0; i < 2; i++) {
+		senders.emplace_back([gem, &stop] {
+			while (!stop) {
+				gem->Send(gem->OnDownloadStarted);
+				gem->Send(gem->OnDownloadProgress);
+			}
+		});
+	}
+
+	for (int i = 0; i < 100; i++) {
+		std::unique_ptr<CountingEvtHandler> started(new CountingEvtHandler());
+		std::unique_ptr<CountingEvtHandler> progress(new CountingEvtHandler());
+		std::unique_ptr<CountingEvtHandler> coalesced(new CountingEvtHandler());
+		gem->Subscribe(started.get(), gem->OnDownloadStarted,
+			       wxObjectEventFunction(&CountingEvtHandler::DummyTarget), "");
+		gem->Subscribe(progress.get(), gem->OnDownloadProgress,
+			       wxObjectEventFunction(&CountingEvtHandler::DummyTarget), "");
+		gem->Subscribe(coalesced.get(), gem->OnDownloadProgress,
+			       wxObjectEventFunction(&CountingEvtHandler::DummyTarget), "", true);
+		std::this_thread::yield();
+		gem->UnSubscribe(progress.get(), gem->OnDownloadProgress);
+		gem->UnSubscribeAll(started.get());
+		gem->UnSubscribeAll(coalesced.get());
+
+		//nothing is queued after unsubscribing, and the coalesced handler
+		//never gets a second event while the first one wasn't processed
+		const int count = started->CallCount + progress->CallCount;
+		std::this_thread::yield();
+		BOOST_CHECK_EQUAL(started->CallCount + progress->CallCount, count);
+		BOOST_CHECK(coalesced->CallCount <= 1);
+	}
+
+	stop = true;
+	for (std::thread& sender : senders) {
+		sender.join();
+	}
+	BOOST_CHECK(permanent.CallCount > 0);
+
+	gem->UnSubscribeAll(&permanent);
+	gem->Release();
+}
@@ -16,6 +16,7 @@ lsl/user/user.cpp
 #include "user.h"
 
 #include <wx/intl.h>
+#include <algorithm>
 
 #include "gui/chatpanel.h"
 #include "ibattle.h"
@@ -142,6 +143,21 @@ void User::SetBattle(IBattle* battle)
 	m_statusicon_idx = icons().GetUserListStateIcon(GetStatus(), false, m_battle != 0);
 }
 
+void User::OnJoinedChannel(Channel& channel)
+{
+	if (std::find(m_channels.begin(), m_channels.end(), &channel) == m_channels.end()) {
+		m_channels.push_back(&channel);
+	}
+}
+
+void User::OnLeftChannel(Channel& channel)
+{
+	std::vector<Channel*>::iterator it = std::find(m_channels.begin(), m_channels.end(), &channel);
+	if (it != m_channels.end()) {
+		m_channels.erase(it);
+	}
+}
+
 void User::SetStatus(const UserStatus& status)
 {
 	CommonUser::SetStatus(status);
@@ -16,10 +16,13 @@ lsl/user/user.h
 
 
 #include "utils/mixins.h"
+#include "utils/stringpool.h"
 #include <lslutils/misc.h>
 #include <string>
+#include <vector>
 
 class IServer;
+class Channel;
 
 const unsigned int SYNC_UNKNOWN = 0;
 const unsigned int SYNC_SYNCED = 1;
@@ -188,25 +191,70 @@ class CommonUser
 {
 public:
 	CommonUser(const std::string& nick, const std::string& country)
-	    : m_nick(std::string(nick))
+	    : m_nick(StringPool::Instance()->Intern(nick))
 	    , m_is_bridged(nick.find(':') != std::string::npos)
-	    , m_country(std::string(country))
+	    , m_country(StringPool::Instance()->Intern(country))
 	    , m_id(0)
 	    , m_trueSkill(0.0f)
 	{
 	}
 
+	CommonUser(const CommonUser& other)
+	    : m_nick(other.m_nick)
+	    , m_is_bridged(other.m_is_bridged)
+	    , m_client_agent(other.m_client_agent)
+	    , m_country(other.m_country)
+	    , m_id(other.m_id)
+	    , m_trueSkill(other.m_trueSkill)
+	    , m_status(other.m_status)
+	    , m_bstatus(other.m_bstatus)
+	{
+		StringPool::Instance()->AddRef(m_nick);
+		StringPool::Instance()->AddRef(m_country);
+	}
+
+	CommonUser& operator=(const CommonUser& other)
+	{
+		StringPool::Instance()->AddRef(other.m_nick);
+		StringPool::Instance()->AddRef(other.m_country);
+		StringPool::Instance()->Release(m_nick);
+		StringPool::Instance()->Release(m_country);
+		m_nick = other.m_nick;
+		m_is_bridged = other.m_is_bridged;
+		m_client_agent = other.m_client_agent;
+		m_country = other.m_country;
+		m_id = other.m_id;
+		m_trueSkill = other.m_trueSkill;
+		m_status = other.m_status;
+		m_bstatus = other.m_bstatus;
+		return *this;
+	}
+
 	virtual ~CommonUser()
 	{
+		StringPool::Instance()->Release(m_nick);
+		StringPool::Instance()->Release(m_country);
 	}
 
 	const std::string& GetNick() const
+	{
+		return StringPool::Instance()->GetString(m_nick);
+	}
+	//! same as GetNick(), without converting on every call
+	const wxString& GetNickWx() const
+	{
+		return StringPool::Instance()->GetWxString(m_nick);
+	}
+	//! interned nick, cheaper to compare and hash than the string
+	StringId GetNickId() const
 	{
 		return m_nick;
 	}
 	virtual void SetNick(const std::string& nick)
 	{
-		m_nick = nick;
+		const StringId old = m_nick;
+		m_nick = StringPool::Instance()->Intern(nick);
+		StringPool::Instance()->Release(old);
 	}
 	bool IsBridged() const
 	{
@@ -220,7 +268,7 @@ public:
 	}
 	const std::string& GetCountry() const
 	{
-		return m_country;
+		return StringPool::Instance()->GetString(m_country);
 	}
 	void SetClientAgent(const std::string& ca)
 	{
@@ -228,7 +276,9 @@ public:
 	}
 	virtual void SetCountry(const std::string& country)
 	{
-		m_country = country;
+		const StringId old = m_country;
+		m_country = StringPool::Instance()->Intern(country);
+		StringPool::Instance()->Release(old);
 	}
 
 	int GetID() const
@@ -287,15 +337,15 @@ public:
 
 	bool operator==(const CommonUser& other) const
 	{
-		return (m_nick == other.GetNick());
+		return (m_nick == other.GetNickId());
 	}
 
 
 private:
-	std::string m_nick;
+	StringId m_nick;
 	bool m_is_bridged;
 	std::string m_client_agent;
-	std::string m_country;
+	StringId m_country;
 	int m_id;
 	double m_trueSkill; //This data is not included into UserStatus because it is not part of MYSTATUS or MYBATTLESTATUS commands
 	UserStatus m_status;
@@ -333,6 +383,14 @@ public:
 	IBattle* GetBattle() const;
 	void SetBattle(IBattle* battle);
 
+	//! channels the user is in, kept up to date by Channel
+	const std::vector<Channel*>& GetChannels() const
+	{
+		return m_channels;
+	}
+	void OnJoinedChannel(Channel& channel);
+	void OnLeftChannel(Channel& channel);
+
 	void SendMyUserStatus() const;
 	void SetStatus(const UserStatus& status);
 	void SetCountry(const std::string& country);
@@ -379,6 +437,7 @@ private:
 
 	IServer* m_serv;
 	IBattle* m_battle;
+	std::vector<Channel*> m_channels;
 	int m_flagicon_idx;
 	int m_rankicon_idx;
 	int m_statusicon_idx;
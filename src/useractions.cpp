@@ -6,6 +6,7 @@
 #include <wx/colour.h>
 #include <wx/intl.h>
 #include <wx/log.h>
+#include <atomic>
 #include <cmath>
 
 #include "gui/battlelist/battlelisttab.h"
@@ -37,15 +38,39 @@ UserActions::~UserActions()
 {
 }
 
-bool UserActions::DoActionOnUser(const UserActions::ActionType action, const wxString& name)
+//! the last holder of the masks drops the nick references; that is at the
+//! latest DestroyGlobals(), the pool is a function static and outlives it
+UserActions::UserActionMasks::~UserActionMasks()
+{
+	for (const auto& entry : byId) {
+		StringPool::Instance()->Release(entry.first);
+	}
+}
+
+bool UserActions::DoActionOnUser(const UserActions::ActionType action, const wxString& name) const
+{
+	return DoActionOnUser(action, STD_STRING(name));
+}
+
+bool UserActions::DoActionOnUser(const UserActions::ActionType action, const std::string& name) const
 {
 	// preventing action on oneself wasn't the best idea, login gets disabled
 	//if ( m_knownUsers.Index( name ) == -1 || ui().IsThisMe(name) || action == ActNone )
 
-	if (m_knownUsers.Index(name) == -1 || action == ActNone)
+	if (action == ActNone)
 		return false;
-	else
-		return (m_actionsGroups.find(action) != m_actionsGroups.end() && m_actionsPeople[action].Index(name) != -1);
+	const std::shared_ptr<const UserActionMasks> masks = std::atomic_load(&m_userActionMasks);
+	const auto it = masks->byName.find(name);
+	return it != masks->byName.end() && (it->second & action) != 0;
+}
+
+bool UserActions::DoActionOnUser(const UserActions::ActionType action, StringId name) const
+{
+	if (action == ActNone)
+		return false;
+	const std::shared_ptr<const UserActionMasks> masks = std::atomic_load(&m_userActionMasks);
+	const auto it = masks->byId.find(name);
+	return it != masks->byId.end() && (it->second & action) != 0;
 }
 
 void UserActions::Init()
@@ -103,8 +128,8 @@ void UserActions::Init()
 	m_groupMap.clear();
 	m_groupActions.clear();
 	m_actionsGroups.clear();
-	m_actionsPeople.clear();
 	m_knownUsers.Clear();
+	std::shared_ptr<UserActionMasks> masks = std::make_shared<UserActionMasks>();
 	for (unsigned int i = 0; i < m_groupNames.GetCount(); ++i) {
 		wxString name = m_groupNames[i];
 		m_groupMap[name] = GetPeopleList(name);
@@ -114,6 +139,17 @@ void UserActions::Init()
 			m_peopleGroup[user] = name;
 		}
 		m_groupActions[name] = GetGroupActions(name);
+		for (unsigned int k = 0; k < m_groupMap[name].GetCount(); ++k) {
+			const std::string user = STD_STRING(m_groupMap[name][k]);
+			StringId id;
+			if (masks->byName.count(user) == 0) { // the one reference ~UserActionMasks releases
+				id = StringPool::Instance()->Intern(user);
+			} else {
+				StringPool::Instance()->Find(user, id);
+			}
+			masks->byName[user] |= m_groupActions[name];
+			masks->byId[id] |= m_groupActions[name];
+		}
 	}
 	for (size_t i = 0; i < m_actionNames.size(); ++i) {
 		UserActions::ActionType cur = (UserActions::ActionType)(1 << i);
@@ -122,9 +158,6 @@ void UserActions::Init()
 			wxString name = m_groupNames[j];
 			if ((m_groupActions[name] & cur) != 0) {
 				tmp.Add(name);
-				for (unsigned int k = 0; k < m_groupMap[name].GetCount(); ++k) {
-					m_actionsPeople[cur].Add((m_groupMap[name])[k]);
-				}
 			}
 		}
 		tmp.Sort();
@@ -133,6 +166,7 @@ void UserActions::Init()
 	m_actionsGroups[ActNone] = m_groupNames;
 	m_groupNames.Sort();
 	m_knownUsers.Sort();
+	std::atomic_store(&m_userActionMasks, std::shared_ptr<const UserActionMasks>(std::move(masks)));
 }
 
 void UserActions::UpdateUI()
@@ -304,7 +338,8 @@ wxColour UserActions::GetGroupColor(const wxString& group) const
 
 bool UserActions::IsKnown(const wxString& name, bool outputWarning) const
 {
-	bool ret = m_knownUsers.Index(name) != -1;
+	const std::shared_ptr<const UserActionMasks> masks = std::atomic_load(&m_userActionMasks);
+	bool ret = masks->byName.count(STD_STRING(name)) > 0;
 	if (outputWarning) {
 		customMessageBoxModal(SL_MAIN_ICON, _("To prevent logical inconsistencies, adding a user to more than one group is not allowed"),
 				      _("Cannot add user to group"));
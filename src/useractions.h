@@ -6,6 +6,11 @@
 #include <wx/arrstr.h>
 #include <map>
 #include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "utils/stringpool.h"
 
 class wxColour;
 
@@ -38,7 +43,10 @@ public:
 		/// update this when adding new actions.
 		ActLast = ActNotifStatus
 	};
-	bool DoActionOnUser(const ActionType action, const wxString& name);
+	//! these can be called from any thread
+	bool DoActionOnUser(const ActionType action, const wxString& name) const;
+	bool DoActionOnUser(const ActionType action, const std::string& name) const;
+	bool DoActionOnUser(const ActionType action, StringId name) const;
 	wxArrayString GetGroupNames() const;
 	void AddUserToGroup(const wxString& group, const wxString& name);
 	void AddGroup(const wxString& name);
@@ -80,15 +88,23 @@ private:
 	typedef std::map<ActionType, wxArrayString> ActionGroupsMap;
 	/// ActionType --> array of groups with that actiontype
 	ActionGroupsMap m_actionsGroups;
-	typedef std::map<ActionType, wxArrayString> ActionPeopleMap;
-	/// ActionType --> array of people with that actiontype
-	ActionPeopleMap m_actionsPeople;
 	///nickname --> group map (we don't allow users to be in more than one group
 	typedef std::map<wxString, wxString> PeopleGroupMap;
 	PeopleGroupMap m_peopleGroup;
 	///list all known users in groups
 	wxArrayString m_knownUsers;
 
+	/// actions of all known users compiled into bitmasks of ActionType, rebuilt by Init
+	struct UserActionMasks {
+		UserActionMasks() = default;
+		UserActionMasks(const UserActionMasks&) = delete;
+		~UserActionMasks();
+		std::unordered_map<std::string, unsigned int> byName;
+		std::unordered_map<StringId, unsigned int> byId; //holds one pool reference per nick, so ids aren't reused while queried
+	};
+	/// replaced as a whole on changes, so queries from other threads see consistent data
+	std::shared_ptr<const UserActionMasks> m_userActionMasks;
+
 	//reload all maps and stuff
 	void Init();
 	void UpdateUI();
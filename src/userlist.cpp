@@ -12,73 +12,186 @@ lsl/container/userlist.cpp
 #include "userlist.h"
 
 #include <wx/log.h>
-#include <iterator>
+#include <algorithm>
 #include <stdexcept>
 
 #include "log.h"
 #include "user.h"
 #include "utils/conversion.h"
 
-const UserList::user_map_t::size_type SEEKPOS_INVALID = UserList::user_map_t::size_type(-1);
+// initial size of the nick index, has to be a power of two
+#define INDEX_MIN_BUCKETS 16
 
 UserList::UserList()
-    : m_seek(m_users.end())
-    , m_seekpos(SEEKPOS_INVALID)
+    : m_index(INDEX_MIN_BUCKETS, 0)
 {
 }
 
+UserList::UserList(const UserList& other)
+    : m_users(other.m_users)
+    , m_nicks(other.m_nicks)
+    , m_index(other.m_index)
+    , m_sorted(other.m_sorted)
+    , m_sorted_nicks(other.m_sorted_nicks)
+{
+	for (const StringId nick : m_nicks) {
+		StringPool::Instance()->AddRef(nick);
+	}
+}
+
+UserList& UserList::operator=(const UserList& other)
+{
+	for (const StringId nick : other.m_nicks) {
+		StringPool::Instance()->AddRef(nick);
+	}
+	for (const StringId nick : m_nicks) {
+		StringPool::Instance()->Release(nick);
+	}
+	m_users = other.m_users;
+	m_nicks = other.m_nicks;
+	m_index = other.m_index;
+	m_sorted = other.m_sorted;
+	m_sorted_nicks = other.m_sorted_nicks;
+	return *this;
+}
+
 UserList::~UserList()
 {
-	m_seek = m_users.end();
-	m_seekpos = SEEKPOS_INVALID;
+	for (const StringId nick : m_nicks) {
+		StringPool::Instance()->Release(nick);
+	}
+}
+
+size_t UserList::HomeBucket(StringId nick) const
+{
+	// ids are sequential, scramble them so neighbours don't form clusters
+	const uint32_t hash = nick * 2654435761u;
+	return (hash ^ (hash >> 16)) & (m_index.size() - 1);
+}
+
+size_t UserList::FindBucket(StringId nick) const
+{
+	const size_t mask = m_index.size() - 1;
+	size_t bucket = HomeBucket(nick);
+	while (m_index[bucket] != 0 && m_nicks[m_index[bucket] - 1] != nick) {
+		bucket = (bucket + 1) & mask;
+	}
+	return bucket;
+}
+
+void UserList::Rehash(size_t buckets)
+{
+	m_index.assign(buckets, 0);
+	for (size_t i = 0; i < m_nicks.size(); i++) {
+		m_index[FindBucket(m_nicks[i])] = i + 1;
+	}
+}
+
+size_t UserList::SortedPosition(StringId nick) const
+{
+	StringPool* pool = StringPool::Instance();
+	const std::string& name = pool->GetString(nick);
+	const auto it = std::lower_bound(m_sorted_nicks.begin(), m_sorted_nicks.end(), name, [pool](StringId id, const std::string& value) {
+		return pool->GetString(id) < value;
+	});
+	return it - m_sorted_nicks.begin();
 }
 
 void UserList::AddUser(User& user)
 {
-	m_users[user.GetNick()] = &user;
-	m_seekpos = SEEKPOS_INVALID;
+	const StringId nick = user.GetNickId();
+	size_t bucket = FindBucket(nick);
+	if (m_index[bucket] != 0) { // replace, same as std::map::operator[]
+		m_users[m_index[bucket] - 1] = &user;
+		m_sorted[SortedPosition(nick)] = &user;
+		return;
+	}
+	if ((m_users.size() + 1) * 2 > m_index.size()) { // keep the index at most half full
+		Rehash(m_index.size() * 2);
+		bucket = FindBucket(nick);
+	}
+	StringPool::Instance()->AddRef(nick); // keeps the id valid even if the user is deleted first
+	m_users.push_back(&user);
+	m_nicks.push_back(nick);
+	m_index[bucket] = m_users.size();
+
+	const size_t sorted = SortedPosition(nick);
+	m_sorted.insert(m_sorted.begin() + sorted, &user);
+	m_sorted_nicks.insert(m_sorted_nicks.begin() + sorted, nick);
 }
 
 void UserList::RemoveUser(const std::string& nick)
 {
-	m_users.erase(nick);
-	m_seekpos = SEEKPOS_INVALID;
+	StringId id;
+	if (StringPool::Instance()->Find(nick, id)) {
+		RemoveUser(id);
+	}
+}
+
+void UserList::RemoveUser(StringId nick)
+{
+	size_t bucket = FindBucket(nick);
+	if (m_index[bucket] == 0) {
+		return;
+	}
+	const size_t pos = m_index[bucket] - 1;
+
+	// backward shift deletion, keeps the probe sequences intact without tombstones
+	const size_t mask = m_index.size() - 1;
+	size_t next = (bucket + 1) & mask;
+	while (m_index[next] != 0) {
+		const size_t home = HomeBucket(m_nicks[m_index[next] - 1]);
+		if (((next - home) & mask) >= ((next - bucket) & mask)) {
+			m_index[bucket] = m_index[next];
+			bucket = next;
+		}
+		next = (next + 1) & mask;
+	}
+	m_index[bucket] = 0;
+
+	// move the last user into the free position
+	const size_t last = m_users.size() - 1;
+	if (pos != last) {
+		m_index[FindBucket(m_nicks[last])] = pos + 1;
+		m_users[pos] = m_users[last];
+		m_nicks[pos] = m_nicks[last];
+	}
+	m_users.pop_back();
+	m_nicks.pop_back();
+
+	const size_t sorted = SortedPosition(nick);
+	m_sorted.erase(m_sorted.begin() + sorted);
+	m_sorted_nicks.erase(m_sorted_nicks.begin() + sorted);
+	StringPool::Instance()->Release(nick);
 }
 
 User& UserList::GetUser(const std::string& nick) const
 {
-	user_const_iter_t u = m_users.find(nick);
+	StringId id;
+	User* user = StringPool::Instance()->Find(nick, id) ? FindUser(id) : nullptr;
 	// user doesn't exist -> throw excpetion (else it will crash/invalid mem access / bad things will happen! in the next line)
-	ASSERT_EXCEPTION(u != m_users.end(), _T("UserList::GetUser(\"") + TowxString(nick) + _T("\"): no such user"));
-	assert(u != m_users.end());
-	return *u->second;
+	ASSERT_EXCEPTION(user != nullptr, _T("UserList::GetUser(\"") + TowxString(nick) + _T("\"): no such user"));
+	return *user;
 }
 
-User& UserList::GetUser(user_map_t::size_type index) const
+User* UserList::FindUser(StringId nick) const
 {
-	if ((m_seekpos == SEEKPOS_INVALID) || (m_seekpos > index)) {
-		m_seek = m_users.begin();
-		m_seekpos = 0;
-	}
-	std::advance(m_seek, index - m_seekpos);
-	m_seekpos = index;
-	return *m_seek->second;
+	const uint32_t pos = m_index[FindBucket(nick)];
+	return pos != 0 ? m_users[pos - 1] : nullptr;
 }
 
-bool UserList::UserExists(std::string const& nick) const
+User& UserList::GetUser(size_type index) const
 {
-	return m_users.find(nick) != m_users.end();
+	return *m_sorted[index];
 }
 
-UserList::user_map_t::size_type UserList::GetNumUsers() const
+bool UserList::UserExists(std::string const& nick) const
 {
-	return m_users.size();
+	StringId id;
+	return StringPool::Instance()->Find(nick, id) && m_index[FindBucket(id)] != 0;
 }
 
-void UserList::Nullify()
+UserList::size_type UserList::GetNumUsers() const
 {
-	for (user_map_t::iterator it = m_users.begin(); it != m_users.begin(); ++it) {
-		delete it->second;
-		it->second = NULL;
-	}
+	return m_users.size();
 }
@@ -13,46 +13,60 @@ lsl/container/userlist.h
 !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 **/
 
-#include <map>
+#include <cstdint>
 #include <string>
+#include <vector>
+
+#include "utils/stringpool.h"
 
 class User;
 
+//! @brief List of users with O(1) access by nick.
+//! Users are kept in a contiguous array, their interned nick ids are indexed
+//! by an open addressing hash table. Removing a user moves the last user into
+//! its slot. Access by position uses a second array sorted by nick, so the
+//! order is stable (i.e. player numbers in the start script).
 class UserList
 {
 public:
-	//! @brief mapping from nick to user object
-	typedef std::map<std::string, User*> user_map_t;
-	//! @brief iterator for user map
-	typedef user_map_t::iterator user_iter_t;
-	typedef user_map_t::const_iterator user_const_iter_t;
+	typedef std::vector<User*> user_vec_t;
+	typedef user_vec_t::size_type size_type;
 
 	UserList();
+	UserList(const UserList& other);
+	UserList& operator=(const UserList& other);
 	~UserList();
 
 	void AddUser(User& user);
 	void RemoveUser(std::string const& nick);
 	User& GetUser(std::string const& nick) const;
-	User& GetUser(user_map_t::size_type index) const;
+	User& GetUser(size_type index) const;
 	bool UserExists(std::string const& nick) const;
-	user_map_t::size_type GetNumUsers() const;
+	//! lookup by interned nick, returns nullptr if the user isn't in the list
+	User* FindUser(StringId nick) const;
+	void RemoveUser(StringId nick);
+	size_type GetNumUsers() const;
 
-	void Nullify();
-	const user_map_t& GetUsers() const
+	//! all users, sorted by nick
+	const user_vec_t& GetUsers() const
 	{
-		return m_users;
+		return m_sorted;
 	}
-	/*
-	UserList& operator= (const UserList& other) = delete;
-	UserList& operator= (const UserList&& other);
-*/
 protected:
-	user_map_t m_users;
+	user_vec_t m_users;
 
 private:
-	// The following are used as internal cache to speed up random access:
-	mutable user_const_iter_t m_seek;
-	mutable user_map_t::size_type m_seekpos;
+	//! returns the bucket containing nick or the empty bucket where it would be inserted
+	size_t FindBucket(StringId nick) const;
+	size_t HomeBucket(StringId nick) const;
+	void Rehash(size_t buckets);
+	//! position of nick in m_sorted or where it would be inserted
+	size_t SortedPosition(StringId nick) const;
+
+	std::vector<StringId> m_nicks;    //same order as m_users, referenced in the StringPool
+	std::vector<uint32_t> m_index;    //position in m_users + 1, 0 marks an empty bucket
+	user_vec_t m_sorted;              //m_users sorted by nick
+	std::vector<StringId> m_sorted_nicks; //same order as m_sorted
 };
 
 #endif // SPRINGLOBBY_HEADERGUARD_USERLIST_H
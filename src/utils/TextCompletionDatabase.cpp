@@ -1,8 +1,8 @@
 /* This file is part of the Springlobby (GPL v2 or later), see COPYING */
 #include "TextCompletionDatabase.h"
 
-#include <wx/regex.h>
 #include <wx/string.h>
+#include <algorithm>
 //--------------------------------------------------------------------------------
 ///
 /// Konstruktor
@@ -33,7 +33,22 @@ unsigned int
 TextCompletionDatabase::Size()
 {
 
-	return hm.size();
+	return entries.size();
+}
+
+//--------------------------------------------------------------------------------
+///
+/// Find the Entry of an Abbreviation, or the Position to insert it at.
+///
+//--------------------------------------------------------------------------------
+std::vector<TextCompletionDatabase::Entry>::iterator
+TextCompletionDatabase::Find(const wxString& key, const wxString& abbreviation)
+{
+	return std::lower_bound(entries.begin(), entries.end(), std::make_pair(&key, &abbreviation),
+				[](const Entry& entry, const std::pair<const wxString*, const wxString*>& value) {
+					const int cmp = entry.key.compare(*value.first);
+					return cmp < 0 || (cmp == 0 && entry.value.abbreviation < *value.second);
+				});
 }
 
 //--------------------------------------------------------------------------------
@@ -49,11 +64,11 @@ TextCompletionDatabase::Size()
 //--------------------------------------------------------------------------------
 void TextCompletionDatabase::Insert_Mapping(const wxString& abbreviation, const wxString& mapping)
 {
+	const wxString key = abbreviation.Lower();
+	std::vector<Entry>::iterator iter = Find(key, abbreviation);
 
-	HashMap_String_String::const_iterator iter = hm.find(abbreviation);
-
-	if (iter == hm.end()) {
-		hm[abbreviation] = mapping;
+	if (iter == entries.end() || iter->value.abbreviation != abbreviation) {
+		entries.insert(iter, Entry{key, Mapping{abbreviation, mapping}});
 	}
 }
 
@@ -68,64 +83,68 @@ void TextCompletionDatabase::Insert_Mapping(const wxString& abbreviation, const
 void TextCompletionDatabase::Delete_Mapping(const wxString& abbreviation)
 {
 
-	HashMap_String_String::iterator iter = hm.find(abbreviation);
+	std::vector<Entry>::iterator iter = Find(abbreviation.Lower(), abbreviation);
 
-	if (iter != hm.end()) {
-		hm.erase(iter);
+	if (iter != entries.end() && iter->value.abbreviation == abbreviation) {
+		entries.erase(iter);
 	}
 }
 
 //--------------------------------------------------------------------------------
 ///
-/// Get all Abbreviations, that match the provided Abbreviation. All matching Abbreviations and their corresponding Mapping are returned.
+/// Get all Abbreviations, that start with the provided Text, ignoring the Case. All matching Abbreviations and their corresponding Mapping are returned.
 ///
-/// \parem abbreviaton
-///		The Abbreviation to search for matching Abbreviations already contained in the TextCompletionDatabase.
+/// \parem text
+///		The Text to search for matching Abbreviations already contained in the TextCompletionDatabase.
+///
+/// \parem max
+///		The maximum Count of Matches to return.
 ///
 /// \return
-///		A HashMap containing all Matches.
+///		The best Matches first: Abbreviations equal to the Text, then shorter ones before longer ones.
 ///
 //--------------------------------------------------------------------------------
-HashMap_String_String
-TextCompletionDatabase::GetMapping(wxString abbreviation)
+std::vector<TextCompletionDatabase::Mapping>
+TextCompletionDatabase::GetMapping(const wxString& text, size_t max) const
 {
+	std::vector<Mapping> result;
+	if (text.empty()) {
+		return result;
+	}
 
-	HashMap_String_String hashmap;
-
-	// Search for all Abbreviations, containing the provided one.
-
-	// The Regex Container
-	wxRegEx regex_Abbreviations;
-
-	// We build the regular Expression:
-
-	// We need to escape all regular Expression Characters, that have a special Meaning
-	abbreviation.Replace(_T("["), _T("\\["));
-	abbreviation.Replace(_T("]"), _T("\\]"));
-
-	wxString regex_Text;
-	regex_Text.append(abbreviation);
-	regex_Text.append(wxT(".*"));
-
-// We compile the regular Expression and if it's correct, we store it in the Regex Container
-#ifdef wxHAS_REGEX_ADVANCED
-	regex_Abbreviations.Compile(regex_Text, wxRE_ADVANCED | wxRE_ICASE);
-#else
-	regex_Abbreviations.Compile(regex_Text, wxRE_EXTENDED | wxRE_ICASE);
-#endif
-
-
-	// Now we iterate over all stored Abbreviations and search for Abbreviations containing the provided Abbreviation
+	// All Abbreviations with the Prefix are next to each other, starting at the first one not less than it
+	const wxString prefix = text.Lower();
+	std::vector<Entry>::const_iterator begin = std::lower_bound(entries.begin(), entries.end(), prefix, [](const Entry& entry, const wxString& value) {
+		return entry.key < value;
+	});
+	std::vector<Entry>::const_iterator end = begin;
+	while (end != entries.end() && end->key.compare(0, prefix.length(), prefix) == 0) {
+		++end;
+	}
 
-	// std::cout << "Abbr: (" << abbreviation.char_str() << ")" << std::endl;
+	std::vector<const Entry*> matches;
+	matches.reserve(end - begin);
+	for (std::vector<Entry>::const_iterator iter = begin; iter != end; ++iter) {
+		matches.push_back(&*iter);
+	}
 
-	for (HashMap_String_String::const_iterator iter = hm.begin(); iter != hm.end(); ++iter) {
-		// std::cout << "iter->first: (" << iter->first.char_str() << ")" << std::endl;
-		if (regex_Abbreviations.Matches(iter->first)) {
-			// std::cout << "Match found!" << std::endl;
-			hashmap[iter->first] = iter->second;
+	const auto rank = [&text](const Entry* a, const Entry* b) {
+		const bool a_exact = a->value.abbreviation == text;
+		const bool b_exact = b->value.abbreviation == text;
+		if (a_exact != b_exact) {
+			return a_exact;
 		}
+		if (a->key.length() != b->key.length()) {
+			return a->key.length() < b->key.length();
+		}
+		return a->key < b->key;
+	};
+	const size_t count = std::min(max, matches.size());
+	std::partial_sort(matches.begin(), matches.begin() + count, matches.end(), rank);
+
+	result.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		result.push_back(matches[i]->value);
 	}
-
-	return hashmap;
+	return result;
 }
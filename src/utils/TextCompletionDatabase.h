@@ -4,14 +4,18 @@
 #define TEXTCOMPLETIONDATABASE_HPP
 
 // wxWidgets
-#include <wx/hashmap.h>
 #include <wx/string.h>
-WX_DECLARE_STRING_HASH_MAP(wxString, HashMap_String_String);
+#include <vector>
 
 
 class TextCompletionDatabase
 {
 public:
+	struct Mapping {
+		wxString abbreviation;
+		wxString mapping;
+	};
+
 	TextCompletionDatabase();
 	virtual ~TextCompletionDatabase();
 
@@ -19,10 +23,17 @@ public:
 
 	void Insert_Mapping(const wxString& abbreviation, const wxString& mapping);
 	void Delete_Mapping(const wxString& abbreviation);
-	HashMap_String_String GetMapping(wxString text);
+	std::vector<Mapping> GetMapping(const wxString& text, size_t max = 100) const;
 
 private:
-	HashMap_String_String hm;
+	struct Entry {
+		wxString key; //!< lower case abbreviation, the entries are sorted by it
+		Mapping value;
+	};
+
+	std::vector<Entry>::iterator Find(const wxString& key, const wxString& abbreviation);
+
+	std::vector<Entry> entries;
 };
 
 #endif // TEXTCOMPLETIONDATABASE_HPP
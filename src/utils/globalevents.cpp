@@ -2,6 +2,7 @@
 #include "globalevents.h"
 
 #include <wx/app.h>
+#include <thread>
 #include <vector>
 
 #include "log.h"
@@ -30,44 +31,97 @@ const wxEventType GlobalEventManager::OnUpdateFinished = wxNewEventType();
 const wxEventType GlobalEventManager::ApplicationSettingsChangedEvent =
     wxNewEventType();
 
-GlobalEventManager* GlobalEventManager::m_Instance = nullptr;
+std::atomic<GlobalEventManager*> GlobalEventManager::m_Instance(nullptr);
+
+//! connected instead of the handler of a coalesced subscription, receives the
+//! queued event and calls the handler with the latest one sent
+class GlobalEventManager::CoalescingSink : public wxEvtHandler
+{
+public:
+	CoalescingSink(wxEvtHandler* handler, wxObjectEventFunction func)
+	    : m_handler(handler)
+	    , m_func(func)
+	    , m_pending(false)
+	{
+	}
+
+	//! stores event to be delivered, returns true if none is queued yet
+	bool Update(const wxEvent& event)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_latest.reset(event.Clone());
+		if (m_pending) {
+			return false;
+		}
+		m_pending = true;
+		return true;
+	}
+
+	void OnEvent(wxEvent& /*queued*/)
+	{
+		std::unique_ptr<wxEvent> event;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			event.swap(m_latest);
+			m_pending = false;
+		}
+		if (event) {
+			(m_handler->*m_func)(*event);
+		}
+	}
+
+private:
+	wxEvtHandler* m_handler;
+	wxObjectEventFunction m_func;
+	std::unique_ptr<wxEvent> m_latest;
+	bool m_pending;
+	std::mutex m_mutex;
+};
 
 GlobalEventManager::GlobalEventManager()
     : m_eventsDisabled(false)
+    , m_eventsTable(std::make_shared<EventsTable>())
+    , m_epoch(0)
 {
 	slLogDebugFunc("");
+	m_senders[0] = 0;
+	m_senders[1] = 0;
 }
 
 GlobalEventManager::~GlobalEventManager()
 {
-	if (!m_eventsTable.empty()) {
+	if (!m_eventsTable->empty()) {
 		wxLogWarning("GlobalEventManager::~GlobalEventManager(): not all subscribers had unsubscibed (expect a crash after this!)");
-		for (const auto& evts : m_eventsTable) {
+		for (const auto& evts : *m_eventsTable) {
 			for (const auto& evt : evts.second) {
-				wxLogWarning("%s", evt.second.c_str());
+				wxLogWarning("%s", evt.debuginfo.c_str());
 			}
 		}
-		m_eventsTable.clear();
+		m_eventsTable.reset();
 	}
 	m_Instance = nullptr;
 }
 
 GlobalEventManager* GlobalEventManager::Instance()
 {
-	if (m_Instance == nullptr) {
-		m_Instance = new GlobalEventManager();
+	GlobalEventManager* instance = m_Instance;
+	if (instance == nullptr) {
+		static std::mutex mutex;
+		std::lock_guard<std::mutex> lock(mutex);
+		instance = m_Instance;
+		if (instance == nullptr) {
+			instance = new GlobalEventManager();
+			m_Instance = instance;
+		}
 	}
-	return m_Instance;
+	return instance;
 }
 
 void GlobalEventManager::Release()
 {
 	slLogDebugFunc("");
 
-	if (m_Instance != nullptr) {
-		delete m_Instance;
-	}
-	m_Instance = nullptr;
+	delete m_Instance.exchange(nullptr);
 }
 
 void GlobalEventManager::Send(wxEventType type)
@@ -87,13 +141,20 @@ void GlobalEventManager::Send(wxCommandEvent event)
 		m_eventsDisabled = true;
 	}
 
-	if (m_eventsTable.find(event.GetEventType()) == m_eventsTable.end())
-		return;
-
-	const auto& evtlist = m_eventsTable[event.GetEventType()];
-	for (const auto& evt : evtlist) {
-		evt.first->QueueEvent(event.Clone());
+	const unsigned int epoch = m_epoch & 1;
+	m_senders[epoch]++;
+	{
+		const std::shared_ptr<const EventsTable> table = std::atomic_load(&m_eventsTable);
+		const auto it = table->find(event.GetEventType());
+		if (it != table->end()) {
+			for (const Subscriber& evt : it->second) {
+				if ((evt.sink == nullptr) || evt.sink->Update(event)) {
+					evt.handler->QueueEvent(event.Clone());
+				}
+			}
+		}
 	}
+	m_senders[epoch]--;
 }
 
 void GlobalEventManager::Send(wxEventType type, void* clientData)
@@ -103,17 +164,19 @@ void GlobalEventManager::Send(wxEventType type, void* clientData)
 	Send(evt);
 }
 
-void GlobalEventManager::Subscribe(wxEvtHandler* evh, wxEventType id, wxObjectEventFunction func, const std::string& debuginfo)
+void GlobalEventManager::Subscribe(wxEvtHandler* evh, wxEventType id, wxObjectEventFunction func, const std::string& debuginfo, bool coalesce)
 {
 	slLogDebugFunc("");
 
-	GlobalEventManager::_Connect(evh, id, func, debuginfo);
+	std::lock_guard<std::mutex> lock(m_write_mutex);
+	GlobalEventManager::_Connect(evh, id, func, debuginfo, coalesce);
 }
 
 void GlobalEventManager::UnSubscribe(wxEvtHandler* evh, wxEventType id)
 {
 	slLogDebugFunc("");
 
+	std::lock_guard<std::mutex> lock(m_write_mutex);
 	GlobalEventManager::_Disconnect(evh, id);
 }
 
@@ -121,66 +184,89 @@ void GlobalEventManager::UnSubscribeAll(wxEvtHandler* evh)
 {
 	slLogDebugFunc("");
 
-	assert(m_eventsTable.size() != 0);
+	std::lock_guard<std::mutex> lock(m_write_mutex);
+	assert(m_eventsTable->size() != 0);
 
 	_Disconnect(evh, ANY_EVENT);
 }
 
-void GlobalEventManager::_Connect(wxEvtHandler* evthandler, wxEventType id, wxObjectEventFunction func, const std::string& debuginfo)
+// replaces the subscribers and waits until no Send() uses the old ones anymore.
+// Senders count in the slot of the current epoch, flipping it twice and waiting
+// for the old slot to drain each time covers all calls started before the swap
+// without waiting for ones started later
+void GlobalEventManager::Publish(std::shared_ptr<const EventsTable> table)
+{
+	std::atomic_store(&m_eventsTable, std::move(table));
+	for (int i = 0; i < 2; i++) {
+		const unsigned int old = m_epoch++ & 1;
+		while (m_senders[old] != 0) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void GlobalEventManager::_Connect(wxEvtHandler* evthandler, wxEventType id, wxObjectEventFunction func, const std::string& debuginfo, bool coalesce)
 {
 	assert(evthandler != nullptr);
 	assert(func != nullptr);
 
-	std::map<wxEvtHandler*, const std::string>& evtlist = m_eventsTable[id];
-	if (evtlist.find(evthandler) != evtlist.end()) {
-		assert(false);
-		return;
+	std::shared_ptr<EventsTable> table = std::make_shared<EventsTable>(*m_eventsTable);
+	std::vector<Subscriber>& evtlist = (*table)[id];
+	for (const Subscriber& evt : evtlist) {
+		if (evt.handler == evthandler) {
+			assert(false);
+			return;
+		}
 	}
 	//	printf("connected event! %lu\n", evthandler);
-	evthandler->Connect(id, func);
-	evtlist.insert(std::make_pair(evthandler, debuginfo));
+	Subscriber subscriber = {evthandler, debuginfo, nullptr};
+	if (coalesce) {
+		subscriber.sink = std::make_shared<CoalescingSink>(evthandler, func);
+		evthandler->Connect(id, SlWxObjectEventFunction(&CoalescingSink::OnEvent), nullptr, subscriber.sink.get());
+	} else {
+		evthandler->Connect(id, func);
+	}
+	evtlist.push_back(subscriber);
 	assert(!evtlist.empty());
+	Publish(std::move(table));
 }
 
 // removes the given eventhandler for the specified event type
 void GlobalEventManager::_Disconnect(wxEvtHandler* evthandler, wxEventType id)
 {
-	//Unlink event handler from all kinds of event types
-	if (id == ANY_EVENT) {
-		std::vector<wxEventType> removalCollection;
-
-		for (auto& it : m_eventsTable) {
-			auto pos = it.second.find(evthandler);
-			if (pos == it.second.end())
+	std::shared_ptr<EventsTable> table = std::make_shared<EventsTable>(*m_eventsTable);
+	bool found = false;
+	for (auto it = table->begin(); it != table->end();) {
+		//Unlink event handler from all kinds of event types or only the specified one
+		if (id != ANY_EVENT && it->first != id) {
+			++it;
+			continue;
+		}
+		std::vector<Subscriber>& evtlist = it->second;
+		for (auto pos = evtlist.begin(); pos != evtlist.end(); ++pos) {
+			if (pos->handler != evthandler) {
 				continue;
-			evthandler->Disconnect(it.first);
-			it.second.erase(pos);
-			if (it.second.empty()) {
-				removalCollection.push_back(it.first);
 			}
+			if (pos->sink != nullptr) {
+				evthandler->Disconnect(it->first, SlWxObjectEventFunction(&CoalescingSink::OnEvent), nullptr, pos->sink.get());
+			} else {
+				evthandler->Disconnect(it->first);
+			}
+			evtlist.erase(pos);
+			found = true;
+			break;
 		}
 		//Clear m_eventsTable from empty records
 		//those having Id but contain no event handlers
-		for (auto it : removalCollection) {
-			m_eventsTable.erase(it);
-		}
-	} else {
-		//Unlink event handler from only specified event type
-
-		auto it = m_eventsTable.find(id);
-		if (it == m_eventsTable.end()) {
-			assert(false);
-			return;
-		}
-		auto pos = it->second.find(evthandler);
-		if (pos == it->second.end()) {
-			assert(false);
-			return;
-		}
-		evthandler->Disconnect(it->first);
-		it->second.erase(pos);
-		if (it->second.empty()) {
-			m_eventsTable.erase(id);
+		if (evtlist.empty()) {
+			it = table->erase(it);
+		} else {
+			++it;
 		}
 	}
+	if (!found) {
+		assert(id == ANY_EVENT);
+		return;
+	}
+	Publish(std::move(table));
 }
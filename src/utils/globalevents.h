@@ -4,9 +4,20 @@
 #define SPRINGLOBBY_HEADERGUARD_GLOBALEVENTS_H
 
 #include <wx/event.h>
+#include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <string>
+#include <vector>
 #include "utils/conversion.h"
+
+//! Delivers global events to all subscribed handlers.
+//! Send() can be called from any thread, it works on an immutable snapshot of
+//! the subscribers which Subscribe() / UnSubscribe() replace. UnSubscribe()
+//! waits for Send() calls still using the old snapshot, so no events are queued
+//! to a handler after it unsubscribed.
 class GlobalEventManager
 {
 private:
@@ -18,7 +29,9 @@ public:
 	static void Release();
 
 public:
-	void Subscribe(wxEvtHandler* evh, wxEventType id, wxObjectEventFunction func, const std::string& debuginfo);
+	//! with coalesce, events sent while one is still queued for evh replace
+	//! it, so only the latest one is delivered (useful for progress updates)
+	void Subscribe(wxEvtHandler* evh, wxEventType id, wxObjectEventFunction func, const std::string& debuginfo, bool coalesce = false);
 	void UnSubscribe(wxEvtHandler* evh, wxEventType id = 0);
 	void UnSubscribeAll(wxEvtHandler* evh);
 
@@ -27,8 +40,17 @@ public:
 	void Send(wxEventType type, void* clientData);
 
 private:
-	void _Connect(wxEvtHandler* evthandler, wxEventType id, wxObjectEventFunction func, const std::string& debuginfo);
+	class CoalescingSink;
+	struct Subscriber {
+		wxEvtHandler* handler;
+		std::string debuginfo;
+		std::shared_ptr<CoalescingSink> sink; //!< set if events are coalesced
+	};
+	typedef std::map<wxEventType, std::vector<Subscriber> > EventsTable;
+
+	void _Connect(wxEvtHandler* evthandler, wxEventType id, wxObjectEventFunction func, const std::string& debuginfo, bool coalesce);
 	void _Disconnect(wxEvtHandler* evthandler, wxEventType id = 0);
+	void Publish(std::shared_ptr<const EventsTable> table);
 
 public:
 	static const wxEventType OnDownloadStarted;
@@ -54,11 +76,14 @@ public:
 	static const wxEventType ApplicationSettingsChangedEvent;
 
 private:
-	static GlobalEventManager* m_Instance;
+	static std::atomic<GlobalEventManager*> m_Instance;
 
 private:
-	bool m_eventsDisabled;
-	std::map<wxEventType, std::map<wxEvtHandler*, const std::string> > m_eventsTable;
+	std::atomic<bool> m_eventsDisabled;
+	std::shared_ptr<const EventsTable> m_eventsTable; //!< only accessed with std::atomic_load/store
+	std::atomic<unsigned int> m_epoch;		  //!< Send() calls count in m_senders[m_epoch & 1]
+	std::atomic<int> m_senders[2];			  //!< Send() calls in progress
+	std::mutex m_write_mutex;			  //!< serializes changes of m_eventsTable
 	const int ANY_EVENT = 0;
 };
 
@@ -84,5 +109,8 @@ static inline wxObjectEventFunction SlWxObjectEventFunction(T func)
 #define SUBSCRIBE_GLOBAL_EVENT(event, callbackfunc) \
 	GlobalEventManager::Instance()->Subscribe(this, event, SlWxObjectEventFunction(&callbackfunc), stdprintf("%s:%d %s()", __FILE__, __LINE__, __func__))
 
+#define SUBSCRIBE_GLOBAL_EVENT_COALESCED(event, callbackfunc) \
+	GlobalEventManager::Instance()->Subscribe(this, event, SlWxObjectEventFunction(&callbackfunc), stdprintf("%s:%d %s()", __FILE__, __LINE__, __func__), true)
+
 
 #endif // SPRINGLOBBY_HEADERGUARD_GLOBALEVENTS_H
@@ -0,0 +1,119 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "highlightmatcher.h"
+
+#include <algorithm>
+#include <queue>
+
+HighlightMatcher::HighlightMatcher()
+    : m_nodes(1)
+{
+	m_nodes[0].fail = 0;
+	m_nodes[0].word = -1;
+	m_nodes[0].output = -1;
+}
+
+HighlightMatcher::HighlightMatcher(const std::vector<std::wstring>& words)
+    : HighlightMatcher()
+{
+	// build the trie
+	for (const std::wstring& word : words) {
+		if (word.empty()) {
+			continue;
+		}
+		int node = 0;
+		for (const wchar_t c : word) {
+			int child = Child(node, c);
+			if (child < 0) {
+				child = m_nodes.size();
+				std::vector<std::pair<wchar_t, int>>& next = m_nodes[node].next;
+				next.insert(std::upper_bound(next.begin(), next.end(), std::make_pair(c, -1)), std::make_pair(c, child));
+				m_nodes.push_back(Node());
+				m_nodes[child].word = -1;
+				m_nodes[child].output = -1;
+			}
+			node = child;
+		}
+		if (m_nodes[node].word < 0) {
+			m_nodes[node].word = m_words.size();
+			m_words.push_back(word.size());
+		}
+	}
+
+	// link every node to the node of its longest proper suffix, breadth first
+	// so the links of shorter prefixes are known already
+	std::queue<int> todo;
+	for (const auto& child : m_nodes[0].next) {
+		m_nodes[child.second].fail = 0;
+		todo.push(child.second);
+	}
+	while (!todo.empty()) {
+		const int node = todo.front();
+		todo.pop();
+		for (const auto& child : m_nodes[node].next) {
+			Node& next = m_nodes[child.second];
+			next.fail = Step(m_nodes[node].fail, child.first);
+			const Node& fail = m_nodes[next.fail];
+			next.output = (fail.word >= 0) ? next.fail : fail.output;
+			todo.push(child.second);
+		}
+	}
+}
+
+int HighlightMatcher::Child(int node, wchar_t c) const
+{
+	const std::vector<std::pair<wchar_t, int>>& next = m_nodes[node].next;
+	const auto it = std::lower_bound(next.begin(), next.end(), std::make_pair(c, -1));
+	if ((it == next.end()) || (it->first != c)) {
+		return -1;
+	}
+	return it->second;
+}
+
+int HighlightMatcher::Step(int node, wchar_t c) const
+{
+	while (true) {
+		const int child = Child(node, c);
+		if (child >= 0) {
+			return child;
+		}
+		if (node == 0) {
+			return 0;
+		}
+		node = m_nodes[node].fail;
+	}
+}
+
+bool HighlightMatcher::Contains(const std::wstring& text) const
+{
+	if (Empty()) {
+		return false;
+	}
+	int node = 0;
+	for (const wchar_t c : text) {
+		node = Step(node, c);
+		if ((m_nodes[node].word >= 0) || (m_nodes[node].output >= 0)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+std::vector<HighlightMatcher::Match> HighlightMatcher::FindAll(const std::wstring& text) const
+{
+	std::vector<Match> res;
+	if (Empty()) {
+		return res;
+	}
+	int node = 0;
+	for (size_t i = 0; i < text.size(); i++) {
+		node = Step(node, text[i]);
+		int out = (m_nodes[node].word >= 0) ? node : m_nodes[node].output;
+		while (out >= 0) {
+			const size_t len = m_words[m_nodes[out].word];
+			res.push_back(Match{i + 1 - len, len});
+			out = m_nodes[out].output;
+		}
+	}
+	return res;
+}
@@ -0,0 +1,52 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_HIGHLIGHTMATCHER_H
+#define SPRINGLOBBY_HEADERGUARD_HIGHLIGHTMATCHER_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+//! @brief Finds any of a set of words in a text with a single pass over it.
+//! The words are compiled into an Aho-Corasick automaton, so the cost of a
+//! lookup only depends on the length of the text, not on the count of words.
+//! Matching is case sensitive, empty words are ignored.
+class HighlightMatcher
+{
+public:
+	struct Match {
+		size_t pos;
+		size_t len;
+	};
+
+	HighlightMatcher();
+	explicit HighlightMatcher(const std::vector<std::wstring>& words);
+
+	bool Empty() const
+	{
+		return m_words.empty();
+	}
+
+	//! true if any word occurs in text
+	bool Contains(const std::wstring& text) const;
+	//! all occurrences of all words, ordered by their end position. For words
+	//! ending at the same position the longest comes first.
+	std::vector<Match> FindAll(const std::wstring& text) const;
+
+private:
+	struct Node {
+		std::vector<std::pair<wchar_t, int>> next; // sorted by char
+		int fail;
+		int word;   //!< index of the longest word ending here, -1 for none
+		int output; //!< next node on the fail chain which ends a word, -1 for none
+	};
+
+	int Child(int node, wchar_t c) const;
+	int Step(int node, wchar_t c) const;
+
+	std::vector<Node> m_nodes;
+	std::vector<size_t> m_words; //!< word lengths
+};
+
+#endif // SPRINGLOBBY_HEADERGUARD_HIGHLIGHTMATCHER_H
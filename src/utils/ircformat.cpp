@@ -0,0 +1,160 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "ircformat.h"
+
+#include <type_traits>
+
+namespace
+{
+
+enum {
+	IRC_BOLD = 0x02,
+	IRC_COLOR = 0x03,
+	IRC_RESET = 0x0f,
+	IRC_MONOSPACE = 0x11,
+	IRC_REVERSE = 0x16,
+	IRC_ITALICS = 0x1d,
+	IRC_STRIKETHROUGH = 0x1e,
+	IRC_UNDERLINE = 0x1f,
+};
+
+//! mIRC uses it to switch back to the default color
+const int IRC_COLOR_DEFAULT_CODE = 99;
+
+template <typename Char>
+unsigned int Code(Char c)
+{
+	return static_cast<typename std::make_unsigned<Char>::type>(c);
+}
+
+template <typename Char>
+bool IsFormatCode(Char c)
+{
+	switch (Code(c)) {
+		case IRC_BOLD:
+		case IRC_COLOR:
+		case IRC_RESET:
+		case IRC_MONOSPACE:
+		case IRC_REVERSE:
+		case IRC_ITALICS:
+		case IRC_STRIKETHROUGH:
+		case IRC_UNDERLINE:
+			return true;
+	}
+	return false;
+}
+
+template <typename Char>
+bool IsDigit(Char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+// reads the up to two digits of a color number at pos, -1 if there are none
+template <typename Char>
+int ReadColor(std::basic_string_view<Char> text, size_t& pos)
+{
+	int color = -1;
+	for (int i = 0; i < 2 && pos < text.size() && IsDigit(text[pos]); i++, pos++) {
+		color = (color < 0 ? 0 : color * 10) + (text[pos] - '0');
+	}
+	return color;
+}
+
+template <typename Char>
+void Parse(std::basic_string_view<Char> text, std::basic_string<Char>& plain, std::vector<IrcTextRun>& runs)
+{
+	plain.clear();
+	plain.reserve(text.size());
+	runs.clear();
+
+	int color = IRC_DEFAULT_COLOR;
+	bool bold = false;
+	size_t pos = 0;
+	while (pos < text.size()) {
+		// add the text up to the next code as a whole
+		size_t end = pos;
+		while (end < text.size() && !IsFormatCode(text[end])) {
+			end++;
+		}
+		if (end > pos) {
+			if (!runs.empty() && runs.back().color == color && runs.back().bold == bold) {
+				runs.back().length += end - pos;
+			} else {
+				runs.push_back({plain.size(), end - pos, color, bold});
+			}
+			plain.append(text.data() + pos, end - pos);
+			pos = end;
+			if (pos >= text.size()) {
+				break;
+			}
+		}
+
+		switch (Code(text[pos++])) {
+			case IRC_BOLD:
+				bold = !bold;
+				break;
+			case IRC_COLOR: {
+				const int fg = ReadColor(text, pos);
+				if (fg < 0) { // a color code without number resets the color
+					color = IRC_DEFAULT_COLOR;
+					break;
+				}
+				if (pos + 1 < text.size() && text[pos] == ',' && IsDigit(text[pos + 1])) {
+					pos++;
+					ReadColor(text, pos); // background colors aren't supported
+				}
+				if (fg < IRC_COLOR_COUNT) {
+					color = fg;
+				} else if (fg == IRC_COLOR_DEFAULT_CODE) {
+					color = IRC_DEFAULT_COLOR;
+				}
+				break;
+			}
+			case IRC_RESET:
+				bold = false;
+				color = IRC_DEFAULT_COLOR;
+				break;
+			default: // underline, italics, ... are dropped
+				break;
+		}
+	}
+}
+
+template <typename Char>
+std::basic_string<Char> Strip(std::basic_string_view<Char> text)
+{
+	size_t pos = 0;
+	while (pos < text.size() && !IsFormatCode(text[pos])) {
+		pos++;
+	}
+	if (pos == text.size()) {
+		return std::basic_string<Char>(text);
+	}
+	std::basic_string<Char> plain;
+	std::vector<IrcTextRun> runs;
+	Parse(text, plain, runs);
+	return plain;
+}
+
+} // namespace
+
+void ParseIrcFormatting(std::wstring_view text, std::wstring& plain, std::vector<IrcTextRun>& runs)
+{
+	Parse(text, plain, runs);
+}
+
+void ParseIrcFormatting(std::string_view text, std::string& plain, std::vector<IrcTextRun>& runs)
+{
+	Parse(text, plain, runs);
+}
+
+std::wstring StripIrcFormatting(std::wstring_view text)
+{
+	return Strip(text);
+}
+
+std::string StripIrcFormatting(std::string_view text)
+{
+	return Strip(text);
+}
@@ -0,0 +1,37 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_IRCFORMAT_H
+#define SPRINGLOBBY_HEADERGUARD_IRCFORMAT_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//! color of text without a color code (or after a reset)
+constexpr int IRC_DEFAULT_COLOR = -1;
+//! count of colors in the irc palette, color codes beyond it are ignored
+constexpr int IRC_COLOR_COUNT = 16;
+
+//! text with the same formatting, offset and length refer to the plain text
+struct IrcTextRun {
+	size_t offset;
+	size_t length;
+	int color; //!< index in the irc palette or IRC_DEFAULT_COLOR
+	bool bold;
+};
+
+//! @brief Splits text containing irc formatting codes in a single pass.
+//! plain receives the text without the codes, runs the formatting of it.
+//! Adjacent text with the same formatting is one run, empty runs are omitted.
+//! Supported are bold (^B), colors (^C, a background color is skipped) and
+//! reset (^O), the other formatting codes are removed.
+//! See http://en.wikichip.org/wiki/irc/colors
+void ParseIrcFormatting(std::wstring_view text, std::wstring& plain, std::vector<IrcTextRun>& runs);
+void ParseIrcFormatting(std::string_view text, std::string& plain, std::vector<IrcTextRun>& runs);
+
+//! text without irc formatting codes
+std::wstring StripIrcFormatting(std::wstring_view text);
+std::string StripIrcFormatting(std::string_view text);
+
+#endif // SPRINGLOBBY_HEADERGUARD_IRCFORMAT_H
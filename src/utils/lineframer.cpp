@@ -0,0 +1,68 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "lineframer.h"
+
+#include <cstring>
+
+LineFramer::LineFramer()
+    : m_read(0)
+    , m_scan(0)
+{
+}
+
+void LineFramer::Append(const char* data, size_t len)
+{
+	Compact();
+	m_buffer.reserve(m_buffer.size() + len);
+	const char* end = data + len;
+	while (data < end) {
+		const char* cr = static_cast<const char*>(memchr(data, '\r', end - data));
+		if (cr == nullptr) {
+			m_buffer.append(data, end - data);
+			break;
+		}
+		m_buffer.append(data, cr - data);
+		data = cr + 1;
+	}
+}
+
+bool LineFramer::Next(std::string_view& line)
+{
+	const char* base = m_buffer.data();
+	const char* nl = static_cast<const char*>(memchr(base + m_scan, '\n', m_buffer.size() - m_scan));
+	if (nl == nullptr) {
+		m_scan = m_buffer.size();
+		return false;
+	}
+	const size_t pos = nl - base;
+	line = std::string_view(base + m_read, pos - m_read);
+	m_read = pos + 1;
+	m_scan = m_read;
+	return true;
+}
+
+void LineFramer::Clear()
+{
+	m_buffer.clear();
+	m_read = 0;
+	m_scan = 0;
+}
+
+void LineFramer::Compact()
+{
+	if (m_read == 0) {
+		return;
+	}
+	if (m_read == m_buffer.size()) {
+		Clear();
+		return;
+	}
+	// only move the incomplete tail when it is small compared to what was consumed,
+	// this keeps the cost amortized O(1) per byte
+	if (m_read < m_buffer.size() - m_read) {
+		return;
+	}
+	m_buffer.erase(0, m_read);
+	m_scan -= m_read;
+	m_read = 0;
+}
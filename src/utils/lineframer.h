@@ -0,0 +1,43 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_LINEFRAMER_H
+#define SPRINGLOBBY_HEADERGUARD_LINEFRAMER_H
+
+#include <string>
+#include <string_view>
+
+//! @brief Splits a stream of received bytes into '\n' terminated lines.
+//! Only newly appended bytes are scanned, '\r' is dropped while appending and
+//! consumed lines are discarded lazily, so a burst of n lines costs O(n).
+class LineFramer
+{
+public:
+	LineFramer();
+
+	void Append(const char* data, size_t len);
+	void Append(const std::string& data)
+	{
+		Append(data.data(), data.size());
+	}
+
+	//! fetch the next complete line (without the trailing '\n')
+	//! @note line stays valid until the next call to Append() or Clear()
+	bool Next(std::string_view& line);
+
+	void Clear();
+
+	//! number of buffered bytes which don't belong to a returned line yet
+	size_t Pending() const
+	{
+		return m_buffer.size() - m_read;
+	}
+
+private:
+	void Compact();
+
+	std::string m_buffer;
+	size_t m_read; //start of the first line not returned yet
+	size_t m_scan; //everything before this was already searched for '\n'
+};
+
+#endif // SPRINGLOBBY_HEADERGUARD_LINEFRAMER_H
@@ -0,0 +1,65 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_SPSCQUEUE_H
+#define SPRINGLOBBY_HEADERGUARD_SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+//! @brief Bounded lock-free queue for exactly one producer and one consumer thread.
+//! Push() may only be called by the producer, Pop() only by the consumer.
+template <typename T>
+class SPSCQueue
+{
+public:
+	//! capacity is rounded up to the next power of two
+	explicit SPSCQueue(size_t capacity)
+	    : m_head(0)
+	    , m_tail(0)
+	{
+		size_t size = 2;
+		while (size < capacity) {
+			size *= 2;
+		}
+		m_items.resize(size);
+		m_mask = size - 1;
+	}
+
+	//! returns false when the queue is full, item is left untouched then
+	bool Push(T&& item)
+	{
+		const size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) > m_mask) {
+			return false;
+		}
+		m_items[tail & m_mask] = std::move(item);
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool Pop(T& item)
+	{
+		const size_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire)) {
+			return false;
+		}
+		item = std::move(m_items[head & m_mask]);
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool Empty() const
+	{
+		return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+	}
+
+private:
+	std::vector<T> m_items;
+	size_t m_mask;
+	alignas(64) std::atomic<size_t> m_head; //next item to pop, written by the consumer
+	alignas(64) std::atomic<size_t> m_tail; //next free slot, written by the producer
+};
+
+#endif // SPRINGLOBBY_HEADERGUARD_SPSCQUEUE_H
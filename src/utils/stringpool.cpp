@@ -0,0 +1,119 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "stringpool.h"
+
+#include <wx/log.h>
+#include <wx/string.h>
+
+#include "conversion.h"
+
+struct StringPool::Entry {
+	std::string str;
+	wxString wxstr;
+	uint32_t refs = 0;
+};
+
+StringPool* StringPool::Instance()
+{
+	static StringPool pool;
+	return &pool;
+}
+
+StringPool::StringPool()
+    : m_count(0)
+{
+	Intern(std::string_view()); // the empty string is never released
+}
+
+StringPool::~StringPool()
+{
+}
+
+StringId StringPool::Intern(std::string_view str)
+{
+	std::unique_lock<std::shared_mutex> lock(m_mutex);
+	auto it = m_ids.find(str);
+	if (it != m_ids.end()) {
+		GetEntry(it->second).refs++;
+		return it->second;
+	}
+
+	StringId id;
+	if (!m_free.empty()) {
+		id = m_free.back();
+		m_free.pop_back();
+	} else {
+		const size_t chunk = m_count >> CHUNK_BITS;
+		if (chunk >= MAX_CHUNKS) {
+			wxLogError(_T("StringPool::Intern(): pool is full"));
+			return 0;
+		}
+		if (!m_chunks[chunk]) {
+			m_chunks[chunk].reset(new Entry[CHUNK_SIZE]);
+		}
+		id = m_count++;
+	}
+	Entry& entry = GetEntry(id);
+	entry.str.assign(str.data(), str.size());
+	entry.wxstr = TowxString(entry.str);
+	entry.refs = 1;
+	m_ids.emplace(entry.str, id);
+	return id;
+}
+
+void StringPool::AddRef(StringId id)
+{
+	if (id == 0) {
+		return;
+	}
+	std::unique_lock<std::shared_mutex> lock(m_mutex);
+	GetEntry(id).refs++;
+}
+
+void StringPool::Release(StringId id)
+{
+	if (id == 0) {
+		return;
+	}
+	std::unique_lock<std::shared_mutex> lock(m_mutex);
+	Entry& entry = GetEntry(id);
+	if (entry.refs == 0 || --entry.refs > 0) {
+		return;
+	}
+	m_ids.erase(entry.str);
+	std::string().swap(entry.str);
+	entry.wxstr = wxString();
+	m_free.push_back(id);
+}
+
+bool StringPool::Find(std::string_view str, StringId& id) const
+{
+	std::shared_lock<std::shared_mutex> lock(m_mutex);
+	auto it = m_ids.find(str);
+	if (it == m_ids.end()) {
+		return false;
+	}
+	id = it->second;
+	return true;
+}
+
+StringPool::Entry& StringPool::GetEntry(StringId id) const
+{
+	return m_chunks[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)];
+}
+
+const std::string& StringPool::GetString(StringId id) const
+{
+	return GetEntry(id).str;
+}
+
+const wxString& StringPool::GetWxString(StringId id) const
+{
+	return GetEntry(id).wxstr;
+}
+
+size_t StringPool::GetCount() const
+{
+	std::shared_lock<std::shared_mutex> lock(m_mutex);
+	return m_count - m_free.size();
+}
@@ -0,0 +1,69 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_STRINGPOOL_H
+#define SPRINGLOBBY_HEADERGUARD_STRINGPOOL_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class wxString;
+
+//! id of a string stored in the StringPool, 0 is the empty string
+typedef uint32_t StringId;
+
+//! @brief Process wide pool for strings which are repeated all over the
+//! lobby state (nicks, countries, channel names).
+//! Every distinct string is stored once together with its wxString version
+//! and identified by a compact id. Entries are reference counted: Intern()
+//! and AddRef() take a reference, Release() drops it. An id and the
+//! references returned for it stay valid while it is referenced, after that
+//! the entry is freed and its id reused.
+//! Interning is thread safe, Find() only takes a shared lock and resolving
+//! an id doesn't lock at all.
+class StringPool
+{
+public:
+	static StringPool* Instance();
+
+	StringPool();
+	~StringPool();
+
+	//! returns the id of str and references it, adds it to the pool if it is unknown
+	//! never throws, returns the id of the empty string if the pool is full
+	StringId Intern(std::string_view str);
+	void AddRef(StringId id);
+	void Release(StringId id);
+	//! looks up an already interned string without adding it or taking a reference
+	bool Find(std::string_view str, StringId& id) const;
+
+	const std::string& GetString(StringId id) const;
+	const wxString& GetWxString(StringId id) const;
+
+	//! number of strings in the pool
+	size_t GetCount() const;
+
+private:
+	struct Entry;
+
+	static const size_t CHUNK_BITS = 12;
+	static const size_t CHUNK_SIZE = 1 << CHUNK_BITS;
+	static const size_t MAX_CHUNKS = 4096;
+
+	Entry& GetEntry(StringId id) const;
+
+	//! entries are allocated in fixed chunks which never move, so readers
+	//! don't have to synchronize with a concurrent Intern()
+	std::unique_ptr<Entry[]> m_chunks[MAX_CHUNKS];
+	std::unordered_map<std::string_view, StringId> m_ids; //views into m_chunks
+	std::vector<StringId> m_free; //released entries, reused first
+	size_t m_count;               //entries ever allocated
+	mutable std::shared_mutex m_mutex; //exclusive for changes, shared for lookups
+};
+
+#endif // SPRINGLOBBY_HEADERGUARD_STRINGPOOL_H
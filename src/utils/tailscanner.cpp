@@ -0,0 +1,110 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#include "tailscanner.h"
+
+#include <wx/file.h>
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+MappedFile::MappedFile(wxFile& file)
+    : m_data(nullptr)
+    , m_size(0)
+#ifdef _WIN32
+    , m_mapping(nullptr)
+#endif
+{
+	const wxFileOffset length = file.Length();
+	if (!file.IsOpened() || length <= 0 || static_cast<unsigned long long>(length) > SIZE_MAX) {
+		return;
+	}
+#ifdef _WIN32
+	const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(file.fd()));
+	m_mapping = CreateFileMapping(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_mapping == NULL) {
+		return;
+	}
+	m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+	void* data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file.fd(), 0);
+	if (data == MAP_FAILED) {
+		return;
+	}
+	m_data = static_cast<const char*>(data);
+#endif
+	m_size = length;
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+	if (m_data != nullptr) {
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping != nullptr) {
+		CloseHandle(m_mapping);
+	}
+#else
+	if (m_data != nullptr) {
+		munmap(const_cast<char*>(m_data), m_size);
+	}
+#endif
+}
+
+//! last occurrence of c in the first size bytes of data
+static inline const char* FindLast(const char* data, char c, size_t size)
+{
+#ifdef __GLIBC__
+	return static_cast<const char*>(memrchr(data, c, size));
+#else
+	for (const char* pos = data + size; pos > data;) {
+		if (*--pos == c) {
+			return pos;
+		}
+	}
+	return nullptr;
+#endif
+}
+
+size_t FindTailLines(const char* data, size_t size, std::string_view eol, size_t count, bool at_start, std::vector<std::string_view>& lines)
+{
+	lines.clear();
+	if (eol.empty() || count == 0) {
+		return 0;
+	}
+
+	// find the delimiters by their last byte, memrchr is vectorized
+	const char last = eol.back();
+	const size_t offset = eol.size() - 1;
+	bool have_end = false;
+	size_t end = 0; //!< start of the delimiter ending the current line
+	size_t remaining = size;
+	while (lines.size() < count) {
+		const char* found = FindLast(data, last, remaining);
+		if (found == nullptr) {
+			break;
+		}
+		remaining = found - data;
+		if (remaining < offset || memcmp(found - offset, eol.data(), offset) != 0) {
+			continue;
+		}
+		const size_t pos = remaining - offset;
+		if (have_end && end > remaining + 1) {
+			lines.emplace_back(data + remaining + 1, end - remaining - 1);
+		}
+		end = pos;
+		have_end = true;
+		remaining = pos;
+	}
+	if (at_start && have_end && end > 0 && lines.size() < count) {
+		lines.emplace_back(data, end);
+	}
+	std::reverse(lines.begin(), lines.end());
+	return lines.size();
+}
@@ -0,0 +1,59 @@
+/* This file is part of the Springlobby (GPL v2 or later), see COPYING */
+
+#ifndef SPRINGLOBBY_HEADERGUARD_TAILSCANNER_H
+#define SPRINGLOBBY_HEADERGUARD_TAILSCANNER_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "utils/mixins.h"
+
+class wxFile;
+
+//! @brief Read-only memory mapping of a whole file.
+class MappedFile : public SL::NonCopyable
+{
+public:
+	//! maps file, which has to be opened for reading
+	explicit MappedFile(wxFile& file);
+	~MappedFile();
+
+	//! false if the file couldn't be mapped, empty files are never mapped
+	bool IsOk() const
+	{
+		return m_data != nullptr;
+	}
+	const char* GetData() const
+	{
+		return m_data;
+	}
+	size_t GetSize() const
+	{
+		return m_size;
+	}
+
+private:
+	const char* m_data;
+	size_t m_size;
+#ifdef _WIN32
+	void* m_mapping;
+#endif
+};
+
+/** Finds the last lines of a text, searching backwards from its end.
+ *
+ * @param data Text to search.
+ * @param size Length of @p data.
+ * @param eol Line delimiter, text after the last one is an incomplete line
+ * and ignored, as are empty lines.
+ * @param count Maximum number of lines to find.
+ * @param at_start Whether @p data is the start of the file, otherwise text
+ * before the first delimiter may be a partial line and is ignored.
+ * @param lines Receives the lines found, oldest first.
+ *
+ * @return Number of lines found.
+ */
+size_t FindTailLines(const char* data, size_t size, std::string_view eol, size_t count, bool at_start, std::vector<std::string_view>& lines);
+
+#endif // SPRINGLOBBY_HEADERGUARD_TAILSCANNER_H